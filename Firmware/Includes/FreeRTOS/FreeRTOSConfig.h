@@ -13,6 +13,14 @@
 
 extern void log_panic(const char *fmt, ...);
 
+extern void rtos_stats_init(void);
+extern uint32_t rtos_stats_get_counter(void);
+extern void rtos_stats_switched_in(void *task);
+extern void rtos_stats_notify(void *task);
+extern void rtos_trace_task_switch(const int in, const uint32_t taskNumber);
+extern void rtos_trace_task_notify(const uint32_t taskNumber);
+extern void rtos_trace_queue(const uint8_t type, const void *queue);
+
 /// enable preemptive multithreading
 #define configUSE_PREEMPTION                                    1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION                 1
@@ -64,7 +72,18 @@ extern void log_panic(const char *fmt, ...);
 #define configUSE_APPLICATION_TASK_TAG                          0
 #define configUSE_COUNTING_SEMAPHORES                           1
 #define configUSE_QUEUE_SETS                                    1
-#define configGENERATE_RUN_TIME_STATS                           0
+
+/**
+ * @brief Runtime statistics
+ *
+ * Task runtime is accounted using the Cortex-M DWT cycle counter, extended to 64 bits and then
+ * divided down, so the 32-bit counter FreeRTOS keeps wraps only every few minutes.
+ *
+ * @seealso Rtos/Stats.cpp
+ */
+#define configGENERATE_RUN_TIME_STATS                           1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()                rtos_stats_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()                        rtos_stats_get_counter()
 
 /// Disable coroutines
 #define configUSE_CO_ROUTINES                                   0
@@ -147,6 +166,36 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
     for( ;; );\
 }\
 
+/**
+ * @brief Kernel trace hooks
+ *
+ * These feed the notification latency statistics (the time a task spends between being notified
+ * and actually getting switched in) as well as the event tracer. They're invoked from inside the
+ * kernel with interrupts masked.
+ *
+ * Queue event type values correspond to `Rtos::Trace::Event`.
+ *
+ * @seealso Rtos/Trace.cpp
+ */
+#define traceTASK_SWITCHED_IN()                                 do { \
+    rtos_stats_switched_in(pxCurrentTCB); \
+    rtos_trace_task_switch(1, pxCurrentTCB->uxTCBNumber); \
+} while(0)
+#define traceTASK_SWITCHED_OUT()                                rtos_trace_task_switch(0, pxCurrentTCB->uxTCBNumber)
+#define traceTASK_NOTIFY(...)                                   do { \
+    rtos_stats_notify(pxTCB); \
+    rtos_trace_task_notify(pxTCB->uxTCBNumber); \
+} while(0)
+#define traceTASK_NOTIFY_FROM_ISR(...)                          traceTASK_NOTIFY()
+#define traceTASK_NOTIFY_GIVE_FROM_ISR(...)                     traceTASK_NOTIFY()
+
+#define traceQUEUE_SEND(pxQueue)                                rtos_trace_queue(0x05, (pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)                       rtos_trace_queue(0x05, (pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue)                             rtos_trace_queue(0x06, (pxQueue))
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)                    rtos_trace_queue(0x06, (pxQueue))
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)                    rtos_trace_queue(0x07, (pxQueue))
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)                 rtos_trace_queue(0x08, (pxQueue))
+
 /*
  * Map the FreeRTOS interrupt handler names to the CMSIS equivalents.
  */
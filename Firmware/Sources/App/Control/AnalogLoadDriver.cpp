@@ -0,0 +1,550 @@
+#include "AnalogLoadDriver.h"
+
+#include "Drivers/SpiBus.h"
+#include "Drivers/I2CDevice/AT24CS32.h"
+
+#include "Log/Logger.h"
+#include "Rtos/Rtos.h"
+
+#include <etl/array.h>
+
+using namespace App::Control;
+
+/// IO expander pin configuration: only the sense relay output is used
+static const etl::array<Drivers::I2CDevice::PI4IOE5V9536::PinConfig,
+    Drivers::I2CDevice::PI4IOE5V9536::kIoLines> gIoPinConfig{{
+    // IO0: sense relay (active high)
+    {
+        .input = false,
+        .initialOutput = false,
+    },
+    Drivers::I2CDevice::PI4IOE5V9536::kPinConfigUnused,
+    Drivers::I2CDevice::PI4IOE5V9536::kPinConfigUnused,
+    Drivers::I2CDevice::PI4IOE5V9536::kPinConfigUnused,
+}};
+
+/**
+ * @brief Thermal network of the channel MOSFETs
+ *
+ * Junction to case (two stages, fit to the transient thermal impedance curve of the MOSFET) and
+ * case to heatsink through the thermal pad.
+ */
+static const etl::array<LoadDriver::SafeOperatingArea::Stage, 3> gThermalStages{{
+    {.resistance = 300, .timeConstant = 5},
+    {.resistance = 150, .timeConstant = 50},
+    {.resistance = 500, .timeConstant = 1000},
+}};
+
+/// DC safe operating area of the channel MOSFETs (derated for linear mode operation)
+static const etl::array<LoadDriver::SafeOperatingArea::Point, 4> gSoaCurve{{
+    {.voltage = 0, .power = 100'000},
+    {.voltage = 10'000, .power = 100'000},
+    {.voltage = 30'000, .power = 75'000},
+    {.voltage = 60'000, .power = 40'000},
+}};
+
+const LoadDriver::SafeOperatingArea AnalogLoadDriver::kSafeOperatingArea{
+    .stages = gThermalStages,
+    .curve = gSoaCurve,
+    .maxJunctionTemp = 125'000,
+    .defaultHeatsinkTemp = 85'000,
+};
+
+const etl::array<uint8_t, AnalogLoadDriver::kAdcReadLength> AnalogLoadDriver::kAdcReadCommand{{
+    MakeAdcCommand(static_cast<uint8_t>(AdcRegister::AdcData), AdcCommand::StaticRead),
+    0, 0, 0,
+}};
+
+/**
+ * @brief Initialize the analog board
+ *
+ * Set up the sense relay and fan controller on the I²C bus, then reset and configure the DAC
+ * (with both outputs at zero) and ADCs on the SPI bus.
+ *
+ * @param bus I²C bus of the load board
+ * @param idprom Identification EEPROM of the load board
+ * @param spi SPI bus of the load board; its select lines must be connected to the board's
+ *        decoder
+ */
+AnalogLoadDriver::AnalogLoadDriver(Drivers::I2CBus *bus, Drivers::I2CDevice::AT24CS32 &idprom,
+        Drivers::SpiBus *spi) : LoadDriver(bus, idprom), spi(spi), io(bus, gIoPinConfig),
+    fan(bus, {}) {
+    int err;
+
+    // DAC first, so the channels are definitely off
+    err = this->initDacs();
+    REQUIRE(!err, "%s: failed to initialize %s (%d)", "AnalogLoadDriver", "DAC", err);
+
+    err = this->initAdcs();
+    REQUIRE(!err, "%s: failed to initialize %s (%d)", "AnalogLoadDriver", "ADCs", err);
+}
+
+/**
+ * @brief Shut down the analog board
+ *
+ * Set all channel currents to zero.
+ */
+AnalogLoadDriver::~AnalogLoadDriver() {
+    etl::array<uint16_t, kNumChannels> codes{};
+    this->writeDacs(codes);
+}
+
+
+
+/**
+ * @brief Handle the driver interrupt
+ *
+ * The current ADC completed a conversion, so read it out (along with the voltage ADC.)
+ */
+void AnalogLoadDriver::handleIrq() {
+    const auto err = this->readAdcs();
+    if(err) {
+        Logger::Warning("%s: failed to read ADCs (%d)", "AnalogLoadDriver", err);
+    }
+}
+
+/**
+ * @brief Change the load enable state
+ *
+ * When disabled, all channel DACs are set to zero; otherwise, the channel setpoints are applied.
+ */
+int AnalogLoadDriver::setEnabled(const bool isEnabled) {
+    this->isEnabled = isEnabled;
+    return this->applyChannelCurrents();
+}
+
+/**
+ * @brief Get the total input current
+ *
+ * Sum up the most recent current readings of all channels.
+ */
+int AnalogLoadDriver::readInputCurrent(uint32_t &outCurrent) {
+    uint32_t total{0};
+    for(const auto current : this->channelCurrent) {
+        total += current;
+    }
+
+    outCurrent = total;
+    return 0;
+}
+
+/**
+ * @brief Get the current of a single channel
+ *
+ * Return the most recent current reading of a channel.
+ */
+int AnalogLoadDriver::readChannelCurrent(const size_t channel, uint32_t &outCurrent) {
+    if(channel >= kNumChannels) {
+        return LoadDriver::Errors::InvalidChannel;
+    }
+
+    outCurrent = this->channelCurrent[channel];
+    return 0;
+}
+
+/**
+ * @brief Set the total load current
+ *
+ * The current is split evenly across all channels, and all DACs are updated in one go. If the
+ * load is disabled, the setpoint is only stored.
+ */
+int AnalogLoadDriver::setOutputCurrent(const uint32_t current) {
+    const auto perChannel = current / kNumChannels;
+    const auto remainder = current % kNumChannels;
+
+    for(size_t i = 0; i < kNumChannels; i++) {
+        this->channelSetpoint[i] = perChannel + ((i < remainder) ? 1 : 0);
+    }
+
+    return this->applyChannelCurrents();
+}
+
+/**
+ * @brief Set the current of each channel
+ *
+ * All DACs are updated in one go. If the load is disabled, the setpoints are only stored.
+ */
+int AnalogLoadDriver::setChannelCurrents(etl::span<const uint32_t> currents) {
+    if(currents.size() != kNumChannels) {
+        return LoadDriver::Errors::InvalidChannel;
+    }
+
+    for(size_t i = 0; i < kNumChannels; i++) {
+        this->channelSetpoint[i] = currents[i];
+    }
+
+    return this->applyChannelCurrents();
+}
+
+/**
+ * @brief Get the maximum input voltage
+ */
+int AnalogLoadDriver::getMaxInputVoltage(uint32_t &outVoltage) {
+    outVoltage = kMaxInputVoltage;
+    return 0;
+}
+
+/**
+ * @brief Get the maximum input current
+ *
+ * This is the sum of the full scale current of all channels.
+ */
+int AnalogLoadDriver::getMaxInputCurrent(uint32_t &outCurrent) {
+    outCurrent = (kChannelMaxCurrent / 1000) * kNumChannels;
+    return 0;
+}
+
+/**
+ * @brief Read the input voltage
+ *
+ * Return the most recent conversion of the voltage ADC, which is read along with the current ADC
+ * on every driver interrupt.
+ */
+int AnalogLoadDriver::readInputVoltage(uint32_t &outVoltage) {
+    outVoltage = this->inputVoltage;
+    return 0;
+}
+
+/**
+ * @brief Apply calibration to a converter
+ *
+ * Calibration tables apply to the current measured for each channel by the current ADC, the
+ * current requested from each channel's DAC output, and the voltage measured by the voltage ADC.
+ */
+int AnalogLoadDriver::setCalibration(const CalibrationTarget target, const size_t channel,
+        const CalibrationTable &table) {
+    switch(target) {
+        case CalibrationTarget::ChannelCurrentSense:
+        case CalibrationTarget::ChannelCurrentSetpoint:
+            if(channel >= kNumChannels) {
+                return LoadDriver::Errors::InvalidChannel;
+            }
+
+            if(target == CalibrationTarget::ChannelCurrentSense) {
+                this->currentSenseCal[channel] = table;
+            } else {
+                this->currentSetpointCal[channel] = table;
+            }
+            return 0;
+
+        case CalibrationTarget::InputVoltageSense:
+            if(channel) {
+                return LoadDriver::Errors::InvalidChannel;
+            }
+
+            this->voltageSenseCal = table;
+            return 0;
+    }
+
+    return LoadDriver::Errors::Unsupported;
+}
+
+/**
+ * @brief Switch the voltage sense relay
+ */
+int AnalogLoadDriver::setExternalVSense(const bool isExternal) {
+    return this->io.setOutput(kSenseRelayPin, isExternal);
+}
+
+/**
+ * @brief Read the heatsink temperature
+ *
+ * This is measured by the remote diode input of the fan controller.
+ */
+int AnalogLoadDriver::readHeatsinkTemperature(int32_t &outTemp) {
+    float temp;
+
+    const auto err = this->fan.getExternalTemp(temp);
+    if(err) {
+        return err;
+    }
+
+    outTemp = static_cast<int32_t>(temp * 1000.f);
+    return 0;
+}
+
+
+
+/**
+ * @brief Reset and configure both ADCs
+ *
+ * Then read them until the voltage ADC completed its first conversion, so that there's always an
+ * input voltage reading. This also ensures both ADCs are present.
+ *
+ * @return 0 on success, or a negative error code
+ */
+int AnalogLoadDriver::initAdcs() {
+    int err;
+
+    err = this->initAdc(SpiDevice::CurrentAdc, kCurrentAdcConfig);
+    if(err) {
+        return err;
+    }
+
+    err = this->initAdc(SpiDevice::VoltageAdc, kVoltageAdcConfig);
+    if(err) {
+        return err;
+    }
+
+    for(uint32_t elapsed = 0; elapsed <= kAdcStartupTimeout; elapsed++) {
+        err = this->readAdcs();
+        if(err || this->hasInputVoltage) {
+            return err;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+
+    return Errors::AdcNotResponding;
+}
+
+/**
+ * @brief Reset and configure an ADC
+ *
+ * The ADC gets a full reset, followed by a single incremental write of its configuration
+ * registers, which also starts continuous conversions.
+ *
+ * @param device Device address of the ADC
+ * @param config Register values to write
+ *
+ * @return 0 on success, or a negative error code
+ */
+int AnalogLoadDriver::initAdc(const SpiDevice device, const AdcConfig &config) {
+    constexpr static const etl::array<uint8_t, 1> kResetCmd{{
+        MakeAdcCommand(0b1110, AdcCommand::Fast),
+    }};
+
+    etl::array<uint8_t, 1 + sizeof(AdcConfig)> configCmd;
+    configCmd[0] = MakeAdcCommand(static_cast<uint8_t>(AdcRegister::Config0),
+            AdcCommand::IncrementalWrite);
+    for(size_t i = 0; i < config.size(); i++) {
+        configCmd[1 + i] = config[i];
+    }
+
+    const etl::array<Drivers::SpiBus::Transaction, 2> txns{{
+        {
+            .txBuf = kResetCmd.data(),
+            .length = kResetCmd.size(),
+        },
+        {
+            .txBuf = configCmd.data(),
+            .length = configCmd.size(),
+        },
+    }};
+
+    const etl::array<Drivers::SpiBus::Frame, txns.size()> frames{{
+        {
+            .device = static_cast<uint8_t>(device),
+            .transactions = {&txns[0], 1},
+        },
+        {
+            .device = static_cast<uint8_t>(device),
+            .transactions = {&txns[1], 1},
+        },
+    }};
+
+    return this->spi->performBatch(frames);
+}
+
+/**
+ * @brief Reset and configure the DAC
+ *
+ * All registers are reset (setting the outputs to zero) and the internal reference is disabled,
+ * since the board has a shared precision reference. The gain of both outputs is set to 1, and the
+ * LDAC pin is disabled, so that outputs are updated by software.
+ *
+ * @return 0 on success, or a negative error code
+ */
+int AnalogLoadDriver::initDacs() {
+    constexpr static const etl::array<etl::array<uint8_t, kDacFrameLength>, 4> kInitCmds{{
+        MakeDacFrame(DacCommand::Reset, 0, 0x0001),
+        MakeDacFrame(DacCommand::InternalReference, 0, 0x0000),
+        // gain register: gain of 1 for both outputs
+        MakeDacFrame(DacCommand::WriteInput, 0b010, 0x0003),
+        MakeDacFrame(DacCommand::Ldac, 0, 0x0003),
+    }};
+
+    etl::array<Drivers::SpiBus::Transaction, kInitCmds.size()> txns;
+    for(size_t i = 0; i < kInitCmds.size(); i++) {
+        txns[i] = {
+            .txBuf = kInitCmds[i].data(),
+            .length = kDacFrameLength,
+        };
+    }
+
+    etl::array<Drivers::SpiBus::Frame, kInitCmds.size()> frames;
+
+    for(size_t i = 0; i < txns.size(); i++) {
+        frames[i] = {
+            .device = static_cast<uint8_t>(SpiDevice::Dac),
+            .transactions = {&txns[i], 1},
+        };
+    }
+
+    return this->spi->performBatch(frames);
+}
+
+/**
+ * @brief Read both ADCs
+ *
+ * Perform a static read of the data register of both ADCs in one batch. The status byte clocked
+ * out with the command indicates whether an ADC has new data; only then is its reading updated.
+ * The current ADC's result carries the ID of the scan channel it's for, which selects the load
+ * channel to update.
+ *
+ * @return 0 on success, or a negative error code
+ */
+int AnalogLoadDriver::readAdcs() {
+    constexpr static const etl::array<SpiDevice, 2> kDevices{{
+        SpiDevice::CurrentAdc, SpiDevice::VoltageAdc,
+    }};
+
+    etl::array<Drivers::SpiBus::Transaction, kDevices.size()> txns;
+    etl::array<Drivers::SpiBus::Frame, kDevices.size()> frames;
+
+    for(size_t i = 0; i < kDevices.size(); i++) {
+        txns[i] = {
+            .rxBuf = this->adcRxBuf[i].data(),
+            .txBuf = kAdcReadCommand.data(),
+            .length = kAdcReadLength,
+        };
+        frames[i] = {
+            .device = static_cast<uint8_t>(kDevices[i]),
+            .transactions = {&txns[i], 1},
+        };
+    }
+
+    const auto err = this->spi->performBatch(frames);
+    if(err) {
+        return err;
+    }
+
+    for(size_t i = 0; i < kDevices.size(); i++) {
+        const auto &rx = this->adcRxBuf[i];
+
+        // status byte: [5:4] device address, [2] data ready (active low)
+        if(((rx[0] >> 4) & 0b11) != kAdcDeviceAddress) {
+            return Errors::AdcNotResponding;
+        } else if(rx[0] & (1 << 2)) {
+            continue;
+        }
+
+        // data: [31:28] channel ID, [27:24] sign extension, [23:0] code
+        const uint8_t channelId = rx[1] >> 4;
+        const uint32_t raw = (static_cast<uint32_t>(rx[2]) << 16) |
+            (static_cast<uint32_t>(rx[3]) << 8) | rx[4];
+        const auto code = static_cast<int32_t>(raw << 8) >> 8;
+
+        if(kDevices[i] == SpiDevice::VoltageAdc) {
+            const auto voltage = this->voltageSenseCal(CodeToVoltage(code));
+            this->inputVoltage = (voltage > 0) ? voltage : 0;
+            this->hasInputVoltage = true;
+            continue;
+        }
+
+        for(size_t channel = 0; channel < kNumChannels; channel++) {
+            if(kScanChannelIds[channel] != channelId) {
+                continue;
+            }
+
+            this->adcCodes[channel] = code;
+
+            const auto current = this->currentSenseCal[channel](CodeToCurrent(code));
+            this->channelCurrent[channel] = (current > 0) ? current : 0;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Write both DAC outputs
+ *
+ * The first channel's input register is written, then the second, which also updates both
+ * outputs. Both writes are performed in a single batch.
+ *
+ * @param codes DAC codes for each channel
+ *
+ * @return 0 on success, or a negative error code
+ */
+int AnalogLoadDriver::writeDacs(etl::span<const uint16_t, kNumChannels> codes) {
+    etl::array<Drivers::SpiBus::Transaction, kNumChannels> txns;
+    etl::array<Drivers::SpiBus::Frame, kNumChannels> frames;
+
+    for(size_t i = 0; i < kNumChannels; i++) {
+        const bool isSecond = (i & 1);
+
+        this->dacTxBuf[i] = MakeDacFrame(isSecond ? DacCommand::WriteInputUpdateAll :
+                DacCommand::WriteInput, isSecond ? 0b001 : 0b000, codes[i]);
+
+        txns[i] = {
+            .txBuf = this->dacTxBuf[i].data(),
+            .length = kDacFrameLength,
+        };
+        frames[i] = {
+            .device = static_cast<uint8_t>(SpiDevice::Dac),
+            .transactions = {&txns[i], 1},
+        };
+    }
+
+    return this->spi->performBatch(frames);
+}
+
+/**
+ * @brief Write the channel setpoints to the DACs
+ *
+ * If the load is disabled, all channels are set to zero instead.
+ *
+ * @return 0 on success, or a negative error code
+ */
+int AnalogLoadDriver::applyChannelCurrents() {
+    etl::array<uint16_t, kNumChannels> codes{};
+
+    if(this->isEnabled) {
+        for(size_t i = 0; i < kNumChannels; i++) {
+            const auto current = this->currentSetpointCal[i](
+                    static_cast<int32_t>(this->channelSetpoint[i]));
+            codes[i] = CurrentToCode((current > 0) ? current : 0);
+        }
+    }
+
+    return this->writeDacs(codes);
+}
+
+/**
+ * @brief Convert an ADC code to channel current
+ *
+ * @param code Signed ADC code
+ *
+ * @return Channel current, in µA; this may be negative, due to offset errors.
+ */
+int32_t AnalogLoadDriver::CodeToCurrent(const int32_t code) {
+    // shunt voltage (µV) = code * Vref / (2^23 * gain); current (µA) = 1000 * µV / mΩ
+    return (static_cast<int64_t>(code) * kReferenceVoltage * 1000) /
+        static_cast<int64_t>((1ULL << 23) * kCurrentAdcGain * kShuntResistance);
+}
+
+/**
+ * @brief Convert a voltage ADC code to input voltage
+ *
+ * @param code Signed ADC code
+ *
+ * @return Input voltage, in mV
+ */
+int32_t AnalogLoadDriver::CodeToVoltage(const int32_t code) {
+    // ADC input (µV) = code * Vref / 2^23; input voltage (mV) = µV * divider / 1000
+    return (static_cast<int64_t>(code) * kReferenceVoltage * kVSenseDivider) /
+        static_cast<int64_t>((1ULL << 23) * 1000);
+}
+
+/**
+ * @brief Convert a channel current to DAC code
+ *
+ * @param current Desired channel current (µA); clamped to the channel's maximum
+ *
+ * @return DAC code to set
+ */
+uint16_t AnalogLoadDriver::CurrentToCode(const uint32_t current) {
+    const auto clamped = (current > kChannelMaxCurrent) ? kChannelMaxCurrent : current;
+    return (static_cast<uint64_t>(clamped) * 0xFFFF) / kChannelMaxCurrent;
+}
@@ -0,0 +1,317 @@
+#ifndef APP_CONTROL_ANALOGLOADDRIVER_H
+#define APP_CONTROL_ANALOGLOADDRIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "LoadDriver.h"
+
+#include "Drivers/SpiBus.h"
+#include "Drivers/I2CDevice/EMC2101.h"
+#include "Drivers/I2CDevice/PI4IOE5V9536.h"
+#include "Util/Uuid.h"
+
+#include <etl/array.h>
+#include <etl/span.h>
+
+namespace App::Control {
+/**
+ * @brief Driver for the two channel analog load board
+ *
+ * This board has two independent channels, each with its own MOSFET and current sense resistor.
+ * The shunt voltages of both channels are measured by an MCP3562 24-bit ADC, which scans its two
+ * differential inputs; the current setpoints come from the two outputs of a DAC8562 16-bit DAC.
+ * The input voltage is measured by an MCP3561 ADC.
+ *
+ * All three sit on a shared SPI bus. The board decodes the bus' select lines into their chip
+ * selects (with a 74LVC1G139) so frames address them by device address, rather than chip select
+ * pins.
+ *
+ * Both ADCs convert continuously, but only the current ADC's (open drain) IRQ output is wired to
+ * the driver interrupt line. When it's asserted, both ADCs are read in a single batched SPI
+ * exchange; the current ADC's result updates the channel it belongs to, and the voltage ADC's
+ * the input voltage, if it indicated new data. Both DAC outputs are written in one burst, and
+ * updated simultaneously.
+ *
+ * The sense relay is driven by a PCA9536 IO expander on the board's I²C bus, and the heatsink
+ * temperature is measured by the remote diode of an EMC2101. The MOSFET temperatures measured by
+ * the board's MCP3426 aren't used yet.
+ */
+class AnalogLoadDriver: public LoadDriver {
+    public:
+        /**
+         * @brief Driver identifier (stored in the board's inventory ROM)
+         *
+         * @remark Placeholder: the design doesn't assign an identifier yet.
+         */
+        constexpr static const Util::Uuid kDriverId{etl::array<uint8_t, Util::Uuid::kByteSize>{{
+            0x5c, 0x3e, 0x1f, 0x2a, 0x8b, 0x47, 0x4e, 0x61,
+            0x9d, 0x02, 0x7a, 0xf4, 0x63, 0xc1, 0x0b, 0x95,
+        }}};
+
+        /// Number of load channels
+        constexpr static const size_t kNumChannels{2};
+
+        /// Errors specific to this driver
+        enum Errors: int {
+            /**
+             * @brief ADC not responding
+             *
+             * The status byte returned by one of the channel ADCs did not contain the expected
+             * device address; it's most likely not present, or the SPI bus is faulty.
+             */
+            AdcNotResponding            = -60000,
+        };
+
+    public:
+        AnalogLoadDriver(Drivers::I2CBus *bus, Drivers::I2CDevice::AT24CS32 &idprom,
+                Drivers::SpiBus *spi);
+        ~AnalogLoadDriver() override;
+
+        void handleIrq() override;
+
+        int setEnabled(const bool isEnabled) override;
+        int readInputCurrent(uint32_t &outCurrent) override;
+        int setOutputCurrent(const uint32_t current) override;
+        int getMaxInputVoltage(uint32_t &outVoltage) override;
+        int getMaxInputCurrent(uint32_t &outCurrent) override;
+
+        size_t getNumChannels() const override {
+            return kNumChannels;
+        }
+        int readChannelCurrent(const size_t channel, uint32_t &outCurrent) override;
+        int setChannelCurrents(etl::span<const uint32_t> currents) override;
+
+        int readInputVoltage(uint32_t &outVoltage) override;
+        int setExternalVSense(const bool isExternal) override;
+
+        int readHeatsinkTemperature(int32_t &outTemp) override;
+
+        const SafeOperatingArea *getSafeOperatingArea() const override {
+            return &kSafeOperatingArea;
+        }
+
+        int setCalibration(const CalibrationTarget target, const size_t channel,
+                const CalibrationTable &table) override;
+
+        /**
+         * @brief Get the most recent raw ADC code of a channel
+         *
+         * @param channel Channel index
+         *
+         * @return Signed 24-bit conversion result, as last read from the current ADC
+         */
+        inline int32_t getChannelCode(const size_t channel) const {
+            return this->adcCodes[channel];
+        }
+
+    private:
+        /**
+         * @brief Addresses of the SPI devices
+         *
+         * These are driven on the bus' select lines, and decoded on the board into the chip
+         * selects of the devices.
+         */
+        enum class SpiDevice: uint8_t {
+            /// MCP3561 measuring the input voltage (decoder output Y1, ~CS_ADC_1)
+            VoltageAdc                  = 1,
+            /// MCP3562 measuring the current of both channels (decoder output Y2, ~CS_ADC_0)
+            CurrentAdc                  = 2,
+            /// DAC8562 setting the current of both channels (decoder output Y3, ~CS_DAC)
+            Dac                         = 3,
+        };
+
+        /**
+         * @brief MCP356x register addresses
+         */
+        enum class AdcRegister: uint8_t {
+            AdcData                     = 0x0,
+            Config0                     = 0x1,
+            Config1                     = 0x2,
+            Config2                     = 0x3,
+            Config3                     = 0x4,
+            Irq                         = 0x5,
+            Mux                         = 0x6,
+            Scan                        = 0x7,
+        };
+
+        /**
+         * @brief MCP356x command types
+         *
+         * These are the low two bits of the command byte.
+         */
+        enum class AdcCommand: uint8_t {
+            Fast                        = 0b00,
+            StaticRead                  = 0b01,
+            IncrementalWrite            = 0b10,
+            IncrementalRead             = 0b11,
+        };
+
+        /// Register values from CONFIG0 through SCAN, written in one incremental write
+        using AdcConfig = etl::array<uint8_t, 9>;
+
+        /// Build an MCP356x command byte
+        constexpr static inline uint8_t MakeAdcCommand(const uint8_t addressOrFastCmd,
+                const AdcCommand type) {
+            return (kAdcDeviceAddress << 6) | ((addressOrFastCmd & 0xF) << 2) |
+                static_cast<uint8_t>(type);
+        }
+
+        /**
+         * @brief DAC8562 commands
+         *
+         * These are bits [21:19] of a write frame.
+         */
+        enum class DacCommand: uint8_t {
+            WriteInput                  = 0b000,
+            WriteInputUpdateAll         = 0b010,
+            PowerDown                   = 0b100,
+            Reset                       = 0b101,
+            Ldac                        = 0b110,
+            InternalReference           = 0b111,
+        };
+
+        /// Build a DAC8562 write frame
+        constexpr static inline etl::array<uint8_t, 3> MakeDacFrame(const DacCommand cmd,
+                const uint8_t address, const uint16_t data) {
+            return {{
+                static_cast<uint8_t>((static_cast<uint8_t>(cmd) << 3) | (address & 0b111)),
+                static_cast<uint8_t>(data >> 8),
+                static_cast<uint8_t>(data & 0xFF),
+            }};
+        }
+
+        int initAdcs();
+        int initAdc(const SpiDevice device, const AdcConfig &config);
+        int initDacs();
+
+        int readAdcs();
+        int writeDacs(etl::span<const uint16_t, kNumChannels> codes);
+        int applyChannelCurrents();
+
+        static int32_t CodeToCurrent(const int32_t code);
+        static int32_t CodeToVoltage(const int32_t code);
+        static uint16_t CurrentToCode(const uint32_t current);
+
+    private:
+        /// SPI device address of the ADCs (as set at the factory)
+        constexpr static const uint8_t kAdcDeviceAddress{0b01};
+        /// Length of an ADC data read (status byte, channel ID and sign-extended 24-bit code)
+        constexpr static const size_t kAdcReadLength{5};
+        /// Time to wait for the first voltage ADC conversion after configuring it (ms)
+        constexpr static const uint32_t kAdcStartupTimeout{50};
+        /// Length of a DAC write frame
+        constexpr static const size_t kDacFrameLength{3};
+
+        /**
+         * @brief Current ADC configuration
+         *
+         * Register values:
+         *
+         * - CONFIG0: internal clock (no clock output), continuous conversion mode
+         * - CONFIG1: no prescaler, OSR = 8192 (approximately 150 sps, so 75 sps per channel)
+         * - CONFIG2: 1x boost, 16x gain, no auto-zero
+         * - CONFIG3: continuous conversion, 32-bit data format with channel ID, no CRC/calibration
+         * - IRQ: IRQ output inactive high-Z (open drain), fast commands enabled, no conversion
+         *   start interrupt
+         * - MUX: unused in scan mode
+         * - SCAN: no delay, scan CH0 - CH1 (channel 0 shunt) and CH2 - CH3 (channel 1 shunt)
+         */
+        constexpr static const AdcConfig kCurrentAdcConfig{{
+            0b11'10'00'11, 0b00'1000'00, 0b10'101'0'11, 0b11'11'0'0'0'0, 0b0'000'01'1'0,
+            0b0000'0001, 0b000'00000, 0b0000'0011, 0b0000'0000,
+        }};
+        /// PGA gain set in the current ADC configuration
+        constexpr static const uint32_t kCurrentAdcGain{16};
+        /**
+         * @brief Scan channel IDs of each load channel
+         *
+         * The current ADC tags each result with the ID of the scan channel it came from; these are
+         * the differential inputs of each load channel's shunt.
+         */
+        constexpr static const etl::array<uint8_t, kNumChannels> kScanChannelIds{{
+            0x8, 0x9,
+        }};
+
+        /**
+         * @brief Voltage ADC configuration
+         *
+         * Same as the current ADC, except for:
+         *
+         * - CONFIG2: 1x boost, 1x gain, no auto-zero
+         * - MUX: CH0 (input voltage sense) - AGND
+         * - SCAN: disabled
+         */
+        constexpr static const AdcConfig kVoltageAdcConfig{{
+            0b11'10'00'11, 0b00'1000'00, 0b10'001'0'11, 0b11'11'0'0'0'0, 0b0'000'01'1'0,
+            0b0000'1000, 0b000'00000, 0b0000'0000, 0b0000'0000,
+        }};
+
+        /// Reference voltage for both ADCs and the DAC (µV)
+        constexpr static const uint32_t kReferenceVoltage{2'500'000};
+
+        /*
+         * The component values below aren't specified in the design yet; they're placeholders.
+         */
+        /// Value of each channel's current sense resistor (mΩ)
+        constexpr static const uint32_t kShuntResistance{10};
+        /**
+         * @brief Full scale current of a channel's DAC (µA)
+         *
+         * The DAC output is divided down before being used as the setpoint for the shunt
+         * voltage regulation loop, such that the full scale output corresponds to this current.
+         */
+        constexpr static const uint32_t kChannelMaxCurrent{10'000'000};
+
+        /// Maximum input voltage (mV)
+        constexpr static const uint32_t kMaxInputVoltage{60'000};
+        /// Ratio of the input voltage divider ahead of the voltage ADC
+        constexpr static const uint32_t kVSenseDivider{40};
+
+        /// Thermal model and SOA of the channel MOSFETs
+        static const SafeOperatingArea kSafeOperatingArea;
+
+        /// Pin on the IO expander that drives the sense relay
+        constexpr static const uint8_t kSenseRelayPin{0};
+
+        /// SPI bus to which the ADCs and DAC are connected
+        Drivers::SpiBus *spi;
+
+        /// IO expander for the sense relay
+        Drivers::I2CDevice::PI4IOE5V9536 io;
+        /// Fan controller, also measuring the heatsink temperature
+        Drivers::I2CDevice::EMC2101 fan;
+
+        /// Transmit data for ADC reads (a single static read command)
+        static const etl::array<uint8_t, kAdcReadLength> kAdcReadCommand;
+        /// Receive buffers for the current and voltage ADC reads
+        etl::array<etl::array<uint8_t, kAdcReadLength>, 2> adcRxBuf
+            __attribute__((aligned(4)));
+        /// Calibration of each channel's current measurement
+        etl::array<CalibrationTable, kNumChannels> currentSenseCal;
+        /// Calibration of each channel's current setpoint
+        etl::array<CalibrationTable, kNumChannels> currentSetpointCal;
+        /// Calibration of the input voltage measurement
+        CalibrationTable voltageSenseCal;
+
+        /// Transmit buffers for the DAC writes
+        etl::array<etl::array<uint8_t, kDacFrameLength>, kNumChannels> dacTxBuf
+            __attribute__((aligned(4)));
+
+        /// Most recent current ADC code for each channel
+        etl::array<int32_t, kNumChannels> adcCodes{};
+        /// Most recent current reading for each channel (µA)
+        etl::array<uint32_t, kNumChannels> channelCurrent{};
+        /// Most recent input voltage reading (mV)
+        uint32_t inputVoltage{0};
+        /// Whether the voltage ADC produced a result yet
+        bool hasInputVoltage{false};
+
+        /// Current setpoint of each channel (µA)
+        etl::array<uint32_t, kNumChannels> channelSetpoint{};
+        /// Whether the load is enabled
+        bool isEnabled{false};
+};
+}
+
+#endif
@@ -0,0 +1,248 @@
+#include "CurrentSharing.h"
+#include "LoadDriver.h"
+
+#include "Log/Logger.h"
+
+#include <etl/algorithm.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Attach to a load driver
+ *
+ * Query the driver's channel count and limits, and reset all channel state.
+ *
+ * @param driver Load driver to control
+ */
+void CurrentSharing::attach(LoadDriver *driver) {
+    int err;
+    uint32_t maxCurrent;
+
+    this->driver = driver;
+    this->numChannels = driver->getNumChannels();
+    REQUIRE(this->numChannels && this->numChannels <= kMaxChannels,
+            "current sharing: invalid channel count (%u)", this->numChannels);
+
+    err = driver->getMaxInputCurrent(maxCurrent);
+    REQUIRE(!err, "current sharing: %s (%d)", "failed to get max current", err);
+    this->channelMaxCurrent = (maxCurrent * 1000) / this->numChannels;
+
+    this->reset();
+}
+
+/**
+ * @brief Reset channel state
+ *
+ * Clear all trims, and bring back any channels that have been shed.
+ */
+void CurrentSharing::reset() {
+    for(auto &ch : this->channels) {
+        ch = {};
+    }
+}
+
+/**
+ * @brief Set the total current setpoint
+ *
+ * Split the setpoint across all active channels, and update the driver.
+ *
+ * @param current Total load current (µA)
+ *
+ * @return 0 on success, or a negative error code
+ */
+int CurrentSharing::setSetpoint(const uint32_t current) {
+    this->setpoint = current;
+
+    if(this->numChannels <= 1) {
+        return this->driver->setOutputCurrent(current);
+    }
+
+    this->distribute();
+    return this->apply();
+}
+
+/**
+ * @brief Run a control tick
+ *
+ * Read the current (and temperature, if supported) of each channel, check for failed channels and
+ * update their trims, then redistribute the setpoint.
+ *
+ * @param isEnabled Whether the load is enabled; if not, trims are frozen and no fault checks are
+ *        performed.
+ *
+ * @return 0 on success, or a negative error code
+ */
+int CurrentSharing::update(const bool isEnabled) {
+    int err;
+
+    if(this->numChannels <= 1) {
+        return 0;
+    }
+
+    // read channel temperatures (if the driver supports them)
+    this->hasTemperatures = true;
+
+    for(size_t i = 0; i < this->numChannels; i++) {
+        err = this->driver->readChannelTemperature(i, this->channels[i].temperature);
+        if(err == LoadDriver::Errors::Unsupported) {
+            this->hasTemperatures = false;
+            break;
+        } else if(err) {
+            return err;
+        }
+    }
+
+    // read currents, then check faults and update trims
+    for(size_t i = 0; i < this->numChannels; i++) {
+        auto &ch = this->channels[i];
+
+        err = this->driver->readChannelCurrent(i, ch.current);
+        if(err) {
+            return err;
+        }
+
+        if(!isEnabled || ch.failed) {
+            continue;
+        }
+
+        this->checkFault(i, ch);
+
+        if(!ch.failed && ch.target >= kFaultMinCurrent) {
+            const auto error = static_cast<int64_t>(ch.target) - static_cast<int64_t>(ch.current);
+            const auto relError = static_cast<int32_t>((error * kOne) / ch.target);
+
+            ch.trim += (static_cast<int64_t>(relError) * kTrimGain) >> 16;
+            ch.trim = etl::clamp(ch.trim, -kMaxTrim, kMaxTrim);
+        }
+    }
+
+    this->distribute();
+    return this->apply();
+}
+
+/**
+ * @brief Distribute the setpoint across channels
+ *
+ * Each active channel's share is weighted by its temperature relative to the average of all
+ * active channels. Shares are limited to a channel's maximum current; any excess is given to
+ * channels that have headroom left. Then, the channel's trim is applied to get the command.
+ */
+void CurrentSharing::distribute() {
+    etl::array<int32_t, kMaxChannels> weights{};
+    const auto active = this->getNumActive();
+
+    if(!active) {
+        for(size_t i = 0; i < this->numChannels; i++) {
+            this->channels[i].target = this->channels[i].command = 0;
+        }
+        return;
+    }
+
+    // calculate weights
+    int64_t avgTemp{0};
+    if(this->hasTemperatures) {
+        for(size_t i = 0; i < this->numChannels; i++) {
+            if(!this->channels[i].failed) {
+                avgTemp += this->channels[i].temperature;
+            }
+        }
+        avgTemp /= static_cast<int64_t>(active);
+    }
+
+    int64_t totalWeight{0};
+    for(size_t i = 0; i < this->numChannels; i++) {
+        const auto &ch = this->channels[i];
+        if(ch.failed) {
+            continue;
+        }
+
+        int32_t weight{kOne};
+        if(this->hasTemperatures) {
+            // temperatures are in m°C
+            weight -= static_cast<int32_t>((kThermalDerating * (ch.temperature - avgTemp)) /
+                    1000);
+            weight = etl::clamp(weight, kMinWeight, kMaxWeight);
+        }
+
+        weights[i] = weight;
+        totalWeight += weight;
+    }
+
+    // split setpoint by weight, clamping to the channel limit
+    uint32_t excess{0};
+    for(size_t i = 0; i < this->numChannels; i++) {
+        auto &ch = this->channels[i];
+
+        ch.target = (static_cast<uint64_t>(this->setpoint) * weights[i]) / totalWeight;
+        if(ch.target > this->channelMaxCurrent) {
+            excess += ch.target - this->channelMaxCurrent;
+            ch.target = this->channelMaxCurrent;
+        }
+    }
+
+    for(size_t i = 0; i < this->numChannels && excess; i++) {
+        auto &ch = this->channels[i];
+        if(ch.failed) {
+            continue;
+        }
+
+        const auto extra = etl::min(excess, this->channelMaxCurrent - ch.target);
+        ch.target += extra;
+        excess -= extra;
+    }
+
+    // apply trims
+    for(size_t i = 0; i < this->numChannels; i++) {
+        auto &ch = this->channels[i];
+
+        const auto trimmed = (static_cast<uint64_t>(ch.target) * (kOne + ch.trim)) >> 16;
+        ch.command = etl::min(trimmed, static_cast<uint64_t>(this->channelMaxCurrent));
+    }
+}
+
+/**
+ * @brief Check whether a channel has failed
+ *
+ * A channel is considered failed if its measured current is far below (open channel) or above
+ * (uncontrolled channel) its command for several consecutive ticks. It is then shed.
+ *
+ * @param channel Index of the channel
+ * @param ch Channel state
+ */
+void CurrentSharing::checkFault(const size_t channel, Channel &ch) {
+    if(ch.command < kFaultMinCurrent) {
+        ch.faultTicks = 0;
+        return;
+    }
+
+    const bool isLow = ch.current < (ch.command / 4);
+    const bool isHigh = ch.current > (ch.command + (ch.command / 2));
+
+    if(!isLow && !isHigh) {
+        ch.faultTicks = 0;
+        return;
+    }
+
+    if(++ch.faultTicks >= kFaultTicks) {
+        ch.failed = true;
+        ch.trim = 0;
+
+        Logger::Warning("control: shedding channel %u (command %u µA, measured %u µA)", channel,
+                ch.command, ch.current);
+    }
+}
+
+/**
+ * @brief Send channel commands to the driver
+ *
+ * @return 0 on success, or a negative error code
+ */
+int CurrentSharing::apply() {
+    etl::array<uint32_t, kMaxChannels> commands{};
+
+    for(size_t i = 0; i < this->numChannels; i++) {
+        commands[i] = this->channels[i].command;
+    }
+
+    return this->driver->setChannelCurrents({commands.data(), this->numChannels});
+}
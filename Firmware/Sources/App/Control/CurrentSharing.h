@@ -0,0 +1,156 @@
+#ifndef APP_CONTROL_CURRENTSHARING_H
+#define APP_CONTROL_CURRENTSHARING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/array.h>
+
+namespace App::Control {
+class LoadDriver;
+
+/**
+ * @brief Current sharing between load channels
+ *
+ * On load boards with several channels in parallel, splitting the setpoint evenly doesn't result
+ * in an even split of dissipation: tolerances of the sense resistors and DACs, as well as the
+ * different thermal coupling of each MOSFET to the heatsink, mean some channels will run hotter
+ * than others, which limits the total power the load can handle.
+ *
+ * This layer sits between the control loop and the driver. It splits the total setpoint into a
+ * target for each channel, weighted by how much hotter or cooler than average the channel is
+ * (if the driver can measure per-channel temperatures). A per-channel trim, updated from the
+ * measured channel current every control tick, then corrects for gain errors so that the
+ * channel actually conducts its target current.
+ *
+ * Channels whose measured current stays far off their command are considered failed: they are
+ * shed, and their share of the current redistributed over the remaining channels.
+ *
+ * All arithmetic is fixed point; fractions are in Q16 format.
+ *
+ * @remark Drivers with a single channel are passed through unmodified.
+ */
+class CurrentSharing {
+    public:
+        /// Maximum number of channels supported
+        constexpr static const size_t kMaxChannels{4};
+
+        /// State of a single channel
+        struct Channel {
+            /// Target current, before trimming (µA)
+            uint32_t target{0};
+            /// Current commanded to the driver (µA)
+            uint32_t command{0};
+            /// Last measured current (µA)
+            uint32_t current{0};
+            /// Last measured temperature (m°C)
+            int32_t temperature{0};
+            /// Gain trim applied to the target (Q16; 0 = no correction)
+            int32_t trim{0};
+            /// Number of consecutive ticks the channel was out of tolerance
+            uint16_t faultTicks{0};
+            /// Whether the channel has been shed
+            bool failed{false};
+        };
+
+    public:
+        void attach(LoadDriver *driver);
+        void reset();
+
+        int setSetpoint(const uint32_t current);
+        int update(const bool isEnabled);
+
+        /**
+         * @brief Get the total current setpoint
+         *
+         * @return Total current (µA) last set with setSetpoint()
+         */
+        inline uint32_t getSetpoint() const {
+            return this->setpoint;
+        }
+
+        /**
+         * @brief Get the number of channels that have not failed
+         */
+        inline size_t getNumActive() const {
+            size_t active{0};
+            for(size_t i = 0; i < this->numChannels; i++) {
+                if(!this->channels[i].failed) {
+                    active++;
+                }
+            }
+            return active;
+        }
+
+        /**
+         * @brief Get the state of a channel
+         *
+         * @param channel Channel index; must be less than the driver's number of channels
+         */
+        inline const Channel &getChannel(const size_t channel) const {
+            return this->channels[channel];
+        }
+
+    private:
+        void distribute();
+        void checkFault(const size_t channel, Channel &ch);
+        int apply();
+
+    private:
+        /// Unity in Q16 format
+        constexpr static const int32_t kOne{1 << 16};
+
+        /**
+         * @brief Integral gain of the trim loop (Q16)
+         *
+         * Fraction of the relative error between target and measured current that's added to the
+         * trim each tick.
+         */
+        constexpr static const int32_t kTrimGain{kOne / 8};
+        /// Maximum magnitude of a channel's trim (Q16)
+        constexpr static const int32_t kMaxTrim{kOne / 4};
+
+        /**
+         * @brief Thermal derating (Q16 per °C)
+         *
+         * Relative reduction in a channel's share for every degree it's hotter than the average
+         * of all active channels; cooler channels take up the difference.
+         */
+        constexpr static const int32_t kThermalDerating{kOne / 50};
+        /// Minimum weight of a channel's share (Q16)
+        constexpr static const int32_t kMinWeight{kOne / 2};
+        /// Maximum weight of a channel's share (Q16)
+        constexpr static const int32_t kMaxWeight{kOne + (kOne / 2)};
+
+        /**
+         * @brief Minimum command to check for faults (µA)
+         *
+         * Below this current, the measurement is too noisy to judge whether a channel is
+         * conducting properly; trims are also frozen.
+         */
+        constexpr static const uint32_t kFaultMinCurrent{100'000};
+        /**
+         * @brief Fault debounce time (control ticks)
+         *
+         * Number of consecutive ticks a channel must be out of tolerance before it's shed. This
+         * needs to cover the settling time of the channel after a setpoint change.
+         */
+        constexpr static const uint16_t kFaultTicks{25};
+
+        /// Driver to control
+        LoadDriver *driver{nullptr};
+        /// Number of channels of the driver
+        size_t numChannels{0};
+        /// Maximum current per channel (µA)
+        uint32_t channelMaxCurrent{0};
+
+        /// Total current setpoint (µA)
+        uint32_t setpoint{0};
+        /// Whether the driver provides per-channel temperatures
+        bool hasTemperatures{false};
+        /// Per-channel state
+        etl::array<Channel, kMaxChannels> channels;
+};
+}
+
+#endif
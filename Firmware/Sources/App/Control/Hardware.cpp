@@ -4,20 +4,26 @@
 #include "Drivers/ExternalIrq.h"
 #include "Drivers/Gpio.h"
 #include "Drivers/I2C.h"
+#include "Drivers/Spi.h"
 
 #include "Log/Logger.h"
+#include "Rtos/Trace.h"
 
 #include <vendor/sam.h>
 
 using namespace App::Control;
 
 Drivers::I2C *Hw::gBus{nullptr};
+Drivers::Spi *Hw::gSpi{nullptr};
+
+/// Cycle counter value when the driver interrupt was last asserted
+static volatile uint32_t gDriverIrqTimestamp{0};
 
 /**
  * @brief Initialize control loop hardware
  *
- * It sets up the SERCOM3 as I²C, a few GPIOs and an external interrupt for both the trigger and
- * driver interrupt inputs.
+ * It sets up the SERCOM3 as I²C, SERCOM4 as SPI, a few GPIOs and an external interrupt for both
+ * the trigger and driver interrupt inputs.
  */
 void Hw::Init() {
     /*
@@ -89,6 +95,41 @@ void Hw::Init() {
     static uint8_t gI2CBuf[sizeof(Drivers::I2C)] __attribute__((aligned(alignof(Drivers::I2C))));
     auto ptr = reinterpret_cast<Drivers::I2C *>(gI2CBuf);
     gBus = new (ptr) Drivers::I2C(Drivers::SercomBase::Unit::Unit3, cfg);
+
+    /*
+     * Set up the SPI bus: MOSI on PC2, SCK on PA5 and MISO on PA6. Devices are selected by
+     * driving their address on the select lines (PA4, PA12, PB0), idle at address 0.
+     */
+    static const Drivers::Spi::Config spiCfg{
+        .rxEnable = 1,
+        .hwChipSelect = 0,
+        .useDma = 1,
+        .dmaChannelTx = kDriverSpiDmaTx,
+        .dmaPriorityTx = 0,
+        .dmaChannelRx = kDriverSpiDmaRx,
+        .dmaPriorityRx = 1,
+        .inputPin = 3,
+        .sckFrequency = 10'000'000,
+    };
+
+    for(const auto &pin : {kDriverMosi, kDriverSck, kDriverMiso}) {
+        Drivers::Gpio::ConfigurePin(pin, {
+            .mode = Drivers::Gpio::Mode::Peripheral,
+            .function = kDriverSpiFunction,
+        });
+    }
+
+    for(const auto &pin : kDriverSpiSelect) {
+        Drivers::Gpio::ConfigurePin(pin, {
+            .mode = Drivers::Gpio::Mode::DigitalOut,
+            .initialOutput = 0,
+        });
+    }
+
+    static uint8_t gSpiBuf[sizeof(Drivers::Spi)] __attribute__((aligned(alignof(Drivers::Spi))));
+    auto spiPtr = reinterpret_cast<Drivers::Spi *>(gSpiBuf);
+    gSpi = new (spiPtr) Drivers::Spi(Drivers::SercomBase::Unit::Unit4, spiCfg);
+    gSpi->setSelectLines(kDriverSpiSelect);
 }
 
 
@@ -117,6 +158,36 @@ void Hw::SetResetState(const bool asserted) {
     Drivers::Gpio::SetOutputState(kDriverReset, asserted);
 }
 
+/**
+ * @brief Get the driver bus queueing statistics
+ *
+ * Read out (and reset) the per priority request queueing latency of the driver control bus.
+ *
+ * @param outStats Buffer to receive statistics, indexed by request priority
+ */
+void Hw::GetBusQueueStats(etl::span<Drivers::I2CBus::QueueStats,
+        Drivers::I2CBus::kNumPriorities> outStats) {
+    if(!gBus) {
+        for(auto &stats : outStats) {
+            stats = {};
+        }
+        return;
+    }
+
+    gBus->getQueueStats(outStats);
+}
+
+/**
+ * @brief Get the time the driver interrupt was last asserted
+ *
+ * This is used to measure the latency of handling driver events, such as protection trips.
+ *
+ * @return Cycle counter value captured in the driver interrupt handler
+ */
+uint32_t Hw::GetDriverIrqTimestamp() {
+    return gDriverIrqTimestamp;
+}
+
 
 
 /**
@@ -126,11 +197,14 @@ void Hw::SetResetState(const bool asserted) {
  */
 void EIC_9_Handler() {
     BaseType_t woken{0};
+    Rtos::Trace::IsrEnter();
 
     if(Drivers::ExternalIrq::HandleIrq(9)) {
+        gDriverIrqTimestamp = DWT->CYCCNT;
         Task::NotifyFromIsr(Task::TaskNotifyBits::IrqAsserted, &woken);
     }
 
+    Rtos::Trace::IsrExit();
     portYIELD_FROM_ISR(woken);
 }
 
@@ -141,10 +215,12 @@ void EIC_9_Handler() {
  */
 void EIC_11_Handler() {
     BaseType_t woken{0};
+    Rtos::Trace::IsrEnter();
 
     if(Drivers::ExternalIrq::HandleIrq(11)) {
         Task::NotifyFromIsr(Task::TaskNotifyBits::ExternalTrigger, &woken);
     }
 
+    Rtos::Trace::IsrExit();
     portYIELD_FROM_ISR(woken);
 }
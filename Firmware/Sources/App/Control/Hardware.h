@@ -2,9 +2,14 @@
 #define APP_CONTROL_HARDWARE_H
 
 #include "Drivers/Gpio.h"
+#include "Drivers/I2CBus.h"
+
+#include <etl/array.h>
+#include <etl/span.h>
 
 namespace Drivers {
 class I2C;
+class Spi;
 }
 
 /// Control loop
@@ -13,7 +18,7 @@ namespace App::Control {
  * @brief Control loop hardware
  *
  * This is responsible for initializing all hardware used by the actual load control; that is, the
- * control I²C bus, and a few related GPIOs.
+ * control I²C bus, the SPI bus for driver boards with SPI converters, and a few related GPIOs.
  */
 class Hw {
     friend class Task;
@@ -64,6 +69,59 @@ class Hw {
         Drivers::Gpio::Port::PortA, 22
     };
 
+    /**
+     * @brief Driver SPI data out (MOSI)
+     *
+     * ANALOG_MOSI on the controller; SoM pin 91
+     */
+    constexpr static const Drivers::Gpio::Pin kDriverMosi{
+        Drivers::Gpio::Port::PortC, 2
+    };
+
+    /**
+     * @brief Driver SPI clock
+     *
+     * ANALOG_SCK on the controller; SoM pin 83
+     */
+    constexpr static const Drivers::Gpio::Pin kDriverSck{
+        Drivers::Gpio::Port::PortA, 5
+    };
+
+    /**
+     * @brief Driver SPI data in (MISO)
+     *
+     * ANALOG_MISO on the controller; SoM pin 18
+     */
+    constexpr static const Drivers::Gpio::Pin kDriverMiso{
+        Drivers::Gpio::Port::PortA, 6
+    };
+
+    /**
+     * @brief Alternate function of the driver SPI pins
+     *
+     * @remark Placeholder: the design doesn't specify which SPI peripheral the pins are muxed to,
+     *         and it must be checked against the SoM pinout.
+     */
+    constexpr static const uint8_t kDriverSpiFunction{5};
+
+    /**
+     * @brief Driver SPI select lines
+     *
+     * ANALOG_SEL0..2 on the controller (SoM pins 17, 69 and 99), which carry the address of the
+     * SPI device to select on the driver board. The board decodes them into its chip selects;
+     * address 0 selects no device.
+     */
+    constexpr static const etl::array<Drivers::Gpio::Pin, 3> kDriverSpiSelect{{
+        {Drivers::Gpio::Port::PortA, 4},
+        {Drivers::Gpio::Port::PortA, 12},
+        {Drivers::Gpio::Port::PortB, 0},
+    }};
+
+    /// DMA channel for driver SPI transmit
+    constexpr static const uint8_t kDriverSpiDmaTx{0};
+    /// DMA channel for driver SPI receive
+    constexpr static const uint8_t kDriverSpiDmaRx{1};
+
 
     public:
         static void Init();
@@ -71,6 +129,11 @@ class Hw {
         static void PulseReset();
         static void SetResetState(const bool asserted);
 
+        static void GetBusQueueStats(etl::span<Drivers::I2CBus::QueueStats,
+                Drivers::I2CBus::kNumPriorities> outStats);
+
+        static uint32_t GetDriverIrqTimestamp();
+
     private:
         /**
          * @brief Driver control bus
@@ -78,6 +141,13 @@ class Hw {
          * Dedicated I²C bus used for communicating with the load driver board.
          */
         static Drivers::I2C *gBus;
+
+        /**
+         * @brief Driver data bus
+         *
+         * SPI bus used for the ADCs and DACs on driver boards that have them.
+         */
+        static Drivers::Spi *gSpi;
 };
 }
 
@@ -0,0 +1,92 @@
+#include "IvSweep.h"
+
+using namespace App::Control;
+
+/**
+ * @brief Start a sweep
+ *
+ * @param newConfig Sweep parameters
+ *
+ * @return Whether the parameters were valid and the sweep was started; if not, the sweep is in
+ *         the aborted state.
+ */
+bool IvSweep::start(const Config &newConfig) {
+    if(!newConfig.endCurrent || newConfig.numSteps < 2 || newConfig.numSteps > kMaxPoints ||
+            !newConfig.settleTicks) {
+        this->state = State::Aborted;
+        return false;
+    }
+
+    this->config = newConfig;
+    this->numPoints = 0;
+    this->settleCount = 0;
+    this->isStepApplied = false;
+
+    this->state = State::Running;
+    return true;
+}
+
+/**
+ * @brief Abort the sweep
+ *
+ * The points captured so far remain available. This is also used to indicate that a requested
+ * sweep could not be started.
+ */
+void IvSweep::abort() {
+    this->state = State::Aborted;
+}
+
+/**
+ * @brief Run the sweep for one tick
+ *
+ * Each point is captured once its step has been applied for the configured number of settling
+ * ticks; the load current returned by the capturing tick is the next step.
+ *
+ * @param voltage Input voltage (mV)
+ * @param current Input current (µA)
+ *
+ * @return Load current to apply (µA)
+ */
+uint32_t IvSweep::update(const uint32_t voltage, const uint32_t current) {
+    if(this->state != State::Running) {
+        return 0;
+    }
+
+    /*
+     * The first step isn't applied until this tick returns, so the measurements passed in now
+     * still reflect the current from before the sweep. Don't count this tick toward its settling
+     * time, so that every point settles for the same number of ticks.
+     */
+    if(!this->isStepApplied) {
+        this->isStepApplied = true;
+        return this->getStepCurrent(0);
+    }
+
+    // wait for the current step to settle
+    if(++this->settleCount < this->config.settleTicks) {
+        return this->getStepCurrent(this->numPoints);
+    }
+    this->settleCount = 0;
+
+    // then capture it, and move on to the next one
+    this->points[this->numPoints++] = {current, voltage};
+
+    if(this->numPoints == this->config.numSteps ||
+            (this->config.minVoltage && voltage < this->config.minVoltage)) {
+        this->state = State::Done;
+        return 0;
+    }
+
+    return this->getStepCurrent(this->numPoints);
+}
+
+/**
+ * @brief Get the load current of a step
+ *
+ * @param step Step index, where step 0 is at zero current
+ *
+ * @return Load current (µA)
+ */
+uint32_t IvSweep::getStepCurrent(const size_t step) const {
+    return (static_cast<uint64_t>(this->config.endCurrent) * step) / (this->config.numSteps - 1);
+}
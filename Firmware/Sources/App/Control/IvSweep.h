@@ -0,0 +1,119 @@
+#ifndef APP_CONTROL_IVSWEEP_H
+#define APP_CONTROL_IVSWEEP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/array.h>
+#include <etl/span.h>
+
+namespace App::Control {
+/**
+ * @brief I-V curve sweep engine
+ *
+ * Walks the load current from zero up to an end current (typically, the short circuit current of
+ * the source) in a fixed number of evenly spaced steps. After each step, it waits a number of
+ * control ticks for the source and the measurement filters to settle, then captures the input
+ * voltage and current into an internal buffer. This characterizes sources such as solar panels
+ * or fuel cells without the host having to step through the curve itself.
+ *
+ * The sweep optionally ends early once the input voltage collapses below a threshold, as it does
+ * once a source is pulled past its short circuit current.
+ *
+ * Like the other control loop building blocks, it doesn't touch the hardware: it's fed the
+ * measurements once per tick, and returns the current to apply.
+ */
+class IvSweep {
+    public:
+        /// Maximum number of points in a sweep
+        constexpr static const size_t kMaxPoints{256};
+
+        /**
+         * @brief Sweep state
+         */
+        enum class State: uint8_t {
+            /// Not running
+            Idle                        = 0,
+            /// Stepping through the curve
+            Running                     = 1,
+            /// Completed; the captured points are available
+            Done                        = 2,
+            /// Aborted (or not started) by the caller
+            Aborted                     = 3,
+        };
+
+        /**
+         * @brief Sweep parameters
+         */
+        struct Config {
+            /// Current of the last step (µA)
+            uint32_t endCurrent{0};
+            /// Number of steps (points captured), including the one at zero current
+            uint16_t numSteps{32};
+            /// Number of control ticks to wait after each step before capturing the point
+            uint16_t settleTicks{5};
+            /// End the sweep once the input voltage drops below this value (mV); 0 to disable
+            uint32_t minVoltage{0};
+        };
+
+        /**
+         * @brief A captured point of the curve
+         *
+         * @remark This is sent to the host as is, so its layout must not change.
+         */
+        struct Point {
+            /// Measured input current (µA)
+            uint32_t current;
+            /// Measured input voltage (mV)
+            uint32_t voltage;
+        };
+        static_assert(sizeof(Point) == 8, "Point layout is part of the host protocol");
+
+    public:
+        bool start(const Config &newConfig);
+        void abort();
+
+        uint32_t update(const uint32_t voltage, const uint32_t current);
+
+        /**
+         * @brief Get the sweep state
+         */
+        inline State getState() const {
+            return this->state;
+        }
+
+        /**
+         * @brief Whether the sweep is currently driving the output
+         */
+        inline bool isRunning() const {
+            return this->state == State::Running;
+        }
+
+        /**
+         * @brief Get the points captured so far
+         */
+        inline etl::span<const Point> getPoints() const {
+            return {this->points.data(), this->numPoints};
+        }
+
+    private:
+        uint32_t getStepCurrent(const size_t step) const;
+
+    private:
+        /// Current state
+        State state{State::Idle};
+        /// Active sweep parameters
+        Config config;
+
+        /// Captured points
+        etl::array<Point, kMaxPoints> points;
+        /// Number of points captured
+        size_t numPoints{0};
+        /// Ticks elapsed since the current step was applied
+        uint16_t settleCount{0};
+        /// Whether the first step has been applied
+        bool isStepApplied{false};
+};
+}
+
+#endif
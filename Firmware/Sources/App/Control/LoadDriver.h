@@ -5,6 +5,11 @@
 #include <stdint.h>
 
 #include "Drivers/I2CBus.h"
+#include "Util/InventoryRom.h"
+#include "Util/PiecewiseLinear.h"
+
+#include <etl/array.h>
+#include <etl/span.h>
 
 namespace Drivers {
 namespace I2CDevice {
@@ -23,6 +28,71 @@ namespace App::Control {
  * need a lot of hand-holding from the actual control loop running in the control task.
  */
 class LoadDriver {
+    public:
+        /// Errors common to all load drivers
+        enum Errors: int {
+            /// The requested operation is not supported by this driver
+            Unsupported                 = -59000,
+            /// Specified channel index is invalid
+            InvalidChannel              = -59001,
+        };
+
+        /**
+         * @brief Thermal model of a channel's power device
+         *
+         * Describes the thermal impedance from the junction of a channel's MOSFET to the
+         * heatsink, as a Foster network of RC stages, as well as its safe operating area.
+         */
+        struct SafeOperatingArea {
+            /// A single stage of the thermal network
+            struct Stage {
+                /// Thermal resistance (m°C/W)
+                uint32_t resistance;
+                /// Time constant (ms)
+                uint32_t timeConstant;
+            };
+
+            /// A point on the DC safe operating area curve
+            struct Point {
+                /// Drain-source voltage (mV)
+                uint32_t voltage;
+                /// Maximum power dissipation at this voltage (mW)
+                uint32_t power;
+            };
+
+            /// Stages of the thermal network, from junction to heatsink
+            etl::span<const Stage> stages;
+            /// DC safe operating area, in order of increasing voltage
+            etl::span<const Point> curve;
+            /// Maximum allowed junction temperature (m°C)
+            int32_t maxJunctionTemp;
+            /// Heatsink temperature to assume if it can't be measured (m°C)
+            int32_t defaultHeatsinkTemp;
+        };
+
+        /**
+         * @brief Converter types that can be calibrated
+         *
+         * @remark These values are stored in the calibration atoms of inventory ROMs, so they
+         *         must not be changed.
+         */
+        enum class CalibrationTarget: uint8_t {
+            /// Channel current measurement (µA)
+            ChannelCurrentSense         = 0x00,
+            /// Channel current setpoint (µA)
+            ChannelCurrentSetpoint      = 0x01,
+            /// Input voltage measurement (mV)
+            InputVoltageSense           = 0x02,
+        };
+
+        /**
+         * @brief Calibration for a single converter
+         *
+         * Maps the value produced by the converter's ideal transfer function to the true value;
+         * for setpoints, it maps the desired value to the value to request from the converter.
+         */
+        using CalibrationTable = Util::PiecewiseLinear<Util::InventoryRom::kMaxCalibrationPoints>;
+
     public:
         /**
          * @brief Initialize driver
@@ -102,6 +172,111 @@ class LoadDriver {
          */
         virtual int setOutputCurrent(const uint32_t current) = 0;
 
+        /**
+         * @brief Get the number of load channels
+         *
+         * Boards with several MOSFETs in parallel can report (and control) each of them
+         * individually.
+         *
+         * @remark The default implementation reports a single channel.
+         */
+        virtual size_t getNumChannels() const {
+            return 1;
+        }
+
+        /**
+         * @brief Read the current of a single channel
+         *
+         * @param channel Channel index, in [0, getNumChannels())
+         * @param outCurrent Current through the channel, in µA
+         *
+         * @return 0 on success or negative error code
+         *
+         * @remark The default implementation returns the total input current for channel 0.
+         */
+        virtual int readChannelCurrent(const size_t channel, uint32_t &outCurrent) {
+            if(channel) {
+                return Errors::InvalidChannel;
+            }
+            return this->readInputCurrent(outCurrent);
+        }
+
+        /**
+         * @brief Set the current of each channel
+         *
+         * Like setOutputCurrent(), but rather than the driver splitting the total current evenly,
+         * each channel's current is specified individually.
+         *
+         * @param currents Current for each channel (in µA); must have getNumChannels() entries
+         *
+         * @return 0 on success or negative error code
+         *
+         * @remark The default implementation forwards to setOutputCurrent() for single channel
+         *         drivers.
+         */
+        virtual int setChannelCurrents(etl::span<const uint32_t> currents) {
+            if(currents.size() != 1) {
+                return Errors::InvalidChannel;
+            }
+            return this->setOutputCurrent(currents[0]);
+        }
+
+        /**
+         * @brief Read the temperature of a single channel
+         *
+         * @param channel Channel index, in [0, getNumChannels())
+         * @param outTemp Temperature of the channel's power device, in m°C
+         *
+         * @return 0 on success or negative error code
+         *
+         * @remark The default implementation does not support per-channel temperatures.
+         */
+        virtual int readChannelTemperature(const size_t channel, int32_t &outTemp) {
+            return Errors::Unsupported;
+        }
+
+        /**
+         * @brief Read the heatsink temperature
+         *
+         * @param outTemp Temperature of the heatsink shared by all channels, in m°C
+         *
+         * @return 0 on success or negative error code
+         *
+         * @remark The default implementation does not support heatsink temperature measurement.
+         */
+        virtual int readHeatsinkTemperature(int32_t &outTemp) {
+            return Errors::Unsupported;
+        }
+
+        /**
+         * @brief Get the thermal model of the channels' power devices
+         *
+         * @return Safe operating area description (shared by all channels), or `nullptr` if the
+         *         driver doesn't provide one; in that case, only the maximum current applies.
+         */
+        virtual const SafeOperatingArea *getSafeOperatingArea() const {
+            return nullptr;
+        }
+
+        /**
+         * @brief Apply calibration to a converter
+         *
+         * This is invoked with the calibration tables from the board's inventory ROM, once the
+         * driver has been initialized.
+         *
+         * @param target Type of converter to calibrate
+         * @param channel Channel index (for per-channel converters)
+         * @param table Calibration to apply to the converter's readings or setpoints
+         *
+         * @return 0 on success or negative error code
+         *
+         * @remark The default implementation does not support calibration.
+         */
+        virtual int setCalibration(const CalibrationTarget target, const size_t channel,
+                const CalibrationTable &table) {
+            return Errors::Unsupported;
+        }
+
         /**
          * @brief Get maximum input voltage
          *
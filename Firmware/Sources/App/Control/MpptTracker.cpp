@@ -0,0 +1,62 @@
+#include "MpptTracker.h"
+
+#include <etl/algorithm.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Change the tracker parameters
+ *
+ * This takes effect at the next perturbation; the tracked operating point is kept.
+ *
+ * @param newConfig Parameters to apply; an interval of 0 is treated as 1.
+ */
+void MpptTracker::configure(const Config &newConfig) {
+    this->config.stepSize = newConfig.stepSize;
+    this->config.interval = etl::max(newConfig.interval, static_cast<uint16_t>(1));
+}
+
+/**
+ * @brief Restart tracking
+ *
+ * @param current Load current to start from (µA)
+ */
+void MpptTracker::reset(const uint32_t current) {
+    this->output = etl::min(current, this->maxOutput);
+    this->lastPower = 0;
+    this->isIncreasing = true;
+    this->ticks = 0;
+}
+
+/**
+ * @brief Run the tracker for one tick
+ *
+ * @param voltage Input voltage (mV)
+ * @param current Input current (µA)
+ *
+ * @return Load current to apply (µA)
+ */
+uint32_t MpptTracker::update(const uint32_t voltage, const uint32_t current) {
+    if(++this->ticks < this->config.interval) {
+        return this->output;
+    }
+    this->ticks = 0;
+
+    // observe: reverse if the last perturbation reduced the power (mV * µA = nW)
+    const uint64_t power = static_cast<uint64_t>(voltage) * current;
+    if(power < this->lastPower) {
+        this->isIncreasing = !this->isIncreasing;
+    }
+    this->lastPower = power;
+
+    // perturb
+    if(this->isIncreasing) {
+        this->output = etl::min(static_cast<uint64_t>(this->output) + this->config.stepSize,
+                static_cast<uint64_t>(this->maxOutput));
+    } else {
+        this->output = (this->output > this->config.stepSize) ?
+            (this->output - this->config.stepSize) : 0;
+    }
+
+    return this->output;
+}
@@ -0,0 +1,68 @@
+#ifndef APP_CONTROL_MPPTTRACKER_H
+#define APP_CONTROL_MPPTTRACKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace App::Control {
+/**
+ * @brief Maximum power point tracker
+ *
+ * Implements the perturb and observe algorithm: every few control ticks, the load current is
+ * moved by a fixed step; if the input power decreased since the previous step, the direction is
+ * reversed. The load current thus climbs towards the source's maximum power point, then
+ * oscillates around it by about one step, following it as it moves (for example, as the
+ * irradiance on a solar panel changes).
+ */
+class MpptTracker {
+    public:
+        /**
+         * @brief Tracker parameters
+         */
+        struct Config {
+            /// Load current change per perturbation (µA)
+            uint32_t stepSize{10'000};
+            /// Number of control ticks between perturbations
+            uint16_t interval{10};
+        };
+
+    public:
+        void configure(const Config &newConfig);
+        void reset(const uint32_t current);
+
+        uint32_t update(const uint32_t voltage, const uint32_t current);
+
+        /**
+         * @brief Get the tracker parameters
+         */
+        inline const Config &getConfig() const {
+            return this->config;
+        }
+
+        /**
+         * @brief Set the maximum output value
+         *
+         * @param max Maximum load current (µA)
+         */
+        inline void setMaxOutput(const uint32_t max) {
+            this->maxOutput = max;
+        }
+
+    private:
+        /// Active parameters
+        Config config;
+        /// Maximum load current (µA)
+        uint32_t maxOutput{0};
+
+        /// Load current currently requested (µA)
+        uint32_t output{0};
+        /// Input power observed at the previous perturbation (nW)
+        uint64_t lastPower{0};
+        /// Whether the load current is currently being increased
+        bool isIncreasing{true};
+        /// Ticks since the last perturbation
+        uint16_t ticks{0};
+};
+}
+
+#endif
@@ -0,0 +1,34 @@
+#include "PiController.h"
+
+#include <etl/algorithm.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Reset the controller
+ *
+ * Set the integrator such that, with no error, the controller outputs the given value.
+ *
+ * @param output Output value to start from (µA)
+ */
+void PiController::reset(const uint32_t output) {
+    this->integrator = static_cast<int64_t>(etl::min(output, this->maxOutput)) * kOne;
+}
+
+/**
+ * @brief Run the controller for one tick
+ *
+ * @param error Control error; positive values increase the output
+ *
+ * @return New output value (µA)
+ */
+uint32_t PiController::update(const int32_t error) {
+    const int64_t max = static_cast<int64_t>(this->maxOutput) * kOne;
+
+    this->integrator = etl::clamp(this->integrator + (this->gains.ki * error),
+            static_cast<int64_t>(0), max);
+
+    const int64_t output = etl::clamp(this->integrator + (this->gains.kp * error),
+            static_cast<int64_t>(0), max);
+    return static_cast<uint32_t>(output / kOne);
+}
@@ -0,0 +1,73 @@
+#ifndef APP_CONTROL_PICONTROLLER_H
+#define APP_CONTROL_PICONTROLLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace App::Control {
+/**
+ * @brief Proportional-integral controller
+ *
+ * Used by the closed loop operation modes (constant voltage, constant power) to calculate the
+ * load current that brings the controlled quantity to its setpoint. It runs once per control
+ * tick; the error is signed such that a positive error requires more current.
+ *
+ * The output is clamped to a configurable maximum; the integrator is clamped to the same range,
+ * so it doesn't wind up while the output is saturated. Gains are in Q16 format.
+ */
+class PiController {
+    public:
+        /// Unity in Q16 format
+        constexpr static const int64_t kOne{1 << 16};
+
+        /**
+         * @brief Controller gains
+         */
+        struct Gains {
+            /// Proportional gain (Q16, µA of output per unit of error)
+            int64_t kp{0};
+            /// Integral gain (Q16, µA of output per unit of error per tick)
+            int64_t ki{0};
+        };
+
+    public:
+        /**
+         * @brief Change the controller gains
+         *
+         * This takes effect on the next update; the integrator is preserved, so there is no bump
+         * in the output.
+         */
+        inline void setGains(const Gains &newGains) {
+            this->gains = newGains;
+        }
+
+        /**
+         * @brief Get the current controller gains
+         */
+        inline const Gains &getGains() const {
+            return this->gains;
+        }
+
+        /**
+         * @brief Set the maximum output value
+         *
+         * @param max Maximum output current (µA)
+         */
+        inline void setMaxOutput(const uint32_t max) {
+            this->maxOutput = max;
+        }
+
+        void reset(const uint32_t output);
+        uint32_t update(const int32_t error);
+
+    private:
+        /// Controller gains
+        Gains gains;
+        /// Maximum output (µA)
+        uint32_t maxOutput{0};
+        /// Integrator state (Q16 µA)
+        int64_t integrator{0};
+};
+}
+
+#endif
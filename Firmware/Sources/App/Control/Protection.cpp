@@ -0,0 +1,73 @@
+#include "Protection.h"
+
+#include "Log/Logger.h"
+#include "Rtos/Rtos.h"
+#include "stm32mp1xx.h"
+
+using namespace App::Control;
+
+/**
+ * @brief Check a sample against the protection thresholds
+ *
+ * @param voltage Input voltage (mV)
+ * @param current Input current (µA)
+ *
+ * @return The first exceeded limit, or Fault::None if the sample is within all limits
+ */
+Protection::Fault Protection::check(const uint32_t voltage, const uint32_t current) const {
+    const auto &l = this->limits;
+
+    if(l.overCurrent && current > l.overCurrent) {
+        return Fault::OverCurrent;
+    } else if(l.overVoltage && voltage > l.overVoltage) {
+        return Fault::OverVoltage;
+    } else if(l.underVoltage && voltage < l.underVoltage) {
+        return Fault::UnderVoltage;
+    }
+
+    // mV * µA = nW
+    if(l.overPower &&
+            ((static_cast<uint64_t>(voltage) * current) / 1'000'000) > l.overPower) {
+        return Fault::OverPower;
+    }
+
+    return Fault::None;
+}
+
+/**
+ * @brief Latch a fault
+ *
+ * Record the fault, and the time it took to react to it. This should be invoked right after the
+ * load was disabled.
+ *
+ * @param fault Fault that occurred
+ * @param voltage Input voltage of the offending sample (mV)
+ * @param current Input current of the offending sample (µA)
+ * @param sampleTimestamp Cycle counter value at the time the sample was acquired
+ */
+void Protection::latch(const Fault fault, const uint32_t voltage, const uint32_t current,
+        const uint32_t sampleTimestamp) {
+    const uint32_t cycles = DWT->CYCCNT - sampleTimestamp;
+    const auto latency = static_cast<uint32_t>((static_cast<uint64_t>(cycles) * 1'000'000) /
+            SystemCoreClock);
+
+    if(latency > this->worstLatency) {
+        this->worstLatency = latency;
+    }
+
+    // keep the first fault, if several occur before it's cleared
+    if(this->isTripped()) {
+        return;
+    }
+
+    this->record = {
+        .fault = fault,
+        .timestamp = static_cast<uint32_t>(xTaskGetTickCount() * portTICK_PERIOD_MS),
+        .voltage = voltage,
+        .current = current,
+        .latency = latency,
+    };
+
+    Logger::Warning("control: protection tripped (fault %u, %u mV, %u µA, %u µs)",
+            static_cast<unsigned int>(fault), voltage, current, latency);
+}
@@ -0,0 +1,132 @@
+#ifndef APP_CONTROL_PROTECTION_H
+#define APP_CONTROL_PROTECTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace App::Control {
+/**
+ * @brief Load protection
+ *
+ * Evaluates the overcurrent (OCP), overvoltage (OVP), overpower (OPP) and undervoltage (UVP)
+ * limits against every new sample, whether it came from the periodic sampling or the driver's
+ * interrupt path. When any of them is exceeded, the control task disables the load right away,
+ * and the fault is latched: the load can't be enabled again until the fault is cleared.
+ *
+ * The trip latency (the time between the sample being acquired and the load being disabled) is
+ * measured with the cycle counter, and the worst case is kept for diagnostics.
+ */
+class Protection {
+    public:
+        /**
+         * @brief Fault types
+         *
+         * @remark These values are reported to the host, so they must not be changed.
+         */
+        enum class Fault: uint8_t {
+            /// No fault
+            None                        = 0,
+            /// Input current above OCP limit
+            OverCurrent                 = 1,
+            /// Input voltage above OVP limit
+            OverVoltage                 = 2,
+            /// Input power above OPP limit
+            OverPower                   = 3,
+            /// Input voltage below UVP limit
+            UnderVoltage                = 4,
+        };
+
+        /**
+         * @brief Protection thresholds
+         *
+         * A threshold of 0 disables the corresponding protection.
+         */
+        struct Limits {
+            /// Overcurrent limit (µA)
+            uint32_t overCurrent{0};
+            /// Overvoltage limit (mV)
+            uint32_t overVoltage{0};
+            /// Overpower limit (mW)
+            uint32_t overPower{0};
+            /// Undervoltage limit (mV)
+            uint32_t underVoltage{0};
+        };
+
+        /**
+         * @brief Latched fault record
+         */
+        struct Record {
+            /// Type of fault
+            Fault fault{Fault::None};
+            /// Time at which the fault was detected (ms since boot)
+            uint32_t timestamp{0};
+            /// Input voltage at the time of the fault (mV)
+            uint32_t voltage{0};
+            /// Input current at the time of the fault (µA)
+            uint32_t current{0};
+            /// Time from sample acquisition until the load was disabled (µs)
+            uint32_t latency{0};
+        };
+
+    public:
+        /**
+         * @brief Update the protection thresholds
+         */
+        inline void setLimits(const Limits &newLimits) {
+            this->limits = newLimits;
+        }
+
+        /**
+         * @brief Get the current protection thresholds
+         */
+        inline const Limits &getLimits() const {
+            return this->limits;
+        }
+
+        Fault check(const uint32_t voltage, const uint32_t current) const;
+        void latch(const Fault fault, const uint32_t voltage, const uint32_t current,
+                const uint32_t sampleTimestamp);
+
+        /**
+         * @brief Whether a fault is latched
+         */
+        inline bool isTripped() const {
+            return this->record.fault != Fault::None;
+        }
+
+        /**
+         * @brief Get the latched fault record
+         */
+        inline const Record &getRecord() const {
+            return this->record;
+        }
+
+        /**
+         * @brief Clear the latched fault
+         *
+         * This allows the load to be enabled again.
+         */
+        inline void clear() {
+            this->record = {};
+        }
+
+        /**
+         * @brief Get the worst case trip latency
+         *
+         * @return Longest time (in µs) observed between a sample and the load being disabled
+         */
+        inline uint32_t getWorstLatency() const {
+            return this->worstLatency;
+        }
+
+    private:
+        /// Active thresholds
+        Limits limits;
+        /// Most recent fault
+        Record record;
+        /// Worst case trip latency (µs)
+        uint32_t worstLatency{0};
+};
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include "RelayAutoTune.h"
+
+#include <math.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Start a tuning run
+ *
+ * @param newConfig Tuning parameters; the bias must be at least as large as the amplitude, so
+ *        that the relay output is symmetric.
+ *
+ * @return Whether the parameters were valid and the tuner was started; if not, the tuner is in
+ *         the failed state.
+ */
+bool RelayAutoTune::start(const Config &newConfig) {
+    if(!newConfig.amplitude || newConfig.bias < newConfig.amplitude || !newConfig.timeout ||
+            !newConfig.numCycles || newConfig.numCycles > kMaxCycles) {
+        this->state = State::Failed;
+        return false;
+    }
+
+    this->config = newConfig;
+    this->result = {};
+
+    this->ticks = 0;
+    this->isRelayHigh = true;
+    this->lastRisingTick = 0;
+    this->numCycles = 0;
+    this->periodSum = 0;
+    this->amplitudeSum = 0;
+
+    this->state = State::Running;
+    return true;
+}
+
+/**
+ * @brief Abort the tuning run
+ *
+ * This is also used to indicate that a requested run could not be started.
+ */
+void RelayAutoTune::abort() {
+    this->state = State::Aborted;
+}
+
+/**
+ * @brief Run the tuner for one tick
+ *
+ * @param error Control error; positive values call for more output
+ *
+ * @return Output value to apply (µA)
+ */
+uint32_t RelayAutoTune::update(const int32_t error) {
+    if(this->state != State::Running) {
+        return this->config.bias;
+    }
+
+    this->ticks++;
+
+    // track the extremes of the oscillation
+    if(error < this->cycleMin) {
+        this->cycleMin = error;
+    }
+    if(error > this->cycleMax) {
+        this->cycleMax = error;
+    }
+
+    // switch the relay; a cycle ends on every low to high transition
+    const int32_t h = static_cast<int32_t>(this->config.hysteresis);
+
+    if(this->isRelayHigh && error < -h) {
+        this->isRelayHigh = false;
+    } else if(!this->isRelayHigh && error > h) {
+        this->isRelayHigh = true;
+        this->finishCycle();
+    }
+
+    if(this->state == State::Running && this->ticks >= this->config.timeout) {
+        this->state = State::Failed;
+    }
+    if(this->state != State::Running) {
+        return this->config.bias;
+    }
+
+    return this->isRelayHigh ? (this->config.bias + this->config.amplitude) :
+        (this->config.bias - this->config.amplitude);
+}
+
+/**
+ * @brief Handle a low to high relay transition
+ *
+ * This marks the end of one oscillation cycle and the start of the next. The first cycle is
+ * discarded, since the process is still settling into the limit cycle.
+ */
+void RelayAutoTune::finishCycle() {
+    if(this->lastRisingTick) {
+        if(++this->numCycles > 1) {
+            this->periodSum += this->ticks - this->lastRisingTick;
+            this->amplitudeSum += static_cast<uint64_t>(
+                    static_cast<int64_t>(this->cycleMax) - this->cycleMin);
+        }
+
+        if(this->numCycles > this->config.numCycles) {
+            this->computeResult();
+            return;
+        }
+    }
+
+    this->lastRisingTick = this->ticks;
+    this->cycleMin = INT32_MAX;
+    this->cycleMax = INT32_MIN;
+}
+
+/**
+ * @brief Derive the controller gains from the measured oscillation
+ */
+void RelayAutoTune::computeResult() {
+    const uint32_t n = this->config.numCycles;
+
+    this->result.period = (this->periodSum + (n / 2)) / n;
+    this->result.amplitude = static_cast<uint32_t>(this->amplitudeSum / (2 * n));
+
+    if(!this->result.period || this->result.amplitude <= this->config.hysteresis) {
+        this->state = State::Failed;
+        return;
+    }
+
+    // describing function of a relay with hysteresis
+    const float a = static_cast<float>(this->result.amplitude);
+    const float h = static_cast<float>(this->config.hysteresis);
+    const float ku = (4.f * static_cast<float>(this->config.amplitude)) /
+        (static_cast<float>(M_PI) * sqrtf((a * a) - (h * h)));
+    this->result.ultimateGain = ku;
+
+    // Ziegler-Nichols: Kp = 0.45 Ku, Ti = Tu / 1.2
+    const float kp = 0.45f * ku;
+    const float ki = (0.54f * ku) / static_cast<float>(this->result.period);
+
+    this->result.gains.kp = static_cast<int64_t>(kp * PiController::kOne);
+    this->result.gains.ki = static_cast<int64_t>(ki * PiController::kOne);
+
+    this->state = State::Done;
+}
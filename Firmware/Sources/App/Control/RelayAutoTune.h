@@ -0,0 +1,131 @@
+#ifndef APP_CONTROL_RELAYAUTOTUNE_H
+#define APP_CONTROL_RELAYAUTOTUNE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PiController.h"
+
+namespace App::Control {
+/**
+ * @brief Relay feedback auto-tuner
+ *
+ * Determines gains for a PiController by closing the loop through a relay (bang-bang controller
+ * with hysteresis) instead: the output is switched between bias + amplitude and bias - amplitude
+ * depending on the sign of the control error, which makes most processes settle into a limit
+ * cycle. The period of that oscillation is the ultimate period Tu, and from its amplitude a, the
+ * ultimate gain is Ku = 4d / (pi * sqrt(a^2 - h^2)). Gains are then derived with the
+ * Ziegler-Nichols rules for a PI controller.
+ *
+ * The tuner doesn't touch any hardware: it's fed the control error once per tick, and returns
+ * the output to apply. Both the period and the gains are thus in terms of control ticks.
+ */
+class RelayAutoTune {
+    public:
+        /// Maximum number of oscillation cycles to measure
+        constexpr static const uint8_t kMaxCycles{16};
+
+        /**
+         * @brief Tuner state
+         */
+        enum class State: uint8_t {
+            /// Not running
+            Idle                        = 0,
+            /// Exciting the process and measuring the oscillation
+            Running                     = 1,
+            /// Completed successfully; gains are available
+            Done                        = 2,
+            /// No usable oscillation was observed before the timeout
+            Failed                      = 3,
+            /// Aborted (or not started) by the caller
+            Aborted                     = 4,
+        };
+
+        /**
+         * @brief Tuning parameters
+         */
+        struct Config {
+            /// Output value around which the relay switches (µA)
+            uint32_t bias{0};
+            /// Relay amplitude; output switches between bias ± amplitude (µA)
+            uint32_t amplitude{0};
+            /// Relay hysteresis, in units of the control error
+            uint32_t hysteresis{0};
+            /// Number of oscillation cycles to average (after the first, which is discarded)
+            uint8_t numCycles{4};
+            /// Maximum duration of the test (ticks)
+            uint32_t timeout{0};
+        };
+
+        /**
+         * @brief Tuning result
+         */
+        struct Result {
+            /// Ultimate period (ticks)
+            uint32_t period{0};
+            /// Oscillation amplitude (peak, in units of the control error)
+            uint32_t amplitude{0};
+            /// Ultimate gain (µA per unit of control error)
+            float ultimateGain{0};
+            /// Derived controller gains
+            PiController::Gains gains;
+        };
+
+    public:
+        bool start(const Config &newConfig);
+        void abort();
+
+        uint32_t update(const int32_t error);
+
+        /**
+         * @brief Get the tuner state
+         */
+        inline State getState() const {
+            return this->state;
+        }
+
+        /**
+         * @brief Whether the tuner is currently driving the output
+         */
+        inline bool isRunning() const {
+            return this->state == State::Running;
+        }
+
+        /**
+         * @brief Get the result of the last completed tuning run
+         */
+        inline const Result &getResult() const {
+            return this->result;
+        }
+
+    private:
+        void finishCycle();
+        void computeResult();
+
+    private:
+        /// Current state
+        State state{State::Idle};
+        /// Active tuning parameters
+        Config config;
+        /// Result of the last tuning run
+        Result result;
+
+        /// Ticks since the tuner was started
+        uint32_t ticks{0};
+        /// Whether the relay is in the high (bias + amplitude) state
+        bool isRelayHigh{false};
+        /// Tick of the most recent low to high relay transition (0 = none yet)
+        uint32_t lastRisingTick{0};
+        /// Number of full cycles observed (including the discarded first one)
+        uint8_t numCycles{0};
+
+        /// Extremes of the control error in the current cycle
+        int32_t cycleMin{0}, cycleMax{0};
+        /// Sum of periods of the measured cycles (ticks)
+        uint32_t periodSum{0};
+        /// Sum of peak-to-peak amplitudes of the measured cycles
+        uint64_t amplitudeSum{0};
+};
+}
+
+#endif
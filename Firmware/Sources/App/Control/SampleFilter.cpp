@@ -0,0 +1,64 @@
+#include "SampleFilter.h"
+
+#include <etl/algorithm.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Change the filter configuration
+ *
+ * Out of range values are clamped to the supported range. The filter is reset.
+ *
+ * @param newConfig Configuration to apply
+ */
+void SampleFilter::configure(const Config &newConfig) {
+    this->config.decimation = etl::clamp(newConfig.decimation, static_cast<uint16_t>(1),
+            static_cast<uint16_t>(kMaxDecimation));
+    this->config.iirShift = etl::min(newConfig.iirShift, kMaxIirShift);
+
+    this->reset();
+}
+
+/**
+ * @brief Reset the filter state
+ *
+ * Discard any partially accumulated samples; the next output initializes the IIR filter directly,
+ * so that it doesn't have to settle from zero.
+ */
+void SampleFilter::reset() {
+    this->accumulator = 0;
+    this->numAccumulated = 0;
+    this->isPrimed = false;
+}
+
+/**
+ * @brief Feed a new sample into the filter
+ *
+ * @param sample Raw input sample
+ *
+ * @return Whether a new output was produced
+ */
+bool SampleFilter::push(const uint32_t sample) {
+    this->raw = sample;
+
+    // decimate
+    this->accumulator += sample;
+    if(++this->numAccumulated < this->config.decimation) {
+        return false;
+    }
+
+    const uint64_t average = (this->accumulator << kFractionBits) / this->numAccumulated;
+    this->accumulator = 0;
+    this->numAccumulated = 0;
+
+    // then low pass filter the decimated stream
+    if(!this->isPrimed || !this->config.iirShift) {
+        this->state = average;
+        this->isPrimed = true;
+    } else {
+        const int64_t delta = static_cast<int64_t>(average) - static_cast<int64_t>(this->state);
+        this->state += delta / (1 << this->config.iirShift);
+    }
+
+    return true;
+}
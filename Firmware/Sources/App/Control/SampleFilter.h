@@ -0,0 +1,112 @@
+#ifndef APP_CONTROL_SAMPLEFILTER_H
+#define APP_CONTROL_SAMPLEFILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace App::Control {
+/**
+ * @brief Measurement filter
+ *
+ * Sits between the raw driver readings and the control loop: samples are pushed in at whatever
+ * rate the driver produces them, averaged in blocks of a configurable length (boxcar decimation,
+ * i.e. a first order CIC filter) and then, optionally, passed through a single pole IIR low pass
+ * filter. The control loop consumes the filter output at its own rate.
+ *
+ * The IIR filter's coefficient is a power of two, so that it's a shift and an add. Its state, as
+ * well as the decimator output, keeps extra fractional bits; this means averaging many samples
+ * actually increases the resolution rather than just reducing noise.
+ */
+class SampleFilter {
+    public:
+        /// Maximum number of samples to average per output
+        constexpr static const size_t kMaxDecimation{256};
+        /// Maximum IIR filter coefficient shift
+        constexpr static const uint8_t kMaxIirShift{12};
+        /**
+         * @brief Number of fractional bits kept in the filter state
+         *
+         * This must be larger than the maximum IIR shift, so that the filter output can settle
+         * to within a fraction of an input unit.
+         */
+        constexpr static const uint8_t kFractionBits{16};
+
+        /**
+         * @brief Filter configuration
+         */
+        struct Config {
+            /// Number of samples averaged to produce one output (1 = no decimation)
+            uint16_t decimation{1};
+            /**
+             * @brief IIR filter coefficient
+             *
+             * Each output moves by 2^-iirShift of the difference towards the new input, so the
+             * time constant is roughly 2^iirShift output samples. 0 disables the filter.
+             */
+            uint8_t iirShift{0};
+        };
+
+    public:
+        void configure(const Config &newConfig);
+        void reset();
+
+        bool push(const uint32_t sample);
+
+        /**
+         * @brief Get the filter configuration
+         */
+        inline const Config &getConfig() const {
+            return this->config;
+        }
+
+        /**
+         * @brief Get the most recent input sample
+         */
+        inline uint32_t getRaw() const {
+            return this->raw;
+        }
+
+        /**
+         * @brief Get the filter output
+         *
+         * @return Filtered value, rounded to the same units as the input
+         */
+        inline uint32_t getFiltered() const {
+            return (this->state + (1U << (kFractionBits - 1))) >> kFractionBits;
+        }
+
+        /**
+         * @brief Get the filter output, with its full resolution
+         *
+         * @return Filtered value, with kFractionBits fractional bits
+         */
+        inline uint64_t getFilteredFraction() const {
+            return this->state;
+        }
+
+        /**
+         * @brief Whether the filter has produced at least one output since it was reset
+         */
+        inline bool isValid() const {
+            return this->isPrimed;
+        }
+
+    private:
+        /// Active configuration
+        Config config;
+
+        /// Sum of the samples in the current decimation block
+        uint64_t accumulator{0};
+        /// Number of samples in the current decimation block
+        uint16_t numAccumulated{0};
+
+        /// Most recent input sample
+        uint32_t raw{0};
+        /// Filter output (with fractional bits)
+        uint64_t state{0};
+        /// Whether the filter has been initialized with a first output
+        bool isPrimed{false};
+};
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "SlewLimiter.h"
+
+#include <etl/algorithm.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Change the limiter parameters
+ *
+ * The new slew rate applies from the next tick on; a soft-start ramp in progress is cut short.
+ *
+ * @param newConfig Parameters to apply
+ * @param tickInterval Control loop period (ms)
+ */
+void SlewLimiter::configure(const Config &newConfig, const uint32_t tickInterval) {
+    this->config = newConfig;
+
+    this->maxStep = etl::min(static_cast<uint64_t>(newConfig.slewRate) * tickInterval,
+            static_cast<uint64_t>(UINT32_MAX));
+    this->softStartTicks = (newConfig.softStartTime + tickInterval - 1) / tickInterval;
+
+    this->isSoftStarting = false;
+}
+
+/**
+ * @brief Set the output to a value directly
+ *
+ * @param current New output value (µA)
+ */
+void SlewLimiter::reset(const uint32_t current) {
+    this->output = current;
+}
+
+/**
+ * @brief Begin a soft-start ramp
+ *
+ * The output ramps up from zero; this does nothing if soft-start is disabled.
+ */
+void SlewLimiter::startSoftStart() {
+    if(!this->softStartTicks) {
+        return;
+    }
+
+    this->output = 0;
+    this->isSoftStarting = true;
+    this->softStartElapsed = 0;
+}
+
+/**
+ * @brief Advance the output by one tick
+ *
+ * @param target Load current requested by the control loop (µA)
+ *
+ * @return Load current to apply (µA)
+ */
+uint32_t SlewLimiter::update(const uint32_t target) {
+    uint32_t next{target};
+
+    // move towards the target by at most one step
+    if(this->maxStep) {
+        if(target > this->output) {
+            next = etl::min(static_cast<uint64_t>(this->output) + this->maxStep,
+                    static_cast<uint64_t>(target));
+        } else {
+            next = (this->output - target > this->maxStep) ? (this->output - this->maxStep) :
+                target;
+        }
+    }
+
+    // and stay below the soft-start ramp, which scales with the target
+    if(this->isSoftStarting) {
+        if(++this->softStartElapsed >= this->softStartTicks) {
+            this->isSoftStarting = false;
+        } else {
+            const uint32_t ramp = (static_cast<uint64_t>(target) * this->softStartElapsed) /
+                this->softStartTicks;
+            next = etl::min(next, ramp);
+        }
+    }
+
+    this->output = next;
+    return this->output;
+}
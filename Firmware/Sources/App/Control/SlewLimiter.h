@@ -0,0 +1,80 @@
+#ifndef APP_CONTROL_SLEWLIMITER_H
+#define APP_CONTROL_SLEWLIMITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace App::Control {
+/**
+ * @brief Load current slew rate limiter and soft-start ramp generator
+ *
+ * Sits between the control loop and the current setpoint applied to the driver: rather than
+ * jumping to a new value, the output moves towards it by at most a fixed step per control tick.
+ * Separately, a soft-start ramp can be started when the load is enabled, which brings the output
+ * up from zero to the requested current linearly over a fixed time.
+ *
+ * Both are computed incrementally once per control tick, so the rates are quantized to the
+ * control loop period.
+ */
+class SlewLimiter {
+    public:
+        /**
+         * @brief Limiter parameters
+         */
+        struct Config {
+            /// Maximum rate of change of the load current (µA per ms, i.e. mA/s); 0 = unlimited
+            uint32_t slewRate{0};
+            /// Duration of the soft-start ramp when enabling the load (ms); 0 = disabled
+            uint32_t softStartTime{0};
+        };
+
+    public:
+        void configure(const Config &newConfig, const uint32_t tickInterval);
+        void reset(const uint32_t current);
+        void startSoftStart();
+
+        uint32_t update(const uint32_t target);
+
+        /**
+         * @brief Get the limiter parameters
+         */
+        inline const Config &getConfig() const {
+            return this->config;
+        }
+
+        /**
+         * @brief Get the current output value
+         *
+         * @return Load current to apply (µA)
+         */
+        inline uint32_t getOutput() const {
+            return this->output;
+        }
+
+        /**
+         * @brief Whether the output is currently being limited
+         *
+         * If not, the output may simply be reset to the target value whenever it changes.
+         */
+        inline bool isActive() const {
+            return this->maxStep || this->isSoftStarting;
+        }
+
+    private:
+        /// Active parameters
+        Config config;
+        /// Maximum output change per tick (µA); 0 = unlimited
+        uint32_t maxStep{0};
+        /// Length of the soft-start ramp (ticks)
+        uint32_t softStartTicks{0};
+
+        /// Current output value (µA)
+        uint32_t output{0};
+        /// Whether the soft-start ramp is in progress
+        bool isSoftStarting{false};
+        /// Ticks elapsed since the soft-start ramp began
+        uint32_t softStartElapsed{0};
+};
+}
+
+#endif
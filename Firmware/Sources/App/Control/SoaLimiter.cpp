@@ -0,0 +1,162 @@
+#include "SoaLimiter.h"
+#include "LoadDriver.h"
+
+#include "Log/Logger.h"
+
+#include <etl/algorithm.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Attach to a load driver
+ *
+ * Query the driver's thermal model, and precompute the per-tick update coefficients for it. All
+ * channels start out at the heatsink temperature.
+ *
+ * @param driver Load driver whose channels are to be protected
+ * @param tickInterval Interval between calls to update(), in ms
+ */
+void SoaLimiter::attach(LoadDriver *driver, const uint32_t tickInterval) {
+    int err;
+    uint32_t maxCurrent;
+
+    this->driver = driver;
+    this->numChannels = driver->getNumChannels();
+    REQUIRE(this->numChannels && this->numChannels <= kMaxChannels,
+            "soa: invalid channel count (%u)", this->numChannels);
+
+    err = driver->getMaxInputCurrent(maxCurrent);
+    REQUIRE(!err, "soa: %s (%d)", "failed to get max current", err);
+    this->channelMaxCurrent = (maxCurrent * 1000) / this->numChannels;
+    this->channelLimit = this->channelMaxCurrent;
+
+    // set up the thermal model
+    this->soa = driver->getSafeOperatingArea();
+    if(!this->soa) {
+        Logger::Warning("soa: %s", "driver has no thermal model, only current limit applies");
+        return;
+    }
+
+    REQUIRE(!this->soa->stages.empty() && this->soa->stages.size() <= kMaxStages,
+            "soa: invalid stage count (%u)", this->soa->stages.size());
+    REQUIRE(!this->soa->curve.empty(), "soa: %s", "empty SOA curve");
+
+    this->numStages = this->soa->stages.size();
+    this->stepResistance = 0;
+
+    for(size_t i = 0; i < this->numStages; i++) {
+        const auto &stage = this->soa->stages[i];
+
+        this->alpha[i] = (static_cast<int64_t>(kOne) * tickInterval) /
+            (stage.timeConstant + tickInterval);
+        this->stepResistance += static_cast<int64_t>(this->alpha[i]) * stage.resistance;
+    }
+
+    this->heatsinkTemp = this->soa->defaultHeatsinkTemp;
+    for(auto &channel : this->rise) {
+        channel.fill(0);
+    }
+}
+
+/**
+ * @brief Run a control tick
+ *
+ * Advance the thermal model of each channel using its measured power dissipation, then calculate
+ * the current limit for the next tick.
+ *
+ * @param voltage Input voltage (mV) which is across each channel's MOSFET
+ *
+ * @return 0 on success, or a negative error code
+ */
+int SoaLimiter::update(const uint32_t voltage) {
+    int err;
+
+    if(!this->soa) {
+        return 0;
+    }
+
+    // read heatsink temperature
+    int32_t temp;
+    err = this->driver->readHeatsinkTemperature(temp);
+
+    if(err == LoadDriver::Errors::Unsupported) {
+        this->heatsinkTemp = this->soa->defaultHeatsinkTemp;
+    } else if(err) {
+        return err;
+    } else {
+        this->heatsinkTemp = temp;
+    }
+
+    // update the model, and find the most limited channel
+    const uint64_t soaPower = this->getSoaPower(voltage);
+    uint32_t limit{this->channelMaxCurrent};
+
+    for(size_t i = 0; i < this->numChannels; i++) {
+        uint32_t current;
+        err = this->driver->readChannelCurrent(i, current);
+        if(err) {
+            return err;
+        }
+
+        const int64_t power = (static_cast<uint64_t>(voltage) * current) / 1'000'000;
+        auto &rise = this->rise[i];
+
+        // rise across each stage; and what remains of it after another tick without power
+        int64_t decayed{0};
+
+        for(size_t j = 0; j < this->numStages; j++) {
+            const int64_t steady = (power * this->soa->stages[j].resistance) / 1000;
+            rise[j] += ((steady - rise[j]) * this->alpha[j]) >> 16;
+            decayed += rise[j] - ((static_cast<int64_t>(rise[j]) * this->alpha[j]) >> 16);
+        }
+
+        // maximum power (mW) to not exceed the junction temperature limit at the next tick
+        const int64_t headroom = static_cast<int64_t>(this->soa->maxJunctionTemp) -
+            this->heatsinkTemp - decayed;
+        uint64_t maxPower{0};
+
+        if(headroom > 0) {
+            maxPower = (static_cast<uint64_t>(headroom) * 1000 * kOne) / this->stepResistance;
+        }
+
+        maxPower = etl::min(maxPower, soaPower);
+
+        // convert to current (µA)
+        if(voltage) {
+            const auto maxCurrent = (maxPower * 1'000'000) / voltage;
+            limit = etl::min(static_cast<uint64_t>(limit), maxCurrent);
+        }
+    }
+
+    this->channelLimit = limit;
+    return 0;
+}
+
+/**
+ * @brief Get the maximum power allowed by the SOA curve
+ *
+ * The curve is linearly interpolated; outside of its range, the closest point applies.
+ *
+ * @param voltage Drain-source voltage (mV)
+ *
+ * @return Maximum DC power dissipation (mW)
+ */
+uint32_t SoaLimiter::getSoaPower(const uint32_t voltage) const {
+    const auto &curve = this->soa->curve;
+
+    if(voltage <= curve.front().voltage) {
+        return curve.front().power;
+    }
+
+    for(size_t i = 1; i < curve.size(); i++) {
+        const auto &lo = curve[i - 1], &hi = curve[i];
+        if(voltage > hi.voltage) {
+            continue;
+        }
+
+        const int64_t slope = static_cast<int64_t>(hi.power) - lo.power;
+        return lo.power + (slope * (voltage - lo.voltage)) / (hi.voltage - lo.voltage);
+    }
+
+    return curve.back().power;
+}
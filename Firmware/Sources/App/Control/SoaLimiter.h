@@ -0,0 +1,116 @@
+#ifndef APP_CONTROL_SOALIMITER_H
+#define APP_CONTROL_SOALIMITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/array.h>
+
+#include "LoadDriver.h"
+
+namespace App::Control {
+/**
+ * @brief Safe operating area limiter
+ *
+ * Keeps the channel MOSFETs within their safe operating area, by limiting the current the control
+ * loop may command.
+ *
+ * For each channel, the junction temperature is modelled with a thermal RC (Foster) network,
+ * which is driven by the power dissipated in the channel (its measured current times the input
+ * voltage) and referenced to the measured heatsink temperature. Every tick, the limiter solves
+ * for the maximum power that keeps the modelled junction temperature below its limit at the next
+ * tick; this is further limited by the DC SOA curve at the present input voltage, then converted
+ * to a current.
+ *
+ * The amount of work per tick only depends on the number of channels, thermal stages and SOA
+ * curve points, all of which are bounded, and all arithmetic is fixed point.
+ */
+class SoaLimiter {
+    public:
+        /// Maximum number of channels supported
+        constexpr static const size_t kMaxChannels{4};
+        /// Maximum number of stages in a thermal network
+        constexpr static const size_t kMaxStages{4};
+
+    public:
+        void attach(LoadDriver *driver, const uint32_t tickInterval);
+
+        int update(const uint32_t voltage);
+
+        /**
+         * @brief Get the current limit for each channel
+         *
+         * @return Maximum current (in µA) any single channel may carry at the moment
+         */
+        inline uint32_t getChannelCurrentLimit() const {
+            return this->channelLimit;
+        }
+
+        /**
+         * @brief Get the modelled junction temperature of a channel
+         *
+         * @param channel Channel index
+         *
+         * @return Junction temperature, in m°C
+         */
+        inline int32_t getJunctionTemp(const size_t channel) const {
+            int32_t temp{this->heatsinkTemp};
+            for(size_t i = 0; i < this->numStages; i++) {
+                temp += this->rise[channel][i];
+            }
+            return temp;
+        }
+
+        /**
+         * @brief Get the last heatsink temperature
+         *
+         * @return Heatsink temperature (m°C) as measured, or the default value if the driver
+         *         can't measure it
+         */
+        inline int32_t getHeatsinkTemp() const {
+            return this->heatsinkTemp;
+        }
+
+    private:
+        uint32_t getSoaPower(const uint32_t voltage) const;
+
+    private:
+        /// Unity in Q16 format
+        constexpr static const int32_t kOne{1 << 16};
+
+        /// Driver whose channels are modelled
+        LoadDriver *driver{nullptr};
+        /// Safe operating area and thermal model of the channels
+        const LoadDriver::SafeOperatingArea *soa{nullptr};
+
+        /// Number of channels
+        size_t numChannels{0};
+        /// Number of stages in the thermal network
+        size_t numStages{0};
+        /// Maximum current of each channel (µA)
+        uint32_t channelMaxCurrent{0};
+
+        /**
+         * @brief Per-stage update coefficient (Q16)
+         *
+         * Fraction by which a stage's temperature rise approaches its steady state value in a
+         * single tick; this is dt / (τ + dt), which is stable for any time constant.
+         */
+        etl::array<int32_t, kMaxStages> alpha{};
+        /**
+         * @brief Junction temperature rise per watt in one tick
+         *
+         * The sum of each stage's update coefficient times its thermal resistance (Q16 m°C/W)
+         */
+        int64_t stepResistance{0};
+
+        /// Temperature rise across each stage of each channel (m°C)
+        etl::array<etl::array<int32_t, kMaxStages>, kMaxChannels> rise{};
+        /// Last heatsink temperature (m°C)
+        int32_t heatsinkTemp{0};
+        /// Current limit for each channel (µA)
+        uint32_t channelLimit{UINT32_MAX};
+};
+}
+
+#endif
@@ -2,18 +2,23 @@
 #include "Hardware.h"
 #include "LoadDriver.h"
 #include "DumbLoadDriver.h"
+#include "AnalogLoadDriver.h"
 
-#include "App/Main/Task.h"
 #include "App/Pinball/Task.h"
+#include "App/Rpmsg/Task.h"
 #include "Drivers/I2C.h"
 #include "Drivers/I2CDevice/AT24CS32.h"
 
 #include "Log/Logger.h"
 #include "Rtos/Rtos.h"
+#include "Supervisor/Checkin.h"
 #include "Util/Base32.h"
 #include "Util/InventoryRom.h"
 
+#include "stm32mp1xx.h"
+
 #include <string.h>
+#include <etl/algorithm.h>
 #include <etl/array.h>
 
 using namespace App::Control;
@@ -71,17 +76,18 @@ void Task::main() {
      * controller driver instance, which in turn initializes the hardware on the driver.
      */
     Logger::Trace("control: %s", "identify hardware");
-    App::Main::Task::CheckIn(App::Main::WatchdogCheckin::Control);
+    Supervisor::Checkin::Register(Supervisor::Checkin::Client::Control, kCheckinDeadline);
+    Supervisor::Checkin::CheckIn(Supervisor::Checkin::Client::Control);
     Hw::PulseReset();
 
-    App::Main::Task::CheckIn(App::Main::WatchdogCheckin::Control);
+    Supervisor::Checkin::CheckIn(Supervisor::Checkin::Client::Control);
     this->identifyDriver();
 
     /*
      * Start handling messages
      */
     Logger::Trace("control: %s", "start message loop");
-    App::Main::Task::CheckIn(App::Main::WatchdogCheckin::Control);
+    Supervisor::Checkin::CheckIn(Supervisor::Checkin::Client::Control);
 
     xTimerStart(this->sampleTimer, portMAX_DELAY);
 
@@ -93,6 +99,20 @@ void Task::main() {
         // handle interrupt and triggers
         if(note & TaskNotifyBits::IrqAsserted) {
             this->driver->handleIrq();
+
+            // the driver may have acquired a new current sample
+            uint32_t current;
+            err = this->driver->readInputCurrent(current);
+            REQUIRE(!err, "control: %s (%d)", "failed to read current", err);
+
+            this->currentFilter.push(current);
+            this->numIrqSamples++;
+
+            // a trip changed the load state, so apply the config before sampling again
+            if(this->isLoadEngaged() && this->checkProtection(this->voltageFilter.getRaw(),
+                        current, Hw::GetDriverIrqTimestamp())) {
+                note |= TaskNotifyBits::ConfigChange;
+            }
         }
 
         // handle load configuration change
@@ -102,7 +122,9 @@ void Task::main() {
 
         // sample sensors
         if(note & TaskNotifyBits::SampleData) {
-            this->readSensors();
+            if(this->readSensors()) {
+                this->updateConfig();
+            }
         }
 
         // update sense input relay
@@ -112,7 +134,7 @@ void Task::main() {
         }
 
         // check in with watchdog
-        App::Main::Task::CheckIn(App::Main::WatchdogCheckin::Control);
+        Supervisor::Checkin::CheckIn(Supervisor::Checkin::Client::Control);
     }
 }
 
@@ -142,83 +164,91 @@ void Task::identifyDriver() {
     /*
      * Now read the identification data out of the ROM. This consists first of a fixed 16-byte
      * header that we verify for correctness, then one or more "atoms" that actually contain
-     * payload data.
+     * payload data. The decoded contents are cached by the board's serial, so this only actually
+     * reads the ROM the first time a particular board is probed.
      *
      * For this application, we really just care about the "driver identifier" which is an UUID
      * matching to one of the driver classes we have.
      */
-    err = Util::InventoryRom::GetAtoms(
-            // TODO: take length into account
+    const Util::InventoryRom::Contents *rom{nullptr};
+
+    err = Util::InventoryRom::ReadCached(serial,
             [](auto addr, auto len, auto buf, auto ctx) -> int {
-        return reinterpret_cast<Drivers::I2CDevice::AT24CS32 *>(ctx)->readData(addr, buf);
-    }, &idprom,
-    /*
-     * We only want to read the driver UUID and hardware revision atoms.
-     */
-    [](auto header, auto ctx, auto readBuf) -> bool {
-        static etl::array<uint8_t, 16> gUuidBuf;
-        static etl::array<uint8_t, 2> gRevBuf;
-
-        switch(header.type) {
-            case Util::InventoryRom::AtomType::HwRevision:
-                readBuf = gRevBuf;
-                break;
-            case Util::InventoryRom::AtomType::DriverId:
-                readBuf = gUuidBuf;
-                break;
-
-            default:
-                break;
-        }
-        return true;
-    }, this,
-    /*
-     * Deal with the driver uuid or hw revision values.
-     */
-    [](auto header, auto buffer, auto ctx) {
-        auto inst = reinterpret_cast<Task *>(ctx);
-
-        switch(header.type) {
-            /*
-             * Hardware revision is represented as a big endian 16-bit integer.
-             */
-            case Util::InventoryRom::AtomType::HwRevision:
-                uint16_t temp;
-                memcpy(&temp, buffer.data(), 2);
-                inst->pcbRev = __builtin_bswap16(temp);
-                break;
-            /*
-             * Driver ID is encoded as a 16 byte binary representation of an UUID.
-             */
-            case Util::InventoryRom::AtomType::DriverId:
-                inst->driverId = Util::Uuid(buffer);
-                break;
-
-            default:
-                break;
-        }
-    }, this);
+        return reinterpret_cast<Drivers::I2CDevice::AT24CS32 *>(ctx)->readData(addr,
+                buf.first(len));
+    }, &idprom, Drivers::I2CDevice::AT24CS32::kDeviceSize, rom);
 
     REQUIRE(err >= 0, "failed to read driver pcb %s: %d", "prom atoms", err);
+    REQUIRE(rom->has(Util::InventoryRom::AtomType::DriverId), "driver pcb has no %s",
+            "driver id");
+
+    this->driverId = Util::Uuid(rom->driverId);
+    this->pcbRev = rom->hwRevision;
 
     // log info about it
     etl::array<char, 0x26> uuidStr;
     this->driverId.format(uuidStr);
 
     Logger::Notice("Driver pcb: rev %u (driver %s)", this->pcbRev, uuidStr.data());
+    if(rom->has(Util::InventoryRom::AtomType::Name)) {
+        Logger::Notice("Driver pcb: %s (%s)", rom->name.data(), rom->manufacturer.data());
+    }
+
+    /*
+     * Instantiate the right driver for the UUID: either the "dumb" I²C load boards, or the two
+     * channel analog board.
+     */
+    static uint8_t gDriverBuf[etl::max(sizeof(DumbLoadDriver), sizeof(AnalogLoadDriver))]
+        __attribute__((aligned(etl::max(alignof(DumbLoadDriver), alignof(AnalogLoadDriver)))));
+
+    if(this->driverId == DumbLoadDriver::kDriverId) {
+        auto ptr = reinterpret_cast<DumbLoadDriver *>(gDriverBuf);
+        this->driver = new (ptr) DumbLoadDriver(Hw::gBus, idprom);
+    } else if(this->driverId == AnalogLoadDriver::kDriverId) {
+        auto ptr = reinterpret_cast<AnalogLoadDriver *>(gDriverBuf);
+        this->driver = new (ptr) AnalogLoadDriver(Hw::gBus, idprom, Hw::gSpi);
+    } else {
+        Logger::Panic("unknown load pcb driver: %s", uuidStr.data());
+    }
+
+    Logger::Notice("Driver pcb: %u channel(s)", this->driver->getNumChannels());
 
     /*
-     * Currently there is only support for the "dumb" load boards, so ensure we instantiate the
-     * right driver for that UUID.
+     * Apply the board's calibration tables. Each is converted to its lookup form once, here, so
+     * that applying it to every sample is cheap.
      */
-    REQUIRE(this->driverId == DumbLoadDriver::kDriverId, "unknown load pcb driver: %s",
-            uuidStr.data());
+    for(size_t i = 0; i < rom->numCalibrationTables; i++) {
+        const auto &cal = rom->calibration[i];
+        LoadDriver::CalibrationTable table;
+
+        if(!table.load(cal.getPoints())) {
+            Logger::Warning("Driver pcb: invalid calibration (target %u, channel %u)",
+                    cal.target, cal.channel);
+            continue;
+        }
 
-    static uint8_t gDriverBuf[sizeof(DumbLoadDriver)]
-        __attribute__((aligned(alignof(DumbLoadDriver))));
-    auto ptr = reinterpret_cast<DumbLoadDriver *>(gDriverBuf);
+        err = this->driver->setCalibration(static_cast<LoadDriver::CalibrationTarget>(cal.target),
+                cal.channel, table);
+        if(err) {
+            Logger::Warning("Driver pcb: failed to apply calibration (target %u, channel %u): %d",
+                    cal.target, cal.channel, err);
+        }
+    }
 
-    this->driver = new (ptr) DumbLoadDriver(Hw::gBus, idprom);
+    if(rom->numCalibrationTables) {
+        Logger::Notice("Driver pcb: %u calibration table(s)", rom->numCalibrationTables);
+    }
+    this->sharing.attach(this->driver);
+    this->soa.attach(this->driver, kMeasureInterval);
+
+    // the closed loop modes and sweeps may request up to the driver's maximum current
+    uint32_t maxCurrent{0};
+    err = this->driver->getMaxInputCurrent(maxCurrent);
+    REQUIRE(!err, "failed to get driver %s: %d", "max current", err);
+
+    this->maxLoadCurrent = maxCurrent * 1000;
+    this->loop.setMaxOutput(this->maxLoadCurrent);
+    this->mppt.setMaxOutput(this->maxLoadCurrent);
 }
 
 
@@ -226,35 +256,172 @@ void Task::identifyDriver() {
 /**
  * @brief Read analog board sensors
  *
- * This updates the cached current and voltage readings.
+ * This updates the cached current and voltage readings, checks the unfiltered readings against
+ * the protection limits, and then runs them through the measurement filters. The voltage gate is
+ * evaluated against the unfiltered input voltage as well, and the control loop then calculates the
+ * load current from the filtered values. Then, the thermal model is advanced (and the current
+ * setpoint limited, if needed) before running the current sharing between the driver's channels.
+ *
+ * If the readings trip the protection, the load has been disabled and nothing else is done; the
+ * caller must then update the load configuration.
+ *
+ * @return Whether the protection tripped
  */
-void Task::readSensors() {
+bool Task::readSensors() {
     int err;
 
+    // the trip latency is measured from the start of the readout, so it includes the bus transfers
+    const uint32_t timestamp = DWT->CYCCNT;
+
     // read current
-    err = this->driver->readInputCurrent(this->inputCurrent);
+    uint32_t current;
+    err = this->driver->readInputCurrent(current);
     REQUIRE(!err, "control: %s (%d)", "failed to read current", err);
 
     // read input voltage
-    err = this->driver->readInputVoltage(this->inputVoltage);
+    uint32_t voltage;
+    err = this->driver->readInputVoltage(voltage);
     REQUIRE(!err, "control: %s (%d)", "failed to read input voltage", err);
+
+    // check the fast protection limits first (against the unfiltered values)
+    if(this->isLoadEngaged() && this->checkProtection(voltage, current, timestamp)) {
+        return true;
+    }
+
+    /*
+     * Filter the readings. If the driver acquired current samples in its interrupt handler, those
+     * were already fed to the filter, and the value read here is just the most recent of them.
+     */
+    if(!this->numIrqSamples) {
+        this->currentFilter.push(current);
+    }
+    this->numIrqSamples = 0;
+
+    this->voltageFilter.push(voltage);
+
+    if(this->currentFilter.isValid()) {
+        this->inputCurrent = this->currentFilter.getFiltered();
+    }
+    if(this->voltageFilter.isValid()) {
+        this->inputVoltage = this->voltageFilter.getFiltered();
+    }
+
+    if(this->isLoadEnabled) {
+        this->updateGate(voltage);
+    }
+
+    this->runControlLoop();
+
+    // enforce safe operating area
+    err = this->soa.update(this->inputVoltage);
+    REQUIRE(!err, "control: %s (%d)", "failed to update soa", err);
+
+    err = this->applyCurrentSetpoint(false);
+    REQUIRE(!err, "control: %s (%d)", "failed to set load current", err);
+
+    // balance channels
+    err = this->sharing.update(this->isLoadEngaged());
+    REQUIRE(!err, "control: %s (%d)", "failed to update current sharing", err);
+
+    return false;
 }
 
 /**
  * @brief Update load configuration
  *
- * Updates the load enable status, as well as the setpoint (current, voltage, etc.)
+ * Updates the load enable status, as well as the setpoint (current, voltage, etc.) and the
+ * protection thresholds. Setpoint changes are applied right away, unless slew rate limiting or a
+ * soft-start ramp is active; the control loop then ramps towards them tick by tick.
  */
 void Task::updateConfig() {
     int err;
 
+    // apply protection and filter changes
+    taskENTER_CRITICAL();
+    this->protection.setLimits(this->pendingLimits);
+    this->loop.setGains((this->mode == OperationMode::ConstantWattage) ? this->powerGains :
+            this->voltageGains);
+
+    if(this->isGateConfigPending) {
+        this->isGateConfigPending = false;
+        this->gate.setThresholds(this->pendingGateThresholds);
+    }
+
+    if(this->isSlewConfigPending) {
+        this->isSlewConfigPending = false;
+        this->slew.configure(this->pendingSlew, kMeasureInterval);
+    }
+
+    if(this->isMpptConfigPending) {
+        this->isMpptConfigPending = false;
+        this->mppt.configure(this->pendingMppt);
+    }
+
+    if(this->isFilterConfigPending) {
+        this->isFilterConfigPending = false;
+        this->currentFilter.configure(this->pendingCurrentFilter);
+        this->voltageFilter.configure(this->pendingVoltageFilter);
+    }
+    taskEXIT_CRITICAL();
+
+    if(this->isFaultClearPending) {
+        this->isFaultClearPending = false;
+        this->protection.clear();
+        Logger::Notice("control: %s", "protection fault cleared");
+    }
+
+    // the load can't be enabled while a fault is latched
+    if(this->isLoadEnabled && this->protection.isTripped()) {
+        Logger::Warning("control: %s", "refusing to enable load: protection fault latched");
+        this->isLoadEnabled = false;
+    }
+
+    // the voltage gate starts out released whenever the load is enabled
+    if(this->isLoadEnabled && !this->prevIsLoadEnabled) {
+        this->gate.reset();
+    }
+
+    if(this->isAutoTunePending) {
+        this->isAutoTunePending = false;
+        this->startAutoTune();
+    }
+    if(this->isSweepPending) {
+        this->isSweepPending = false;
+        this->startSweep();
+    }
+
+    // restart the closed loop controllers (from zero current) on mode change or enabling the load
+    if(!this->autoTune.isRunning() && !this->sweep.isRunning()) {
+        if(this->mode == OperationMode::ConstantCurrent) {
+            this->controlCurrent = this->loadCurrentSetpoint;
+        } else if(this->mode != this->loopMode ||
+                (this->isLoadEnabled && !this->prevIsLoadEnabled)) {
+            this->loop.reset(0);
+            this->mppt.reset(0);
+            this->controlCurrent = 0;
+        }
+    }
+    this->loopMode = this->mode;
+
+    // soft-start when enabling the load; if not limiting, setpoint changes apply right away
+    if(this->isLoadEnabled && !this->prevIsLoadEnabled) {
+        this->startSoftStart();
+    } else if(!this->slew.isActive()) {
+        this->slew.reset(this->controlCurrent);
+    }
+
     if(this->isLoadEnabled) {
+        // give any previously shed channels another chance
+        if(!this->prevIsLoadEnabled) {
+            this->sharing.reset();
+        }
+
         // update current
-        err = this->driver->setOutputCurrent(this->loadCurrentSetpoint);
+        err = this->applyCurrentSetpoint(true);
         REQUIRE(!err, "control: %s (%d)", "failed to set load current", err);
 
-        // enable load
-        err = this->driver->setEnabled(true);
+        // enable load (unless the voltage gate holds it off)
+        err = this->driver->setEnabled(this->gate.isEngaged());
         REQUIRE(!err, "control: %s (%d)", "failed to set load enable status", err);
     } else {
         // disable load
@@ -262,7 +429,7 @@ void Task::updateConfig() {
         REQUIRE(!err, "control: %s (%d)", "failed to set load enable status", err);
 
         // enable current (the cached value)
-        err = this->driver->setOutputCurrent(this->loadCurrentSetpoint);
+        err = this->applyCurrentSetpoint(true);
         REQUIRE(!err, "control: %s (%d)", "failed to set load current", err);
     }
 
@@ -272,3 +439,334 @@ void Task::updateConfig() {
         this->prevIsLoadEnabled = this->isLoadEnabled;
     }
 }
+
+/**
+ * @brief Apply the current setpoint
+ *
+ * Limit the current requested by the control loop (after slew rate limiting) to what the SOA
+ * limiter allows for all active channels, then pass it on to the current sharing layer.
+ *
+ * @param force Update the setpoint even if the limited value did not change
+ *
+ * @return 0 on success, or a negative error code
+ */
+int Task::applyCurrentSetpoint(const bool force) {
+    const uint64_t limit = static_cast<uint64_t>(this->soa.getChannelCurrentLimit()) *
+        this->sharing.getNumActive();
+    const uint32_t requested = this->slew.getOutput();
+    const uint32_t setpoint = etl::min(static_cast<uint64_t>(requested), limit);
+
+    const bool isLimited = (setpoint != requested);
+    if(isLimited != this->isSoaLimited) {
+        this->isSoaLimited = isLimited;
+        Logger::Notice("control: soa limit %s (%u µA)", isLimited ? "active" : "released",
+                setpoint);
+    }
+
+    if(!force && setpoint == this->sharing.getSetpoint()) {
+        return 0;
+    }
+
+    return this->sharing.setSetpoint(setpoint);
+}
+
+/**
+ * @brief Check a sample against the protection limits
+ *
+ * If any limit is exceeded, the load is disabled right away; only then is the fault latched and
+ * the host notified. The rest of the load state is left for the caller to update (with
+ * updateConfig()) once it's done with the sample.
+ *
+ * @param voltage Input voltage (mV)
+ * @param current Input current (µA)
+ * @param timestamp Cycle counter value when the sample was acquired
+ *
+ * @return Whether a limit was exceeded, and the load disabled
+ */
+bool Task::checkProtection(const uint32_t voltage, const uint32_t current,
+        const uint32_t timestamp) {
+    int err;
+
+    const auto fault = this->protection.check(voltage, current);
+    if(fault == Protection::Fault::None) {
+        return false;
+    }
+
+    err = this->driver->setEnabled(false);
+    REQUIRE(!err, "control: %s (%d)", "failed to set load enable status", err);
+
+    this->protection.latch(fault, voltage, current, timestamp);
+    this->isLoadEnabled = false;
+
+    App::Rpmsg::Task::NotifyTask(App::Rpmsg::Task::TaskNotifyBits::SendFault);
+    return true;
+}
+
+/**
+ * @brief Evaluate the voltage gate against a new input voltage sample
+ *
+ * When the gate engages, the current sharing, control loop and soft-start ramp restart from zero
+ * (as when the load is enabled) before the driver is enabled; when it releases, the driver is
+ * disabled right away. Either way, the host is notified.
+ *
+ * @param voltage Unfiltered input voltage (mV); the filtered value would delay the transition by
+ *        (at least) the decimation factor's worth of control periods.
+ */
+void Task::updateGate(const uint32_t voltage) {
+    int err;
+
+    if(!this->gate.update(voltage)) {
+        return;
+    }
+
+    const bool engaged = this->gate.isEngaged();
+    if(engaged) {
+        this->sharing.reset();
+        this->loop.reset(0);
+        this->mppt.reset(0);
+        this->controlCurrent = (this->mode == OperationMode::ConstantCurrent) ?
+            this->loadCurrentSetpoint : 0;
+        this->startSoftStart();
+
+        err = this->applyCurrentSetpoint(true);
+        REQUIRE(!err, "control: %s (%d)", "failed to set load current", err);
+    }
+
+    err = this->driver->setEnabled(engaged);
+    REQUIRE(!err, "control: %s (%d)", "failed to set load enable status", err);
+
+    Logger::Notice("control: voltage gate %s (%u mV)", engaged ? "engaged" : "released", voltage);
+    App::Rpmsg::Task::NotifyTask(App::Rpmsg::Task::TaskNotifyBits::SendGateEvent);
+}
+
+/**
+ * @brief Run the control loop for one tick
+ *
+ * Determine the load current to request: in constant current mode, that's simply the setpoint;
+ * the closed loop modes run their controller (or the maximum power point tracker) on the filtered
+ * measurements. While an auto tuning run or I-V curve sweep is in progress, it takes precedence.
+ *
+ * The resulting current is then passed through the slew rate limiter; tuning runs and sweeps
+ * bypass it, since they rely on clean steps.
+ */
+void Task::runControlLoop() {
+    if(this->autoTune.isRunning()) {
+        if(!this->isLoadEngaged()) {
+            this->autoTune.abort();
+        } else {
+            this->controlCurrent = this->autoTune.update(this->getControlError(this->autoTuneMode,
+                    this->autoTuneSetpoint));
+        }
+        this->slew.reset(this->controlCurrent);
+
+        if(!this->autoTune.isRunning()) {
+            this->finishAutoTune();
+        }
+        return;
+    } else if(this->sweep.isRunning()) {
+        if(!this->isLoadEngaged()) {
+            this->sweep.abort();
+        } else {
+            this->controlCurrent = this->sweep.update(this->inputVoltage, this->inputCurrent);
+        }
+        this->slew.reset(this->controlCurrent);
+
+        if(!this->sweep.isRunning()) {
+            this->finishSweep();
+        }
+        return;
+    }
+
+    switch(this->mode) {
+        case OperationMode::ConstantCurrent:
+            this->controlCurrent = this->loadCurrentSetpoint;
+            break;
+
+        case OperationMode::ConstantVoltage:
+            if(this->isLoadEngaged()) {
+                this->controlCurrent = this->loop.update(this->getControlError(this->mode,
+                        this->voltageSetpoint));
+            }
+            break;
+
+        case OperationMode::ConstantWattage:
+            if(this->isLoadEngaged()) {
+                this->controlCurrent = this->loop.update(this->getControlError(this->mode,
+                        this->powerSetpoint));
+            }
+            break;
+
+        case OperationMode::MaximumPower:
+            if(this->isLoadEngaged()) {
+                this->controlCurrent = this->mppt.update(this->inputVoltage, this->inputCurrent);
+            }
+            break;
+    }
+
+    this->slew.update(this->controlCurrent);
+}
+
+/**
+ * @brief Start ramping up the load current from zero
+ *
+ * Invoked when the load starts sinking current. This starts the soft-start ramp; if neither it
+ * nor slew rate limiting are enabled, the requested current is applied directly.
+ */
+void Task::startSoftStart() {
+    this->slew.reset(0);
+    this->slew.startSoftStart();
+
+    if(!this->slew.isActive()) {
+        this->slew.reset(this->controlCurrent);
+    }
+}
+
+/**
+ * @brief Calculate the control error of a closed loop mode
+ *
+ * The error is signed such that a positive value calls for more load current: in constant
+ * voltage mode, that's when the input voltage is above the setpoint; in constant power mode, when
+ * the input power is below it.
+ *
+ * @param mode Operation mode to calculate the error for
+ * @param setpoint Setpoint of that mode (mV or mW)
+ *
+ * @return Control error (mV or mW)
+ */
+int32_t Task::getControlError(const OperationMode mode, const uint32_t setpoint) const {
+    int64_t error{0};
+
+    switch(mode) {
+        case OperationMode::ConstantVoltage:
+            error = static_cast<int64_t>(this->inputVoltage) - setpoint;
+            break;
+
+        case OperationMode::ConstantWattage: {
+            // mV * µA = nW
+            const uint64_t power = (static_cast<uint64_t>(this->inputVoltage) *
+                    this->inputCurrent) / 1'000'000;
+            error = static_cast<int64_t>(setpoint) - static_cast<int64_t>(power);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return etl::clamp(error, static_cast<int64_t>(INT32_MIN), static_cast<int64_t>(INT32_MAX));
+}
+
+/**
+ * @brief Start an auto tuning run
+ *
+ * Invoked from the configuration update, when a tuning run was requested. The request is rejected
+ * (and the rpmsg task notified right away) if the load is disabled, or the parameters are invalid.
+ */
+void Task::startAutoTune() {
+    taskENTER_CRITICAL();
+    const auto config = this->pendingAutoTune;
+    taskEXIT_CRITICAL();
+
+    if(!this->isLoadEngaged() || this->sweep.isRunning() ||
+            (this->autoTuneMode != OperationMode::ConstantVoltage &&
+             this->autoTuneMode != OperationMode::ConstantWattage)) {
+        Logger::Warning("control: %s", "refusing to auto tune: load disabled, busy or bad mode");
+        this->autoTune.abort();
+        this->finishAutoTune();
+        return;
+    } else if(!this->autoTune.start(config)) {
+        Logger::Warning("control: %s", "refusing to auto tune: invalid parameters");
+        this->finishAutoTune();
+        return;
+    }
+
+    Logger::Notice("control: auto tune started (mode %u, setpoint %u)",
+            static_cast<unsigned int>(this->autoTuneMode), this->autoTuneSetpoint);
+}
+
+/**
+ * @brief Handle the end of an auto tuning run
+ *
+ * If the run succeeded, its gains are applied to the tuned mode's controller; either way, the
+ * controller continues from the current the relay was biased at, and the rpmsg task is notified
+ * so it can report (and store) the result.
+ */
+void Task::finishAutoTune() {
+    const auto state = this->autoTune.getState();
+
+    if(state == RelayAutoTune::State::Done) {
+        const auto &result = this->autoTune.getResult();
+
+        taskENTER_CRITICAL();
+        if(this->autoTuneMode == OperationMode::ConstantVoltage) {
+            this->voltageGains = result.gains;
+        } else {
+            this->powerGains = result.gains;
+        }
+        taskEXIT_CRITICAL();
+
+        if(this->mode == this->autoTuneMode) {
+            this->loop.setGains(result.gains);
+        }
+
+        Logger::Notice("control: auto tune done (Tu %u ticks, a %u)", result.period,
+                result.amplitude);
+    } else {
+        Logger::Warning("control: auto tune %s (%u)", "failed",
+                static_cast<unsigned int>(state));
+    }
+
+    this->loop.reset(this->controlCurrent);
+
+    App::Rpmsg::Task::NotifyTask(App::Rpmsg::Task::TaskNotifyBits::SendAutoTuneResult);
+}
+
+/**
+ * @brief Start an I-V curve sweep
+ *
+ * Invoked from the configuration update, when a sweep was requested. The request is rejected (and
+ * the rpmsg task notified right away) if the load is disabled, an auto tuning run is in progress,
+ * or the parameters are invalid.
+ */
+void Task::startSweep() {
+    taskENTER_CRITICAL();
+    auto config = this->pendingSweep;
+    taskEXIT_CRITICAL();
+
+    if(!config.endCurrent) {
+        config.endCurrent = this->maxLoadCurrent;
+    }
+
+    if(!this->isLoadEngaged() || this->autoTune.isRunning()) {
+        Logger::Warning("control: %s", "refusing to sweep: load disabled or busy");
+        this->sweep.abort();
+        this->finishSweep();
+        return;
+    } else if(!this->sweep.start(config)) {
+        Logger::Warning("control: %s", "refusing to sweep: invalid parameters");
+        this->finishSweep();
+        return;
+    }
+
+    Logger::Notice("control: sweep started (%u steps to %u µA)", config.numSteps,
+            config.endCurrent);
+}
+
+/**
+ * @brief Handle the end of an I-V curve sweep
+ *
+ * Restart the closed loop controllers from zero current (the sweep likely ended at a very
+ * different operating point) and notify the rpmsg task, so it can send the curve to the host.
+ */
+void Task::finishSweep() {
+    Logger::Notice("control: sweep %s (%u points)",
+            (this->sweep.getState() == IvSweep::State::Done) ? "done" : "aborted",
+            this->sweep.getPoints().size());
+
+    this->loop.reset(0);
+    this->mppt.reset(0);
+    this->controlCurrent = (this->mode == OperationMode::ConstantCurrent) ?
+        this->loadCurrentSetpoint : 0;
+
+    App::Rpmsg::Task::NotifyTask(App::Rpmsg::Task::TaskNotifyBits::SendSweep);
+}
@@ -9,7 +9,17 @@
 
 #include <etl/string_view.h>
 
+#include "CurrentSharing.h"
+#include "IvSweep.h"
 #include "LoadDriver.h"
+#include "MpptTracker.h"
+#include "PiController.h"
+#include "Protection.h"
+#include "RelayAutoTune.h"
+#include "SampleFilter.h"
+#include "SlewLimiter.h"
+#include "SoaLimiter.h"
+#include "VoltageGate.h"
 
 namespace App::Control {
 /**
@@ -19,6 +29,7 @@ enum class OperationMode {
     ConstantCurrent,
     ConstantVoltage,
     ConstantWattage,
+    MaximumPower,
 };
 
 
@@ -104,7 +115,7 @@ class Task {
         /**
          * @brief Get the current input voltage
          *
-         * @return Voltage at input terminals, in millivolts
+         * @return Voltage at input terminals (filtered), in millivolts
          */
         inline static auto GetInputVoltage() {
             return gShared->inputVoltage;
@@ -113,12 +124,64 @@ class Task {
         /**
          * @brief Get input current
          *
-         * @return Current through the load, in microamps
+         * @return Current through the load (filtered), in microamps
          */
         inline static auto GetInputCurrent() {
             return gShared->inputCurrent;
         }
 
+        /**
+         * @brief Get the most recent unfiltered input voltage
+         *
+         * @return Voltage at input terminals, in millivolts
+         */
+        inline static auto GetRawInputVoltage() {
+            return gShared->voltageFilter.getRaw();
+        }
+
+        /**
+         * @brief Get the most recent unfiltered input current
+         *
+         * @return Current through the load, in microamps
+         */
+        inline static auto GetRawInputCurrent() {
+            return gShared->currentFilter.getRaw();
+        }
+
+        /**
+         * @brief Update the measurement filter configuration
+         *
+         * The new configuration is applied (and the filters reset) by the control task on its
+         * next configuration update.
+         *
+         * @param current Configuration for the input current filter
+         * @param voltage Configuration for the input voltage filter
+         */
+        inline static void SetFilterConfig(const SampleFilter::Config &current,
+                const SampleFilter::Config &voltage) {
+            taskENTER_CRITICAL();
+            gShared->pendingCurrentFilter = current;
+            gShared->pendingVoltageFilter = voltage;
+            gShared->isFilterConfigPending = true;
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the active measurement filter configuration
+         *
+         * @param outCurrent Variable to receive the input current filter configuration
+         * @param outVoltage Variable to receive the input voltage filter configuration
+         */
+        inline static void GetFilterConfig(SampleFilter::Config &outCurrent,
+                SampleFilter::Config &outVoltage) {
+            taskENTER_CRITICAL();
+            outCurrent = gShared->currentFilter.getConfig();
+            outVoltage = gShared->voltageFilter.getConfig();
+            taskEXIT_CRITICAL();
+        }
+
         /**
          * @brief Get maximum input voltage
          *
@@ -188,6 +251,42 @@ class Task {
             NotifyTask(TaskNotifyBits::ConfigChange);
         }
 
+        /**
+         * @brief Get the current set point
+         *
+         * @return Load current set point for constant current mode, in µA
+         */
+        inline static auto GetCurrentSetpoint() {
+            return gShared->loadCurrentSetpoint;
+        }
+
+        /**
+         * @brief Update the slew rate limiter and soft-start parameters
+         *
+         * The new parameters are applied by the control task on its next configuration update.
+         *
+         * @param config New limiter parameters
+         */
+        inline static void SetSlewConfig(const SlewLimiter::Config &config) {
+            taskENTER_CRITICAL();
+            gShared->pendingSlew = config;
+            gShared->isSlewConfigPending = true;
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the active slew rate limiter and soft-start parameters
+         */
+        inline static SlewLimiter::Config GetSlewConfig() {
+            taskENTER_CRITICAL();
+            const auto config = gShared->slew.getConfig();
+            taskEXIT_CRITICAL();
+
+            return config;
+        }
+
         /**
          * @brief Set load state
          *
@@ -205,6 +304,49 @@ class Task {
             return gShared->isLoadEnabled;
         }
 
+        /**
+         * @brief Update the voltage gate (Von/Voff) thresholds
+         *
+         * The new thresholds are applied by the control task on its next configuration update.
+         *
+         * @param thresholds New gate thresholds
+         */
+        inline static void SetGateThresholds(const VoltageGate::Thresholds &thresholds) {
+            taskENTER_CRITICAL();
+            gShared->pendingGateThresholds = thresholds;
+            gShared->isGateConfigPending = true;
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the active voltage gate thresholds
+         */
+        inline static VoltageGate::Thresholds GetGateThresholds() {
+            taskENTER_CRITICAL();
+            const auto thresholds = gShared->gate.getThresholds();
+            taskEXIT_CRITICAL();
+
+            return thresholds;
+        }
+
+        /**
+         * @brief Get the voltage gate state and its most recent transition
+         *
+         * @param outRecord Variable to receive the most recent transition
+         *
+         * @return Whether the gate currently allows the load to sink current
+         */
+        inline static bool GetGateState(VoltageGate::Record &outRecord) {
+            taskENTER_CRITICAL();
+            outRecord = gShared->gate.getRecord();
+            const bool engaged = gShared->gate.isEngaged();
+            taskEXIT_CRITICAL();
+
+            return engaged;
+        }
+
         /**
          * @brief Get the current control loop operation mode
          */
@@ -212,13 +354,274 @@ class Task {
             return gShared->mode;
         }
 
+        /**
+         * @brief Change the control loop operation mode
+         *
+         * When switching to one of the closed loop modes, the controller starts from zero load
+         * current.
+         */
+        inline static void SetMode(const OperationMode mode) {
+            gShared->mode = mode;
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Set the voltage set point
+         *
+         * This is used when the load is in constant voltage mode.
+         *
+         * @param voltage Desired input voltage, in mV
+         */
+        inline static void SetVoltageSetpoint(const uint32_t voltage) {
+            gShared->voltageSetpoint = voltage;
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the voltage set point
+         *
+         * @return Input voltage set point for constant voltage mode, in mV
+         */
+        inline static auto GetVoltageSetpoint() {
+            return gShared->voltageSetpoint;
+        }
+
+        /**
+         * @brief Set the power set point
+         *
+         * This is used when the load is in constant power mode.
+         *
+         * @param power Desired input power, in mW
+         */
+        inline static void SetPowerSetpoint(const uint32_t power) {
+            gShared->powerSetpoint = power;
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the power set point
+         *
+         * @return Input power set point for constant power mode, in mW
+         */
+        inline static auto GetPowerSetpoint() {
+            return gShared->powerSetpoint;
+        }
+
+        /**
+         * @brief Update the maximum power point tracker parameters
+         *
+         * The new parameters are applied by the control task on its next configuration update;
+         * the tracked operating point is kept.
+         *
+         * @param config New tracker parameters
+         */
+        inline static void SetMpptConfig(const MpptTracker::Config &config) {
+            taskENTER_CRITICAL();
+            gShared->pendingMppt = config;
+            gShared->isMpptConfigPending = true;
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the active maximum power point tracker parameters
+         */
+        inline static MpptTracker::Config GetMpptConfig() {
+            taskENTER_CRITICAL();
+            const auto config = gShared->mppt.getConfig();
+            taskEXIT_CRITICAL();
+
+            return config;
+        }
+
+        /**
+         * @brief Update the gains of a closed loop mode's controller
+         *
+         * The gains are picked up by the control loop on its next configuration update, without
+         * disturbing its output.
+         *
+         * @param mode Operation mode to change the gains for (constant voltage or power)
+         * @param gains New controller gains
+         */
+        inline static void SetLoopGains(const OperationMode mode,
+                const PiController::Gains &gains) {
+            taskENTER_CRITICAL();
+            if(mode == OperationMode::ConstantVoltage) {
+                gShared->voltageGains = gains;
+            } else if(mode == OperationMode::ConstantWattage) {
+                gShared->powerGains = gains;
+            }
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the gains of a closed loop mode's controller
+         *
+         * @param mode Operation mode to get the gains for (constant voltage or power)
+         */
+        inline static PiController::Gains GetLoopGains(const OperationMode mode) {
+            taskENTER_CRITICAL();
+            const auto gains = (mode == OperationMode::ConstantVoltage) ? gShared->voltageGains :
+                gShared->powerGains;
+            taskEXIT_CRITICAL();
+
+            return gains;
+        }
+
+        /**
+         * @brief Start automatic tuning of a closed loop mode's controller
+         *
+         * The load must be enabled. While tuning, the relay drives the load current, regardless
+         * of the operation mode. When the tuning completes, its gains are applied to the mode's
+         * controller, and the rpmsg task is notified.
+         *
+         * @param mode Operation mode to tune (constant voltage or power)
+         * @param setpoint Setpoint to oscillate around (mV or mW, depending on the mode)
+         * @param config Tuning parameters
+         */
+        inline static void StartAutoTune(const OperationMode mode, const uint32_t setpoint,
+                const RelayAutoTune::Config &config) {
+            taskENTER_CRITICAL();
+            gShared->autoTuneMode = mode;
+            gShared->autoTuneSetpoint = setpoint;
+            gShared->pendingAutoTune = config;
+            gShared->isAutoTunePending = true;
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Start an I-V curve sweep
+         *
+         * The load must be enabled. While sweeping, the sweep drives the load current,
+         * regardless of the operation mode; afterwards, the closed loop modes restart from zero
+         * current. The rpmsg task is notified once the sweep completes.
+         *
+         * @param config Sweep parameters; if the end current is 0, the driver's maximum current
+         *        is used.
+         */
+        inline static void StartSweep(const IvSweep::Config &config) {
+            taskENTER_CRITICAL();
+            gShared->pendingSweep = config;
+            gShared->isSweepPending = true;
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the state and captured points of the most recent I-V curve sweep
+         *
+         * @remark The points are only valid while no new sweep is running; the control task
+         *         notifies the rpmsg task once a sweep completes, so they're consistent when read
+         *         in response to that.
+         */
+        inline static IvSweep::State GetSweep(etl::span<const IvSweep::Point> &outPoints) {
+            outPoints = gShared->sweep.getPoints();
+            return gShared->sweep.getState();
+        }
+
+        /**
+         * @brief Get the state and result of the most recent auto tuning run
+         *
+         * @remark The result is only updated by the control task before it notifies the rpmsg
+         *         task of completion, so it's consistent when read in response to that.
+         */
+        inline static RelayAutoTune::State GetAutoTuneResult(RelayAutoTune::Result &outResult) {
+            outResult = gShared->autoTune.getResult();
+            return gShared->autoTune.getState();
+        }
+
+        /**
+         * @brief Update the protection thresholds
+         *
+         * The new thresholds are applied by the control task on its next configuration update.
+         *
+         * @param limits New protection thresholds
+         */
+        inline static void SetProtectionLimits(const Protection::Limits &limits) {
+            taskENTER_CRITICAL();
+            gShared->pendingLimits = limits;
+            taskEXIT_CRITICAL();
+
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
+        /**
+         * @brief Get the protection thresholds
+         *
+         * @return Thresholds most recently requested (which may not yet have been applied)
+         */
+        inline static Protection::Limits GetProtectionLimits() {
+            taskENTER_CRITICAL();
+            const auto limits = gShared->pendingLimits;
+            taskEXIT_CRITICAL();
+
+            return limits;
+        }
+
+        /**
+         * @brief Get the latched fault record
+         *
+         * @remark The record is only updated by the control task before it sends a fault
+         *         notification, so it's consistent when read in response to that.
+         */
+        inline static Protection::Record GetFaultRecord() {
+            return gShared->protection.getRecord();
+        }
+
+        /**
+         * @brief Get the worst case protection trip latency
+         *
+         * @return Longest time (µs) between a sample and the load being disabled
+         */
+        inline static auto GetWorstTripLatency() {
+            return gShared->protection.getWorstLatency();
+        }
+
+        /**
+         * @brief Clear a latched protection fault
+         *
+         * This allows the load to be enabled again. It stays disabled until explicitly enabled.
+         */
+        inline static void ClearFault() {
+            gShared->isFaultClearPending = true;
+            NotifyTask(TaskNotifyBits::ConfigChange);
+        }
+
     private:
         void main();
 
         void identifyDriver();
 
-        void readSensors();
+        bool readSensors();
         void updateConfig();
+        int applyCurrentSetpoint(const bool force);
+
+        void updateGate(const uint32_t voltage);
+        void runControlLoop();
+        void startSoftStart();
+        int32_t getControlError(const OperationMode mode, const uint32_t setpoint) const;
+        void startAutoTune();
+        void finishAutoTune();
+        void startSweep();
+        void finishSweep();
+
+        bool checkProtection(const uint32_t voltage, const uint32_t current,
+                const uint32_t timestamp);
+
+        /**
+         * @brief Whether the load is actually sinking current
+         *
+         * That is, it's enabled, and the voltage gate (if any) engaged it.
+         */
+        inline bool isLoadEngaged() const {
+            return this->isLoadEnabled && this->gate.isEngaged();
+        }
 
     private:
         /// Task handle
@@ -234,11 +637,71 @@ class Task {
         OperationMode mode{OperationMode::ConstantCurrent};
         /// Load set point (µA)
         uint32_t loadCurrentSetpoint{0};
-
-        /// Last input voltage reading (mV)
+        /// Input voltage set point, for constant voltage mode (mV)
+        uint32_t voltageSetpoint{0};
+        /// Input power set point, for constant power mode (mW)
+        uint32_t powerSetpoint{0};
+        /// Load current requested by the control loop (µA)
+        uint32_t controlCurrent{0};
+        /// Maximum load current the driver supports (µA)
+        uint32_t maxLoadCurrent{0};
+        /// Limits the rate of change of the requested load current
+        SlewLimiter slew;
+        /// Slew rate limiter parameters to apply on the next configuration update
+        SlewLimiter::Config pendingSlew;
+        /// Whether the slew rate limiter parameters were changed
+        bool isSlewConfigPending{false};
+
+        /// Controller for the closed loop modes
+        PiController loop;
+        /// Operation mode the controller was last reset for
+        OperationMode loopMode{OperationMode::ConstantCurrent};
+        /// Controller gains for constant voltage mode
+        PiController::Gains voltageGains;
+        /// Controller gains for constant power mode
+        PiController::Gains powerGains;
+
+        /// Relay auto-tuner for the closed loop controllers
+        RelayAutoTune autoTune;
+        /// Operation mode being tuned
+        OperationMode autoTuneMode{OperationMode::ConstantVoltage};
+        /// Setpoint the tuning oscillates around (mV or mW)
+        uint32_t autoTuneSetpoint{0};
+        /// Tuning parameters to start a run with on the next configuration update
+        RelayAutoTune::Config pendingAutoTune;
+        /// Whether a tuning run should be started
+        bool isAutoTunePending{false};
+
+        /// Maximum power point tracker
+        MpptTracker mppt;
+        /// Tracker parameters to apply on the next configuration update
+        MpptTracker::Config pendingMppt;
+        /// Whether the tracker parameters were changed
+        bool isMpptConfigPending{false};
+
+        /// I-V curve sweep engine
+        IvSweep sweep;
+        /// Sweep parameters to start a sweep with on the next configuration update
+        IvSweep::Config pendingSweep;
+        /// Whether a sweep should be started
+        bool isSweepPending{false};
+
+        /// Last filtered input voltage (mV)
         uint32_t inputVoltage{0};
-        /// Last input current reading (µA)
+        /// Last filtered input current (µA)
         uint32_t inputCurrent{0};
+        /// Input voltage filter
+        SampleFilter voltageFilter;
+        /// Input current filter
+        SampleFilter currentFilter;
+        /// Number of current samples acquired from the driver interrupt since the last tick
+        size_t numIrqSamples{0};
+        /// Input current filter configuration to apply on the next configuration update
+        SampleFilter::Config pendingCurrentFilter;
+        /// Input voltage filter configuration to apply on the next configuration update
+        SampleFilter::Config pendingVoltageFilter;
+        /// Whether the filter configuration was changed
+        bool isFilterConfigPending{false};
         /// Are we using external voltage sense?
         bool isUsingExternalSense{false};
         /// Is the load enabled?
@@ -248,6 +711,24 @@ class Task {
 
         /// Driver handling the load
         LoadDriver *driver{nullptr};
+        /// Splits the load current across the driver's channels
+        CurrentSharing sharing;
+        /// Limits the load current to the safe operating area
+        SoaLimiter soa;
+        /// Whether the current setpoint is currently being limited by the SOA limiter
+        bool isSoaLimited{false};
+        /// Disables the load if any of the protection thresholds are exceeded
+        Protection protection;
+        /// Protection thresholds to apply on the next configuration update
+        Protection::Limits pendingLimits;
+        /// Whether the latched fault should be cleared on the next configuration update
+        bool isFaultClearPending{false};
+        /// Engages the load based on the input voltage
+        VoltageGate gate;
+        /// Voltage gate thresholds to apply on the next configuration update
+        VoltageGate::Thresholds pendingGateThresholds;
+        /// Whether the voltage gate thresholds were changed
+        bool isGateConfigPending{false};
         /// Driver identifier
         Util::Uuid driverId;
         /// Hardware revision of driver
@@ -257,8 +738,15 @@ class Task {
         /// Runtime priority level
         static const constexpr uint8_t kPriority{Rtos::TaskPriority::AppHigh};
 
-        /// Size of the task's stack, in words
-        static const constexpr size_t kStackSize{420};
+        /**
+         * @brief Size of the task's stack, in words
+         *
+         * The deepest path is identifying the driver board at startup: the inventory ROM parser
+         * (with its 255 byte atom buffer) on top of a blocking EEPROM read, which comes to about
+         * 1.3K. The control loop itself needs less than half that. This leaves about twice the
+         * estimate; check the high water mark in the task statistics when changing either path.
+         */
+        static const constexpr size_t kStackSize{640};
         /// Task name (for display purposes)
         static const constexpr etl::string_view kName{"Control"};
         /// Notification index
@@ -272,6 +760,14 @@ class Task {
          */
         constexpr static const size_t kMeasureInterval{10};
 
+        /**
+         * @brief Watchdog check-in deadline (in ms)
+         *
+         * Maximum time between check-ins with the supervisor. This is generous, since identifying
+         * the driver board involves a fair bit of slow I²C traffic.
+         */
+        constexpr static const uint32_t kCheckinDeadline{500};
+
         /// Preallocated stack for the task
         StackType_t stack[kStackSize];
 
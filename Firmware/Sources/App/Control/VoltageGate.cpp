@@ -0,0 +1,58 @@
+#include "VoltageGate.h"
+
+#include "Rtos/Rtos.h"
+
+#include <etl/algorithm.h>
+
+using namespace App::Control;
+
+/**
+ * @brief Change the gate thresholds
+ *
+ * The gate state is kept; the new thresholds apply from the next sample on.
+ *
+ * @param newThresholds Thresholds to apply
+ */
+void VoltageGate::setThresholds(const Thresholds &newThresholds) {
+    this->thresholds.onVoltage = newThresholds.onVoltage;
+    this->thresholds.offVoltage = etl::min(newThresholds.offVoltage, newThresholds.onVoltage);
+}
+
+/**
+ * @brief Reset the gate to the released state
+ *
+ * This is done whenever the load is enabled, so that it only engages once the input voltage
+ * reaches the turn-on threshold.
+ */
+void VoltageGate::reset() {
+    this->engaged = false;
+}
+
+/**
+ * @brief Evaluate a new input voltage sample
+ *
+ * @param voltage Input voltage (mV)
+ *
+ * @return Whether the gate state changed
+ */
+bool VoltageGate::update(const uint32_t voltage) {
+    if(!this->isActive()) {
+        return false;
+    }
+
+    if(!this->engaged && voltage >= this->thresholds.onVoltage) {
+        this->engaged = true;
+    } else if(this->engaged && voltage < this->thresholds.offVoltage) {
+        this->engaged = false;
+    } else {
+        return false;
+    }
+
+    this->record = {
+        .isEngaged = this->engaged,
+        .timestamp = static_cast<uint32_t>(xTaskGetTickCount() * portTICK_PERIOD_MS),
+        .voltage = voltage,
+    };
+
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef APP_CONTROL_VOLTAGEGATE_H
+#define APP_CONTROL_VOLTAGEGATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace App::Control {
+/**
+ * @brief Input voltage load gating
+ *
+ * Engages the (enabled) load only once the input voltage rises to a turn-on threshold (Von), and
+ * releases it again when the voltage drops below a turn-off threshold (Voff). The turn-off
+ * threshold is usually lower than the turn-on threshold, so the gap between them provides
+ * hysteresis. This is mostly used for power supply startup tests, where the load should only
+ * draw current once the supply under test has come up.
+ *
+ * The thresholds are evaluated against every new input voltage sample in the control task, so
+ * the load is switched within one control period of the threshold being crossed; the time of the
+ * most recent transition is recorded.
+ */
+class VoltageGate {
+    public:
+        /**
+         * @brief Gate thresholds
+         */
+        struct Thresholds {
+            /// Turn-on voltage (mV); 0 disables gating
+            uint32_t onVoltage{0};
+            /// Turn-off voltage (mV); clamped to at most the turn-on voltage
+            uint32_t offVoltage{0};
+        };
+
+        /**
+         * @brief Most recent gate transition
+         */
+        struct Record {
+            /// Whether the gate engaged (rather than released) the load
+            bool isEngaged{false};
+            /// Time at which the threshold was crossed (ms since boot)
+            uint32_t timestamp{0};
+            /// Input voltage sample that crossed the threshold (mV)
+            uint32_t voltage{0};
+        };
+
+    public:
+        void setThresholds(const Thresholds &newThresholds);
+        void reset();
+
+        bool update(const uint32_t voltage);
+
+        /**
+         * @brief Get the active thresholds
+         */
+        inline const Thresholds &getThresholds() const {
+            return this->thresholds;
+        }
+
+        /**
+         * @brief Whether gating is enabled
+         */
+        inline bool isActive() const {
+            return !!this->thresholds.onVoltage;
+        }
+
+        /**
+         * @brief Whether the gate currently allows the load to sink current
+         *
+         * This is always the case if gating is disabled.
+         */
+        inline bool isEngaged() const {
+            return !this->isActive() || this->engaged;
+        }
+
+        /**
+         * @brief Get the most recent gate transition
+         */
+        inline const Record &getRecord() const {
+            return this->record;
+        }
+
+    private:
+        /// Active thresholds
+        Thresholds thresholds;
+        /// Gate state
+        bool engaged{false};
+        /// Most recent transition
+        Record record;
+};
+}
+
+#endif
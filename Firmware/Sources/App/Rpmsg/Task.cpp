@@ -1,19 +1,163 @@
 #include "Task.h"
 
+#include "App/Control/Hardware.h"
+#include "App/Control/Task.h"
+#include "Drivers/I2CBus.h"
+#include "Log/CrashDump.h"
 #include "Log/Logger.h"
 #include "Rtos/Rtos.h"
+#include "Rtos/SlabAllocator.h"
+#include "Rtos/Stats.h"
+#include "Rtos/Trace.h"
 
 #include "Rpc/Types.h"
 #include "Rpc/MessageHandler.h"
 #include "Rpc/Rpc.h"
+#include "Rpc/Endpoints/Confd/Service.h"
+#include "Supervisor/Checkin.h"
 
 #include <cbor.h>
+#include <ctype.h>
+#include <etl/algorithm.h>
+#include <stdio.h>
 #include <string.h>
 
 using namespace App::Rpmsg;
 
 Task *Task::gShared{nullptr};
 
+/**
+ * @brief Format the configuration key of a loop gain
+ *
+ * Gains are stored as floats (µA per mV or mW; per control loop tick for the integral gain) under
+ * `control.loop.<profile>.<mode>.<gain>`.
+ *
+ * @param outKey Buffer to receive the key
+ * @param profile Name of the loop gain profile
+ * @param mode Operation mode (`cv` or `cp`)
+ * @param gain Which gain (`kp` or `ki`)
+ */
+static void FormatGainKey(etl::span<char> outKey, const char *profile, const char *mode,
+        const char *gain) {
+    snprintf(outKey.data(), outKey.size(), "control.loop.%s.%s.%s", profile, mode, gain);
+}
+
+/**
+ * @brief Read the controller gains of an operation mode from a loop gain profile
+ *
+ * @param profile Name of the loop gain profile
+ * @param mode Operation mode (`cv` or `cp`)
+ * @param outGains Variable to receive the gains
+ *
+ * @return 0 on success, or a configuration service status code
+ */
+static int ReadLoopGains(const char *profile, const char *mode,
+        App::Control::PiController::Gains &outGains) {
+    int err;
+    etl::array<char, 64> key;
+    float kp, ki;
+
+    FormatGainKey(key, profile, mode, "kp");
+    err = Rpc::GetConfigService()->get(key.data(), kp);
+    if(err) {
+        return err;
+    }
+
+    FormatGainKey(key, profile, mode, "ki");
+    err = Rpc::GetConfigService()->get(key.data(), ki);
+    if(err) {
+        return err;
+    }
+
+    outGains.kp = static_cast<int64_t>(kp * App::Control::PiController::kOne);
+    outGains.ki = static_cast<int64_t>(ki * App::Control::PiController::kOne);
+    return 0;
+}
+
+/**
+ * @brief Store the controller gains of an operation mode in a loop gain profile
+ *
+ * @param profile Name of the loop gain profile
+ * @param mode Operation mode (`cv` or `cp`)
+ * @param gains Gains to store
+ *
+ * @return 0 on success, or a configuration service status code
+ */
+static int WriteLoopGains(const char *profile, const char *mode,
+        const App::Control::PiController::Gains &gains) {
+    int err;
+    etl::array<char, 64> key;
+
+    FormatGainKey(key, profile, mode, "kp");
+    err = Rpc::GetConfigService()->set(key.data(),
+            static_cast<float>(gains.kp) / App::Control::PiController::kOne);
+    if(err) {
+        return err;
+    }
+
+    FormatGainKey(key, profile, mode, "ki");
+    return Rpc::GetConfigService()->set(key.data(),
+            static_cast<float>(gains.ki) / App::Control::PiController::kOne);
+}
+
+/**
+ * @brief Encode controller gains
+ *
+ * Add a map with the keys `kp` and `ki` (as floats, in the same units as they are stored) to the
+ * given map.
+ *
+ * @param map Map to add the gains to
+ * @param key Key under which the gains are added
+ * @param gains Gains to encode
+ */
+static void EncodeLoopGains(CborEncoder *map, const char *key,
+        const App::Control::PiController::Gains &gains) {
+    CborEncoder encoderGains;
+
+    cbor_encode_text_stringz(map, key);
+    cbor_encoder_create_map(map, &encoderGains, 2);
+
+    cbor_encode_text_stringz(&encoderGains, "kp");
+    cbor_encode_float(&encoderGains,
+            static_cast<float>(gains.kp) / App::Control::PiController::kOne);
+    cbor_encode_text_stringz(&encoderGains, "ki");
+    cbor_encode_float(&encoderGains,
+            static_cast<float>(gains.ki) / App::Control::PiController::kOne);
+
+    cbor_encoder_close_container(map, &encoderGains);
+}
+
+/**
+ * @brief Decode a loop gain profile name
+ *
+ * Profile names become part of configuration keys, so they may only consist of alphanumeric
+ * characters, dashes and underscores.
+ *
+ * @param value CBOR value holding the name
+ * @param outName Buffer to receive the (NUL terminated) name; it's empty if invalid
+ *
+ * @return Whether the name is valid
+ */
+static bool CopyProfileName(const CborValue *value, etl::span<char> outName) {
+    size_t len{outName.size()};
+
+    if(!cbor_value_is_text_string(value) ||
+            cbor_value_copy_text_string(value, outName.data(), &len, nullptr)) {
+        outName[0] = '\0';
+        return false;
+    }
+
+    for(size_t i = 0; i < len; i++) {
+        const auto c = outName[i];
+        if(!isalnum(c) && c != '-' && c != '_') {
+            outName[0] = '\0';
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /**
  * @brief Initialize the RPC message handler
  */
@@ -82,6 +226,7 @@ void Task::main() {
     REQUIRE(remoteAlive, "failed to get %s:%x remote", kRpmsgName.data(), kRpmsgAddress);
 
     xTimerStart(this->sampleTimer, portMAX_DELAY);
+    Supervisor::Checkin::Register(Supervisor::Checkin::Client::Rpmsg, kCheckinDeadline);
 
     // event loop
     Logger::Trace("rpmsg: %s", "start message loop");
@@ -93,33 +238,128 @@ void Task::main() {
         if(note & TaskNotifyBits::SendMeasurements) {
             this->sendMeasurements();
         }
+        if(note & TaskNotifyBits::SendTaskStats) {
+            this->sendTaskStats();
+        }
+        if(note & TaskNotifyBits::SendTrace) {
+            this->sendTrace();
+        }
+        this->checkTraceTimeout();
+        if(note & TaskNotifyBits::SendCrashDump) {
+            this->sendCrashDump();
+        }
+        if(note & TaskNotifyBits::SendHeapStats) {
+            this->sendHeapStats();
+        }
+        if(note & TaskNotifyBits::SendFault) {
+            this->sendFault();
+        }
+        if(note & TaskNotifyBits::SendProtectionConfig) {
+            this->sendProtectionConfig();
+        }
+        if(note & TaskNotifyBits::SendFilterConfig) {
+            this->sendFilterConfig();
+        }
+        if(note & TaskNotifyBits::SendAutoTuneResult) {
+            this->sendAutoTuneResult();
+        }
+        if(note & TaskNotifyBits::LoadLoopProfile) {
+            this->loadLoopProfile();
+        }
+        if(note & TaskNotifyBits::SendOpMode) {
+            this->sendOpMode();
+        }
+        if(note & TaskNotifyBits::SendSweep) {
+            this->sendSweep();
+        }
+        if(note & TaskNotifyBits::SendGateConfig) {
+            this->sendGateConfig(false);
+        }
+        if(note & TaskNotifyBits::SendGateEvent) {
+            this->sendGateConfig(true);
+        }
+
+        // check in with watchdog
+        Supervisor::Checkin::CheckIn(Supervisor::Checkin::Client::Rpmsg);
     }
 }
 
 /**
- * @brief Send the current measurement values to the host
+ * @brief Prepare the send buffer for a message
  *
- * Capture the current measured voltage, current, and temperature values; then send them to the
- * host for processing.
+ * Fill in the RPC header in the transmit buffer, and set up a CBOR encoder for the payload that
+ * follows it.
+ *
+ * @param type Message type
+ * @param tag Tag of the request being replied to (0 for broadcasts)
+ * @param flags RPC header flags
+ *
+ * @return Encoder for the message payload
  */
-void Task::sendMeasurements() {
-    int err;
-    size_t totalNumBytes;
-    CborEncoder encoder, encoderMap;
+CborEncoder Task::prepareMessage(const MsgType type, const uint8_t tag, const uint8_t flags) {
+    CborEncoder encoder;
 
-    // prepare RPC header
     auto hdr = reinterpret_cast<struct rpc_header *>(this->txBuffer.data());
     memset(hdr, 0, sizeof(*hdr));
 
     hdr->version = kRpcVersionLatest;
-    hdr->type = static_cast<uint8_t>(MsgType::Measurement);
-    hdr->flags = kRpcFlagBroadcast;
+    hdr->type = static_cast<uint8_t>(type);
+    hdr->tag = tag;
+    hdr->flags = flags;
 
-    // set up the CBOR encoder for the remaining memory
     const auto maxPayloadSize = kMaxPacketSize - sizeof(*hdr);
     cbor_encoder_init(&encoder, hdr->payload, maxPayloadSize, 0);
 
-    err = cbor_encoder_create_map(&encoder, &encoderMap, 3);
+    return encoder;
+}
+
+/**
+ * @brief Send the message in the send buffer
+ *
+ * Complete the RPC header with the length of the payload encoded, then send it to the host.
+ *
+ * @param encoder Payload encoder returned by prepareMessage()
+ *
+ * @return 0 on success, or a negative error code
+ */
+int Task::sendMessage(const CborEncoder &encoder) {
+    int err;
+
+    auto hdr = reinterpret_cast<struct rpc_header *>(this->txBuffer.data());
+    const size_t totalNumBytes = sizeof(*hdr) +
+        cbor_encoder_get_buffer_size(&encoder, hdr->payload);
+    hdr->length = totalNumBytes;
+
+    err = Rpc::GetHandler()->sendTo(this->ep,
+            {reinterpret_cast<uint8_t *>(this->txBuffer.data()), totalNumBytes},
+            this->ep->dest_addr, pdMS_TO_TICKS(10));
+
+    if(err < 0) {
+        Logger::Warning("%s failed: %d", "MessageHandler::sendTo", err);
+        return err;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Send the current measurement values to the host
+ *
+ * Capture the current measured voltage, current, and temperature values; then send them to the
+ * host for processing. The payload is a map with the following keys:
+ *
+ * - v: Input voltage, in V
+ * - i: Input current, in A
+ * - t: Temperature, in °C
+ * - raw: Whether the voltage and current are unfiltered
+ */
+void Task::sendMeasurements() {
+    int err;
+    CborEncoder encoderMap;
+
+    auto encoder = this->prepareMessage(MsgType::Measurement, 0, kRpcFlagBroadcast);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 4);
     if(err) {
         Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
         return;
@@ -128,13 +368,22 @@ void Task::sendMeasurements() {
     // write the body
     static float t{0.};
 
-    // TODO: read actual values instead of made-up stuff here
+    const bool isRaw = this->isRawTelemetry;
+    const auto voltage = isRaw ? App::Control::Task::GetRawInputVoltage() :
+        App::Control::Task::GetInputVoltage();
+    const auto current = isRaw ? App::Control::Task::GetRawInputCurrent() :
+        App::Control::Task::GetInputCurrent();
+
     // voltage
     cbor_encode_text_stringz(&encoderMap, "v");
-    cbor_encode_float(&encoderMap, 2.f * fabsf(sinf(t * 1.33f)));
+    cbor_encode_float(&encoderMap, static_cast<float>(voltage) / 1'000.f);
     // current
     cbor_encode_text_stringz(&encoderMap, "i");
-    cbor_encode_float(&encoderMap, 70.f * fabsf(cosf(t)));
+    cbor_encode_float(&encoderMap, static_cast<float>(current) / 1'000'000.f);
+    // which stream the above values are from
+    cbor_encode_text_stringz(&encoderMap, "raw");
+    cbor_encode_boolean(&encoderMap, isRaw);
+    // TODO: read actual temperature instead of made-up stuff here
     // temperature
     cbor_encode_text_stringz(&encoderMap, "t");
     cbor_encode_float(&encoderMap, 20.f + fabsf(50.f * cosf(t)));
@@ -148,69 +397,1259 @@ void Task::sendMeasurements() {
         return;
     }
 
-    // return the buffer of just the message
-    totalNumBytes = sizeof(*hdr) + cbor_encoder_get_buffer_size(&encoder, hdr->payload);
+    this->sendMessage(encoder);
+}
 
-    hdr->length = totalNumBytes;
+/**
+ * @brief Send task statistics to the host
+ *
+ * Collect the runtime statistics of all tasks, and send them as a reply to the most recent
+ * request. The payload is a map with the total CPU load (`load`) and an array of tasks (`tasks`),
+ * each of which is a map with the following keys:
+ *
+ * - n: Task name
+ * - p: Current priority
+ * - c: CPU usage, in 0.01%
+ * - s: Minimum free stack space, in words
+ * - l: Average notification latency, in µs
+ * - L: Maximum notification latency, in µs
+ */
+void Task::sendTaskStats() {
+    int err;
+    CborEncoder encoderMap, encoderTasks, encoderTask;
 
-    // send the message
-    err = Rpc::GetHandler()->sendTo(this->ep,
-            {reinterpret_cast<uint8_t *>(this->txBuffer.data()), totalNumBytes},
-            this->ep->dest_addr, pdMS_TO_TICKS(10));
+    // collect statistics
+    static etl::array<Rtos::Stats::TaskInfo, Rtos::Stats::kMaxTasks> gTasks;
+    etl::array<Drivers::I2CBus::QueueStats, Drivers::I2CBus::kNumPriorities> busStats;
+    uint16_t totalLoad;
 
-    if(err < 0) {
-        Logger::Warning("%s failed: %d", "MessageHandler::sendTo", err);
+    const auto numTasks = Rtos::Stats::Collect(gTasks, totalLoad);
+    App::Control::Hw::GetBusQueueStats(busStats);
+
+    auto encoder = this->prepareMessage(MsgType::TaskStats, this->taskStatsTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 3);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "load");
+    cbor_encode_uint(&encoderMap, totalLoad);
+
+    cbor_encode_text_stringz(&encoderMap, "tasks");
+    err = cbor_encoder_create_array(&encoderMap, &encoderTasks, numTasks);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_array", err);
+        return;
+    }
+
+    for(size_t i = 0; i < numTasks; i++) {
+        const auto &task = gTasks[i];
+
+        cbor_encoder_create_map(&encoderTasks, &encoderTask, 6);
+
+        cbor_encode_text_stringz(&encoderTask, "n");
+        cbor_encode_text_stringz(&encoderTask, task.name);
+        cbor_encode_text_stringz(&encoderTask, "p");
+        cbor_encode_uint(&encoderTask, task.priority);
+        cbor_encode_text_stringz(&encoderTask, "c");
+        cbor_encode_uint(&encoderTask, task.cpuLoad);
+        cbor_encode_text_stringz(&encoderTask, "s");
+        cbor_encode_uint(&encoderTask, task.stackFree);
+        cbor_encode_text_stringz(&encoderTask, "l");
+        cbor_encode_uint(&encoderTask, task.notifyLatencyAvg);
+        cbor_encode_text_stringz(&encoderTask, "L");
+        cbor_encode_uint(&encoderTask, task.notifyLatencyMax);
+
+        cbor_encoder_close_container(&encoderTasks, &encoderTask);
+    }
+
+    cbor_encoder_close_container(&encoderMap, &encoderTasks);
+
+    // driver bus queueing latency, indexed by request priority
+    cbor_encode_text_stringz(&encoderMap, "i2c");
+    cbor_encoder_create_array(&encoderMap, &encoderTasks, busStats.size());
+
+    for(const auto &stats : busStats) {
+        cbor_encoder_create_map(&encoderTasks, &encoderTask, 3);
+
+        cbor_encode_text_stringz(&encoderTask, "n");
+        cbor_encode_uint(&encoderTask, stats.numRequests);
+        cbor_encode_text_stringz(&encoderTask, "l");
+        cbor_encode_uint(&encoderTask, stats.latencyAvg);
+        cbor_encode_text_stringz(&encoderTask, "L");
+        cbor_encode_uint(&encoderTask, stats.latencyMax);
+
+        cbor_encoder_close_container(&encoderTasks, &encoderTask);
+    }
+
+    cbor_encoder_close_container(&encoderMap, &encoderTasks);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
         return;
     }
+
+    this->sendMessage(encoder);
 }
 
 
+/**
+ * @brief Send a chunk of the event trace to the host
+ *
+ * Reply to a trace read request with the records starting at the requested offset. The payload
+ * is a map with the following keys:
+ *
+ * - clk: Frequency of the timestamp counter, in Hz
+ * - total: Total number of records in the trace buffer
+ * - off: Offset of the first record in this message
+ * - rec: Byte string containing the raw trace records
+ * - tasks: Map of task number to name (only when reading from offset 0)
+ *
+ * Recording is stopped when the first chunk is read, and resumed when the last one is sent. If
+ * the host requested a reset instead, the trace buffer is cleared and the reply is empty.
+ */
+void Task::sendTrace() {
+    int err;
+    CborEncoder encoderMap, encoderTasks;
+
+    const auto offset = this->traceReset ? 0 : this->traceOffset;
+    const bool isFirst = !offset;
+
+    if(this->traceReset) {
+        Rtos::Trace::Reset();
+        this->isTraceReading = false;
+    } else if(isFirst) {
+        Rtos::Trace::Stop();
+        this->isTraceReading = true;
+    }
+
+    // read the records
+    static etl::array<Rtos::Trace::Record, kTraceChunkSize> gRecords;
+
+    const auto total = this->traceReset ? 0 : Rtos::Trace::GetNumRecords();
+    const auto numRecords = this->traceReset ? 0 : Rtos::Trace::Read(offset, gRecords);
+
+    this->traceReadTime = xTaskGetTickCount();
+    if(this->isTraceReading && offset + numRecords >= total) {
+        Rtos::Trace::Start();
+        this->isTraceReading = false;
+    }
+
+    auto encoder = this->prepareMessage(MsgType::TraceRead, this->traceTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, isFirst ? 5 : 4);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "clk");
+    cbor_encode_uint(&encoderMap, SystemCoreClock);
+    cbor_encode_text_stringz(&encoderMap, "total");
+    cbor_encode_uint(&encoderMap, total);
+    cbor_encode_text_stringz(&encoderMap, "off");
+    cbor_encode_uint(&encoderMap, offset);
+    cbor_encode_text_stringz(&encoderMap, "rec");
+    cbor_encode_byte_string(&encoderMap, reinterpret_cast<const uint8_t *>(gRecords.data()),
+            numRecords * sizeof(Rtos::Trace::Record));
+
+    // task names, so the host can label the timeline
+    if(isFirst) {
+        static etl::array<TaskStatus_t, Rtos::Stats::kMaxTasks> gTaskInfo;
+        const auto numTasks = uxTaskGetSystemState(gTaskInfo.data(), gTaskInfo.size(), nullptr);
+
+        cbor_encode_text_stringz(&encoderMap, "tasks");
+        cbor_encoder_create_map(&encoderMap, &encoderTasks, numTasks);
+
+        for(size_t i = 0; i < numTasks; i++) {
+            cbor_encode_uint(&encoderTasks, gTaskInfo[i].xTaskNumber);
+            cbor_encode_text_stringz(&encoderTasks, gTaskInfo[i].pcTaskName);
+        }
+
+        cbor_encoder_close_container(&encoderMap, &encoderTasks);
+    }
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
 
 /**
- * @brief Handle an incoming rpmsg message
+ * @brief Resume trace recording if a read was abandoned
  *
- * This handles all requests from the Linux side; these requests will be to change operating
- * parameters of the load, for example. Measurement data (and other state changes) are
- * broadcast to the remote endpoint periodically.
+ * If the host stops requesting chunks part way through a read (for example, because it crashed)
+ * recording would otherwise remain stopped until reset.
+ */
+void Task::checkTraceTimeout() {
+    if(this->isTraceReading &&
+            (xTaskGetTickCount() - this->traceReadTime) >= pdMS_TO_TICKS(kTraceReadTimeout)) {
+        Logger::Notice("rpmsg: %s", "trace read timed out, resuming recording");
+        Rtos::Trace::Start();
+        this->isTraceReading = false;
+    }
+}
+
+/**
+ * @brief Send a chunk of the crash snapshot to the host
  *
- * @remark This is called in the context of the virtio message processing task. Use care when
- *         accessing task internal state.
+ * Reply to a crash snapshot request with the raw snapshot data starting at the requested offset.
+ * The payload is a map with the following keys:
+ *
+ * - size: Total size of the snapshot, in bytes (0 if there is none)
+ * - off: Offset of the first byte in this message
+ * - data: Byte string containing the raw snapshot data
+ *
+ * If requested, the snapshot is discarded after the reply has been prepared.
  */
-void Task::handleMessage(etl::span<const uint8_t> message, const uint32_t srcAddr) {
-    Endpoint::handleMessage(message, srcAddr);
+void Task::sendCrashDump() {
+    int err;
+    CborEncoder encoderMap;
 
-    // bail early if it's 0 length (sent to notify us of the remote endpoint becoming alive)
-    if(message.empty()) {
+    const auto snapshot = Log::CrashDump::GetSnapshot();
+    const auto offset = etl::min(static_cast<size_t>(this->crashDumpOffset), snapshot.size());
+    const auto chunk = snapshot.subspan(offset,
+            etl::min(kCrashDumpChunkSize, snapshot.size() - offset));
+
+    auto encoder = this->prepareMessage(MsgType::CrashDump, this->crashDumpTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 3);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
         return;
     }
 
-    // discard if not large enough for an rpc header
-    if(message.size() < sizeof(struct rpc_header)) {
-        Logger::Warning("%s: discarding message (%p, %lu) from %08x: %s", kRpmsgName.data(),
-                message.data(), message.size(), srcAddr, "msg too short");
+    cbor_encode_text_stringz(&encoderMap, "size");
+    cbor_encode_uint(&encoderMap, snapshot.size());
+    cbor_encode_text_stringz(&encoderMap, "off");
+    cbor_encode_uint(&encoderMap, offset);
+    cbor_encode_text_stringz(&encoderMap, "data");
+    cbor_encode_byte_string(&encoderMap, chunk.data(), chunk.size());
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
         return;
     }
 
-    // basic header validation
-    auto hdr = reinterpret_cast<const struct rpc_header *>(message.data());
-    if(hdr->length < sizeof(struct rpc_header)) {
-        Logger::Warning("%s: discarding message (%p, %lu) from %08x: %s", kRpmsgName.data(),
-                message.data(), message.size(), srcAddr, "invalid hdr length");
+    if(this->crashDumpClear) {
+        Logger::Notice("rpmsg: %s", "discarding crash snapshot");
+        Log::CrashDump::Clear();
+    }
+
+    this->sendMessage(encoder);
+}
+
+/**
+ * @brief Send heap statistics to the host
+ *
+ * Reply to a heap statistics request with the usage of each slab allocator size class. The
+ * payload is a map with a single key (`classes`) which holds an array of maps with the following
+ * keys:
+ *
+ * - s: Block size, in bytes
+ * - n: Total number of blocks
+ * - u: Number of blocks in use
+ * - p: Maximum number of blocks ever in use
+ * - a: Number of allocations served
+ * - o: Number of allocations that fell through to the heap because the class was full
+ */
+void Task::sendHeapStats() {
+    int err;
+    CborEncoder encoderMap, encoderClasses, encoderClass;
+
+    etl::array<Rtos::SlabAllocator::ClassStats, Rtos::SlabAllocator::kNumClasses> stats;
+    Rtos::SlabAllocator::GetStats(stats);
+
+    auto encoder = this->prepareMessage(MsgType::HeapStats, this->heapStatsTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 1);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
         return;
     }
-    else if(hdr->version != kRpcVersionLatest) {
-        Logger::Warning("%s: discarding message (%p, %lu) from %08x: %s", kRpmsgName.data(),
-                message.data(), message.size(), srcAddr, "invalid rpc version");
+
+    cbor_encode_text_stringz(&encoderMap, "classes");
+    cbor_encoder_create_array(&encoderMap, &encoderClasses, stats.size());
+
+    for(const auto &cls : stats) {
+        cbor_encoder_create_map(&encoderClasses, &encoderClass, 6);
+
+        cbor_encode_text_stringz(&encoderClass, "s");
+        cbor_encode_uint(&encoderClass, cls.blockSize);
+        cbor_encode_text_stringz(&encoderClass, "n");
+        cbor_encode_uint(&encoderClass, cls.numBlocks);
+        cbor_encode_text_stringz(&encoderClass, "u");
+        cbor_encode_uint(&encoderClass, cls.inUse);
+        cbor_encode_text_stringz(&encoderClass, "p");
+        cbor_encode_uint(&encoderClass, cls.peakInUse);
+        cbor_encode_text_stringz(&encoderClass, "a");
+        cbor_encode_uint(&encoderClass, cls.numAllocs);
+        cbor_encode_text_stringz(&encoderClass, "o");
+        cbor_encode_uint(&encoderClass, cls.numOverflows);
+
+        cbor_encoder_close_container(&encoderClasses, &encoderClass);
+    }
+
+    cbor_encoder_close_container(&encoderMap, &encoderClasses);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
         return;
     }
 
-    // invoke the appropriate handler
-    Logger::Trace("rpmsg: msg %p (%u bytes) from %x", message.data(), message.size(), srcAddr);
+    this->sendMessage(encoder);
+}
 
-    switch(hdr->type) {
-        // no-op
-        case static_cast<uint8_t>(MsgType::NoOp):
-            break;
+
+/**
+ * @brief Send the latched fault record to the host
+ *
+ * Broadcast after the load protection tripped. The payload is a map with the following keys:
+ *
+ * - f: Fault type (1 = overcurrent, 2 = overvoltage, 3 = overpower, 4 = undervoltage)
+ * - t: Time at which the fault was detected, in ms since boot
+ * - v: Input voltage at the time of the fault, in mV
+ * - i: Input current at the time of the fault, in µA
+ * - lat: Time between the offending sample and the load being disabled, in µs
+ */
+void Task::sendFault() {
+    int err;
+    CborEncoder encoderMap;
+
+    const auto record = App::Control::Task::GetFaultRecord();
+    if(record.fault == App::Control::Protection::Fault::None) {
+        return;
+    }
+
+    auto encoder = this->prepareMessage(MsgType::Fault, 0, kRpcFlagBroadcast);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 5);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "f");
+    cbor_encode_uint(&encoderMap, static_cast<uint8_t>(record.fault));
+    cbor_encode_text_stringz(&encoderMap, "t");
+    cbor_encode_uint(&encoderMap, record.timestamp);
+    cbor_encode_text_stringz(&encoderMap, "v");
+    cbor_encode_uint(&encoderMap, record.voltage);
+    cbor_encode_text_stringz(&encoderMap, "i");
+    cbor_encode_uint(&encoderMap, record.current);
+    cbor_encode_text_stringz(&encoderMap, "lat");
+    cbor_encode_uint(&encoderMap, record.latency);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
+
+/**
+ * @brief Send the protection configuration to the host
+ *
+ * Reply to a protection configuration request. The payload is a map with the following keys:
+ *
+ * - ocp: Overcurrent threshold, in µA
+ * - ovp: Overvoltage threshold, in mV
+ * - opp: Overpower threshold, in mW
+ * - uvp: Undervoltage threshold, in mV
+ * - f: Currently latched fault type (0 if none)
+ * - lat: Worst case trip latency observed, in µs
+ *
+ * A threshold of 0 indicates the corresponding protection is disabled.
+ */
+void Task::sendProtectionConfig() {
+    int err;
+    CborEncoder encoderMap;
+
+    const auto limits = App::Control::Task::GetProtectionLimits();
+    const auto record = App::Control::Task::GetFaultRecord();
+
+    auto encoder = this->prepareMessage(MsgType::ProtectionConfig, this->protectionTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 6);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "ocp");
+    cbor_encode_uint(&encoderMap, limits.overCurrent);
+    cbor_encode_text_stringz(&encoderMap, "ovp");
+    cbor_encode_uint(&encoderMap, limits.overVoltage);
+    cbor_encode_text_stringz(&encoderMap, "opp");
+    cbor_encode_uint(&encoderMap, limits.overPower);
+    cbor_encode_text_stringz(&encoderMap, "uvp");
+    cbor_encode_uint(&encoderMap, limits.underVoltage);
+    cbor_encode_text_stringz(&encoderMap, "f");
+    cbor_encode_uint(&encoderMap, static_cast<uint8_t>(record.fault));
+    cbor_encode_text_stringz(&encoderMap, "lat");
+    cbor_encode_uint(&encoderMap, App::Control::Task::GetWorstTripLatency());
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
+
+
+/**
+ * @brief Send the measurement filter configuration to the host
+ *
+ * Reply to a filter configuration request. The payload is a map with the following keys:
+ *
+ * - i: Input current filter configuration
+ * - v: Input voltage filter configuration
+ * - raw: Whether measurement updates carry the unfiltered values
+ *
+ * Each filter configuration is a map with the keys `dec` (number of samples averaged per output)
+ * and `iir` (IIR filter coefficient shift; 0 if disabled).
+ */
+void Task::sendFilterConfig() {
+    int err;
+    CborEncoder encoderMap, encoderFilter;
+
+    App::Control::SampleFilter::Config configs[2];
+    App::Control::Task::GetFilterConfig(configs[0], configs[1]);
+
+    auto encoder = this->prepareMessage(MsgType::FilterConfig, this->filterTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 3);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    for(size_t i = 0; i < 2; i++) {
+        cbor_encode_text_stringz(&encoderMap, i ? "v" : "i");
+        cbor_encoder_create_map(&encoderMap, &encoderFilter, 2);
+
+        cbor_encode_text_stringz(&encoderFilter, "dec");
+        cbor_encode_uint(&encoderFilter, configs[i].decimation);
+        cbor_encode_text_stringz(&encoderFilter, "iir");
+        cbor_encode_uint(&encoderFilter, configs[i].iirShift);
+
+        cbor_encoder_close_container(&encoderMap, &encoderFilter);
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "raw");
+    cbor_encode_boolean(&encoderMap, this->isRawTelemetry);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
+
+
+/**
+ * @brief Send the auto tuning result to the host
+ *
+ * Reply to an auto tuning request, once the run completed or was rejected. If it succeeded, and
+ * the request named a loop gain profile, the gains are stored in that profile first. The payload
+ * is a map with the following keys:
+ *
+ * - state: Tuner state (2 = done, 3 = failed, 4 = aborted or rejected)
+ * - tu: Ultimate period, in control loop ticks
+ * - a: Oscillation amplitude (peak), in mV or mW
+ * - ku: Ultimate gain, in µA per mV or mW
+ * - gains: Controller gains derived from the result (a map with keys `kp` and `ki`)
+ * - saved: Whether the gains were stored in the profile
+ */
+void Task::sendAutoTuneResult() {
+    int err;
+    CborEncoder encoderMap;
+    bool saved{false};
+
+    App::Control::RelayAutoTune::Result result;
+    const auto state = App::Control::Task::GetAutoTuneResult(result);
+
+    // store the gains in the profile (this may block for a while)
+    if(state == App::Control::RelayAutoTune::State::Done && this->autoTuneProfile[0]) {
+        const auto mode = (this->autoTuneMode ==
+                static_cast<uint8_t>(App::Control::OperationMode::ConstantVoltage)) ? "cv" : "cp";
+
+        err = WriteLoopGains(this->autoTuneProfile.data(), mode, result.gains);
+        if(err) {
+            Logger::Warning("rpmsg: failed to store loop profile '%s': %d",
+                    this->autoTuneProfile.data(), err);
+        } else {
+            saved = true;
+        }
+    }
+
+    auto encoder = this->prepareMessage(MsgType::AutoTune, this->autoTuneTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 6);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "state");
+    cbor_encode_uint(&encoderMap, static_cast<uint8_t>(state));
+    cbor_encode_text_stringz(&encoderMap, "tu");
+    cbor_encode_uint(&encoderMap, result.period);
+    cbor_encode_text_stringz(&encoderMap, "a");
+    cbor_encode_uint(&encoderMap, result.amplitude);
+    cbor_encode_text_stringz(&encoderMap, "ku");
+    cbor_encode_float(&encoderMap, result.ultimateGain);
+    EncodeLoopGains(&encoderMap, "gains", result.gains);
+    cbor_encode_text_stringz(&encoderMap, "saved");
+    cbor_encode_boolean(&encoderMap, saved);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
+
+
+/**
+ * @brief Load a loop gain profile
+ *
+ * Read the constant voltage and power controller gains of the requested profile from the
+ * configuration service, and pass them to the control loop, which applies them without a
+ * restart. Modes with no gains in the profile keep their current gains.
+ *
+ * Then, reply with the gains in effect. The payload is a map with the following keys:
+ *
+ * - cv: Constant voltage controller gains (a map with keys `kp` and `ki`)
+ * - cp: Constant power controller gains
+ * - ok: Whether gains for both modes were found in the profile
+ */
+void Task::loadLoopProfile() {
+    using App::Control::OperationMode;
+
+    int err;
+    CborEncoder encoderMap;
+    bool ok{false};
+
+    // read the gains (this may block for a while)
+    if(this->loopProfile[0]) {
+        const struct {
+            const char *name;
+            OperationMode mode;
+        } modes[]{
+            {"cv", OperationMode::ConstantVoltage},
+            {"cp", OperationMode::ConstantWattage},
+        };
+
+        ok = true;
+
+        for(const auto &mode : modes) {
+            App::Control::PiController::Gains gains;
+
+            err = ReadLoopGains(this->loopProfile.data(), mode.name, gains);
+            if(err) {
+                Logger::Warning("rpmsg: failed to load loop profile '%s' (%s): %d",
+                        this->loopProfile.data(), mode.name, err);
+                ok = false;
+                continue;
+            }
+
+            App::Control::Task::SetLoopGains(mode.mode, gains);
+        }
+    }
+
+    auto encoder = this->prepareMessage(MsgType::LoopProfile, this->loopProfileTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 3);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    EncodeLoopGains(&encoderMap, "cv",
+            App::Control::Task::GetLoopGains(OperationMode::ConstantVoltage));
+    EncodeLoopGains(&encoderMap, "cp",
+            App::Control::Task::GetLoopGains(OperationMode::ConstantWattage));
+    cbor_encode_text_stringz(&encoderMap, "ok");
+    cbor_encode_boolean(&encoderMap, ok);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
+
+
+/**
+ * @brief Send the operation mode to the host
+ *
+ * Reply to an operation mode request. The payload is a map with the following keys:
+ *
+ * - mode: Operation mode (0 = constant current, 1 = constant voltage, 2 = constant power,
+ *   3 = maximum power point tracking)
+ * - en: Whether the load is enabled
+ * - i: Current setpoint, in µA
+ * - v: Voltage setpoint, in mV
+ * - p: Power setpoint, in mW
+ * - mppt: Maximum power point tracker parameters; a map with the keys `step` (load current change
+ *   per perturbation, in µA) and `interval` (control loop ticks between perturbations)
+ * - slew: Load current slew rate limiting; a map with the keys `rate` (maximum rate of change, in
+ *   µA per ms; 0 = unlimited) and `soft` (soft-start ramp duration when enabling, in ms; 0 =
+ *   disabled)
+ */
+void Task::sendOpMode() {
+    int err;
+    CborEncoder encoderMap, encoderMppt, encoderSlew;
+
+    const auto mppt = App::Control::Task::GetMpptConfig();
+    const auto slew = App::Control::Task::GetSlewConfig();
+
+    auto encoder = this->prepareMessage(MsgType::OpMode, this->opModeTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 7);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "mode");
+    cbor_encode_uint(&encoderMap, static_cast<uint8_t>(App::Control::Task::GetMode()));
+    cbor_encode_text_stringz(&encoderMap, "en");
+    cbor_encode_boolean(&encoderMap, App::Control::Task::GetIsLoadActive());
+    cbor_encode_text_stringz(&encoderMap, "i");
+    cbor_encode_uint(&encoderMap, App::Control::Task::GetCurrentSetpoint());
+    cbor_encode_text_stringz(&encoderMap, "v");
+    cbor_encode_uint(&encoderMap, App::Control::Task::GetVoltageSetpoint());
+    cbor_encode_text_stringz(&encoderMap, "p");
+    cbor_encode_uint(&encoderMap, App::Control::Task::GetPowerSetpoint());
+
+    cbor_encode_text_stringz(&encoderMap, "mppt");
+    cbor_encoder_create_map(&encoderMap, &encoderMppt, 2);
+    cbor_encode_text_stringz(&encoderMppt, "step");
+    cbor_encode_uint(&encoderMppt, mppt.stepSize);
+    cbor_encode_text_stringz(&encoderMppt, "interval");
+    cbor_encode_uint(&encoderMppt, mppt.interval);
+    cbor_encoder_close_container(&encoderMap, &encoderMppt);
+
+    cbor_encode_text_stringz(&encoderMap, "slew");
+    cbor_encoder_create_map(&encoderMap, &encoderSlew, 2);
+    cbor_encode_text_stringz(&encoderSlew, "rate");
+    cbor_encode_uint(&encoderSlew, slew.slewRate);
+    cbor_encode_text_stringz(&encoderSlew, "soft");
+    cbor_encode_uint(&encoderSlew, slew.softStartTime);
+    cbor_encoder_close_container(&encoderMap, &encoderSlew);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
+
+
+/**
+ * @brief Send the captured I-V curve to the host
+ *
+ * Sent once a sweep requested by the host completes (or is rejected). The points are split across
+ * as many replies as needed, which are sent back to back. The payload of each is a map with the
+ * following keys:
+ *
+ * - state: Sweep state (2 = done, 3 = aborted or rejected)
+ * - total: Total number of points captured
+ * - off: Index of the first point in this message
+ * - pts: Byte string containing the points; each is the input current (µA) followed by the input
+ *   voltage (mV), as 32-bit little endian integers
+ *
+ * At least one message is always sent, even if no points were captured.
+ */
+void Task::sendSweep() {
+    int err;
+    size_t offset{0};
+
+    etl::span<const App::Control::IvSweep::Point> points;
+    const auto state = App::Control::Task::GetSweep(points);
+
+    do {
+        CborEncoder encoderMap;
+
+        const auto chunk = points.subspan(offset,
+                etl::min(points.size() - offset, kSweepChunkSize));
+
+        auto encoder = this->prepareMessage(MsgType::IvSweep, this->sweepTag, kRpcFlagReply);
+
+        err = cbor_encoder_create_map(&encoder, &encoderMap, 4);
+        if(err) {
+            Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+            return;
+        }
+
+        cbor_encode_text_stringz(&encoderMap, "state");
+        cbor_encode_uint(&encoderMap, static_cast<uint8_t>(state));
+        cbor_encode_text_stringz(&encoderMap, "total");
+        cbor_encode_uint(&encoderMap, points.size());
+        cbor_encode_text_stringz(&encoderMap, "off");
+        cbor_encode_uint(&encoderMap, offset);
+        cbor_encode_text_stringz(&encoderMap, "pts");
+        cbor_encode_byte_string(&encoderMap, reinterpret_cast<const uint8_t *>(chunk.data()),
+                chunk.size_bytes());
+
+        err = cbor_encoder_close_container(&encoder, &encoderMap);
+        if(err) {
+            Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+            return;
+        }
+
+        err = this->sendMessage(encoder);
+        if(err < 0) {
+            return;
+        }
+
+        offset += chunk.size();
+    } while(offset < points.size());
+}
+
+
+/**
+ * @brief Send the voltage gate configuration and state to the host
+ *
+ * This is either the reply to a gate configuration request, or broadcast when the gate engages or
+ * releases the load. The payload is a map with the following keys:
+ *
+ * - von: Turn-on voltage, in mV (0 if gating is disabled)
+ * - voff: Turn-off voltage, in mV
+ * - on: Whether the gate currently allows the load to sink current
+ * - t: Time of the most recent gate transition, in ms since boot
+ * - v: Input voltage sample that caused the most recent transition, in mV
+ *
+ * @param isBroadcast Whether this is a gate event broadcast, rather than a reply
+ */
+void Task::sendGateConfig(const bool isBroadcast) {
+    int err;
+    CborEncoder encoderMap;
+
+    App::Control::VoltageGate::Record record;
+    const auto thresholds = App::Control::Task::GetGateThresholds();
+    const bool engaged = App::Control::Task::GetGateState(record);
+
+    auto encoder = isBroadcast ?
+        this->prepareMessage(MsgType::GateEvent, 0, kRpcFlagBroadcast) :
+        this->prepareMessage(MsgType::GateConfig, this->gateTag, kRpcFlagReply);
+
+    err = cbor_encoder_create_map(&encoder, &encoderMap, 5);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_create_map", err);
+        return;
+    }
+
+    cbor_encode_text_stringz(&encoderMap, "von");
+    cbor_encode_uint(&encoderMap, thresholds.onVoltage);
+    cbor_encode_text_stringz(&encoderMap, "voff");
+    cbor_encode_uint(&encoderMap, thresholds.offVoltage);
+    cbor_encode_text_stringz(&encoderMap, "on");
+    cbor_encode_boolean(&encoderMap, engaged);
+    cbor_encode_text_stringz(&encoderMap, "t");
+    cbor_encode_uint(&encoderMap, record.timestamp);
+    cbor_encode_text_stringz(&encoderMap, "v");
+    cbor_encode_uint(&encoderMap, record.voltage);
+
+    err = cbor_encoder_close_container(&encoder, &encoderMap);
+    if(err) {
+        Logger::Warning("%s failed: %d", "cbor_encoder_close_container", err);
+        return;
+    }
+
+    this->sendMessage(encoder);
+}
+
+
+/**
+ * @brief Handle an incoming rpmsg message
+ *
+ * This handles all requests from the Linux side; these requests will be to change operating
+ * parameters of the load, for example. Measurement data (and other state changes) are
+ * broadcast to the remote endpoint periodically.
+ *
+ * @remark This is called in the context of the virtio message processing task. Use care when
+ *         accessing task internal state.
+ */
+void Task::handleMessage(etl::span<const uint8_t> message, const uint32_t srcAddr) {
+    Endpoint::handleMessage(message, srcAddr);
+
+    // bail early if it's 0 length (sent to notify us of the remote endpoint becoming alive)
+    if(message.empty()) {
+        return;
+    }
+
+    // discard if not large enough for an rpc header
+    if(message.size() < sizeof(struct rpc_header)) {
+        Logger::Warning("%s: discarding message (%p, %lu) from %08x: %s", kRpmsgName.data(),
+                message.data(), message.size(), srcAddr, "msg too short");
+        return;
+    }
+
+    // basic header validation
+    auto hdr = reinterpret_cast<const struct rpc_header *>(message.data());
+    if(hdr->length < sizeof(struct rpc_header)) {
+        Logger::Warning("%s: discarding message (%p, %lu) from %08x: %s", kRpmsgName.data(),
+                message.data(), message.size(), srcAddr, "invalid hdr length");
+        return;
+    }
+    else if(hdr->version != kRpcVersionLatest) {
+        Logger::Warning("%s: discarding message (%p, %lu) from %08x: %s", kRpmsgName.data(),
+                message.data(), message.size(), srcAddr, "invalid rpc version");
+        return;
+    }
+
+    // invoke the appropriate handler
+    Logger::Trace("rpmsg: msg %p (%u bytes) from %x", message.data(), message.size(), srcAddr);
+
+    switch(hdr->type) {
+        // no-op
+        case static_cast<uint8_t>(MsgType::NoOp):
+            break;
+
+        // task statistics: collected and sent from the task
+        case static_cast<uint8_t>(MsgType::TaskStats):
+            this->taskStatsTag = hdr->tag;
+            NotifyTask(TaskNotifyBits::SendTaskStats);
+            break;
+
+        // heap statistics: collected and sent from the task
+        case static_cast<uint8_t>(MsgType::HeapStats):
+            this->heapStatsTag = hdr->tag;
+            NotifyTask(TaskNotifyBits::SendHeapStats);
+            break;
+
+        // trace read: decode the requested offset, and whether to reset the trace instead
+        case static_cast<uint8_t>(MsgType::TraceRead): {
+            CborParser parser;
+            CborValue it, value;
+            uint64_t offset{0};
+            bool reset{false};
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it)) {
+                if(!cbor_value_map_find_value(&it, "off", &value) &&
+                        cbor_value_is_unsigned_integer(&value)) {
+                    cbor_value_get_uint64(&value, &offset);
+                }
+                if(!cbor_value_map_find_value(&it, "reset", &value) &&
+                        cbor_value_is_boolean(&value)) {
+                    cbor_value_get_boolean(&value, &reset);
+                }
+            }
+
+            this->traceTag = hdr->tag;
+            this->traceOffset = offset;
+            this->traceReset = reset;
+            NotifyTask(TaskNotifyBits::SendTrace);
+            break;
+        }
+
+        // crash snapshot: decode the requested offset, and whether to discard it
+        case static_cast<uint8_t>(MsgType::CrashDump): {
+            CborParser parser;
+            CborValue it, value;
+            uint64_t offset{0};
+            bool clear{false};
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it)) {
+                if(!cbor_value_map_find_value(&it, "off", &value) &&
+                        cbor_value_is_unsigned_integer(&value)) {
+                    cbor_value_get_uint64(&value, &offset);
+                }
+                if(!cbor_value_map_find_value(&it, "clear", &value) &&
+                        cbor_value_is_boolean(&value)) {
+                    cbor_value_get_boolean(&value, &clear);
+                }
+            }
+
+            this->crashDumpTag = hdr->tag;
+            this->crashDumpOffset = offset;
+            this->crashDumpClear = clear;
+            NotifyTask(TaskNotifyBits::SendCrashDump);
+            break;
+        }
+
+        // protection configuration: update any specified thresholds, and clear faults
+        case static_cast<uint8_t>(MsgType::ProtectionConfig): {
+            CborParser parser;
+            CborValue it, value;
+            bool changed{false}, clear{false};
+
+            auto limits = App::Control::Task::GetProtectionLimits();
+            const struct {
+                const char *key;
+                uint32_t &out;
+            } fields[]{
+                {"ocp", limits.overCurrent},
+                {"ovp", limits.overVoltage},
+                {"opp", limits.overPower},
+                {"uvp", limits.underVoltage},
+            };
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it)) {
+                for(const auto &field : fields) {
+                    uint64_t temp;
+                    if(!cbor_value_map_find_value(&it, field.key, &value) &&
+                            cbor_value_is_unsigned_integer(&value) &&
+                            !cbor_value_get_uint64(&value, &temp)) {
+                        field.out = etl::min(temp, static_cast<uint64_t>(UINT32_MAX));
+                        changed = true;
+                    }
+                }
+
+                if(!cbor_value_map_find_value(&it, "clear", &value) &&
+                        cbor_value_is_boolean(&value)) {
+                    cbor_value_get_boolean(&value, &clear);
+                }
+            }
+
+            if(changed) {
+                App::Control::Task::SetProtectionLimits(limits);
+            }
+            if(clear) {
+                App::Control::Task::ClearFault();
+            }
+
+            this->protectionTag = hdr->tag;
+            NotifyTask(TaskNotifyBits::SendProtectionConfig);
+            break;
+        }
+
+        // filter configuration: update the specified filters, and the telemetry stream
+        case static_cast<uint8_t>(MsgType::FilterConfig): {
+            CborParser parser;
+            CborValue it, value, field;
+            bool changed{false};
+
+            App::Control::SampleFilter::Config configs[2];
+            App::Control::Task::GetFilterConfig(configs[0], configs[1]);
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it)) {
+                for(size_t i = 0; i < 2; i++) {
+                    uint64_t temp;
+
+                    if(cbor_value_map_find_value(&it, i ? "v" : "i", &value) ||
+                            !cbor_value_is_map(&value)) {
+                        continue;
+                    }
+
+                    if(!cbor_value_map_find_value(&value, "dec", &field) &&
+                            cbor_value_is_unsigned_integer(&field) &&
+                            !cbor_value_get_uint64(&field, &temp)) {
+                        configs[i].decimation = etl::min(temp,
+                                static_cast<uint64_t>(UINT16_MAX));
+                        changed = true;
+                    }
+                    if(!cbor_value_map_find_value(&value, "iir", &field) &&
+                            cbor_value_is_unsigned_integer(&field) &&
+                            !cbor_value_get_uint64(&field, &temp)) {
+                        configs[i].iirShift = etl::min(temp, static_cast<uint64_t>(UINT8_MAX));
+                        changed = true;
+                    }
+                }
+
+                if(!cbor_value_map_find_value(&it, "raw", &value) &&
+                        cbor_value_is_boolean(&value)) {
+                    cbor_value_get_boolean(&value, &this->isRawTelemetry);
+                }
+            }
+
+            if(changed) {
+                App::Control::Task::SetFilterConfig(configs[0], configs[1]);
+            }
+
+            this->filterTag = hdr->tag;
+            NotifyTask(TaskNotifyBits::SendFilterConfig);
+            break;
+        }
+
+        /*
+         * Operation mode: update any specified setpoints, tracker and slew rate parameters, then
+         * the mode, and finally the load enable state. The keys are the same as in the reply.
+         */
+        case static_cast<uint8_t>(MsgType::OpMode): {
+            using App::Control::OperationMode;
+
+            CborParser parser;
+            CborValue it, value, field;
+            uint64_t temp;
+
+            const struct {
+                const char *key;
+                void (*set)(const uint32_t);
+            } setpoints[]{
+                {"i", App::Control::Task::SetCurrentSetpoint},
+                {"v", App::Control::Task::SetVoltageSetpoint},
+                {"p", App::Control::Task::SetPowerSetpoint},
+            };
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it)) {
+                for(const auto &setpoint : setpoints) {
+                    if(!cbor_value_map_find_value(&it, setpoint.key, &value) &&
+                            cbor_value_is_unsigned_integer(&value) &&
+                            !cbor_value_get_uint64(&value, &temp)) {
+                        setpoint.set(etl::min(temp, static_cast<uint64_t>(UINT32_MAX)));
+                    }
+                }
+
+                if(!cbor_value_map_find_value(&it, "mppt", &value) &&
+                        cbor_value_is_map(&value)) {
+                    auto mppt = App::Control::Task::GetMpptConfig();
+
+                    if(!cbor_value_map_find_value(&value, "step", &field) &&
+                            cbor_value_is_unsigned_integer(&field) &&
+                            !cbor_value_get_uint64(&field, &temp)) {
+                        mppt.stepSize = etl::min(temp, static_cast<uint64_t>(UINT32_MAX));
+                    }
+                    if(!cbor_value_map_find_value(&value, "interval", &field) &&
+                            cbor_value_is_unsigned_integer(&field) &&
+                            !cbor_value_get_uint64(&field, &temp)) {
+                        mppt.interval = etl::min(temp, static_cast<uint64_t>(UINT16_MAX));
+                    }
+
+                    App::Control::Task::SetMpptConfig(mppt);
+                }
+
+                if(!cbor_value_map_find_value(&it, "slew", &value) &&
+                        cbor_value_is_map(&value)) {
+                    auto slew = App::Control::Task::GetSlewConfig();
+
+                    if(!cbor_value_map_find_value(&value, "rate", &field) &&
+                            cbor_value_is_unsigned_integer(&field) &&
+                            !cbor_value_get_uint64(&field, &temp)) {
+                        slew.slewRate = etl::min(temp, static_cast<uint64_t>(UINT32_MAX));
+                    }
+                    if(!cbor_value_map_find_value(&value, "soft", &field) &&
+                            cbor_value_is_unsigned_integer(&field) &&
+                            !cbor_value_get_uint64(&field, &temp)) {
+                        slew.softStartTime = etl::min(temp, static_cast<uint64_t>(UINT32_MAX));
+                    }
+
+                    App::Control::Task::SetSlewConfig(slew);
+                }
+
+                if(!cbor_value_map_find_value(&it, "mode", &value) &&
+                        cbor_value_is_unsigned_integer(&value) &&
+                        !cbor_value_get_uint64(&value, &temp)) {
+                    if(temp <= static_cast<uint8_t>(OperationMode::MaximumPower)) {
+                        App::Control::Task::SetMode(static_cast<OperationMode>(temp));
+                    } else {
+                        Logger::Warning("rpmsg: invalid operation mode %u",
+                                static_cast<unsigned int>(temp));
+                    }
+                }
+
+                if(!cbor_value_map_find_value(&it, "en", &value) &&
+                        cbor_value_is_boolean(&value)) {
+                    bool enable;
+                    cbor_value_get_boolean(&value, &enable);
+                    App::Control::Task::SetIsLoadActive(enable);
+                }
+            }
+
+            this->opModeTag = hdr->tag;
+            NotifyTask(TaskNotifyBits::SendOpMode);
+            break;
+        }
+
+        /*
+         * Auto tuning: start the run in the control task, which notifies us once it's done. The
+         * parameters are:
+         *
+         * - mode: Operation mode to tune (1 = constant voltage, 2 = constant power)
+         * - sp: Setpoint to oscillate around, in mV or mW
+         * - bias: Load current the relay switches around, in µA
+         * - d: Relay amplitude, in µA
+         * - h: Relay hysteresis, in mV or mW
+         * - cycles: Number of oscillation cycles to measure
+         * - timeout: Maximum duration, in control loop ticks
+         * - profile: Loop gain profile to store the result in (optional)
+         */
+        case static_cast<uint8_t>(MsgType::AutoTune): {
+            using App::Control::OperationMode;
+
+            CborParser parser;
+            CborValue it, value;
+            uint64_t mode{0}, setpoint{0}, bias{0}, amplitude{0}, hysteresis{0}, cycles{4},
+                     timeout{1000};
+
+            const struct {
+                const char *key;
+                uint64_t &out;
+            } fields[]{
+                {"mode", mode},
+                {"sp", setpoint},
+                {"bias", bias},
+                {"d", amplitude},
+                {"h", hysteresis},
+                {"cycles", cycles},
+                {"timeout", timeout},
+            };
+
+            this->autoTuneProfile[0] = '\0';
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it)) {
+                for(const auto &field : fields) {
+                    if(!cbor_value_map_find_value(&it, field.key, &value) &&
+                            cbor_value_is_unsigned_integer(&value)) {
+                        cbor_value_get_uint64(&value, &field.out);
+                    }
+                }
+
+                if(!cbor_value_map_find_value(&it, "profile", &value) &&
+                        !CopyProfileName(&value, this->autoTuneProfile)) {
+                    Logger::Warning("rpmsg: %s", "invalid loop profile name");
+                }
+            }
+
+            // anything other than the closed loop modes is rejected by the control task
+            auto opMode{OperationMode::ConstantCurrent};
+            if(mode == static_cast<uint8_t>(OperationMode::ConstantVoltage) ||
+                    mode == static_cast<uint8_t>(OperationMode::ConstantWattage)) {
+                opMode = static_cast<OperationMode>(mode);
+            }
+
+            App::Control::RelayAutoTune::Config config;
+            config.bias = etl::min(bias, static_cast<uint64_t>(UINT32_MAX));
+            config.amplitude = etl::min(amplitude, static_cast<uint64_t>(UINT32_MAX));
+            config.hysteresis = etl::min(hysteresis, static_cast<uint64_t>(INT32_MAX));
+            config.numCycles = etl::min(cycles, static_cast<uint64_t>(UINT8_MAX));
+            config.timeout = etl::min(timeout, static_cast<uint64_t>(UINT32_MAX));
+
+            this->autoTuneTag = hdr->tag;
+            this->autoTuneMode = static_cast<uint8_t>(opMode);
+            App::Control::Task::StartAutoTune(opMode,
+                    etl::min(setpoint, static_cast<uint64_t>(UINT32_MAX)), config);
+            break;
+        }
+
+        /*
+         * I-V curve sweep: start it in the control task, which notifies us once it's done. The
+         * parameters are:
+         *
+         * - end: Load current of the last step, in µA (0 = driver's maximum current)
+         * - steps: Number of steps (points captured), including the one at zero current
+         * - settle: Control loop ticks to wait after each step before capturing the point
+         * - vmin: End the sweep once the input voltage drops below this, in mV (0 = disabled)
+         */
+        case static_cast<uint8_t>(MsgType::IvSweep): {
+            CborParser parser;
+            CborValue it, value;
+            uint64_t end{0}, steps{32}, settle{5}, minVoltage{0};
+
+            const struct {
+                const char *key;
+                uint64_t &out;
+            } fields[]{
+                {"end", end},
+                {"steps", steps},
+                {"settle", settle},
+                {"vmin", minVoltage},
+            };
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it)) {
+                for(const auto &field : fields) {
+                    if(!cbor_value_map_find_value(&it, field.key, &value) &&
+                            cbor_value_is_unsigned_integer(&value)) {
+                        cbor_value_get_uint64(&value, &field.out);
+                    }
+                }
+            }
+
+            App::Control::IvSweep::Config config;
+            config.endCurrent = etl::min(end, static_cast<uint64_t>(UINT32_MAX));
+            config.numSteps = etl::min(steps, static_cast<uint64_t>(UINT16_MAX));
+            config.settleTicks = etl::min(settle, static_cast<uint64_t>(UINT16_MAX));
+            config.minVoltage = etl::min(minVoltage, static_cast<uint64_t>(UINT32_MAX));
+
+            this->sweepTag = hdr->tag;
+            App::Control::Task::StartSweep(config);
+            break;
+        }
+
+        // voltage gate configuration: update the thresholds, if both are specified
+        case static_cast<uint8_t>(MsgType::GateConfig): {
+            CborParser parser;
+            CborValue it, value;
+            uint64_t on, off;
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it) &&
+                    !cbor_value_map_find_value(&it, "von", &value) &&
+                    cbor_value_is_unsigned_integer(&value) &&
+                    !cbor_value_get_uint64(&value, &on) &&
+                    !cbor_value_map_find_value(&it, "voff", &value) &&
+                    cbor_value_is_unsigned_integer(&value) &&
+                    !cbor_value_get_uint64(&value, &off)) {
+                App::Control::Task::SetGateThresholds({
+                    .onVoltage = static_cast<uint32_t>(etl::min(on,
+                                static_cast<uint64_t>(UINT32_MAX))),
+                    .offVoltage = static_cast<uint32_t>(etl::min(off,
+                                static_cast<uint64_t>(UINT32_MAX))),
+                });
+            }
+
+            this->gateTag = hdr->tag;
+            NotifyTask(TaskNotifyBits::SendGateConfig);
+            break;
+        }
+
+        // loop gain profile: load (and apply) the gains from the task
+        case static_cast<uint8_t>(MsgType::LoopProfile): {
+            CborParser parser;
+            CborValue it, value;
+
+            this->loopProfile[0] = '\0';
+
+            const auto payload = message.subspan(sizeof(struct rpc_header));
+            if(!cbor_parser_init(payload.data(), payload.size(), 0, &parser, &it) &&
+                    cbor_value_is_map(&it) &&
+                    !cbor_value_map_find_value(&it, "profile", &value) &&
+                    !CopyProfileName(&value, this->loopProfile)) {
+                Logger::Warning("rpmsg: %s", "invalid loop profile name");
+            }
+
+            this->loopProfileTag = hdr->tag;
+            NotifyTask(TaskNotifyBits::LoadLoopProfile);
+            break;
+        }
 
         default:
             Logger::Warning("rpmsg: unknown message type %02x (from %08x)", hdr->type, srcAddr);
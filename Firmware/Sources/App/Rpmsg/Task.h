@@ -11,6 +11,8 @@
 #include <etl/span.h>
 #include <etl/string_view.h>
 
+struct CborEncoder;
+
 namespace App::Rpmsg {
 /**
  * @brief rpmsg Control Endpoint
@@ -35,12 +37,109 @@ class Task: public Rpc::Endpoint {
              */
             SendMeasurements            = (1 << 0),
 
+            /**
+             * @brief Send task statistics
+             *
+             * The host requested task runtime statistics; collect them and send a reply.
+             */
+            SendTaskStats               = (1 << 1),
+
+            /**
+             * @brief Send trace records
+             *
+             * The host requested a chunk of the event trace buffer.
+             */
+            SendTrace                   = (1 << 2),
+
+            /**
+             * @brief Send crash snapshot
+             *
+             * The host requested a chunk of the crash snapshot from a previous run.
+             */
+            SendCrashDump               = (1 << 3),
+
+            /**
+             * @brief Send heap statistics
+             *
+             * The host requested slab allocator usage statistics.
+             */
+            SendHeapStats               = (1 << 4),
+
+            /**
+             * @brief Send fault record
+             *
+             * The load protection tripped; send the fault record to the host.
+             */
+            SendFault                   = (1 << 5),
+
+            /**
+             * @brief Send protection configuration
+             *
+             * The host changed or requested the protection thresholds; send a reply.
+             */
+            SendProtectionConfig        = (1 << 6),
+
+            /**
+             * @brief Send filter configuration
+             *
+             * The host changed or requested the measurement filter configuration; send a reply.
+             */
+            SendFilterConfig            = (1 << 7),
+
+            /**
+             * @brief Send auto tuning result
+             *
+             * A loop auto tuning run completed (or was rejected); store the gains in the
+             * requested profile, if successful, and send a reply.
+             */
+            SendAutoTuneResult          = (1 << 8),
+
+            /**
+             * @brief Load loop profile
+             *
+             * The host selected a loop gain profile; load its gains from the configuration
+             * service, apply them, and send a reply.
+             */
+            LoadLoopProfile             = (1 << 9),
+
+            /**
+             * @brief Send operation mode
+             *
+             * The host changed or requested the operation mode and setpoints; send a reply.
+             */
+            SendOpMode                  = (1 << 10),
+
+            /**
+             * @brief Send I-V curve
+             *
+             * An I-V curve sweep completed (or was rejected); send the captured points.
+             */
+            SendSweep                   = (1 << 11),
+
+            /**
+             * @brief Send voltage gate configuration
+             *
+             * The host changed or requested the voltage gate thresholds; send a reply.
+             */
+            SendGateConfig              = (1 << 12),
+
+            /**
+             * @brief Send voltage gate event
+             *
+             * The voltage gate engaged or released the load; notify the host.
+             */
+            SendGateEvent               = (1 << 13),
+
             /**
              * @brief All valid notify bits
              *
              * Bitwise OR of all notification bits.
              */
-            All                         = (SendMeasurements),
+            All                         = (SendMeasurements | SendTaskStats | SendTrace |
+                                    SendCrashDump | SendHeapStats | SendFault |
+                                    SendProtectionConfig | SendFilterConfig |
+                                    SendAutoTuneResult | LoadLoopProfile | SendOpMode |
+                                    SendSweep | SendGateConfig | SendGateEvent),
         };
 
         /**
@@ -65,10 +164,33 @@ class Task: public Rpc::Endpoint {
 
     private:
         void sendMeasurements();
+        void sendTaskStats();
+        void sendTrace();
+        void checkTraceTimeout();
+        void sendCrashDump();
+        void sendHeapStats();
+        void sendFault();
+        void sendProtectionConfig();
+        void sendFilterConfig();
+        void sendAutoTuneResult();
+        void loadLoopProfile();
+        void sendOpMode();
+        void sendSweep();
+        void sendGateConfig(const bool isBroadcast);
 
     private:
         /// Maximum size for a message to be sent, bytes
         constexpr static const size_t kMaxPacketSize{512};
+        /// Maximum number of trace records to send per message
+        constexpr static const size_t kTraceChunkSize{32};
+        /// Time after the last trace chunk was read after which recording is resumed (msec)
+        constexpr static const uint32_t kTraceReadTimeout{2000};
+        /// Maximum number of crash snapshot bytes to send per message
+        constexpr static const size_t kCrashDumpChunkSize{384};
+        /// Maximum number of I-V curve points to send per message
+        constexpr static const size_t kSweepChunkSize{48};
+        /// Maximum length of a loop gain profile name, excluding the terminator
+        constexpr static const size_t kMaxProfileNameLength{23};
 
         /// Task handle
         TaskHandle_t task;
@@ -82,6 +204,49 @@ class Task: public Rpc::Endpoint {
         /// Message send buffer
         etl::array<uint8_t, kMaxPacketSize> txBuffer;
 
+        /// Tag of the most recent task statistics request
+        uint8_t taskStatsTag{0};
+        /// Tag of the most recent trace read request
+        uint8_t traceTag{0};
+        /// Record offset requested by the most recent trace read request
+        uint32_t traceOffset{0};
+        /// Whether the most recent trace read request asked for the trace buffer to be reset
+        bool traceReset{false};
+        /// Whether trace recording is stopped for a read in progress
+        bool isTraceReading{false};
+        /// Time at which the most recent trace chunk was sent (ticks)
+        TickType_t traceReadTime{0};
+        /// Tag of the most recent crash snapshot request
+        uint8_t crashDumpTag{0};
+        /// Byte offset requested by the most recent crash snapshot request
+        uint32_t crashDumpOffset{0};
+        /// Whether the crash snapshot should be discarded after the request
+        bool crashDumpClear{false};
+        /// Tag of the most recent heap statistics request
+        uint8_t heapStatsTag{0};
+        /// Tag of the most recent protection configuration request
+        uint8_t protectionTag{0};
+        /// Tag of the most recent filter configuration request
+        uint8_t filterTag{0};
+        /// Whether measurement updates carry unfiltered rather than filtered values
+        bool isRawTelemetry{false};
+        /// Tag of the most recent auto tuning request
+        uint8_t autoTuneTag{0};
+        /// Operation mode being tuned by the most recent auto tuning request
+        uint8_t autoTuneMode{0};
+        /// Profile to store the auto tuning result in (empty to not store it)
+        etl::array<char, kMaxProfileNameLength + 1> autoTuneProfile{};
+        /// Tag of the most recent operation mode request
+        uint8_t opModeTag{0};
+        /// Tag of the most recent I-V curve sweep request
+        uint8_t sweepTag{0};
+        /// Tag of the most recent voltage gate configuration request
+        uint8_t gateTag{0};
+        /// Tag of the most recent loop profile request
+        uint8_t loopProfileTag{0};
+        /// Loop gain profile to load
+        etl::array<char, kMaxProfileNameLength + 1> loopProfile{};
+
     private:
         /**
          * @brief loadd RPC message types
@@ -106,9 +271,52 @@ class Task: public Rpc::Endpoint {
             /**
              * @brief System mode configuration
              *
-             * This updates the current operating mode of the load.
+             * This updates the current operating mode of the load, its setpoints, the maximum
+             * power point tracker parameters, and the setpoint slew rate limiting.
              */
             OpMode                      = 0x03,
+            /**
+             * @brief Protection configuration
+             *
+             * Get or set the OCP, OVP, OPP and UVP thresholds, or clear a latched fault.
+             */
+            ProtectionConfig            = 0x04,
+            /**
+             * @brief Measurement filter configuration
+             *
+             * Get or set the decimation and low pass filtering applied to the input current and
+             * voltage, and whether measurement updates carry the raw or filtered values.
+             */
+            FilterConfig                = 0x05,
+            /**
+             * @brief Control loop auto tuning
+             *
+             * Run a relay auto tuning of the constant voltage or power controller; the reply is
+             * sent once it completes. The resulting gains are applied, and optionally stored in a
+             * loop gain profile.
+             */
+            AutoTune                    = 0x06,
+            /**
+             * @brief Control loop gain profile
+             *
+             * Load the constant voltage and power controller gains from a stored profile (for
+             * example, one per source under test) and apply them.
+             */
+            LoopProfile                 = 0x07,
+            /**
+             * @brief I-V curve sweep
+             *
+             * Step the load current from zero to an end current, capturing the input voltage and
+             * current at each step. Once done, all captured points are sent in a burst of replies
+             * without further requests from the host.
+             */
+            IvSweep                     = 0x08,
+            /**
+             * @brief Voltage gate configuration
+             *
+             * Get or set the turn-on and turn-off voltages (Von/Voff) that gate the load.
+             */
+            GateConfig                  = 0x09,
             /**
              * @brief Periodic measurement update
              *
@@ -116,9 +324,54 @@ class Task: public Rpc::Endpoint {
              * is sent periodically without request from the host.
              */
             Measurement                 = 0x10,
+            /**
+             * @brief Protection fault
+             *
+             * Sent without request from the host when the load protection trips, and disabled the
+             * load; it contains the latched fault record.
+             */
+            Fault                       = 0x11,
+            /**
+             * @brief Voltage gate event
+             *
+             * Sent without request from the host when the voltage gate engages or releases the
+             * load; the payload is the same as the gate configuration reply.
+             */
+            GateEvent                   = 0x12,
+            /**
+             * @brief Task statistics
+             *
+             * Request per task CPU usage, stack high water marks and notification latencies. The
+             * reply contains the values accumulated since the previous request.
+             */
+            TaskStats                   = 0x20,
+            /**
+             * @brief Read event trace
+             *
+             * Read a chunk of the kernel event trace. Reading from offset 0 stops recording; it
+             * resumes once the last chunk has been read, or if no further chunk is requested
+             * within a timeout. The request may instead discard the trace and restart recording.
+             */
+            TraceRead                   = 0x21,
+            /**
+             * @brief Read crash snapshot
+             *
+             * Read a chunk of the crash snapshot left behind by a previous run of the firmware,
+             * or discard it.
+             */
+            CrashDump                   = 0x22,
+            /**
+             * @brief Heap statistics
+             *
+             * Request usage statistics for each size class of the slab allocator.
+             */
+            HeapStats                   = 0x23,
         };
 
+        CborEncoder prepareMessage(const MsgType type, const uint8_t tag, const uint8_t flags);
+        int sendMessage(const CborEncoder &encoder);
 
+    private:
         /// rpmsg channel name
         constexpr static const etl::string_view kRpmsgName{"pl.control"};
         /// rpmsg address
@@ -127,8 +380,15 @@ class Task: public Rpc::Endpoint {
         /// Runtime priority level
         static const constexpr uint8_t kPriority{Rtos::TaskPriority::AppLow};
 
-        /// Size of the task's stack, in words
-        static const constexpr size_t kStackSize{420};
+        /**
+         * @brief Size of the task's stack, in words
+         *
+         * The deepest path is reading or storing a loop gain profile: formatting the 64 byte key,
+         * then encoding a confd request and blocking on its reply, for about 1K. Encoding replies
+         * (such as I-V sweep chunks) is shallower. This leaves about twice the estimate; check the
+         * high water mark in the task statistics when adding confd accesses or handlers.
+         */
+        static const constexpr size_t kStackSize{512};
         /// Task name (for display purposes)
         static const constexpr etl::string_view kName{"RpmsgRpc"};
         /// Notification index
@@ -141,6 +401,9 @@ class Task: public Rpc::Endpoint {
          */
         constexpr static const size_t kMeasureInterval{100};
 
+        /// Watchdog check-in deadline (in ms); must be longer than the measurement interval
+        constexpr static const uint32_t kCheckinDeadline{1000};
+
         /// Preallocated stack for the task
         StackType_t stack[kStackSize];
 
@@ -27,6 +27,11 @@ enum NotifyBits: uint32_t {
      * @brief DMA controller
      */
     DmaController                       = (1 << 1),
+
+    /**
+     * @brief SPI controller (DMA batch completion)
+     */
+    SpiController                       = (1 << 2),
 };
 
 /**
@@ -3,6 +3,7 @@
 
 #include "Log/Logger.h"
 #include "Rtos/Rtos.h"
+#include "Rtos/Trace.h"
 
 #include <string.h>
 #include <etl/algorithm.h>
@@ -11,7 +12,6 @@
 
 using namespace Drivers;
 
-DmacDescriptor Dma::gDescriptors[kNumChannels] __attribute__((aligned(8)));
 DmacDescriptor Dma::gWritebackDescriptors[kNumChannels] __attribute__((aligned(8)));
 etl::array<TaskHandle_t, Dma::kNumChannels> Dma::gBlockedTasks;
 etl::array<int, Dma::kNumChannels> Dma::gCompletionReason;
@@ -32,6 +32,11 @@ void Dma::Init() {
 
     // set up concurrency support
     etl::fill(gBlockedTasks.begin(), gBlockedTasks.end(), nullptr);
+    etl::fill(gChainCallbacks.begin(), gChainCallbacks.end(), nullptr);
+
+    // mark all chain descriptors as free
+    memset(gChainPool, 0, sizeof(gChainPool));
+    gChainPoolFree = kChainPoolAllFree;
 
     // configure the descriptor and write-back bases
     memset(gDescriptors, 0, sizeof(gDescriptors));
@@ -162,94 +167,6 @@ void Dma::ResetChannel(const uint8_t channel) {
     while(regs.CHCTRLA.bit.SWRST) {}
 }
 
-/**
- * @brief Configure a DMA transfer descriptor
- *
- * Sets up a channel's DMA transfer descriptor with the provided transfer source, destination, and
- * other configuration values.
- *
- * @remark Once the descriptor is configured, the transfer will begin with the next trigger, which
- *         may be a software trigger.
- *
- * @param channel DMA channel to update the descriptor for
- * @param size Size of a beat (single bus cycle)
- * @param source Address to read data from
- * @param srcIncrement Whether the source address is incremented after each transfer
- * @param destination Destination memory address
- * @param destIncrement Whether the destination address is incremented after each transfer
- * @param transferLength Total size of the transfer, in bytes. Must be evenly divisible by the
- *        beat size, and result in less than \f$2^16-1\f$ transfers total.
- *
- * @return 0 on success, an error code otherwise
- */
-int Dma::ConfigureTransfer(const uint8_t channel, const BeatSize size, const void *source,
-        const bool srcIncrement, void *destination, const bool destIncrement,
-        const size_t transferLength) {
-    REQUIRE(channel < kNumChannels, "DMAC: invalid channel (%u)", channel);
-
-    // validate transfer size
-    size_t numBeats{0};
-
-    switch(size) {
-        case BeatSize::Byte:
-            numBeats = transferLength;
-            break;
-        case BeatSize::HalfWord:
-            if(transferLength & 0b1) {
-                return Errors::LengthBeatMismatch;
-            }
-            numBeats = transferLength / 2;
-            break;
-        case BeatSize::Word:
-            if(transferLength & 0b11) {
-                return Errors::LengthBeatMismatch;
-            }
-            numBeats = transferLength / 4;
-            break;
-    }
-
-    if(numBeats > 0xffff) {
-        return Errors::TooLong;
-    }
-
-    // ensure channel is disabled
-    auto &desc = gDescriptors[channel];
-    desc.BTCTRL.bit.VALID = 0;
-    __DSB();
-
-    // configure channel control
-    desc.BTCTRL.bit.SRCINC = srcIncrement ? 1 : 0;
-    desc.BTCTRL.bit.DSTINC = destIncrement ? 1 : 0;
-    desc.BTCTRL.bit.BEATSIZE = static_cast<uint8_t>(size) & 0b11;
-
-    desc.BTCTRL.bit.BLOCKACT = 0x01; // disable after transfer, raise interrupt
-
-    desc.BTCNT.reg = static_cast<uint16_t>(numBeats);
-
-    // configure source and destination
-    if(srcIncrement) {
-        desc.SRCADDR.reg = reinterpret_cast<uintptr_t>(source) + transferLength;
-    } else {
-        desc.SRCADDR.reg = reinterpret_cast<uintptr_t>(source);
-    }
-
-    if(destIncrement) {
-        desc.DSTADDR.reg = reinterpret_cast<uintptr_t>(destination) + transferLength;
-    } else {
-        desc.DSTADDR.reg = reinterpret_cast<uintptr_t>(destination);
-    }
-
-    // no linked descriptor
-    desc.DESCADDR.reg = 0;
-
-    // lastly, enable the descriptor again
-    __DSB();
-    desc.BTCTRL.bit.VALID = 1;
-
-    // if we get here, the transfer is ok
-    return 0;
-}
-
 /**
  * @brief Trigger a DMA channel transfer
  *
@@ -345,6 +262,11 @@ void Dma::SignalChannelComplete(const uint8_t channel, const int status) {
     gCompletionReason[channel] = status;
     __DSB();
 
+    // invoke the chain's callback
+    if(gChainCallbacks[channel]) {
+        gChainCallbacks[channel](channel, status, gChainCallbackContexts[channel]);
+    }
+
     // notify waiting task, if any
     auto task = gBlockedTasks[channel];
     if(!task) return;
@@ -359,27 +281,34 @@ void Dma::SignalChannelComplete(const uint8_t channel, const int status) {
  * @brief DMA channel 0 interrupt handler
  */
 void DMAC_0_Handler(void) {
+    Rtos::Trace::IsrEnter();
     Dma::HandleIrq(0);
+    Rtos::Trace::IsrExit();
 }
 
 /**
  * @brief DMA channel 1 interrupt handler
  */
 void DMAC_1_Handler(void) {
+    Rtos::Trace::IsrEnter();
     Dma::HandleIrq(1);
+    Rtos::Trace::IsrExit();
 }
 
 /**
  * @brief DMA channel 2 interrupt handler
  */
 void DMAC_2_Handler(void) {
+    Rtos::Trace::IsrEnter();
     Dma::HandleIrq(2);
+    Rtos::Trace::IsrExit();
 }
 
 /**
  * @brief DMA channel 3 interrupt handler
  */
 void DMAC_3_Handler(void) {
+    Rtos::Trace::IsrEnter();
     // TODO: implement
     Logger::Panic("DMAC: unhandled irq %u (%08x)", 3, DMAC->INTSTATUS.reg);
 }
@@ -388,6 +317,7 @@ void DMAC_3_Handler(void) {
  * @brief DMA channel 4-31 interrupt handler
  */
 void DMAC_4_Handler(void) {
+    Rtos::Trace::IsrEnter();
     // TODO: implement
     Logger::Panic("DMAC: unhandled irq %u (%08x)", 4, DMAC->INTSTATUS.reg);
 }
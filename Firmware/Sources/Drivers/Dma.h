@@ -24,10 +24,12 @@ namespace Drivers {
  * Provides an interface to the processor's internal 32-channel DMA controller. It encapsulates the
  * required memory allocations for DMA descriptor buffers.
  *
- * @remark Only a subset of all 32 channels may be initialized to save memory.
+ * Simple transfers use a single descriptor per channel. Transfers that consist of multiple
+ * segments (for example, several buffers to be sent back to back) can instead be described by a
+ * chain of linked descriptors, allocated from a shared pool, which the controller executes without
+ * any CPU intervention between segments.
  *
- * @remark The linked transfer descriptor feature is not implemented. DMA transfers are always
- *         done with a single descriptor.
+ * @remark Only a subset of all 32 channels may be initialized to save memory.
  */
 class Dma {
     friend void ::DMAC_0_Handler();
@@ -75,6 +77,20 @@ class Dma {
              * The DMA transfer tried to submit an invalid transfer descriptor.
              */
             InvalidDescriptor           = -304,
+
+            /**
+             * @brief Descriptor pool exhausted
+             *
+             * There are not enough free descriptors in the pool to allocate the requested chain.
+             */
+            NoDescriptors               = -305,
+
+            /**
+             * @brief Invalid chain
+             *
+             * The descriptor chain is empty, or a segment index is out of range.
+             */
+            InvalidChain                = -306,
         };
 
         /**
@@ -129,6 +145,46 @@ class Dma {
         constexpr static const size_t kNumChannels{8};
         static_assert(kNumChannels <= 32, "invalid maximum channel count");
 
+        /**
+         * @brief Number of descriptors in the chain pool
+         *
+         * Total number of descriptors available to be allocated to descriptor chains, shared by
+         * all channels.
+         */
+        constexpr static const size_t kChainPoolSize{32};
+        static_assert(kChainPoolSize <= 32, "chain pool too large for allocation bitmap");
+        /// Chain pool allocation bitmap with all descriptors free
+        constexpr static const uint32_t kChainPoolAllFree{(kChainPoolSize == 32) ? 0xFFFFFFFF :
+            ((1U << (kChainPoolSize % 32)) - 1)};
+
+        /**
+         * @brief Chain completion callback
+         *
+         * Invoked from the DMA interrupt handler when a descriptor chain completes (or for
+         * circular chains, each time a segment marked to raise an interrupt completes.)
+         *
+         * @param channel DMA channel the chain executed on
+         * @param status 0 on success, or a negative error code
+         * @param ctx Context pointer passed when the chain was started
+         */
+        using ChainCallback = void(*)(const uint8_t channel, const int status, void *ctx);
+
+        /**
+         * @brief A chain of linked transfer descriptors
+         *
+         * Each descriptor describes one segment of the transfer; segments are executed in order.
+         * A chain is allocated from the descriptor pool, configured segment by segment, then
+         * started on a channel.
+         *
+         * @remark A chain must not be modified while it's executing, and may only execute on a
+         *         single channel at a time.
+         */
+        struct Chain {
+            /// First descriptor of the chain (descriptors are contiguous in the pool)
+            DmacDescriptor *descriptors{nullptr};
+            /// Number of descriptors (segments) in the chain
+            size_t length{0};
+        };
     public:
         Dma() = delete;
 
@@ -145,10 +201,23 @@ class Dma {
                 const void *source, const bool srcIncrement, void *destination,
                 const bool destIncrement, const size_t transferLength);
 
+        static int AllocChain(Chain &outChain, const size_t length);
+        static void FreeChain(Chain &chain);
+        static int ConfigureChainSegment(Chain &chain, const size_t index, const BeatSize size,
+                const void *source, const bool srcIncrement, void *destination,
+                const bool destIncrement, const size_t transferLength,
+                const bool interrupt = false);
+        static int StartChain(const uint8_t channel, Chain &chain, const bool circular = false,
+                ChainCallback callback = nullptr, void *callbackContext = nullptr);
+
         static void Trigger(const uint8_t channel);
         static int WaitForCompletion(const uint8_t channel);
 
     private:
+        static int BuildDescriptor(DmacDescriptor &desc, const BeatSize size,
+                const void *source, const bool srcIncrement, void *destination,
+                const bool destIncrement, const size_t transferLength);
+
         static void HandleIrq(const uint8_t channel);
         static void SignalChannelComplete(const uint8_t channel, const int reason = 0);
 
@@ -183,6 +252,29 @@ class Dma {
          * transfer completed.
          */
         static etl::array<int, kNumChannels> gCompletionReason;
+
+        /**
+         * @brief Descriptor chain pool
+         *
+         * Storage for the descriptors of all descriptor chains.
+         */
+        static DmacDescriptor gChainPool[kChainPoolSize];
+
+        /**
+         * @brief Chain pool allocation bitmap
+         *
+         * Each set bit corresponds to a free descriptor in the chain pool.
+         */
+        static uint32_t gChainPoolFree;
+
+        /**
+         * @brief Chain completion callbacks
+         *
+         * Callback (and its context) to invoke when the descriptor chain running on a channel
+         * completes, if any.
+         */
+        static etl::array<ChainCallback, kNumChannels> gChainCallbacks;
+        static etl::array<void *, kNumChannels> gChainCallbackContexts;
 };
 }
 
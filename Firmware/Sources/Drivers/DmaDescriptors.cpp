@@ -0,0 +1,300 @@
+#include "Dma.h"
+
+#include "Log/Logger.h"
+#include "Rtos/Rtos.h"
+
+#include <string.h>
+#include <vendor/sam.h>
+
+using namespace Drivers;
+
+DmacDescriptor Dma::gDescriptors[kNumChannels] __attribute__((aligned(8)));
+DmacDescriptor Dma::gChainPool[kChainPoolSize] __attribute__((aligned(8)));
+uint32_t Dma::gChainPoolFree{kChainPoolAllFree};
+etl::array<Dma::ChainCallback, Dma::kNumChannels> Dma::gChainCallbacks;
+etl::array<void *, Dma::kNumChannels> Dma::gChainCallbackContexts;
+
+/**
+ * @brief Configure a DMA transfer descriptor
+ *
+ * Sets up a channel's DMA transfer descriptor with the provided transfer source, destination, and
+ * other configuration values.
+ *
+ * @remark Once the descriptor is configured, the transfer will begin with the next trigger, which
+ *         may be a software trigger.
+ *
+ * @param channel DMA channel to update the descriptor for
+ * @param size Size of a beat (single bus cycle)
+ * @param source Address to read data from
+ * @param srcIncrement Whether the source address is incremented after each transfer
+ * @param destination Destination memory address
+ * @param destIncrement Whether the destination address is incremented after each transfer
+ * @param transferLength Total size of the transfer, in bytes. Must be evenly divisible by the
+ *        beat size, and result in less than \f$2^16-1\f$ transfers total.
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int Dma::ConfigureTransfer(const uint8_t channel, const BeatSize size, const void *source,
+        const bool srcIncrement, void *destination, const bool destIncrement,
+        const size_t transferLength) {
+    REQUIRE(channel < kNumChannels, "DMAC: invalid channel (%u)", channel);
+
+    // ensure channel is disabled
+    auto &desc = gDescriptors[channel];
+    desc.BTCTRL.bit.VALID = 0;
+    __DSB();
+
+    int err = BuildDescriptor(desc, size, source, srcIncrement, destination, destIncrement,
+            transferLength);
+    if(err) {
+        return err;
+    }
+
+    desc.BTCTRL.bit.BLOCKACT = 0x01; // disable after transfer, raise interrupt
+
+    // no linked descriptor (and thus no chain callback)
+    desc.DESCADDR.reg = 0;
+
+    taskENTER_CRITICAL();
+    gChainCallbacks[channel] = nullptr;
+    taskEXIT_CRITICAL();
+
+    // lastly, enable the descriptor again
+    __DSB();
+    desc.BTCTRL.bit.VALID = 1;
+
+    // if we get here, the transfer is ok
+    return 0;
+}
+
+/**
+ * @brief Fill in a transfer descriptor
+ *
+ * Set up the beat size, transfer count, and source and destination addresses of a descriptor. Its
+ * block action and link to the next descriptor are left for the caller to configure.
+ *
+ * @param desc Descriptor to fill in; it should not be valid
+ * @param size Size of a beat (single bus cycle)
+ * @param source Address to read data from
+ * @param srcIncrement Whether the source address is incremented after each transfer
+ * @param destination Destination memory address
+ * @param destIncrement Whether the destination address is incremented after each transfer
+ * @param transferLength Total size of the transfer, in bytes
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int Dma::BuildDescriptor(DmacDescriptor &desc, const BeatSize size, const void *source,
+        const bool srcIncrement, void *destination, const bool destIncrement,
+        const size_t transferLength) {
+    // validate transfer size
+    size_t numBeats{0};
+
+    switch(size) {
+        case BeatSize::Byte:
+            numBeats = transferLength;
+            break;
+        case BeatSize::HalfWord:
+            if(transferLength & 0b1) {
+                return Errors::LengthBeatMismatch;
+            }
+            numBeats = transferLength / 2;
+            break;
+        case BeatSize::Word:
+            if(transferLength & 0b11) {
+                return Errors::LengthBeatMismatch;
+            }
+            numBeats = transferLength / 4;
+            break;
+    }
+
+    if(numBeats > 0xffff) {
+        return Errors::TooLong;
+    }
+
+    // configure channel control
+    desc.BTCTRL.bit.SRCINC = srcIncrement ? 1 : 0;
+    desc.BTCTRL.bit.DSTINC = destIncrement ? 1 : 0;
+    desc.BTCTRL.bit.BEATSIZE = static_cast<uint8_t>(size) & 0b11;
+
+    desc.BTCNT.reg = static_cast<uint16_t>(numBeats);
+
+    // configure source and destination
+    if(srcIncrement) {
+        desc.SRCADDR.reg = reinterpret_cast<uintptr_t>(source) + transferLength;
+    } else {
+        desc.SRCADDR.reg = reinterpret_cast<uintptr_t>(source);
+    }
+
+    if(destIncrement) {
+        desc.DSTADDR.reg = reinterpret_cast<uintptr_t>(destination) + transferLength;
+    } else {
+        desc.DSTADDR.reg = reinterpret_cast<uintptr_t>(destination);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Allocate a descriptor chain
+ *
+ * Reserves a contiguous range of descriptors from the chain pool. The descriptors are invalid
+ * until they are configured with ConfigureChainSegment().
+ *
+ * @param outChain Chain to initialize
+ * @param length Number of segments in the chain
+ *
+ * @return 0 on success, or an error code
+ */
+int Dma::AllocChain(Chain &outChain, const size_t length) {
+    if(!length || length > kChainPoolSize) {
+        return Errors::InvalidChain;
+    }
+
+    const uint32_t mask = (length == 32) ? 0xFFFFFFFF : ((1U << length) - 1);
+    int err{Errors::NoDescriptors};
+
+    taskENTER_CRITICAL();
+
+    for(size_t first = 0; first + length <= kChainPoolSize; first++) {
+        if((gChainPoolFree & (mask << first)) == (mask << first)) {
+            gChainPoolFree &= ~(mask << first);
+
+            outChain.descriptors = &gChainPool[first];
+            outChain.length = length;
+            err = 0;
+            break;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    if(!err) {
+        memset(outChain.descriptors, 0, sizeof(DmacDescriptor) * length);
+    }
+    return err;
+}
+
+/**
+ * @brief Release a descriptor chain
+ *
+ * Returns the chain's descriptors to the pool.
+ *
+ * @param chain Chain to release; it must not be executing
+ */
+void Dma::FreeChain(Chain &chain) {
+    if(!chain.descriptors) {
+        return;
+    }
+
+    const size_t first = chain.descriptors - gChainPool;
+    REQUIRE(first < kChainPoolSize, "DMAC: invalid chain (%p)", chain.descriptors);
+
+    const uint32_t mask = (chain.length == 32) ? 0xFFFFFFFF : ((1U << chain.length) - 1);
+
+    taskENTER_CRITICAL();
+    gChainPoolFree |= (mask << first);
+    taskEXIT_CRITICAL();
+
+    chain.descriptors = nullptr;
+    chain.length = 0;
+}
+
+/**
+ * @brief Configure a segment of a descriptor chain
+ *
+ * Sets up the transfer for a single descriptor in the chain.
+ *
+ * @param chain Chain to configure
+ * @param index Index of the segment to configure
+ * @param size Size of a beat (single bus cycle)
+ * @param source Address to read data from
+ * @param srcIncrement Whether the source address is incremented after each transfer
+ * @param destination Destination memory address
+ * @param destIncrement Whether the destination address is incremented after each transfer
+ * @param transferLength Total size of the segment, in bytes
+ * @param interrupt Raise an interrupt (and invoke the chain callback) once this segment completes;
+ *        the last segment of a chain always does.
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int Dma::ConfigureChainSegment(Chain &chain, const size_t index, const BeatSize size,
+        const void *source, const bool srcIncrement, void *destination,
+        const bool destIncrement, const size_t transferLength, const bool interrupt) {
+    if(index >= chain.length) {
+        return Errors::InvalidChain;
+    }
+
+    auto &desc = chain.descriptors[index];
+    desc.BTCTRL.bit.VALID = 0;
+
+    int err = BuildDescriptor(desc, size, source, srcIncrement, destination, destIncrement,
+            transferLength);
+    if(err) {
+        return err;
+    }
+
+    desc.BTCTRL.bit.BLOCKACT = interrupt ? 0x01 : 0x00;
+    desc.BTCTRL.bit.VALID = 1;
+
+    return 0;
+}
+
+/**
+ * @brief Start executing a descriptor chain
+ *
+ * Links the chain's descriptors together, and installs the first one as the channel's transfer
+ * descriptor. The transfer begins with the next trigger, once the channel is enabled.
+ *
+ * @param channel DMA channel to execute the chain on; it must be disabled
+ * @param chain Descriptor chain to execute, all of whose segments must have been configured
+ * @param circular When set, the last segment links back to the first, so the chain repeats until
+ *        the channel is disabled. This is useful for continuous acquisition into a ring of
+ *        buffers; mark segments to raise an interrupt to be notified as each buffer fills.
+ * @param callback Function to invoke (from interrupt context) on completion, if any
+ * @param callbackContext Context pointer passed to the callback
+ *
+ * @return 0 on success, an error code otherwise
+ *
+ * @remark WaitForCompletion() may also be used to wait for a (non-circular) chain to complete.
+ *
+ * @remark This may be called from interrupt context, such as a chain completion callback.
+ */
+int Dma::StartChain(const uint8_t channel, Chain &chain, const bool circular,
+        ChainCallback callback, void *callbackContext) {
+    REQUIRE(channel < kNumChannels, "DMAC: invalid channel (%u)", channel);
+
+    if(!chain.descriptors || !chain.length) {
+        return Errors::InvalidChain;
+    }
+
+    // link the descriptors
+    for(size_t i = 0; i < chain.length; i++) {
+        auto &desc = chain.descriptors[i];
+        if(!desc.BTCTRL.bit.VALID) {
+            return Errors::InvalidDescriptor;
+        }
+
+        if(i + 1 < chain.length) {
+            desc.DESCADDR.reg = reinterpret_cast<uintptr_t>(&chain.descriptors[i + 1]);
+        } else {
+            desc.DESCADDR.reg = circular ? reinterpret_cast<uintptr_t>(&chain.descriptors[0]) : 0;
+            desc.BTCTRL.bit.BLOCKACT = 0x01;
+        }
+    }
+
+    // install callback (this may be called from an ISR, to start the next chain)
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    gChainCallbacks[channel] = callback;
+    gChainCallbackContexts[channel] = callbackContext;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    // then copy the first descriptor into the channel's base descriptor
+    auto &base = gDescriptors[channel];
+    base.BTCTRL.bit.VALID = 0;
+    __DSB();
+
+    memcpy(&base, &chain.descriptors[0], sizeof(base));
+
+    __DSB();
+    return 0;
+}
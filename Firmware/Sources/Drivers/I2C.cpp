@@ -5,6 +5,7 @@
 
 #include "Log/Logger.h"
 #include "Rtos/Rtos.h"
+#include "Rtos/Trace.h"
 
 #include <vendor/sam.h>
 
@@ -23,9 +24,6 @@ I2C::I2C(const SercomBase::Unit unit, const Config &conf) : unit(unit),
     // mark the underlying SERCOM as used and enable clocking resources
     SercomBase::MarkAsUsed(unit);
 
-    // allocate locks
-    this->busLock = xSemaphoreCreateMutexStatic(&this->busLockStorage);
-
     // reset
     this->reset();
 
@@ -51,7 +49,9 @@ I2C::I2C(const SercomBase::Unit unit, const Config &conf) : unit(unit),
             configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1);
 
     SercomBase::RegisterHandler(unit, 0, [](void *ctx) {
+        Rtos::Trace::IsrEnter();
         reinterpret_cast<I2C *>(ctx)->irqMasterOnBus();
+        Rtos::Trace::IsrExit();
     }, this);
     SercomBase::RegisterHandler(unit, 1, [](void *ctx) {
         /*
@@ -60,10 +60,14 @@ I2C::I2C(const SercomBase::Unit unit, const Config &conf) : unit(unit),
          * the "master on bus" handler correctly deals with receiving data, based on the status
          * flags, so it should be fine to call here instead of building a separate handler.
          */
+        Rtos::Trace::IsrEnter();
         reinterpret_cast<I2C *>(ctx)->irqMasterOnBus();
+        Rtos::Trace::IsrExit();
     }, this);
     SercomBase::RegisterHandler(unit, 3, [](void *ctx) {
+        Rtos::Trace::IsrEnter();
         reinterpret_cast<I2C *>(ctx)->irqError();
+        Rtos::Trace::IsrExit();
     }, this);
 
     this->regs->INTENSET.reg = SERCOM_I2CM_INTENSET_MB | SERCOM_I2CM_INTENSET_SB |
@@ -84,9 +88,6 @@ I2C::~I2C() {
     this->disable();
     this->reset();
 
-    // close locks
-    vSemaphoreDelete(this->busLock);
-
     // mark as available
     SercomBase::MarkAsAvailable(this->unit);
 }
@@ -197,14 +198,51 @@ void I2C::waitSysOpSync() {
 /**
  * @brief Perform bus transactions
  *
- * Execute the provided transactions, one after another.
+ * Execute the provided transactions, one after another; this submits them as a request to the
+ * bus queue, then blocks the calling task until they've completed.
  */
-int I2C::perform(etl::span<const Transaction> transactions) {
-    int err{-1};
+int I2C::perform(etl::span<const Transaction> transactions, const Priority priority) {
+    int err;
     uint32_t note{0};
     BaseType_t ok;
 
-    const auto currentTask = xTaskGetCurrentTaskHandle();
+    Request request{
+        .transactions = transactions,
+        .priority = priority,
+        .notifyTask = xTaskGetCurrentTaskHandle(),
+        .notifyIndex = Rtos::TaskNotifyIndex::DriverPrivate,
+        .notifyBits = Drivers::NotifyBits::I2CMaster,
+    };
+
+    err = this->submit(request);
+    if(err) {
+        return err;
+    }
+
+    // wait for the transactions to complete/error out; the request lives on our stack
+    ok = xTaskNotifyWaitIndexed(Rtos::TaskNotifyIndex::DriverPrivate, 0,
+            Drivers::NotifyBits::I2CMaster, &note, portMAX_DELAY);
+    REQUIRE(ok == pdTRUE, "%s failed: %d", "xTaskNotifyWaitIndexed", ok);
+
+    return request.status;
+}
+
+/**
+ * @brief Submit transactions for asynchronous execution
+ *
+ * Append the request to the queue for its priority. If the bus is idle, the request is started
+ * immediately; otherwise, it's started from the interrupt handler once it's the oldest pending
+ * request of the highest priority, so queued requests are executed back-to-back without involving
+ * any tasks.
+ *
+ * @param request Request to submit; it must remain valid until it is completed
+ *
+ * @return 0 if the request was queued, or a negative error code
+ *
+ * @remark This may be called from interrupt context, including from completion callbacks.
+ */
+int I2C::submit(Request &request) {
+    int err;
 
     // ensure we're enabled
     if(!this->enabled) {
@@ -212,38 +250,70 @@ int I2C::perform(etl::span<const Transaction> transactions) {
     }
 
     // validate inputs
-    if(transactions.empty()) {
+    if(request.transactions.empty()) {
         return Errors::InvalidTransaction;
     }
 
-    err = I2CBus::ValidateTransactions(transactions);
+    err = I2CBus::ValidateTransactions(request.transactions);
     if(err) {
         return err;
     }
 
-    // acquire lock on the bus and prepare for the first transaction
-    if(!xSemaphoreTake(this->busLock, portMAX_DELAY)) {
-        // failed to acquire lock
-        return Errors::InUse;
-    }
-
     /*
-     * Perform setup inside a critical section.
-     *
-     * This is required so that we don't get interrupted while we configure the address of the
-     * peripheral and reset state machine state. Otherwise, we can get into some fucked state where
-     * subsequent bus transactions will hang.
+     * Enqueue the request with interrupts masked, so we can't race against the interrupt handler
+     * completing the current request. If no request is executing, the bus is idle, so we'll need
+     * to kick off the request ourselves.
      *
-     * XXX: This probably needs more debugging...
+     * This must also be done with interrupts masked, so that we don't get interrupted while we
+     * configure the address of the peripheral and reset state machine state.
      */
-    taskENTER_CRITICAL();
+    request.next = nullptr;
+    request.status = 0;
+
+    if(static_cast<size_t>(request.priority) >= kNumPriorities) {
+        return Errors::InvalidTransaction;
+    }
+
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    request.submitTime = DWT->CYCCNT;
+
+    if(!this->currentRequest) {
+        this->startRequest(request);
+    } else {
+        this->queue.push(request);
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    return 0;
+}
+
+/**
+ * @brief Start executing a request
+ *
+ * Reset the state machine, then begin the first transaction of the request. This is invoked
+ * either when submitting a request to an idle bus, or when the previous request completes.
+ *
+ * @remark Interrupts must be masked when invoking this.
+ */
+void I2C::startRequest(Request &request) {
+    // update queueing statistics
+    auto &stats = this->latency[static_cast<size_t>(request.priority)];
+    const uint32_t waited = DWT->CYCCNT - request.submitTime;
+
+    stats.numRequests++;
+    stats.latencyTotal += waited;
+    if(waited > stats.latencyMax) {
+        stats.latencyMax = waited;
+    }
 
-    this->waiting = currentTask;
+    // prepare state machine
+    this->currentRequest = &request;
     this->completion = -1;
-    this->state = State::Idle;
+    this->isRequestDone = false;
     this->currentTxn = 0;
     this->currentTxnOffset = 0;
-    this->currentTxns = transactions;
+    this->currentTxns = request.transactions;
 
     /*
      * Start the transfer by writing the address of the first device.
@@ -251,38 +321,8 @@ int I2C::perform(etl::span<const Transaction> transactions) {
      * In the case of a read, also preprogram CTRLB.ACKACT so that if we're reading only a single
      * byte, we transmit a NACK automatically once that first byte has been received.
      */
-    const auto &first = transactions.front();
-
     this->state = State::SendAddress;
-    this->beginTransaction(first, false);
-
-    taskEXIT_CRITICAL();
-
-    // wait for the transactions to complete/error out
-    ok = xTaskNotifyWaitIndexed(Rtos::TaskNotifyIndex::DriverPrivate, 0,
-            Drivers::NotifyBits::I2CMaster, &note, portMAX_DELAY);
-    if(!ok) {
-        err = Errors::UnspecifiedError;
-        goto beach;
-    }
-
-    // interpret the result (from interrupts)
-    if(!this->completion) { // success
-        err = 0;
-    }
-    // transaction(s) failed
-    else {
-        err = this->completion;
-    }
-
-    // clean up and release the lock
-beach:;
-    this->waiting = nullptr;
-
-    ok = xSemaphoreGive(this->busLock);
-    REQUIRE(ok == pdTRUE, "failed to release I2C bus lock");
-
-    return err;
+    this->beginTransaction(request.transactions.front(), false);
 }
 
 
@@ -324,7 +364,7 @@ void I2C::irqMasterOnBus() {
             // case 1: bus error
             if((irqs & SERCOM_I2CM_INTFLAG_MB) && (status & SERCOM_I2CM_STATUS_BUSERR)) {
                 // abort transaction
-                this->irqCompleteTxn(Errors::BusError, &woken);
+                this->irqCompleteTxn(Errors::BusError);
 
                 // ack irq and update state
                 this->state = State::Idle;
@@ -334,7 +374,7 @@ void I2C::irqMasterOnBus() {
             else if((irqs & SERCOM_I2CM_INTFLAG_MB) && (status & SERCOM_I2CM_STATUS_RXNACK)) {
                 // issue STOP and abort transaction
                 this->issueStop();
-                this->irqCompleteTxn(Errors::NoAck, &woken);
+                this->irqCompleteTxn(Errors::NoAck);
 
                 // update state machine
                 this->state = State::Idle;
@@ -360,7 +400,7 @@ void I2C::irqMasterOnBus() {
                      */
                     if(this->currentTxn == (this->currentTxns.size() - 1)) {
                         this->issueStop();
-                        this->irqCompleteTxn(0, &woken);
+                        this->irqCompleteTxn(0);
 
                         needsStop = false;
                     }
@@ -450,14 +490,14 @@ void I2C::irqMasterOnBus() {
             // byte sent, NACK received
             else if((irqs & SERCOM_I2CM_INTFLAG_MB) && (status & SERCOM_I2CM_STATUS_RXNACK)) {
                 this->issueStop();
-                this->irqCompleteTxn(Errors::UnexpectedNAck, &woken);
+                this->irqCompleteTxn(Errors::UnexpectedNAck);
 
                 needsStop = false;
             }
             // other error
             else {
                 this->issueStop();
-                this->irqCompleteTxn(Errors::TransmissionError, &woken);
+                this->irqCompleteTxn(Errors::TransmissionError);
 
                 needsStop = false;
 
@@ -504,7 +544,7 @@ void I2C::irqMasterOnBus() {
             // unknown error
             else {
                 this->issueStop();
-                this->irqCompleteTxn(Errors::ReceptionError, &woken);
+                this->irqCompleteTxn(Errors::ReceptionError);
 
                 Logger::Panic("SERCOM%u I2C irq error: state %u (irq %02x status %08x)",
                         static_cast<unsigned int>(this->unit),
@@ -542,7 +582,7 @@ void I2C::irqMasterOnBus() {
          */
         if(this->currentTxn == (this->currentTxns.size() - 1)) {
             if(needsStop) this->issueStop();
-            this->irqCompleteTxn(0, &woken);
+            this->irqCompleteTxn(0);
 
             this->state = State::Idle;
         }
@@ -559,6 +599,10 @@ void I2C::irqMasterOnBus() {
         }
     }
 
+    if(this->isRequestDone) {
+        this->irqFinishRequest(&woken);
+    }
+
     portYIELD_FROM_ISR(woken);
 }
 
@@ -577,7 +621,7 @@ void I2C::irqError() {
      */
     if(status & SERCOM_I2CM_STATUS_BUSERR) {
         this->regs->STATUS.reg = SERCOM_I2CM_STATUS_BUSSTATE(0b00) | SERCOM_I2CM_STATUS_BUSERR;
-        this->irqCompleteTxn(Errors::BusError, &woken);
+        this->irqCompleteTxn(Errors::BusError);
     }
     /**
      * Arbitration was lost to another master. If there is not a multimaster, this may indicate
@@ -585,7 +629,7 @@ void I2C::irqError() {
      */
     else if(status & SERCOM_I2CM_STATUS_ARBLOST) {
         this->regs->STATUS.reg = SERCOM_I2CM_STATUS_BUSSTATE(0b00) | SERCOM_I2CM_STATUS_ARBLOST;
-        this->irqCompleteTxn(Errors::ArbitrationLost, &woken);
+        this->irqCompleteTxn(Errors::ArbitrationLost);
     }
     // unknown error
     else {
@@ -595,23 +639,81 @@ void I2C::irqError() {
     // clear errors
     this->regs->INTFLAG.reg = SERCOM_I2CM_INTFLAG_ERROR;
 
+    if(this->isRequestDone) {
+        this->irqFinishRequest(&woken);
+    }
+
     portYIELD_FROM_ISR(woken);
 }
 
 /**
  * @brief Terminate the currently executing transaction with a status code
  *
+ * The request is completed once the interrupt handler has finished updating the bus state.
+ *
  * @param status Error/status code
- * @param woken Set when a higher priority task became runnable
  */
-void I2C::irqCompleteTxn(const int status, BaseType_t *woken) {
-    // update status
+void I2C::irqCompleteTxn(const int status) {
     this->completion = status;
-    __DSB();
+    this->isRequestDone = true;
+}
+
+/**
+ * @brief Complete the current request
+ *
+ * Start the next request (if any) so that the bus doesn't go idle between requests. This is the
+ * oldest pending request of the highest priority that has any pending requests. Then, the
+ * completed request's callback and task notification are invoked.
+ *
+ * @param woken Set when a higher priority task became runnable
+ */
+void I2C::irqFinishRequest(BaseType_t *woken) {
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    auto done = this->currentRequest;
+    const auto status = this->completion;
+    auto next = this->queue.pop();
+
+    if(next) {
+        this->startRequest(*next);
+    } else {
+        this->currentRequest = nullptr;
+        this->isRequestDone = false;
+        this->state = State::Idle;
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    // the completion callback may submit another request, so this comes last
+    I2CBus::CompleteRequest(*done, status, woken);
+}
+
+/**
+ * @brief Read out request queueing statistics
+ *
+ * Get the queueing latency statistics of each priority, over the window since the previous call,
+ * then reset them.
+ *
+ * @param outStats Buffer to receive the statistics, indexed by priority
+ */
+void I2C::getQueueStats(etl::span<QueueStats, kNumPriorities> outStats) {
+    const auto cyclesPerUs = SystemCoreClock / 1'000'000;
+
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    for(size_t i = 0; i < kNumPriorities; i++) {
+        auto &stats = this->latency[i];
+        auto &out = outStats[i];
+
+        out.numRequests = stats.numRequests;
+        out.latencyAvg = stats.numRequests ?
+            static_cast<uint32_t>((stats.latencyTotal / stats.numRequests) / cyclesPerUs) : 0;
+        out.latencyMax = stats.latencyMax / cyclesPerUs;
+
+        stats = {};
+    }
 
-    // notify
-    xTaskNotifyIndexedFromISR(this->waiting, Rtos::TaskNotifyIndex::DriverPrivate,
-            Drivers::NotifyBits::I2CMaster, eSetBits, woken);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
 }
 
 /**
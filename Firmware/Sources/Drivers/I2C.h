@@ -3,12 +3,14 @@
 
 #include "SercomBase.h"
 #include "I2CBus.h"
+#include "I2CRequestQueue.h"
 
 #include "Rtos/Rtos.h"
 
 #include <stddef.h>
 #include <stdint.h>
 
+#include <etl/array.h>
 #include <etl/span.h>
 
 namespace Drivers {
@@ -43,7 +45,7 @@ class I2C: public I2CBus {
              * The bus timed out waiting for a device to acknowledge; likely, there is no device
              * at the specified address.
              */
-            NoAck                       = -101,
+            NoAck                       = I2CBus::kErrorNoAck,
             /**
              * @brief Driver already in use
              *
@@ -148,15 +150,21 @@ class I2C: public I2CBus {
         void enable();
         void disable();
 
-        virtual int perform(etl::span<const Transaction> transactions) override;
+        virtual int perform(etl::span<const Transaction> transactions,
+                const Priority priority = Priority::Normal) override;
+        virtual int submit(Request &request) override;
+
+        void getQueueStats(etl::span<QueueStats, kNumPriorities> outStats);
 
     private:
         void waitSysOpSync();
+        void startRequest(Request &request);
 
         void irqMasterOnBus();
         void irqError();
 
-        void irqCompleteTxn(const int status, BaseType_t *woken);
+        void irqCompleteTxn(const int status);
+        void irqFinishRequest(BaseType_t *woken);
         void beginTransaction(const Transaction &txn, const bool needsStop = true);
 
         /**
@@ -208,13 +216,22 @@ class I2C: public I2CBus {
         /// MMIO register base
         ::SercomI2cm *regs;
 
+        /// Request currently executing on the bus, or `nullptr` if the bus is idle
+        Request *currentRequest{nullptr};
+        /// Pending requests
+        I2CRequestQueue queue;
+
         /**
-         * @brief Task currently waiting on bus transactions
+         * @brief Queueing latency accumulators
          *
-         * This is updated whenever we start a new transaction, and it references the task that
-         * is blocked on the transactions
+         * Per priority latency statistics (in cycles) since they were last read out
          */
-        TaskHandle_t waiting;
+        struct {
+            uint32_t numRequests;
+            uint64_t latencyTotal;
+            uint32_t latencyMax;
+        } latency[kNumPriorities]{};
+
         /**
          * @brief Completion code of the most recent batch of transactions
          *
@@ -222,6 +239,8 @@ class I2C: public I2CBus {
          * to completion, otherwise, an error code.
          */
         int completion{0};
+        /// Set by the interrupt handler when the current request has finished executing
+        bool isRequestDone{false};
 
         /**
          * @brief Currently executing transaction block
@@ -245,17 +264,6 @@ class I2C: public I2CBus {
          */
         size_t currentTxnOffset{0};
 
-
-        /**
-         * @brief Bus lock
-         *
-         * This lock protects access to the bus, in the way of transactions.
-         */
-        SemaphoreHandle_t busLock;
-
-        /// Storage for allocating bus lock
-        StaticSemaphore_t busLockStorage;
-
     private:
         /**
          * @brief Enable timeout
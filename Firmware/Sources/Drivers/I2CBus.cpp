@@ -39,3 +39,56 @@ int I2CBus::ValidateTransactions(etl::span<const Transaction> transactions) {
     return 0;
 }
 
+
+/**
+ * @brief Submit a batch of transactions for asynchronous execution
+ *
+ * The request is queued behind any requests already pending on the bus; the call returns without
+ * waiting for it to execute. Once it completes, its completion callback is invoked and the
+ * requested task notification is sent.
+ *
+ * The default implementation performs the transactions synchronously, and completes the request
+ * before returning. Busses that can execute transactions in the background override this.
+ *
+ * @param request Request to submit; it must remain valid until it is completed
+ *
+ * @return 0 if the request was submitted, or a negative error code if it was rejected. Errors that
+ *         occur while executing the request are reported in its completion status instead.
+ */
+int I2CBus::submit(Request &request) {
+    const auto status = this->perform(request.transactions, request.priority);
+    CompleteRequest(request, status, nullptr);
+
+    return 0;
+}
+
+/**
+ * @brief Complete a request
+ *
+ * Store the completion status, then invoke the request's callback, and notify its task.
+ *
+ * @param request Request that completed
+ * @param status Completion status
+ * @param woken If invoked from an ISR, set when a higher priority task became runnable; it must
+ *        be `nullptr` when invoked from task context.
+ */
+void I2CBus::CompleteRequest(Request &request, const int status, BaseType_t *woken) {
+    // copy out notification info, in case the callback reuses the request
+    const auto task = request.notifyTask;
+    const auto index = request.notifyIndex;
+    const auto bits = request.notifyBits;
+
+    request.status = status;
+
+    if(request.callback) {
+        request.callback(status, request.callbackContext);
+    }
+
+    if(task) {
+        if(woken) {
+            xTaskNotifyIndexedFromISR(task, index, bits, eSetBits, woken);
+        } else {
+            xTaskNotifyIndexed(task, index, bits, eSetBits);
+        }
+    }
+}
@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "Rtos/Rtos.h"
+
 #include <etl/span.h>
 
 namespace Drivers {
@@ -16,6 +18,47 @@ namespace Drivers {
  */
 class I2CBus {
     public:
+        /**
+         * @brief Request priority
+         *
+         * Requests of a higher priority are executed before any pending requests of a lower
+         * priority. Requests are never interrupted once started, so they are preempted only at
+         * request boundaries.
+         */
+        enum class Priority: uint8_t {
+            /// Latency sensitive traffic, such as the control loop's measurements and setpoints
+            High                        = 0,
+            /// Default priority
+            Normal                      = 1,
+            /// Background traffic, such as indicators, thermal management and EEPROM writes
+            Low                         = 2,
+        };
+        /// Total number of request priorities
+        constexpr static const size_t kNumPriorities{3};
+
+        /**
+         * @brief Error code for a device not acknowledging its address
+         *
+         * All bus implementations report this same error, so that drivers for devices that don't
+         * acknowledge while busy can detect that condition regardless of the underlying bus.
+         */
+        constexpr static const int kErrorNoAck{-101};
+
+        /**
+         * @brief Request queueing statistics
+         *
+         * Describes how long requests of a particular priority waited in the queue before they
+         * started executing on the bus, over some window of time.
+         */
+        struct QueueStats {
+            /// Number of requests started
+            uint32_t numRequests{0};
+            /// Average time between submitting and starting a request, in µs
+            uint32_t latencyAvg{0};
+            /// Maximum time between submitting and starting a request, in µs
+            uint32_t latencyMax{0};
+        };
+
         /**
          * @brief A single transaction on the I²C bus
          *
@@ -74,6 +117,53 @@ class I2CBus {
             etl::span<uint8_t> data;
         };
 
+        /**
+         * @brief Completion callback for an asynchronous request
+         *
+         * @param status 0 if all transactions completed successfully, or a negative error code
+         * @param ctx Context pointer specified in the request
+         *
+         * @remark This may be invoked from interrupt context.
+         */
+        using CompletionCallback = void(*)(const int status, void *ctx);
+
+        /**
+         * @brief An asynchronous batch of transactions
+         *
+         * Requests are queued on the bus, and executed in the order they were submitted. Once all
+         * transactions in a request have completed (or it failed) the completion callback is
+         * invoked, and the specified task notified, if any.
+         *
+         * @remark The request, its transactions and all their buffers must remain valid until
+         *         the request has completed.
+         */
+        struct Request {
+            /// Transactions to perform back-to-back
+            etl::span<const Transaction> transactions;
+            /// Priority of the request
+            Priority priority{Priority::Normal};
+
+            /// Callback to invoke on completion (optional)
+            CompletionCallback callback{nullptr};
+            /// Context pointer passed to the completion callback
+            void *callbackContext{nullptr};
+
+            /// Task to notify on completion (optional)
+            TaskHandle_t notifyTask{nullptr};
+            /// Notification index to set bits under
+            size_t notifyIndex{0};
+            /// Notification bits to set on completion
+            uint32_t notifyBits{0};
+
+            /// Completion status: 0 on success, or a negative error code
+            int status{0};
+
+            /// Next request in the bus' queue (used internally by the bus)
+            Request *next{nullptr};
+            /// Cycle counter value when the request was submitted (used internally by the bus)
+            uint32_t submitTime{0};
+        };
+
     public:
         virtual ~I2CBus() = default;
 
@@ -85,6 +175,7 @@ class I2CBus {
          * a failure.
          *
          * @param transactions An array of transaction descriptors
+         * @param priority Priority of the transactions, relative to others on the bus
          *
          * @return 0 on success, or a negative error code.
          *
@@ -96,10 +187,14 @@ class I2CBus {
          *         returns. The buffer memory of each transaction must be in memory accessible to
          *         peripherals.
          */
-        virtual int perform(etl::span<const Transaction> transactions) = 0;
+        virtual int perform(etl::span<const Transaction> transactions,
+                const Priority priority = Priority::Normal) = 0;
+
+        virtual int submit(Request &request);
 
     protected:
         static int ValidateTransactions(etl::span<const Transaction> transactions);
+        static void CompleteRequest(Request &request, const int status, BaseType_t *woken);
 };
 }
 
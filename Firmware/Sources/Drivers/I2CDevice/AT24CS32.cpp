@@ -3,6 +3,7 @@
 #include "Drivers/I2CBus.h"
 #include "Log/Logger.h"
 #include "Rtos/Rtos.h"
+#include "stm32mp1xx.h"
 
 #include <etl/array.h>
 
@@ -51,74 +52,332 @@ int AT24CS32::Read(Drivers::I2CBus *bus, const uint8_t deviceAddress, const uint
         },
     }};
 
-    return bus->perform(txns);
+    return bus->perform(txns, I2CBus::Priority::Low);
+}
+
+/**
+ * @brief Write data to the memory array
+ *
+ * Split the data into page writes. Each page is written as soon as the device finished the write
+ * cycle of the previous page: while the device is busy, it won't acknowledge its address, so the
+ * page write is retried until it does.
+ *
+ * @param address Starting address for the write
+ * @param data Data to write
+ *
+ * @return 0 on success, or a negative error code
+ */
+int AT24CS32::writeData(const uint16_t address, etl::span<const uint8_t> data) {
+    int err;
+
+    if(data.empty() || (address + data.size()) > kDeviceSize) {
+        return Errors::InvalidBuffer;
+    }
+
+    for(size_t offset = 0; offset < data.size();) {
+        const auto chunk = GetChunkSize(address + offset, data.size() - offset);
+
+        err = PageWrite(this->bus, this->deviceAddress, address + offset,
+                data.subspan(offset, chunk));
+        if(err) {
+            return err;
+        }
+
+        offset += chunk;
+    }
+
+    // wait for the last page's write cycle
+    return WaitForWrite(this->bus, this->deviceAddress);
+}
+
+/**
+ * @brief Write data to the memory array in the background
+ *
+ * Starts a write that's performed page by page, like writeData(), but without blocking the
+ * calling task. Instead, the bus requests are submitted asynchronously, and retried from a timer
+ * while the device is busy.
+ *
+ * @param op Write operation state; it must not already be busy, and must remain valid until the
+ *        write completes
+ * @param address Starting address for the write
+ * @param data Data to write; it must remain valid until the write completes
+ * @param callback Function to invoke once all data was written (and the last write cycle has
+ *        completed) or the write failed; it may be invoked from interrupt context
+ * @param callbackContext Context pointer passed to the callback
+ *
+ * @return 0 if the write was started, or a negative error code. Errors during the write are
+ *         reported to the callback instead.
+ */
+int AT24CS32::writeDataAsync(AsyncWrite &op, const uint16_t address,
+        etl::span<const uint8_t> data, I2CBus::CompletionCallback callback,
+        void *callbackContext) {
+    if(data.empty() || (address + data.size()) > kDeviceSize) {
+        return Errors::InvalidBuffer;
+    }
+
+    bool expected{false};
+    if(!__atomic_compare_exchange_n(&op.busy, &expected, true, false, __ATOMIC_ACQUIRE,
+                __ATOMIC_RELAXED)) {
+        return Errors::InUse;
+    }
+
+    op.device = this;
+    op.polling = false;
+    op.attempts = 0;
+    op.address = address;
+    op.remaining = data;
+    op.callback = callback;
+    op.callbackContext = callbackContext;
+
+    op.submit();
+    return 0;
 }
 
 /**
  * @brief Perform a page write
  *
- * Writes a single page (up to 32 bytes) to the device.
+ * Writes a single page (up to 32 bytes) to the device. If the device does not acknowledge the
+ * write because it's still busy with a previous write cycle, it's retried.
  *
  * @param bus I²C bus to perform IO against
  * @param deviceAddress I²C address of the device
  * @param start Starting memory address for the write
  * @param buffer Buffer containing data to write
- * @param numBytes Number of bytes to write, or 0 for entire buffer
  *
  * @return 0 on success, or an error code
  *
  * @remark A single page write may write at most 32 bytes, if the starting address is 32-byte
- *         aligned. Otherwise, the write length is reduced to the remainder of the 32-byte chunk,
+ *         aligned. Otherwise, the write length is limited to the remainder of the 32-byte chunk,
  *         as wraparound in page writes is probably unintended.
+ *
+ * @remark This does not wait for the write cycle to complete.
  */
 int AT24CS32::PageWrite(Drivers::I2CBus *bus, const uint8_t deviceAddress,
-        const uint16_t start, etl::span<const uint8_t> buffer, const size_t numBytes) {
-    int err;
-
+        const uint16_t start, etl::span<const uint8_t> buffer) {
     // validate buffer
-    if(buffer.empty() || buffer.size() > kPageSize) {
+    if(buffer.empty() || buffer.size() > GetChunkSize(start, kPageSize)) {
         return Errors::InvalidBuffer;
     }
 
-    const auto pageOff = start & (kPageSize - 1);
-    if(buffer.size() > (kPageSize - pageOff)) {
-        return Errors::InvalidBuffer;
+    // do the write
+    etl::array<uint8_t, 2> addressBuf;
+    etl::array<I2CBus::Transaction, 2> txns;
+
+    return PerformPolled(bus, PrepareWrite(addressBuf, txns, deviceAddress, start, buffer));
+}
+
+/**
+ * @brief Wait for a write cycle to complete
+ *
+ * Poll the device (by writing only a memory address, which does not start a write cycle) until it
+ * acknowledges it again.
+ *
+ * @param bus I²C bus to perform IO against
+ * @param deviceAddress I²C address of the device
+ *
+ * @return 0 on success, or an error code
+ */
+int AT24CS32::WaitForWrite(Drivers::I2CBus *bus, const uint8_t deviceAddress) {
+    etl::array<uint8_t, 2> addressBuf;
+    etl::array<I2CBus::Transaction, 2> txns;
+
+    return PerformPolled(bus, PrepareWrite(addressBuf, txns, deviceAddress, 0, {}));
+}
+
+/**
+ * @brief Perform transactions, retrying while the device is busy
+ *
+ * The transactions are retried every poll interval, as long as the device does not acknowledge
+ * its address.
+ *
+ * @param bus I²C bus to perform IO against
+ * @param txns Transactions to perform
+ *
+ * @return 0 on success, WriteTimeout if the device remained busy, or another error code
+ */
+int AT24CS32::PerformPolled(Drivers::I2CBus *bus, etl::span<const I2CBus::Transaction> txns) {
+    for(size_t attempt = 0; attempt < kMaxPollAttempts; attempt++) {
+        const auto err = bus->perform(txns, I2CBus::Priority::Low);
+        if(err != I2CBus::kErrorNoAck) {
+            return err;
+        }
+
+        vTaskDelay(kPollInterval);
     }
-    if(numBytes > buffer.size()) {
-        return Errors::InvalidBuffer;
+
+    return Errors::WriteTimeout;
+}
+
+/**
+ * @brief Set up the transactions for a write
+ *
+ * This writes the two address bytes (in big endian order) followed by the data, if any.
+ *
+ * @param addressBuf Buffer to hold the memory address
+ * @param txns Buffer to hold the transactions
+ * @param deviceAddress I²C address of the device
+ * @param start Starting memory address for the write
+ * @param data Data to write, or an empty span to write only the address
+ *
+ * @return Transactions to perform
+ */
+etl::span<const Drivers::I2CBus::Transaction> AT24CS32::PrepareWrite(
+        etl::array<uint8_t, 2> &addressBuf, etl::array<I2CBus::Transaction, 2> &txns,
+        const uint8_t deviceAddress, const uint16_t start, etl::span<const uint8_t> data) {
+    addressBuf[0] = static_cast<uint8_t>((start & 0xFF00) >> 8);
+    addressBuf[1] = static_cast<uint8_t>(start & 0x00FF);
+
+    // write address
+    txns[0] = {
+        .address = deviceAddress,
+        .read = 0,
+        .length = 2,
+        .data = addressBuf
+    };
+
+    if(data.empty()) {
+        return {txns.data(), 1};
     }
 
-    // do the write
-    etl::array<uint8_t, 2> addressBuf{
-        static_cast<uint8_t>((start & 0xFF00) >> 8), static_cast<uint8_t>(start & 0x00FF)
+    // write data
+    txns[1] = {
+        .address = deviceAddress,
+        .read = 0,
+        .continuation = 1,
+        .skipRestart = 1,
+        .length = static_cast<uint16_t>(data.size()),
+        .data = {const_cast<uint8_t *>(data.data()), data.size()},
     };
 
-    etl::array<I2CBus::Transaction, 2> txns{{
-        // write address
-        {
-            .address = deviceAddress,
-            .read = 0,
-            .length = 2,
-            .data = addressBuf
-        },
-        // write data
-        {
-            .address = deviceAddress,
-            .read = 0,
-            .continuation = 1,
-            .skipRestart = 1,
-            .length = static_cast<uint16_t>(numBytes ? numBytes : buffer.size()),
-            .data = {const_cast<uint8_t *>(buffer.data()), buffer.size()},
-        },
-    }};
+    return txns;
+}
+
+
+
+/**
+ * @brief Initialize an asynchronous write object
+ *
+ * Allocates the timer used to delay retries.
+ */
+AT24CS32::AsyncWrite::AsyncWrite() {
+    this->timer = xTimerCreateStatic("AT24CS32 write",
+        kPollInterval, pdFALSE, this, &AsyncWrite::TimerFired, &this->timerBuf);
+    REQUIRE(this->timer, "AT24CS32: %s", "failed to allocate timer");
+}
+
+/**
+ * @brief Clean up an asynchronous write object
+ *
+ * @remark The object may not be destroyed while a write is in progress.
+ */
+AT24CS32::AsyncWrite::~AsyncWrite() {
+    REQUIRE(!this->isBusy(), "AT24CS32: %s", "destroying busy write");
+    xTimerDelete(this->timer, portMAX_DELAY);
+}
+
+/**
+ * @brief Submit the request for the current step of the write
+ *
+ * This is either the write of the next page, or, once all data has been written, a poll for
+ * completion of the final write cycle.
+ */
+void AT24CS32::AsyncWrite::submit() {
+    if(this->polling) {
+        this->request.transactions = PrepareWrite(this->addressBuf, this->txns,
+                this->device->deviceAddress, 0, {});
+    } else {
+        this->chunkSize = GetChunkSize(this->address, this->remaining.size());
+        this->request.transactions = PrepareWrite(this->addressBuf, this->txns,
+                this->device->deviceAddress, this->address,
+                this->remaining.first(this->chunkSize));
+    }
+
+    this->request.priority = I2CBus::Priority::Low;
+    this->request.callback = &AsyncWrite::RequestCompleted;
+    this->request.callbackContext = this;
+
+    const auto err = this->device->bus->submit(this->request);
+    if(err) {
+        this->finish(err);
+    }
+}
+
+/**
+ * @brief Complete the write
+ *
+ * Mark the write object as idle, then invoke the completion callback.
+ *
+ * @param status Completion status of the write
+ */
+void AT24CS32::AsyncWrite::finish(const int status) {
+    const auto callback = this->callback;
+    const auto ctx = this->callbackContext;
 
-    err = bus->perform(txns);
+    __atomic_store_n(&this->busy, false, __ATOMIC_RELEASE);
 
-    if(!err) {
-        // insert write delay
-        vTaskDelay(pdMS_TO_TICKS(5));
+    if(callback) {
+        callback(status, ctx);
+    }
+}
+
+/**
+ * @brief Bus request completion handler
+ *
+ * If the device didn't acknowledge the request, it's still busy with a write cycle, so the
+ * request is retried after the poll interval. Otherwise, advance to the next page; since the
+ * device will be busy programming the page just written, the next request is always delayed.
+ *
+ * @param status Completion status of the request
+ * @param ctx Write object
+ *
+ * @remark This may be invoked from interrupt context.
+ */
+void AT24CS32::AsyncWrite::RequestCompleted(const int status, void *ctx) {
+    auto op = reinterpret_cast<AsyncWrite *>(ctx);
+
+    if(status == I2CBus::kErrorNoAck) {
+        if(++op->attempts >= kMaxPollAttempts) {
+            op->finish(Errors::WriteTimeout);
+            return;
+        }
+    } else if(status) {
+        op->finish(status);
+        return;
+    } else if(op->polling) {
+        op->finish(0);
+        return;
+    } else {
+        op->address += op->chunkSize;
+        op->remaining = op->remaining.subspan(op->chunkSize);
+        op->polling = op->remaining.empty();
+        op->attempts = 0;
+    }
+
+    /*
+     * Retry (or send the next request) once the timer expires. In task context, this may be
+     * invoked from the timer task itself (if the bus completes requests synchronously) so we can't
+     * block on the timer command queue.
+     */
+    BaseType_t ok;
+
+    if(__get_IPSR()) {
+        BaseType_t woken{pdFALSE};
+        ok = xTimerStartFromISR(op->timer, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        ok = xTimerStart(op->timer, 0);
     }
 
-    return err;
+    REQUIRE(ok == pdPASS, "AT24CS32: %s", "failed to start timer");
 }
 
+/**
+ * @brief Retry timer callback
+ *
+ * Submits the request for the current step of the write. This runs in the context of the timer
+ * service task.
+ */
+void AT24CS32::AsyncWrite::TimerFired(TimerHandle_t timer) {
+    auto op = reinterpret_cast<AsyncWrite *>(pvTimerGetTimerID(timer));
+    op->submit();
+}
@@ -1,15 +1,15 @@
 #ifndef DRIVERS_I2CDEVICE_AT24CS32_H
 #define DRIVERS_I2CDEVICE_AT24CS32_H
 
+#include "Drivers/I2CBus.h"
+#include "Rtos/Rtos.h"
+
 #include <stddef.h>
 #include <stdint.h>
 
+#include <etl/array.h>
 #include <etl/span.h>
 
-namespace Drivers {
-class I2CBus;
-}
-
 namespace Drivers::I2CDevice {
 /**
  * @brief I²C EEPROM with serial number
@@ -18,8 +18,9 @@ namespace Drivers::I2CDevice {
  * number. This serial is preprogrammed from the factory and guaranteed unique among all devices in
  * the series.
  *
- * @remark Write accesses are rather slow; we always wait the maximum 5ms write delay, rather than
- *         polling for completion, for simplicity.
+ * @remark Write accesses are rather slow: each page takes up to 5ms to program. While busy, the
+ *         device does not acknowledge its address, so we poll it to detect when the write cycle
+ *         completed, rather than always waiting the maximum write delay.
  */
 class AT24CS32 {
     public:
@@ -33,6 +34,21 @@ class AT24CS32 {
              * The buffer may be too small (or too large) for the given request.
              */
             InvalidBuffer               = -5200,
+
+            /**
+             * @brief Write cycle timed out
+             *
+             * The device did not acknowledge its address again after a page write, within the
+             * maximum write cycle time.
+             */
+            WriteTimeout                = -5201,
+
+            /**
+             * @brief Asynchronous write in progress
+             *
+             * The write operation object passed is still busy with a previous write.
+             */
+            InUse                       = -5202,
         };
 
         /**
@@ -63,6 +79,83 @@ class AT24CS32 {
          */
         constexpr static const uint8_t kSerialAddressOffset{0b0001000};
 
+        /**
+         * @brief Interval between polls for write completion, in ticks
+         */
+        constexpr static const TickType_t kPollInterval{pdMS_TO_TICKS(1)};
+
+        /**
+         * @brief Maximum number of times to poll for write completion
+         *
+         * This is roughly twice the maximum write cycle time (5ms) after which the device is
+         * considered to be unresponsive.
+         */
+        constexpr static const size_t kMaxPollAttempts{10};
+
+        /**
+         * @brief State of an asynchronous write
+         *
+         * Holds all state of a write that's performed in the background by writeDataAsync(),
+         * including the bus request and the timer used to pace polling the device. Each object
+         * may be used for one write at a time, but may be reused once the write has completed.
+         *
+         * @remark The object must remain valid until the write has completed.
+         */
+        class AsyncWrite {
+            friend class AT24CS32;
+
+            public:
+                AsyncWrite();
+                ~AsyncWrite();
+
+                /**
+                 * @brief Check whether a write is in progress
+                 */
+                inline bool isBusy() const {
+                    return __atomic_load_n(&this->busy, __ATOMIC_RELAXED);
+                }
+
+            private:
+                void submit();
+                void finish(const int status);
+
+                static void RequestCompleted(const int status, void *ctx);
+                static void TimerFired(TimerHandle_t timer);
+
+            private:
+                /// Device being written to
+                const AT24CS32 *device{nullptr};
+                /// Set while a write is in progress
+                bool busy{false};
+                /// Set once all pages are written, and we're waiting for the last write cycle
+                bool polling{false};
+                /// Number of times the device did not acknowledge the current request
+                uint8_t attempts{0};
+
+                /// Memory address of the current page write
+                uint16_t address{0};
+                /// Data remaining to be written, starting with the current page
+                etl::span<const uint8_t> remaining;
+                /// Number of bytes written by the current page write
+                size_t chunkSize{0};
+
+                /// Callback to invoke when the write completes
+                I2CBus::CompletionCallback callback{nullptr};
+                /// Context for the completion callback
+                void *callbackContext{nullptr};
+
+                /// Memory address for the current request
+                etl::array<uint8_t, 2> addressBuf;
+                /// Transactions of the current request
+                etl::array<I2CBus::Transaction, 2> txns;
+                /// Bus request for the current page write (or poll)
+                I2CBus::Request request;
+
+                /// Timer to delay retrying a request the device did not acknowledge
+                TimerHandle_t timer;
+                StaticTimer_t timerBuf;
+        };
+
     public:
         /**
          * @brief Initialize the EEPROM
@@ -92,8 +185,9 @@ class AT24CS32 {
         /**
          * @brief Write to the EEPROM array
          *
-         * Writes data to the EEPROM. Internally, this attempts to use page writes for maximum
-         * efficiency.
+         * Writes data to the EEPROM, split into page writes. Rather than waiting the worst case
+         * write cycle time after each page, the next page is written as soon as the device
+         * acknowledges its address again, indicating that the previous write cycle completed.
          *
          * @param address Starting address for the write
          * @param data Data to write to the memory array
@@ -102,50 +196,14 @@ class AT24CS32 {
          *
          * @remark There is no way to check whether the device is write protected, other than to
          *         read back the value of the memory array after attempting a write.
+         *
+         * @remark The call returns once the write cycle of the last page completed, so the data
+         *         may be read back immediately.
          */
-        int writeData(uint16_t address, etl::span<const uint8_t> data) {
-            int err;
+        int writeData(const uint16_t address, etl::span<const uint8_t> data);
 
-            size_t offset{0};
-
-            // write partial start page
-            if(address & (kPageSize - 1)) {
-                const auto bytes = kPageSize - (address & (kPageSize - 1));
-                err = PageWrite(this->bus, this->deviceAddress, address, data, bytes);
-                if(err) {
-                    return err;
-                }
-
-                offset += bytes;
-            }
-
-            // write full pages
-            const auto fullPages = (data.size() - offset) / kPageSize;
-            if(fullPages) {
-                for(size_t page = 0; page < fullPages; page++) {
-                    etl::span<const uint8_t> subspan(data.begin() + offset, kPageSize);
-
-                    err = PageWrite(this->bus, this->deviceAddress, address + offset, subspan, kPageSize);
-                    if(err) {
-                        return err;
-                    }
-                    offset += kPageSize;
-                }
-            }
-
-            // write any remaining partial page
-            if(offset < data.size()) {
-                etl::span<const uint8_t> subspan(data.begin() + offset, data.size() - offset);
-                err = PageWrite(this->bus, this->deviceAddress, address + offset, subspan,
-                        subspan.size());
-                if(err) {
-                    return err;
-                }
-            }
-
-            // if we get here, assume success
-            return 0;
-        }
+        int writeDataAsync(AsyncWrite &op, const uint16_t address, etl::span<const uint8_t> data,
+                I2CBus::CompletionCallback callback, void *callbackContext);
 
         /**
          * @brief Read serial number
@@ -164,7 +222,24 @@ class AT24CS32 {
         static int Read(Drivers::I2CBus *bus, const uint8_t deviceAddress, const uint16_t start,
                 etl::span<uint8_t> buffer);
         static int PageWrite(Drivers::I2CBus *bus, const uint8_t deviceAddress,
-                const uint16_t start, etl::span<const uint8_t> buffer, const size_t numBytes = 0);
+                const uint16_t start, etl::span<const uint8_t> buffer);
+        static int WaitForWrite(Drivers::I2CBus *bus, const uint8_t deviceAddress);
+        static int PerformPolled(Drivers::I2CBus *bus, etl::span<const I2CBus::Transaction> txns);
+
+        /**
+         * @brief Get the number of bytes that may be written in a single page write
+         *
+         * @param address Starting address of the write
+         * @param remaining Number of bytes left to write
+         */
+        static constexpr inline size_t GetChunkSize(const uint16_t address, const size_t remaining) {
+            const auto pageRemaining = kPageSize - (address & (kPageSize - 1));
+            return (remaining < pageRemaining) ? remaining : pageRemaining;
+        }
+
+        static etl::span<const I2CBus::Transaction> PrepareWrite(
+                etl::array<uint8_t, 2> &addressBuf, etl::array<I2CBus::Transaction, 2> &txns,
+                const uint8_t deviceAddress, const uint16_t start, etl::span<const uint8_t> data);
 
     private:
         /// Parent bus
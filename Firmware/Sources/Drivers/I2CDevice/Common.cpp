@@ -3,6 +3,8 @@
 #include "Drivers/I2CBus.h"
 #include "Log/Logger.h"
 
+#include <etl/array.h>
+
 using namespace Drivers::I2CDevice;
 
 /**
@@ -14,11 +16,12 @@ using namespace Drivers::I2CDevice;
  * @param deviceAddress Address of I²C device
  * @param reg Register to write
  * @param value 8-bit value to write to register
+ * @param priority Bus priority of the request
  *
  * @return 0 on success, or an error code
  */
 int Common::WriteRegister(I2CBus *bus, const uint8_t deviceAddress, const uint8_t reg,
-        const uint8_t value) {
+        const uint8_t value, const I2CBus::Priority priority) {
     etl::array<uint8_t, 2> request{
         reg, value,
     };
@@ -32,7 +35,48 @@ int Common::WriteRegister(I2CBus *bus, const uint8_t deviceAddress, const uint8_
         },
     }};
 
-    return bus->perform(txns);
+    return bus->perform(txns, priority);
+}
+
+/**
+ * @brief Write consecutive registers
+ *
+ * Write multiple registers in one transaction, relying on the device to auto-increment the
+ * register address after each byte.
+ *
+ * @param bus I²C bus the device is connected to
+ * @param deviceAddress Address of I²C device
+ * @param first First register to write
+ * @param values Values to write to the registers, starting at the first register
+ * @param priority Bus priority of the request
+ *
+ * @return 0 on success, or an error code
+ */
+int Common::WriteRegisters(I2CBus *bus, const uint8_t deviceAddress, const uint8_t first,
+        etl::span<const uint8_t> values, const I2CBus::Priority priority) {
+    etl::array<uint8_t, 1> request{
+        first
+    };
+
+    // the payload is sent directly out of the caller's buffer, without re-addressing the device
+    etl::array<I2CBus::Transaction, 2> txns{{
+        {
+            .address = deviceAddress,
+            .read = 0,
+            .length = request.size(),
+            .data = request
+        },
+        {
+            .address = deviceAddress,
+            .read = 0,
+            .continuation = 1,
+            .skipRestart = 1,
+            .length = static_cast<uint16_t>(values.size()),
+            .data = {const_cast<uint8_t *>(values.data()), values.size()}
+        },
+    }};
+
+    return bus->perform(txns, priority);
 }
 
 /**
@@ -44,11 +88,12 @@ int Common::WriteRegister(I2CBus *bus, const uint8_t deviceAddress, const uint8_
  * @param deviceAddress Address of I²C device
  * @param reg Register to read
  * @param outValue Variable to receive the read data; not modified if the transaction fails.
+ * @param priority Bus priority of the request
  *
  * @return 0 on success, or an error code
  */
 int Common::ReadRegister(I2CBus *bus, const uint8_t deviceAddress, const uint8_t reg,
-        uint8_t &outValue) {
+        uint8_t &outValue, const I2CBus::Priority priority) {
     int err;
 
     etl::array<uint8_t, 1> request{
@@ -74,7 +119,7 @@ int Common::ReadRegister(I2CBus *bus, const uint8_t deviceAddress, const uint8_t
         },
     }};
 
-    err = bus->perform(txns);
+    err = bus->perform(txns, priority);
 
     if(!err) {
         outValue = reply[0];
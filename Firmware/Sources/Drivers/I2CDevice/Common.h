@@ -4,9 +4,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
-namespace Drivers {
-class I2CBus;
-}
+#include <etl/span.h>
+
+#include "Drivers/I2CBus.h"
 
 namespace Drivers::I2CDevice {
 /**
@@ -17,9 +17,13 @@ namespace Drivers::I2CDevice {
 class Common {
     public:
         static int WriteRegister(I2CBus *bus, const uint8_t deviceAddress, const uint8_t reg,
-                const uint8_t value);
+                const uint8_t value, const I2CBus::Priority priority = I2CBus::Priority::Normal);
         static int ReadRegister(I2CBus *bus, const uint8_t deviceAddress, const uint8_t reg,
-                uint8_t &outValue);
+                uint8_t &outValue, const I2CBus::Priority priority = I2CBus::Priority::Normal);
+
+        static int WriteRegisters(I2CBus *bus, const uint8_t deviceAddress, const uint8_t first,
+                etl::span<const uint8_t> values,
+                const I2CBus::Priority priority = I2CBus::Priority::Normal);
 };
 }
 
@@ -58,12 +58,26 @@ int DAC60501::setGain(const Gain newGain) {
 /**
  * @brief Write DAC register
  *
- * Transfers 16 bits of data to a DAC register.
+ * Update the register cache, and write the register to the device if its value changed.
  */
 int DAC60501::writeRegister(const Reg r, const uint16_t value) {
+    this->cache.write(static_cast<uint8_t>(r), value);
+
+    // the device doesn't support writing multiple registers in one transaction
+    return this->cache.flush([this](auto first, auto values) {
+        return this->writeRegisterUncached(first, values[0]);
+    }, 1);
+}
+
+/**
+ * @brief Write DAC register to the device
+ *
+ * Transfers 16 bits of data to a DAC register.
+ */
+int DAC60501::writeRegisterUncached(const uint8_t r, const uint16_t value) {
     // build request in buffer
     etl::array<uint8_t, 3> buffer{{
-        static_cast<uint8_t>(r), static_cast<uint8_t>((value & 0xFF00) >> 8),
+        r, static_cast<uint8_t>((value & 0xFF00) >> 8),
         static_cast<uint8_t>(value & 0x00FF)
     }};
 
@@ -77,18 +91,22 @@ int DAC60501::writeRegister(const Reg r, const uint16_t value) {
         },
     }};
 
-    return this->bus->perform(txns);
+    return this->bus->perform(txns, I2CBus::Priority::High);
 }
 
 /**
  * @brief Read DAC register
  *
- * Reads the DAC register specified.
+ * Reads the DAC register specified; cached registers are only read from the device once.
  *
  * @param reg Register to read
  * @param outValue The 16-bit quantity read from the register
  */
 int DAC60501::readRegister(const Reg r, uint16_t &outValue) {
+    if(this->cache.read(static_cast<uint8_t>(r), outValue)) {
+        return 0;
+    }
+
     etl::array<uint8_t, 2> buffer;
     etl::array<uint8_t, 1> txBuffer{{
         static_cast<uint8_t>(r)
@@ -111,13 +129,14 @@ int DAC60501::readRegister(const Reg r, uint16_t &outValue) {
         },
     }};
 
-    const auto err = this->bus->perform(txns);
+    const auto err = this->bus->perform(txns, I2CBus::Priority::High);
     if(err) {
         return err;
     }
 
     // extract value
     outValue = (buffer[0]) << 8 | (buffer[1]);
+    this->cache.fill(static_cast<uint8_t>(r), outValue);
 
     return 0;
 }
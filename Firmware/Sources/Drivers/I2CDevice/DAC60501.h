@@ -4,8 +4,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "RegisterCache.h"
 #include "Rtos/Rtos.h"
 
+#include <etl/array.h>
+
 namespace Drivers {
 class I2CBus;
 }
@@ -38,10 +41,12 @@ class DAC60501 {
         /**
          * @brief Reset the DAC
          *
-         * Perform a soft reset.
+         * Perform a soft reset. All registers return to their default values, so the register
+         * cache is invalidated.
          */
         inline int reset() {
             auto err =  this->writeRegister(Reg::Trigger, 0b1010);
+            this->cache.invalidateAll();
             if(!err) {
                 vTaskDelay(pdMS_TO_TICKS(5));
             }
@@ -51,7 +56,8 @@ class DAC60501 {
         /**
          * @brief Set DAC output (raw code)
          *
-         * Sets the raw DAC output code value
+         * Sets the raw DAC output code value. If the code is unchanged, no bus transaction is
+         * performed.
          *
          * @param code Raw DAC code to set
          *
@@ -105,6 +111,16 @@ class DAC60501 {
         int writeRegister(const Reg r, const uint16_t value);
         int readRegister(const Reg r, uint16_t &outValue);
 
+        int writeRegisterUncached(const uint8_t r, const uint16_t value);
+
+        /// Number of device registers
+        constexpr static const size_t kNumRegisters{9};
+
+        /// Registers never cached: the trigger register is a command, status is updated by the DAC
+        constexpr static const etl::array<uint8_t, 2> kVolatileRegisters{{
+            static_cast<uint8_t>(Reg::Trigger), static_cast<uint8_t>(Reg::Status),
+        }};
+
     private:
         /// Parent bus
         Drivers::I2CBus *bus;
@@ -113,6 +129,9 @@ class DAC60501 {
 
         /// current gain mode
         Gain gain;
+
+        /// Shadow copy of the device registers
+        RegisterCache<uint16_t, kNumRegisters> cache{kVolatileRegisters};
 };
 }
 
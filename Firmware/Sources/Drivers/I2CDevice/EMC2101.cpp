@@ -1,10 +1,9 @@
 #include "EMC2101.h"
+#include "Common.h"
 
 #include "Drivers/I2CBus.h"
 #include "Log/Logger.h"
 
-#include <etl/array.h>
-
 using namespace Drivers::I2CDevice;
 
 /**
@@ -101,10 +100,9 @@ void EMC2101::applyConfig(const Config &conf) {
 }
 
 /**
- * @brief Write a register in the device.
+ * @brief Write a register
  *
- * This performs the "write byte" protocol. This consists of sending the register address and
- * register data in one write transaction.
+ * Writes to cached registers are skipped if the register already holds the value.
  *
  * @param reg Register number to write
  * @param value Data to write to the register
@@ -112,27 +110,23 @@ void EMC2101::applyConfig(const Config &conf) {
  * @return 0 on success, or underlying bus error code
  */
 int EMC2101::writeRegister(const Regs reg, const uint8_t value) {
-    // build up the request
-    etl::array<uint8_t, 2> data{{
-        static_cast<uint8_t>(reg), value
-    }};
-
-    // send it
-    return this->bus->perform({{
-        {
-            .address = this->address,
-            .read = 0,
-            .length = 2,
-            .data = data
-        }
-    }});
+    const auto regNum = static_cast<uint8_t>(reg);
+
+    if(regNum >= kNumCachedRegisters) {
+        return this->writeRegisterUncached(regNum, value);
+    }
+
+    // SMBus only supports writing a single byte at a time
+    this->cache.write(regNum, value);
+    return this->cache.flush([this](auto first, auto values) {
+        return this->writeRegisterUncached(first, values[0]);
+    }, 1);
 }
 
 /**
- * @brief Read a register in the device.
+ * @brief Read a register
  *
- * This performs the "read byte" protocol. This consists of sending the register address,
- * performing a restart, then reading one byte.
+ * Cached registers are read from the device only the first time.
  *
  * @param reg Register number to read
  * @param outValue Variable to receive the register data
@@ -141,36 +135,50 @@ int EMC2101::writeRegister(const Regs reg, const uint8_t value) {
  */
 int EMC2101::readRegister(const Regs reg, uint8_t &outValue) {
     int err;
+    const auto regNum = static_cast<uint8_t>(reg);
 
-    // build up the request
-    etl::array<uint8_t, 1> request{{
-        static_cast<uint8_t>(reg)
-    }}, response;
-
-    // send it
-    err = this->bus->perform({{
-        {
-            .address = this->address,
-            .read = 0,
-            .length = 1,
-            .data = request
-        },
-        {
-            .address = this->address,
-            .read = 1,
-            .continuation = 1,
-            .length = 1,
-            .data = response
-        }
-    }});
+    if(this->cache.read(regNum, outValue)) {
+        return 0;
+    }
 
+    err = this->readRegisterUncached(regNum, outValue);
     if(!err) {
-        outValue = response[0];
+        this->cache.fill(regNum, outValue);
     }
 
     return err;
 }
 
+/**
+ * @brief Write a register in the device.
+ *
+ * This performs the "write byte" protocol. This consists of sending the register address and
+ * register data in one write transaction.
+ *
+ * @param reg Register number to write
+ * @param value Data to write to the register
+ *
+ * @return 0 on success, or underlying bus error code
+ */
+int EMC2101::writeRegisterUncached(const uint8_t reg, const uint8_t value) {
+    return Common::WriteRegister(this->bus, this->address, reg, value, I2CBus::Priority::Low);
+}
+
+/**
+ * @brief Read a register in the device.
+ *
+ * This performs the "read byte" protocol. This consists of sending the register address,
+ * performing a restart, then reading one byte.
+ *
+ * @param reg Register number to read
+ * @param outValue Variable to receive the register data
+ *
+ * @return 0 on success, or underlying bus error code
+ */
+int EMC2101::readRegisterUncached(const uint8_t reg, uint8_t &outValue) {
+    return Common::ReadRegister(this->bus, this->address, reg, outValue, I2CBus::Priority::Low);
+}
+
 
 
 /**
@@ -352,6 +360,7 @@ int EMC2101::setFanMode(const FanMode mode) {
     if(!err) {
         this->useFanTable = (mode == FanMode::Automatic);
     }
+
     return err;
 }
 
@@ -1,9 +1,12 @@
 #ifndef DRIVERS_I2CDEVICE_EMC2101_H
 #define DRIVERS_I2CDEVICE_EMC2101_H
 
+#include "RegisterCache.h"
+
 #include <stddef.h>
 #include <stdint.h>
 
+#include <etl/array.h>
 #include <etl/span.h>
 
 namespace Drivers {
@@ -325,6 +328,30 @@ class EMC2101 {
         int writeRegister(const Regs reg, const uint8_t value);
         int readRegister(const Regs reg, uint8_t &outValue);
 
+        int writeRegisterUncached(const uint8_t reg, const uint8_t value);
+        int readRegisterUncached(const uint8_t reg, uint8_t &outValue);
+
+        /**
+         * @brief Number of cached registers
+         *
+         * Covers all registers up to (and including) the fan lookup table; the remaining
+         * registers are either identification registers or only written once at startup.
+         */
+        constexpr static const size_t kNumCachedRegisters{0x60};
+
+        /**
+         * @brief Registers updated by the device
+         *
+         * Besides measurements and status, this includes the fan setting: the controller updates
+         * it itself while the fan lookup table is in use.
+         */
+        constexpr static const etl::array<uint8_t, 7> kVolatileRegisters{{
+            static_cast<uint8_t>(Regs::InternalTemp), static_cast<uint8_t>(Regs::ExternalTempHigh),
+            static_cast<uint8_t>(Regs::Status), static_cast<uint8_t>(Regs::ExternalTempLow),
+            static_cast<uint8_t>(Regs::FanSetting),
+            static_cast<uint8_t>(Regs::TachCountLow), static_cast<uint8_t>(Regs::TachCountHigh),
+        }};
+
     private:
         /**
          * @brief Is the fan control table used?
@@ -354,6 +381,9 @@ class EMC2101 {
          * The I²C bus to which the controller is connected.
          */
         Drivers::I2CBus *bus;
+
+        /// Shadow copy of the device registers
+        RegisterCache<uint8_t, kNumCachedRegisters> cache{kVolatileRegisters};
 };
 }
 
@@ -43,11 +43,106 @@ MCP3421::~MCP3421() {
  * @return 0 on success, or a negative error code
  */
 int MCP3421::read(int32_t &out) {
+    uint8_t status;
+    return this->readWithStatus(out, status);
+}
+
+/**
+ * @brief Read the latest conversion, and adjust the gain
+ *
+ * Read the most recent conversion result; this puts the device into continuous conversion mode
+ * if needed, so the read never waits for a conversion to complete. If the conversion result is
+ * new, the PGA gain is adjusted for the next conversion, based on the magnitude of the result:
+ *
+ * - At or above 7/8 of full scale, the gain is halved.
+ * - Below 3/8 of full scale, the gain is doubled.
+ *
+ * After a gain change, the first new conversion is discarded, since it may have been started
+ * with the previous gain. Until a conversion with the new gain is available, the previous sample
+ * is returned again (and marked as not being new.)
+ *
+ * @param out Variable to receive the sample; it carries the gain the conversion was made with
+ *
+ * @return 0 on success, or a negative error code
+ */
+int MCP3421::readAutoranging(Sample &out) {
+    int err;
+    int32_t code;
+    uint8_t status;
+
+    if(this->isOneShot) {
+        this->isOneShot = false;
+
+        err = this->updateConfig();
+        if(err) {
+            return err;
+        }
+    }
+
+    err = this->readWithStatus(code, status);
+    if(err) {
+        return err;
+    }
+
+    // output register wasn't updated, or conversion may have been made with the old gain
+    if(status & kConfigNotReady) {
+        out = this->lastSample;
+        out.isNew = false;
+        return 0;
+    } else if(this->autorangeDiscard) {
+        this->autorangeDiscard--;
+
+        out = this->lastSample;
+        out.isNew = false;
+        return 0;
+    }
+
+    // record the new sample
+    this->lastSample = {
+        .code = code,
+        .voltage = CodeToVoltage(code, this->depth, this->gain),
+        .gain = this->gain,
+        .isNew = true,
+    };
+    out = this->lastSample;
+
+    // then adjust the gain for the next conversion
+    const int32_t magnitude = (code < 0) ? -code : code;
+    const int32_t fullScale = DepthToFullScale(this->depth);
+    Gain newGain{this->gain};
+
+    if(magnitude >= (fullScale / 8) * kAutorangeUpper) {
+        newGain = LowerGain(this->gain);
+    } else if(magnitude < (fullScale / 8) * kAutorangeLower) {
+        newGain = HigherGain(this->gain);
+    }
+
+    if(newGain != this->gain) {
+        this->autorangeDiscard = 1;
+
+        err = this->setGain(newGain);
+        if(err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Read the latest conversion and the configuration register
+ *
+ * @param out Variable to receive the sign extended ADC code
+ * @param outStatus Variable to receive the configuration register (including the ready bit)
+ *
+ * @return 0 on success, or a negative error code
+ */
+int MCP3421::readWithStatus(int32_t &out, uint8_t &outStatus) {
     int err;
 
-    // read from device, based on the current sample depth
-    etl::array<uint8_t, 3> buffer;
-    const uint16_t bytesToRead = (this->depth == SampleDepth::Highest) ? 3 : 2;
+    // read from device, based on the current sample depth; the config register follows the data
+    etl::array<uint8_t, 4> buffer;
+    const uint16_t bytesToRead = (this->depth == SampleDepth::Highest) ? 4 : 3;
 
     etl::array<I2CBus::Transaction, 1> txns{{
         {
@@ -58,7 +153,7 @@ int MCP3421::read(int32_t &out) {
         },
     }};
 
-    err = this->bus->perform(txns);
+    err = this->bus->perform(txns, I2CBus::Priority::High);
     if(err) {
         return err;
     }
@@ -84,6 +179,7 @@ int MCP3421::read(int32_t &out) {
     }
 
     out = static_cast<int32_t>(temp);
+    outStatus = buffer[bytesToRead - 1];
     return 0;
 }
 
@@ -100,7 +196,7 @@ int MCP3421::updateConfig() {
     uint8_t reg{0};
 
     if(!this->isOneShot) {
-        reg |= (1 << 4);
+        reg |= kConfigContinuous;
     }
 
     reg |= (static_cast<uint8_t>(this->depth) & 0b11) << 2;
@@ -116,5 +212,5 @@ int MCP3421::updateConfig() {
         },
     }};
 
-    return this->bus->perform(txns);
+    return this->bus->perform(txns, I2CBus::Priority::High);
 }
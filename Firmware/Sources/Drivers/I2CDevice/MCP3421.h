@@ -26,6 +26,10 @@ namespace Drivers::I2CDevice {
  *
  * Lastly, the driver exposes the ability to place the device into either continuous or one
  * shot conversion mode.
+ *
+ * For inputs with a wide dynamic range, the autoranging read path adjusts the PGA gain based on
+ * the magnitude of the conversion results, with hysteresis so that it doesn't toggle between two
+ * gains; this gains up to 3 bits of resolution for small inputs, without reducing the sample rate.
  */
 class MCP3421 {
     public:
@@ -70,6 +74,20 @@ class MCP3421 {
             x8                          = 0b11,
         };
 
+        /**
+         * @brief Autoranged conversion result
+         */
+        struct Sample {
+            /// Raw, sign extended ADC code
+            int32_t code{0};
+            /// Input voltage at the ADC (µV)
+            int32_t voltage{0};
+            /// PGA gain the conversion was made with
+            Gain gain{Gain::Unity};
+            /// Whether this is a new conversion since the previous read
+            bool isNew{false};
+        };
+
     public:
         MCP3421(Drivers::I2CBus *bus, const uint8_t address,
                 const SampleDepth depth = SampleDepth::Low, const Gain gain = Gain::Unity);
@@ -117,7 +135,20 @@ class MCP3421 {
             return this->updateConfig();
         }
 
+        /**
+         * @brief Select the conversion mode
+         *
+         * In one shot mode, the ADC enters standby after each conversion.
+         *
+         * @return 0 on success, or a negative error code
+         */
+        inline int setOneShot(const bool newOneShot) {
+            this->isOneShot = newOneShot;
+            return this->updateConfig();
+        }
+
         int read(int32_t &out);
+        int readAutoranging(Sample &out);
 
         /**
          * @brief Read the input voltage at the ADC
@@ -222,6 +253,13 @@ class MCP3421 {
             }
         }
 
+        /**
+         * @brief Get the largest positive output code for a given sample depth
+         */
+        static constexpr inline int32_t DepthToFullScale(const SampleDepth depth) {
+            return (1 << (11 + (2 * static_cast<uint8_t>(depth)))) - 1;
+        }
+
         /**
          * @brief Convert a raw ADC reading to a voltage
          *
@@ -243,6 +281,28 @@ class MCP3421 {
 
     private:
         int updateConfig();
+        int readWithStatus(int32_t &out, uint8_t &outStatus);
+
+    private:
+        /// Conversion not ready bit in the configuration register
+        constexpr static const uint8_t kConfigNotReady{(1 << 7)};
+        /// Conversion mode bit in the configuration register (1 = continuous)
+        constexpr static const uint8_t kConfigContinuous{(1 << 4)};
+
+        /**
+         * @brief Autoranging upper threshold (fraction of full scale, in 1/8ths)
+         *
+         * When the magnitude of a conversion is at or above this, the gain is reduced.
+         */
+        constexpr static const int32_t kAutorangeUpper{7};
+        /**
+         * @brief Autoranging lower threshold (fraction of full scale, in 1/8ths)
+         *
+         * When the magnitude of a conversion is below this, the gain is increased. Since each
+         * gain step doubles the code, this must be less than half the upper threshold to provide
+         * hysteresis.
+         */
+        constexpr static const int32_t kAutorangeLower{3};
 
     private:
         /// Parent bus
@@ -256,6 +316,11 @@ class MCP3421 {
         Gain gain{Gain::Unity};
         /// Is one shot conversion mode enabled?
         bool isOneShot{false};
+
+        /// Most recent autoranged sample
+        Sample lastSample;
+        /// Number of new conversions to discard after a gain change
+        uint8_t autorangeDiscard{0};
 };
 }
 
@@ -25,15 +25,14 @@ PCA9543A::PCA9543A(const uint8_t address, Drivers::I2CBus *parent) : bus(parent)
     err = this->readStatus(status);
     REQUIRE(!err, "%s: failed to %s: %d", "PCA9543A", "read status", err);
 
-    if(status & (1 << 0)) {
-        this->activeBus = 0;
-    } else if(status & (1 << 1)) {
-        this->activeBus = 1;
-    }
     // if both busses are active, disable them
-    else if((status & 0b11) == 0b11) {
+    if((status & 0b11) == 0b11) {
         err = this->sendPacket(0);
         REQUIRE(!err, "%s: failed to %s: %d", "PCA9543A", "reset port", err);
+    } else if(status & (1 << 0)) {
+        this->activeBus = 0;
+    } else if(status & (1 << 1)) {
+        this->activeBus = 1;
     }
 }
 
@@ -185,31 +184,67 @@ int PCA9543A::readStatus(uint8_t &outStatus) {
  * This will ensure that the mux has activated the appropriate channel, then forwards the actual
  * transaction to the parent bus we're connected to. The bus lock on the mux is held for the entire
  * duration of the call.
+ *
+ * The mux remembers the active channel, so the select write is only required when switching
+ * channels; in that case, it's prepended to the downstream transactions and both are performed as
+ * a single request on the upstream bus. If any part of such a request fails, the mux state is
+ * unknown, so the active channel is forgotten and will be selected again next time.
  */
-int PCA9543A::DownstreamBus::perform(etl::span<const Transaction> transactions) {
+int PCA9543A::DownstreamBus::perform(etl::span<const Transaction> transactions,
+        const Priority priority) {
     BaseType_t ok;
     int err;
+    auto mux = this->parent;
 
     // acquire bus lock
-    ok = xSemaphoreTakeRecursive(this->parent->busLock, portMAX_DELAY);
+    ok = xSemaphoreTakeRecursive(mux->busLock, portMAX_DELAY);
     if(ok != pdTRUE) {
         return -1;
     }
 
-    // switch channel, if needed
-    if(this->parent->activeBus != this->channel) {
-        err = this->parent->activateBus(this->channel);
-        if(err) {
-            goto beach;
+    mux->stats.numBatches++;
+
+    // channel already active: forward transactions as-is
+    if(mux->activeBus == this->channel) {
+        err = mux->bus->perform(transactions, priority);
+    }
+    // small batch: select and transactions in one request
+    else if(transactions.size() <= kMaxCombinedTransactions) {
+        etl::array<uint8_t, 1> select{{static_cast<uint8_t>(1U << this->channel)}};
+        etl::array<Transaction, kMaxCombinedTransactions + 1> combined;
+
+        combined[0] = {
+            .address = mux->address,
+            .read = 0,
+            .length = 1,
+            .data = select
+        };
+        for(size_t i = 0; i < transactions.size(); i++) {
+            combined[i + 1] = transactions[i];
+        }
+
+        mux->stats.numSelects++;
+        mux->activeBus = this->channel;
+
+        err = mux->bus->perform({combined.data(), transactions.size() + 1}, priority);
+    }
+    // otherwise, switch channel first
+    else {
+        mux->stats.numSelects++;
+
+        err = mux->activateBus(this->channel);
+        if(!err) {
+            err = mux->bus->perform(transactions, priority);
         }
     }
 
-    // perform txn
-    err = this->parent->bus->perform(transactions);
+    // on failure, we no longer know which channel the mux has selected
+    if(err && mux->activeBus) {
+        mux->activeBus = etl::nullopt;
+        mux->stats.numInvalidations++;
+    }
 
     // release bus lock
-beach:;
-    xSemaphoreGiveRecursive(this->parent->busLock);
+    xSemaphoreGiveRecursive(mux->busLock);
     return err;
 }
-
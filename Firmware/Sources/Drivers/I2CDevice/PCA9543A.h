@@ -50,7 +50,8 @@ class PCA9543A {
                     channel(channel) {}
 
             public:
-                int perform(etl::span<const Transaction> transactions) override;
+                int perform(etl::span<const Transaction> transactions,
+                        const Priority priority = Priority::Normal) override;
 
             private:
                 /**
@@ -70,6 +71,28 @@ class PCA9543A {
                 uint8_t channel;
         };
 
+    public:
+        /**
+         * @brief Channel selection statistics
+         */
+        struct Stats {
+            /// Number of transaction batches performed on downstream busses
+            uint32_t numBatches{0};
+            /// Number of batches that required switching channels
+            uint32_t numSelects{0};
+            /// Number of times the selected channel was invalidated due to an error
+            uint32_t numInvalidations{0};
+        };
+
+        /**
+         * @brief Maximum downstream batch size for combined selection
+         *
+         * Batches of up to this many transactions are performed in a single request to the
+         * upstream bus together with the channel select write; larger batches are performed as
+         * two separate requests.
+         */
+        constexpr static const size_t kMaxCombinedTransactions{8};
+
     public:
         PCA9543A(const uint8_t address, Drivers::I2CBus *parent);
         ~PCA9543A();
@@ -88,6 +111,23 @@ class PCA9543A {
         int activateBus(const uint8_t bus);
         int deactivateBus();
 
+        /**
+         * @brief Forget the currently active bus
+         *
+         * Use this if the mux may have been reset behind the driver's back; the next downstream
+         * transaction will select the channel again.
+         */
+        inline void invalidateActiveBus() {
+            this->activeBus = etl::nullopt;
+        }
+
+        /**
+         * @brief Get channel selection statistics
+         */
+        constexpr inline const Stats &getStats() const {
+            return this->stats;
+        }
+
         /**
          * @brief Get downstream bus 0
          */
@@ -112,6 +152,8 @@ class PCA9543A {
         uint8_t address;
         /// Currently active bus
         etl::optional<uint8_t> activeBus;
+        /// Channel selection statistics
+        Stats stats;
 
         /**
          * @brief Bus lock
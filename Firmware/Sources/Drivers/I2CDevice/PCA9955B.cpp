@@ -47,7 +47,7 @@ PCA9955B::PCA9955B(Drivers::I2CBus *bus, const uint8_t busAddress, const uint16_
             .data = mode,
         },
     }};
-    err = this->bus->perform(modeTxns);
+    err = this->bus->perform(modeTxns, I2CBus::Priority::Low);
     REQUIRE(!err, "%s: failed to set %s (%d)", "PCA9955B", "mode registers", err);
 
     /*
@@ -71,7 +71,7 @@ PCA9955B::PCA9955B(Drivers::I2CBus *bus, const uint8_t busAddress, const uint16_
             .data = irefBuf,
         },
     }};
-    err = this->bus->perform(irefBufTxns);
+    err = this->bus->perform(irefBufTxns, I2CBus::Priority::Low);
     REQUIRE(!err, "%s: failed to set %s (%d)", "PCA9955B", "IREF", err);
 
     /*
@@ -111,7 +111,7 @@ PCA9955B::PCA9955B(Drivers::I2CBus *bus, const uint8_t busAddress, const uint16_
             .data = ledMode,
         },
     }};
-    err = this->bus->perform(ledModeTxns);
+    err = this->bus->perform(ledModeTxns, I2CBus::Priority::Low);
     REQUIRE(!err, "%s: failed to set %s (%d)", "PCA9955B", "gradation/channel mode", err);
 }
 
@@ -137,7 +137,7 @@ PCA9955B::~PCA9955B() {
         },
     }};
 
-    err = this->bus->perform(txns);
+    err = this->bus->perform(txns, I2CBus::Priority::Low);
     if(err) {
         Logger::Warning("%s: failed to set %s (%d)", "PCA9955B", "PWMALL", err);
     }
@@ -169,6 +169,6 @@ int PCA9955B::setBrightness(const uint8_t channel, const float level) {
         },
     }};
 
-    return this->bus->perform(txns);
+    return this->bus->perform(txns, I2CBus::Priority::Low);
 }
 
@@ -11,7 +11,8 @@ using namespace Drivers::I2CDevice;
  * All pins are configured as inputs (with optional inversion) or outputs.
  */
 PI4IOE5V9536::PI4IOE5V9536(Drivers::I2CBus *bus, etl::span<const PinConfig, kIoLines> pins,
-        const uint8_t address) : bus(bus), deviceAddress(address) {
+        const uint8_t address, const I2CBus::Priority priority) : bus(bus),
+        deviceAddress(address), priority(priority) {
     int err;
     uint8_t invert{0}, config{0};
 
@@ -37,10 +38,11 @@ PI4IOE5V9536::PI4IOE5V9536(Drivers::I2CBus *bus, etl::span<const PinConfig, kIoL
         }
     }
 
-    err = this->writeRegister(Register::OutputPort, this->output);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "PI4IOE5V9536", "OutputPort", err);
-    err = this->writeRegister(Register::InputInvert, invert);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "PI4IOE5V9536", "InputInvert", err);
-    err = this->writeRegister(Register::PinConfig, config);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "PI4IOE5V9536", "PinConfig", err);
+    // outputs are written before the pin configuration, so they don't glitch when enabled
+    this->cache.write(static_cast<uint8_t>(Register::OutputPort), this->output);
+    this->cache.write(static_cast<uint8_t>(Register::InputInvert), invert);
+    this->cache.write(static_cast<uint8_t>(Register::PinConfig), config);
+
+    err = this->flush();
+    REQUIRE(!err, "%s: failed to write register %s (%d)", "PI4IOE5V9536", "config", err);
 }
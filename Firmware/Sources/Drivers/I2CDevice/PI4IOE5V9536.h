@@ -2,15 +2,14 @@
 #define DRIVERS_I2CDEVICE_PI4IOE5V9536_H
 
 #include "Common.h"
+#include "RegisterCache.h"
+#include "Drivers/I2CBus.h"
 
 #include <stdint.h>
 
+#include <etl/array.h>
 #include <etl/span.h>
 
-namespace Drivers {
-class I2CBus;
-}
-
 namespace Drivers::I2CDevice {
 /**
  * @brief PI4IOE5V9536 – 4-bit IO expander with I²C interface
@@ -72,7 +71,8 @@ class PI4IOE5V9536 {
 
     public:
         PI4IOE5V9536(Drivers::I2CBus *bus, etl::span<const PinConfig, kIoLines> pins,
-                const uint8_t address = 0b100'0001);
+                const uint8_t address = 0b100'0001,
+                const I2CBus::Priority priority = I2CBus::Priority::Normal);
 
         /**
          * @brief Set the state of an output pin
@@ -107,7 +107,7 @@ class PI4IOE5V9536 {
             }
 
             this->output |= bits;
-            return this->writeRegister(Register::OutputPort, static_cast<uint8_t>(this->output & 0xFF));
+            return this->writeRegister(Register::OutputPort, this->output);
         }
 
         /**
@@ -125,7 +125,7 @@ class PI4IOE5V9536 {
             }
 
             this->output &= ~bits;
-            return this->writeRegister(Register::OutputPort, static_cast<uint8_t>(this->output & 0xFF));
+            return this->writeRegister(Register::OutputPort, this->output);
         }
 
         /**
@@ -154,12 +154,27 @@ class PI4IOE5V9536 {
         /**
          * @brief Write a device register
          *
+         * The write is skipped if the register already holds this value.
+         *
          * @param reg Device register to write
          * @param value Data to write into the register
          */
         int writeRegister(const Register reg, const uint8_t value) {
-            return Common::WriteRegister(this->bus, this->deviceAddress, static_cast<uint8_t>(reg),
-                    value);
+            this->cache.write(static_cast<uint8_t>(reg), value);
+            return this->flush();
+        }
+
+        /**
+         * @brief Write all modified registers to the device
+         *
+         * The device doesn't auto-increment the register address, so each register is written
+         * individually.
+         */
+        int flush() {
+            return this->cache.flush([this](auto reg, auto values) {
+                return Common::WriteRegister(this->bus, this->deviceAddress, reg, values[0],
+                        this->priority);
+            }, 1);
         }
 
         /**
@@ -170,14 +185,27 @@ class PI4IOE5V9536 {
          */
         int readRegister(const Register reg, uint8_t &outValue) {
             return Common::ReadRegister(this->bus, this->deviceAddress, static_cast<uint8_t>(reg),
-                    outValue);
+                    outValue, this->priority);
         }
 
+        /// Number of device registers
+        constexpr static const size_t kNumRegisters{4};
+
+        /// Volatile registers (the input port reflects the pin state)
+        constexpr static const etl::array<uint8_t, 1> kVolatileRegisters{{
+            static_cast<uint8_t>(Register::InputPort),
+        }};
+
     private:
         /// Parent bus
         Drivers::I2CBus *bus;
         /// Device address
         uint8_t deviceAddress;
+        /// Bus priority of register accesses
+        I2CBus::Priority priority;
+
+        /// Shadow copy of the device registers
+        RegisterCache<uint8_t, kNumRegisters> cache{kVolatileRegisters};
 
         /**
          * @brief Output value
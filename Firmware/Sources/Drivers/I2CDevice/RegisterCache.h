@@ -0,0 +1,227 @@
+#ifndef DRIVERS_I2CDEVICE_REGISTERCACHE_H
+#define DRIVERS_I2CDEVICE_REGISTERCACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/array.h>
+#include <etl/bitset.h>
+#include <etl/span.h>
+
+namespace Drivers::I2CDevice {
+/**
+ * @brief Shadow register cache
+ *
+ * Holds a copy of a device's registers, so that drivers can avoid reading back registers that
+ * only the firmware ever modifies, and skip writes that wouldn't change the register's value.
+ *
+ * Writes are staged in the cache, marking the register as dirty; they're then written to the
+ * device in one go by flush(), which combines consecutive dirty registers into a single burst
+ * (for devices that support auto-incrementing the register address.)
+ *
+ * Registers whose value may be changed by the device itself (status, input or measurement
+ * registers) as well as command registers that have side effects when written should be marked
+ * as volatile: they're never served from the cache, and writes to them always go to the device.
+ *
+ * @tparam Value Type of a single register value
+ * @tparam kNumRegisters Number of registers in the cache, starting at register 0. Registers above
+ *         this are not cached, and must be accessed directly.
+ *
+ * @remark The cache is not thread safe; the owning driver must serialize accesses to it.
+ */
+template<typename Value, size_t kNumRegisters>
+class RegisterCache {
+    static_assert(kNumRegisters && kNumRegisters <= 256, "invalid register count");
+
+    public:
+        /**
+         * @brief Initialize the register cache
+         *
+         * All registers start out invalid, so that the first read or write of each goes to the
+         * device.
+         *
+         * @param volatileRegs List of registers that must not be cached
+         */
+        RegisterCache(etl::span<const uint8_t> volatileRegs = {}) {
+            for(const auto reg : volatileRegs) {
+                if(reg < kNumRegisters) {
+                    this->volatileRegs.set(reg);
+                }
+            }
+        }
+
+        /**
+         * @brief Check whether a register can be served from the cache
+         *
+         * @return Whether the register is within the cache, and not volatile
+         */
+        constexpr inline bool isCacheable(const uint8_t reg) const {
+            return (reg < kNumRegisters) && !this->volatileRegs.test(reg);
+        }
+
+        /**
+         * @brief Read a register from the cache
+         *
+         * @param reg Register to read
+         * @param outValue Variable to receive the cached register value
+         *
+         * @return Whether the cache holds a valid value for the register; if not, the register
+         *         must be read from the device (and stored with fill())
+         */
+        bool read(const uint8_t reg, Value &outValue) const {
+            if(!this->isCacheable(reg) || !this->valid.test(reg)) {
+                return false;
+            }
+
+            outValue = this->values[reg];
+            return true;
+        }
+
+        /**
+         * @brief Store a value read from the device
+         *
+         * @param reg Register that was read
+         * @param value Value read from the device
+         */
+        void fill(const uint8_t reg, const Value value) {
+            if(!this->isCacheable(reg)) {
+                return;
+            }
+
+            this->values[reg] = value;
+            this->valid.set(reg);
+            this->dirty.reset(reg);
+        }
+
+        /**
+         * @brief Stage a register write
+         *
+         * Update the shadow copy of the register. If this changes the register's value (or the
+         * register's current value is unknown, or it is volatile) it's marked dirty, so that the
+         * next flush writes it to the device.
+         *
+         * @param reg Register to write; it must be within the cache
+         * @param value New register value
+         *
+         * @return Whether the register is dirty
+         */
+        bool write(const uint8_t reg, const Value value) {
+            if(reg >= kNumRegisters) {
+                return false;
+            }
+
+            if(!this->isCacheable(reg) || !this->valid.test(reg) || this->values[reg] != value) {
+                this->values[reg] = value;
+                this->dirty.set(reg);
+            }
+
+            return this->dirty.test(reg);
+        }
+
+        /**
+         * @brief Stage a read-modify-write of a cached register
+         *
+         * @param reg Register to modify; its value must be valid in the cache
+         * @param mask Bits to modify
+         * @param bits New values for the bits in the mask
+         *
+         * @return Whether the register is dirty, or `false` if the register isn't cached
+         */
+        bool update(const uint8_t reg, const Value mask, const Value bits) {
+            Value temp;
+            if(!this->read(reg, temp)) {
+                return false;
+            }
+
+            return this->write(reg, (temp & ~mask) | (bits & mask));
+        }
+
+        /**
+         * @brief Write all dirty registers to the device
+         *
+         * Consecutive dirty registers are combined into bursts, up to the specified maximum
+         * length. Registers are written in increasing address order.
+         *
+         * @param writer Function invoked to write a burst, with the signature
+         *        `int(const uint8_t first, etl::span<const Value> values)`. It returns 0 on
+         *        success, or a negative error code.
+         * @param maxBurst Maximum number of registers to write in a single burst
+         *
+         * @return 0 on success, or the error code returned by the writer. Registers in the failed
+         *         burst are invalidated, since their state on the device is unknown.
+         */
+        template<typename Writer>
+        int flush(Writer &&writer, const size_t maxBurst = kNumRegisters) {
+            for(size_t first = 0; first < kNumRegisters; first++) {
+                if(!this->dirty.test(first)) {
+                    continue;
+                }
+
+                // find the end of this run of dirty registers
+                size_t count{1};
+                while((first + count) < kNumRegisters && count < maxBurst &&
+                        this->dirty.test(first + count)) {
+                    count++;
+                }
+
+                const int err = writer(static_cast<uint8_t>(first),
+                        etl::span<const Value>(this->values.data() + first, count));
+
+                for(size_t i = first; i < (first + count); i++) {
+                    this->dirty.reset(i);
+                    this->valid.set(i, !err && !this->volatileRegs.test(i));
+                }
+
+                if(err) {
+                    return err;
+                }
+
+                first += count - 1;
+            }
+
+            return 0;
+        }
+
+        /**
+         * @brief Check whether any registers are waiting to be written
+         */
+        inline bool isDirty() const {
+            return this->dirty.any();
+        }
+
+        /**
+         * @brief Invalidate a single register
+         *
+         * Its next access will go to the device.
+         */
+        inline void invalidate(const uint8_t reg) {
+            if(reg < kNumRegisters) {
+                this->valid.reset(reg);
+            }
+        }
+
+        /**
+         * @brief Invalidate all registers
+         *
+         * Use this if the device may have lost its state, such as after a reset. Any pending
+         * writes are discarded.
+         */
+        inline void invalidateAll() {
+            this->valid.reset();
+            this->dirty.reset();
+        }
+
+    private:
+        /// Shadow register values
+        etl::array<Value, kNumRegisters> values{};
+
+        /// Registers whose shadow value matches the device
+        etl::bitset<kNumRegisters> valid;
+        /// Registers whose shadow value must be written to the device
+        etl::bitset<kNumRegisters> dirty;
+        /// Registers that are never cached
+        etl::bitset<kNumRegisters> volatileRegs;
+};
+}
+
+#endif
@@ -17,9 +17,11 @@ using namespace Drivers::I2CDevice;
  * @param bus I²C bus to which the expander is connected
  * @param pins A list of 16 pin configuration entries, one for each IO pin
  * @param address I²C address of the device
+ * @param priority Bus priority for all register accesses
  */
 XRA1203::XRA1203(Drivers::I2CBus *bus, const uint8_t address,
-        etl::span<const PinConfig, kIoLines> pins) : bus(bus), deviceAddress(address) {
+        etl::span<const PinConfig, kIoLines> pins, const I2CBus::Priority priority) : bus(bus),
+        deviceAddress(address), priority(priority) {
     int err;
     uint16_t ocr{0}, pir{0}, gcr{0}, pur{0}, ier{0}, tscr{0}, reir{0}, feir{0}, ifr{0};
 
@@ -76,32 +78,34 @@ XRA1203::XRA1203(Drivers::I2CBus *bus, const uint8_t address,
     this->output = ocr;
     this->tristate = tscr;
 
-    // then write the actual registers
-    err = this->writeRegister(Register::OCR1, ocr);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "OCR", err);
-    err = this->writeRegister(Register::PIR1, pir);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "PIR", err);
-    err = this->writeRegister(Register::PUR1, pur);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "PUR", err);
-    err = this->writeRegister(Register::GCR1, gcr);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "GCR", err);
-    err = this->writeRegister(Register::TSCR1, tscr);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "TSCR", err);
-    err = this->writeRegister(Register::REIR1, reir);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "REIR", err);
-    err = this->writeRegister(Register::FEIR1, feir);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "FEIR", err);
-    err = this->writeRegister(Register::IFR1, ifr);
-    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "IFR", err);
-    err = this->writeRegister(Register::IER1, ier);
+    /*
+     * Then write the actual registers: this is done in two steps, so that interrupts are only
+     * enabled once all pins are fully configured. Otherwise, each batch of consecutive registers
+     * is written in one go.
+     */
+    this->stageRegister(Register::OCR1, ocr);
+    this->stageRegister(Register::PIR1, pir);
+    this->stageRegister(Register::GCR1, gcr);
+    this->stageRegister(Register::PUR1, pur);
+    this->stageRegister(Register::TSCR1, tscr);
+    this->stageRegister(Register::REIR1, reir);
+    this->stageRegister(Register::FEIR1, feir);
+    this->stageRegister(Register::IFR1, ifr);
+
+    err = this->flush();
+    REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "config", err);
+
+    this->stageRegister(Register::IER1, ier);
+
+    err = this->flush();
     REQUIRE(!err, "%s: failed to write register %s (%d)", "XRA1203", "IER", err);
 }
 
 /**
  * @brief Set the state of an output pin
  *
- * This internally updates the shadow register, then writes back the state for a bank of 8 pins at
- * a time to avoid the overhead of an extra read transaction to the device.
+ * This internally updates the shadow register, then writes back the register for the bank of 8
+ * pins containing the pin, if its value changed. No read transaction to the device is needed.
  *
  * @param pin Pin number to set ([0,15])
  * @param state New state of the pin; true = set
@@ -121,12 +125,9 @@ int XRA1203::setOutput(const uint8_t pin, const bool state) {
         this->output &= ~bit;
     }
 
-    // set the appropriate half of the register
-    if(pin >= 8) {
-        return this->writeRegister(Register::OCR1, static_cast<uint8_t>(this->output >> 8));
-    } else {
-        return this->writeRegister(Register::OCR2, static_cast<uint8_t>(this->output & 0xFF));
-    }
+    // write the changed half of the register
+    this->stageRegister(Register::OCR1, this->output);
+    return this->flush();
 }
 
 /**
@@ -150,45 +151,8 @@ int XRA1203::setOutputTristate(const uint8_t pin, const bool isTristate) {
         this->tristate &= ~bit;
     }
 
-    // set the appropriate half of the register
-    if(pin >= 8) {
-        return this->writeRegister(Register::TSCR1, static_cast<uint8_t>(this->tristate >> 8));
-    } else {
-        return this->writeRegister(Register::TSCR2, static_cast<uint8_t>(this->tristate & 0xFF));
-    }
-}
-
-
-
-/**
- * @brief Write the upper and lower part of a register
- *
- * Writes the 16-bit value to two consecutive registers. All registers are laid out with the
- * register 0 having the high 8 bits, and register 1 the low 8 bits. That is to say, when writing
- * a 16-bit register, each bit corresponds to channels 0-15, and the byte halves are swapped when
- * writing to the device. (just trust me bro this works)
- *
- * @param reg Register to write
- * @param value 16-bit value to write to register
- *
- * @return 0 on success, or an error code
- */
-int XRA1203::writeRegister(const Register reg, const uint16_t value) {
-    etl::array<uint8_t, 3> request{
-        static_cast<uint8_t>(reg),
-        static_cast<uint8_t>(value & 0x00FF),
-        static_cast<uint8_t>((value & 0xFF00) >> 8),
-    };
-
-    etl::array<I2CBus::Transaction, 1> txns{{
-        {
-            .address = this->deviceAddress,
-            .read = 0,
-            .length = 3,
-            .data = request
-        },
-    }};
-
-    return this->bus->perform(txns);
+    // write the changed half of the register
+    this->stageRegister(Register::TSCR1, this->tristate);
+    return this->flush();
 }
 
@@ -2,15 +2,14 @@
 #define DRIVERS_I2CDEVICE_XRA1203_H
 
 #include "Common.h"
+#include "RegisterCache.h"
+#include "Drivers/I2CBus.h"
 
 #include <stdint.h>
 
+#include <etl/array.h>
 #include <etl/span.h>
 
-namespace Drivers {
-class I2CBus;
-}
-
 namespace Drivers::I2CDevice {
 /**
  * @brief XRA1203 – 16-bit IO expander with I²C interface and interrupts
@@ -126,7 +125,8 @@ class XRA1203 {
 
     public:
         XRA1203(Drivers::I2CBus *bus, const uint8_t address,
-               etl::span<const PinConfig, kIoLines> pins);
+               etl::span<const PinConfig, kIoLines> pins,
+               const I2CBus::Priority priority = I2CBus::Priority::Normal);
 
         int setOutput(const uint8_t pin, const bool state);
         int setOutputTristate(const uint8_t pin, const bool isTristate);
@@ -172,15 +172,32 @@ class XRA1203 {
         };
 
         /**
-         * @brief Write a device register
+         * @brief Stage a write to a register pair
+         *
+         * Update the shadow copies of both halves of a register; it's written to the device on
+         * the next flush, if its value changed. Register 0 holds pins 0-7, register 1 pins 8-15.
+         *
+         * @param reg First (low) register to write
+         * @param value 16-bit value to write
+         */
+        inline void stageRegister(const Register reg, const uint16_t value) {
+            const auto first = static_cast<uint8_t>(reg);
+            this->cache.write(first, static_cast<uint8_t>(value & 0x00FF));
+            this->cache.write(first + 1, static_cast<uint8_t>((value & 0xFF00) >> 8));
+        }
+
+        /**
+         * @brief Write all modified registers to the device
          *
-         * @param reg Device register to write
-         * @param value Data to write into the register
+         * Consecutive modified registers are written in one auto-increment burst.
          */
-        int writeRegister(const Register reg, const uint8_t value) {
-            return Common::WriteRegister(this->bus, this->deviceAddress, static_cast<uint8_t>(reg),
-                    value);
+        inline int flush() {
+            return this->cache.flush([this](auto first, auto values) {
+                return Common::WriteRegisters(this->bus, this->deviceAddress, first, values,
+                        this->priority);
+            });
         }
+
         /**
          * @brief Read a device register
          *
@@ -189,11 +206,9 @@ class XRA1203 {
          */
         int readRegister(const Register reg, uint8_t &outValue) {
             return Common::ReadRegister(this->bus, this->deviceAddress, static_cast<uint8_t>(reg),
-                    outValue);
+                    outValue, this->priority);
         }
 
-        int writeRegister(const Register reg, const uint16_t value);
-
         /**
          * @brief Read the upper and lower part of a register
          *
@@ -231,11 +246,30 @@ class XRA1203 {
             return 0;
         }
 
+        /// Number of device registers
+        constexpr static const size_t kNumRegisters{0x16};
+
+        /**
+         * @brief Volatile registers
+         *
+         * Input and interrupt status registers are updated by the device, so they're never
+         * cached.
+         */
+        constexpr static const etl::array<uint8_t, 4> kVolatileRegisters{{
+            static_cast<uint8_t>(Register::GSR1), static_cast<uint8_t>(Register::GSR2),
+            static_cast<uint8_t>(Register::ISR1), static_cast<uint8_t>(Register::ISR2),
+        }};
+
     private:
         /// Parent bus
         Drivers::I2CBus *bus;
         /// Device address
         uint8_t deviceAddress;
+        /// Bus priority of register accesses
+        I2CBus::Priority priority;
+
+        /// Shadow copy of the device registers
+        RegisterCache<uint8_t, kNumRegisters> cache{kVolatileRegisters};
 
         /**
          * @brief GPIO configuration
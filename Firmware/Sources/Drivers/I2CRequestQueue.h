@@ -0,0 +1,95 @@
+#ifndef DRIVERS_I2CREQUESTQUEUE_H
+#define DRIVERS_I2CREQUESTQUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "I2CBus.h"
+
+#include <etl/array.h>
+
+namespace Drivers {
+/**
+ * @brief Queue of pending I²C bus requests
+ *
+ * Keeps one intrusive FIFO (linked through the requests' `next` field) per request priority.
+ * Requests are taken from the queue oldest first, starting with the highest priority that has
+ * any pending requests.
+ *
+ * This holds no hardware state, so bus implementations only need to decide when to start the
+ * next request.
+ *
+ * @remark The queue is not thread safe; the bus must serialize accesses to it, typically by
+ *         masking interrupts.
+ */
+class I2CRequestQueue {
+    public:
+        /**
+         * @brief Append a request to the queue for its priority
+         *
+         * @return Whether the request was queued; it's rejected if its priority is invalid.
+         */
+        bool push(I2CBus::Request &request) {
+            const auto prio = static_cast<size_t>(request.priority);
+            if(prio >= I2CBus::kNumPriorities) {
+                return false;
+            }
+
+            request.next = nullptr;
+
+            if(this->tail[prio]) {
+                this->tail[prio]->next = &request;
+                this->tail[prio] = &request;
+            } else {
+                this->head[prio] = this->tail[prio] = &request;
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Remove the next request to execute from the queue
+         *
+         * @return Oldest request of the highest priority with pending requests, or `nullptr` if
+         *         the queue is empty
+         */
+        I2CBus::Request *pop() {
+            for(size_t i = 0; i < I2CBus::kNumPriorities; i++) {
+                auto request = this->head[i];
+                if(!request) {
+                    continue;
+                }
+
+                this->head[i] = request->next;
+                if(!this->head[i]) {
+                    this->tail[i] = nullptr;
+                }
+
+                request->next = nullptr;
+                return request;
+            }
+
+            return nullptr;
+        }
+
+        /**
+         * @brief Whether there are no pending requests
+         */
+        bool empty() const {
+            for(const auto request : this->head) {
+                if(request) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        /// Oldest pending request for each priority
+        etl::array<I2CBus::Request *, I2CBus::kNumPriorities> head{};
+        /// Newest pending request for each priority; new requests are appended here
+        etl::array<I2CBus::Request *, I2CBus::kNumPriorities> tail{};
+};
+}
+
+#endif
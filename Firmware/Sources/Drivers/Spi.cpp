@@ -1,5 +1,6 @@
 #include "Spi.h"
 #include "SercomBase.h"
+#include "Common.h"
 #include "Dma.h"
 #include "Gpio.h"
 
@@ -10,6 +11,11 @@
 
 using namespace Drivers;
 
+/// Transmit data for receive-only DMA transfers
+static const uint8_t gDmaTxZero[4] __attribute__((aligned(4))){0, 0, 0, 0};
+/// Sink for received data when a DMA transaction has no receive buffer
+static uint8_t gDmaRxDiscard[4] __attribute__((aligned(4)));
+
 /**
  * @brief Initialize the SERCOM in SPI master mode.
  *
@@ -32,7 +38,11 @@ Spi::Spi(const SercomBase::Unit unit, const Config &conf) : unit(unit), rxEnable
         this->dmaTxChannel = conf.dmaChannelTx;
         this->dmaTxPriority = conf.dmaPriorityTx;
 
-        REQUIRE(!conf.rxEnable, "SPI DMA receive not yet implemented");
+        if(conf.rxEnable) {
+            this->dmaRx = 1;
+            this->dmaRxChannel = conf.dmaChannelRx;
+            this->dmaRxPriority = conf.dmaPriorityRx;
+        }
     }
 
     // TODO: IRQ config
@@ -86,6 +96,11 @@ void Spi::enable() {
                 Dma::TriggerAction::Burst, SercomBase::GetDmaTxTrigger(this->unit),
                 this->dmaTxPriority);
     }
+    if(this->dmaRx) {
+        Dma::ConfigureChannel(this->dmaRxChannel, Dma::FifoThreshold::x1, 0,
+                Dma::TriggerAction::Burst, SercomBase::GetDmaRxTrigger(this->unit),
+                this->dmaRxPriority);
+    }
 
     // set the bit
     taskENTER_CRITICAL();
@@ -137,16 +152,79 @@ beach:;
     return err;
 }
 
+/**
+ * @brief Perform a batch of chip select framed transactions
+ *
+ * Each frame's chip select is asserted, its transactions performed, then the chip select is
+ * deasserted again, before moving on to the next frame.
+ *
+ * With DMA, the data for all frames is described by one descriptor chain per direction; the DMA
+ * interrupt handler toggles chip selects and starts the next frame, so the calling task is only
+ * woken once the entire batch is done. Otherwise, each frame is performed in polled mode.
+ *
+ * @param frames Frames to execute, in order
+ *
+ * @return 0 on success, negative error code otherwise
+ *
+ * @remark DMA batches transfer one byte per DMA beat, so that transactions may be any length.
+ *         They're intended for many small transactions (such as sampling several converters);
+ *         large transfers should use perform() instead.
+ */
+int Spi::performBatch(etl::span<const Frame> frames) {
+    int err{0};
+    size_t numTxns{0};
+
+    // validate inputs
+    if(frames.empty()) {
+        return Errors::InvalidTransaction;
+    }
+
+    for(const auto &frame : frames) {
+        if(frame.transactions.empty()) {
+            return Errors::InvalidTransaction;
+        } else if(frame.device && (*frame.device >> this->selectLines.size())) {
+            return Errors::InvalidTransaction;
+        }
+
+        for(const auto &txn : frame.transactions) {
+            if(!txn.length || txn.length > 0xFFFF || (!txn.rxBuf && !txn.txBuf)) {
+                return Errors::InvalidBuffer;
+            }
+        }
+
+        numTxns += frame.transactions.size();
+    }
+
+    // prefer DMA, if possible
+    if(this->dmaCapable && numTxns <= kMaxBatchTransactions) {
+        return this->runDmaBatch(frames, Dma::BeatSize::Byte);
+    }
+
+    for(const auto &frame : frames) {
+        this->setChipSelect(frame, true);
+        err = this->perform(frame.transactions);
+        this->setChipSelect(frame, false);
+
+        if(err) {
+            break;
+        }
+    }
+
+    return err;
+}
+
 /**
  * @brief Perform an SPI transfer using DMA
  *
+ * The bulk of the transfer (all whole 32-bit words) is transferred by DMA, in both directions if
+ * the receiver is enabled. Any remaining bytes are then transferred in polled mode.
+ *
  * @param txn Transaction to perform
  *
  * @return 0 on success, negative error code otherwise
  */
 int Spi::doDmaTransfer(const Transaction &txn) {
     int err{0};
-    bool tx{false};
 
     // validate arguments
     if(!txn.length || (!txn.rxBuf && !txn.txBuf)) {
@@ -161,33 +239,19 @@ int Spi::doDmaTransfer(const Transaction &txn) {
         return Errors::InvalidBuffer;
     }
 
-    // disable length register (DMA always writes the whole 32 bits)
-    this->regs->LENGTH.reg = 0;
-
-    size_t timeout{kResetSyncTimeout};
-    do {
-        REQUIRE(--timeout, "SPI %s timed out", "disable length");
-    } while(!!this->regs->SYNCBUSY.bit.LENGTH);
-
-    // configure DMA channels
-    if(txPtr) {
-        err = Dma::ConfigureTransfer(this->dmaTxChannel, Dma::BeatSize::Word, txPtr, true,
-                const_cast<uint32_t *>(&this->regs->DATA.reg), false, dmaLength);
-        if(err) {
-            goto beach;
-        }
-        tx = true;
-    }
-    if(this->rxEnabled && rxPtr) {
-        // TODO: configure receive DMA
-        Logger::Panic("SPI: %s", "DMA receive not yet implemented");
-    }
-
-    // start DMA channels (and wait for them to complete)
-    if(tx) {
-        Dma::EnableChannel(this->dmaTxChannel);
-
-        Dma::WaitForCompletion(this->dmaTxChannel);
+    // transfer the whole words as a single, unframed transaction
+    const Transaction dmaTxn{
+        .rxBuf = rxPtr,
+        .txBuf = txPtr,
+        .length = dmaLength,
+    };
+    const Frame frame{
+        .transactions = {&dmaTxn, 1},
+    };
+
+    err = this->runDmaBatch({&frame, 1}, Dma::BeatSize::Word);
+    if(err) {
+        return err;
     }
 
     // transfer remaining bytes
@@ -205,19 +269,221 @@ int Spi::doDmaTransfer(const Transaction &txn) {
         // perform a single polled mode transfer
         taskENTER_CRITICAL();
         this->doPolledTransferSingle(txPtr, rxPtr, remaining, true);
+        while(!this->regs->INTFLAG.bit.TXC){}
         taskEXIT_CRITICAL();
     }
 
-    // clean up
+    return err;
+}
+
+/**
+ * @brief Execute frames using DMA
+ *
+ * Build descriptor chains for the transmit (and, if enabled, receive) channels, with one segment
+ * per transaction, then start the first frame and wait for the interrupt handler to signal that
+ * all frames have completed.
+ *
+ * Transactions without a transmit buffer send zeroes; received data for transactions without a
+ * receive buffer is discarded. The receiver is always drained, so it can't overflow.
+ *
+ * @param frames Frames to execute
+ * @param beatSize DMA beat size; for word beats, all transaction lengths must be a multiple of 4
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+int Spi::runDmaBatch(etl::span<const Frame> frames, const Dma::BeatSize beatSize) {
+    int err;
+    uint32_t note;
+    size_t numTxns{0}, segment{0};
+
+    auto &b = this->batch;
+
+    for(const auto &frame : frames) {
+        numTxns += frame.transactions.size();
+    }
+
+    // set up the descriptor chains
+    err = Dma::AllocChain(b.txChain, numTxns);
+    if(err) {
+        return err;
+    }
+
+    if(this->dmaRx) {
+        err = Dma::AllocChain(b.rxChain, numTxns);
+        if(err) {
+            goto beach;
+        }
+    }
+
+    for(const auto &frame : frames) {
+        for(const auto &txn : frame.transactions) {
+            const auto txPtr = txn.txBuf ? txn.txBuf : gDmaTxZero;
+            err = Dma::ConfigureChainSegment(b.txChain, segment, beatSize, txPtr, !!txn.txBuf,
+                    const_cast<uint32_t *>(&this->regs->DATA.reg), false, txn.length);
+            if(err) {
+                goto beach;
+            }
+
+            if(this->dmaRx) {
+                const auto rxPtr = txn.rxBuf ? txn.rxBuf : gDmaRxDiscard;
+                err = Dma::ConfigureChainSegment(b.rxChain, segment, beatSize,
+                        const_cast<uint32_t *>(&this->regs->DATA.reg), false, rxPtr,
+                        !!txn.rxBuf, txn.length);
+                if(err) {
+                    goto beach;
+                }
+            }
+
+            segment++;
+        }
+    }
+
+    /*
+     * Word beats write all 32 bits of the data register (so the length counter is disabled) while
+     * byte beats need the length set to a single byte.
+     */
+    this->setLength((beatSize == Dma::BeatSize::Word) ? 0 : 1);
+
+    // start the first frame, and wait for the batch to complete
+    b.frames = frames;
+    b.frame = 0;
+    b.segment = 0;
+    b.status = -1;
+    b.task = xTaskGetCurrentTaskHandle();
+
+    err = this->startFrame();
+    if(err) {
+        goto beach;
+    }
+
+    if(!xTaskNotifyWaitIndexed(Rtos::TaskNotifyIndex::DriverPrivate, 0,
+                Drivers::NotifyBits::SpiController, &note, portMAX_DELAY)) {
+        err = Errors::BlockError;
+        goto beach;
+    }
+
+    err = b.status;
+
 beach:;
-    // disable DMA channels
-    if(tx) {
+    // release descriptors
+    if(this->dmaTx) {
         Dma::DisableChannel(this->dmaTxChannel);
     }
+    if(this->dmaRx) {
+        Dma::DisableChannel(this->dmaRxChannel);
+    }
+
+    Dma::FreeChain(b.txChain);
+    Dma::FreeChain(b.rxChain);
+    b.task = nullptr;
 
     return err;
 }
 
+/**
+ * @brief Start the current frame of a DMA batch
+ *
+ * Assert the frame's chip select, then start the portions of the descriptor chains corresponding
+ * to the frame's transactions. The receive channel is started first, so that it's ready for the
+ * first byte; completion is signalled by the receive channel if enabled, since it finishes last.
+ *
+ * @return 0 on success, negative error code otherwise
+ *
+ * @remark This may be called from interrupt context.
+ */
+int Spi::startFrame() {
+    int err;
+    auto &b = this->batch;
+    const auto &frame = b.frames[b.frame];
+    const auto numTxns = frame.transactions.size();
+
+    Dma::Chain tx{b.txChain.descriptors + b.segment, numTxns};
+
+    this->setChipSelect(frame, true);
+
+    if(this->dmaRx) {
+        Dma::Chain rx{b.rxChain.descriptors + b.segment, numTxns};
+
+        err = Dma::StartChain(this->dmaRxChannel, rx, false, [](auto, auto status, auto ctx) {
+            reinterpret_cast<Spi *>(ctx)->irqFrameCompleted(status);
+        }, this);
+        if(err) {
+            return err;
+        }
+
+        err = Dma::StartChain(this->dmaTxChannel, tx);
+        if(err) {
+            return err;
+        }
+
+        Dma::EnableChannel(this->dmaRxChannel);
+    } else {
+        err = Dma::StartChain(this->dmaTxChannel, tx, false, [](auto, auto status, auto ctx) {
+            reinterpret_cast<Spi *>(ctx)->irqFrameCompleted(status);
+        }, this);
+        if(err) {
+            return err;
+        }
+    }
+
+    Dma::EnableChannel(this->dmaTxChannel);
+    return 0;
+}
+
+/**
+ * @brief Handle completion of a DMA batch frame
+ *
+ * Wait for the last byte to be shifted out, then deassert the chip select. If there are further
+ * frames, start the next one; otherwise (or if the frame failed) wake up the task waiting on the
+ * batch.
+ *
+ * @param status DMA completion status of the frame
+ *
+ * @remark This is invoked from the DMA interrupt handler.
+ */
+void Spi::irqFrameCompleted(int status) {
+    auto &b = this->batch;
+    const auto &frame = b.frames[b.frame];
+
+    while(!this->regs->INTFLAG.bit.TXC){}
+    this->setChipSelect(frame, false);
+
+    if(!status) {
+        b.segment += frame.transactions.size();
+
+        if(++b.frame < b.frames.size()) {
+            status = this->startFrame();
+            if(!status) {
+                return;
+            }
+        }
+    }
+
+    // batch is done
+    BaseType_t woken{pdFALSE};
+    b.status = status;
+
+    xTaskNotifyIndexedFromISR(b.task, Rtos::TaskNotifyIndex::DriverPrivate,
+            Drivers::NotifyBits::SpiController, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Program the length register
+ *
+ * @param length Number of bytes to transfer per data register write ([1, 3]) or 0 to disable the
+ *        length counter, so that all 32 bits are transferred
+ */
+void Spi::setLength(const size_t length) {
+    this->regs->LENGTH.reg = length ?
+        (SERCOM_SPI_LENGTH_LENEN | SERCOM_SPI_LENGTH_LEN(length)) : 0;
+
+    size_t timeout{kResetSyncTimeout};
+    do {
+        REQUIRE(--timeout, "SPI %s timed out", "set length");
+    } while(!!this->regs->SYNCBUSY.bit.LENGTH);
+}
+
 /**
  * @brief Perform a SPI transfer in polled mode
  *
@@ -248,12 +514,7 @@ int Spi::doPolledTransfer(const Transaction &txn) {
 
     if(blocks) {
         // disable length register (write all 32 bits)
-        this->regs->LENGTH.reg = 0;
-
-        size_t timeout{kResetSyncTimeout};
-        do {
-            REQUIRE(--timeout, "SPI %s timed out", "disable length");
-        } while(!!this->regs->SYNCBUSY.bit.LENGTH);
+        this->setLength(0);
 
         // process each block
         for(size_t i = 0; i < blocks; i++) {
@@ -2,8 +2,12 @@
 #define DRIVERS_SPI_H
 
 #include "SercomBase.h"
+#include "Dma.h"
+#include "Gpio.h"
+#include "SpiBus.h"
 
 #include "Log/Logger.h"
+#include "Rtos/Rtos.h"
 
 #include <stddef.h>
 #include <stdint.h>
@@ -16,12 +20,21 @@ namespace Drivers {
  * @brief SERCOM SPI driver
  *
  * Implements SPI via one of the SERCOM peripherals. The driver supports both blocking and DMA
- * driven operation, automatically configurable during setup.
+ * driven operation, automatically configurable during setup. With DMA, transfers are full duplex:
+ * a receive channel is used alongside the transmit channel whenever the receiver is enabled.
+ *
+ * Several transactions to different devices can be batched: each frame in a batch asserts its
+ * chip select for the duration of its transactions. The data of all frames is described by a
+ * single pair of DMA descriptor chains, and frames are advanced from the DMA interrupt, so the
+ * calling task only blocks once for the entire batch.
+ *
+ * Frames select their device with a chip select pin, or by driving a device address onto the
+ * select lines configured with setSelectLines().
  *
  * @note The driver only supports 8-bit master mode with no address matching. Additionally, all
  *       data transfers are done in 32-bit units.
  */
-class Spi {
+class Spi: public SpiBus {
     public:
         /// Error codes
         enum Errors: int {
@@ -40,6 +53,13 @@ class Spi {
              * list may also be empty.
              */
             InvalidTransaction          = -201,
+
+            /**
+             * @brief Failed to block on transfer
+             *
+             * Something went wrong while waiting for a DMA batch to complete.
+             */
+            BlockError                  = -202,
         };
 
         /**
@@ -119,6 +139,20 @@ class Spi {
              */
             uint32_t dmaPriorityTx:2{0};
 
+            /**
+             * @brief Receive DMA channel
+             *
+             * Channel number for the receive DMA channel, if DMA and the receiver are enabled.
+             */
+            uint32_t dmaChannelRx:5{0};
+            /**
+             * @brief Receive DMA priority
+             *
+             * Set the priority level of DMA transfers to drain the receive buffer of the SPI. This
+             * should be higher than the transmit priority, so received data can't overflow.
+             */
+            uint32_t dmaPriorityRx:2{0};
+
             /**
              * @brief Pad for data input
              *
@@ -148,22 +182,13 @@ class Spi {
         };
 
         /**
-         * @brief A SPI transaction
-         *
-         * This is a small encapsulation of a transaction length, and the associated read/write
-         * buffers.
+         * @brief Maximum number of transactions in a DMA batch
          *
-         * @note If both transmit and receive buffers are specified, they must both be sufficiently
-         *       large to fit the desired number of bytes.
+         * Each transaction needs a descriptor for the transmit and receive channels, which are
+         * allocated from the DMA controller's shared chain pool. Larger batches are performed
+         * with polled transfers.
          */
-        struct Transaction {
-            /// Pointer to buffer to hold receive data
-            void *rxBuf{nullptr};
-            /// Pointer to buffer holding data to be transmitted
-            const void *txBuf{nullptr};
-            /// Number of bytes to transfer
-            size_t length;
-        };
+        constexpr static const size_t kMaxBatchTransactions{Dma::kChainPoolSize / 4};
 
     public:
         Spi(const SercomBase::Unit unit, const Config &conf);
@@ -171,7 +196,22 @@ class Spi {
         void reset();
         void enable();
 
-        int perform(etl::span<const Transaction> transactions);
+        int perform(etl::span<const Transaction> transactions) override;
+        int performBatch(etl::span<const Frame> frames) override;
+
+        /**
+         * @brief Set the select lines for device addresses
+         *
+         * Line `n` is driven with bit `n` of a frame's device address. The lines are driven to
+         * kIdleDevice immediately.
+         *
+         * @param lines Select lines, least significant bit first; they must already be configured
+         *        as outputs, and remain valid for the lifetime of the bus.
+         */
+        void setSelectLines(etl::span<const Gpio::Pin> lines) {
+            this->selectLines = lines;
+            this->driveSelectLines(kIdleDevice);
+        }
 
         /**
          * @brief Perform a write to the SPI device
@@ -189,9 +229,59 @@ class Spi {
         }
 
     private:
+        /**
+         * @brief State of a DMA batch
+         *
+         * Describes the DMA batch currently executing; frames are advanced by the interrupt
+         * handler of the DMA channel that completes last.
+         */
+        struct Batch {
+            /// Frames to execute
+            etl::span<const Frame> frames;
+            /// Index of the frame currently executing
+            size_t frame{0};
+            /// Index of the first segment of the current frame in the descriptor chains
+            size_t segment{0};
+            /// Transmit descriptor chain (one segment per transaction)
+            Dma::Chain txChain;
+            /// Receive descriptor chain, if the receiver is enabled
+            Dma::Chain rxChain;
+            /// Task to notify when the batch completes
+            TaskHandle_t task{nullptr};
+            /// Completion status of the batch
+            int status{0};
+        };
+
         int doPolledTransfer(const Transaction &txn);
         int doDmaTransfer(const Transaction &txn);
 
+        int runDmaBatch(etl::span<const Frame> frames, const Dma::BeatSize beatSize);
+        int startFrame();
+        void irqFrameCompleted(int status);
+
+        /**
+         * @brief Assert or deassert a frame's chip select
+         */
+        inline void setChipSelect(const Frame &frame, const bool asserted) {
+            if(frame.chipSelect) {
+                Gpio::SetOutputState(*frame.chipSelect, asserted ^ frame.chipSelectActiveLow);
+            }
+            if(frame.device) {
+                this->driveSelectLines(asserted ? *frame.device : kIdleDevice);
+            }
+        }
+
+        /**
+         * @brief Drive a device address on the select lines
+         */
+        inline void driveSelectLines(const uint8_t device) {
+            for(size_t i = 0; i < this->selectLines.size(); i++) {
+                Gpio::SetOutputState(this->selectLines[i], device & (1U << i));
+            }
+        }
+
+        void setLength(const size_t length);
+
         static void ApplyConfiguration(const SercomBase::Unit unit, ::SercomSpi *regs,
                 const Config &conf);
         static void UpdateSckFreq(const SercomBase::Unit unit,
@@ -227,22 +317,16 @@ class Spi {
             }
 
             // program length register
-            this->regs->LENGTH.reg = SERCOM_SPI_LENGTH_LENEN | SERCOM_SPI_LENGTH_LEN(length);
-
-            size_t timeout{kResetSyncTimeout};
-            do {
-                REQUIRE(--timeout, "SPI %s timed out", "enable length");
-            } while(!!this->regs->SYNCBUSY.bit.LENGTH);
+            this->setLength(length);
 
             // write transmit data
             while(!this->regs->INTFLAG.bit.DRE){}
             this->regs->DATA.reg = transmit;
 
-            // decode the receive data, if desired
+            // decode the receive data, if desired; received bytes are packed from the LSB up
             if(this->rxEnabled) {
                 while(!this->regs->INTFLAG.bit.RXC){}
 
-                // TODO: validate this
                 uint32_t rxWord = this->regs->DATA.reg;
                 if(rxPtr) {
                     for(size_t i = 0; i < length; i++) {
@@ -262,17 +346,25 @@ class Spi {
         bool rxEnabled{false};
 
         /// is DMA enabled?
-        uint16_t dmaCapable:1{false};
+        uint32_t dmaCapable:1{false};
         /// use DMA for transmit
-        uint16_t dmaTx:1{false};
+        uint32_t dmaTx:1{false};
         /// DMA channel for transmit
-        uint16_t dmaTxChannel:5{0};
+        uint32_t dmaTxChannel:5{0};
         /// Priority for DMA
-        uint16_t dmaTxPriority:2{0};
+        uint32_t dmaTxPriority:2{0};
         /// Use DMA for receive
-        uint16_t dmaRx:1{false};
+        uint32_t dmaRx:1{false};
         /// DMA channel for receive
-        uint16_t dmaRxChannel:5{0};
+        uint32_t dmaRxChannel:5{0};
+        /// Priority for receive DMA
+        uint32_t dmaRxPriority:2{0};
+
+        /// Currently executing DMA batch
+        Batch batch;
+
+        /// Select lines to drive device addresses on, least significant bit first
+        etl::span<const Gpio::Pin> selectLines;
 
         /// MMIO register base
         ::SercomSpi *regs;
@@ -0,0 +1,95 @@
+#ifndef DRIVERS_SPIBUS_H
+#define DRIVERS_SPIBUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Gpio.h"
+
+#include <etl/optional.h>
+#include <etl/span.h>
+
+namespace Drivers {
+/**
+ * @brief Abstract interface for a SPI bus
+ *
+ * Device drivers talk to the bus through this interface, so they work the same whether they're
+ * on a SERCOM SPI bus, or a simulated one.
+ *
+ * Devices are selected either by a dedicated chip select pin, or by a device address that the bus
+ * drives on its select lines. The latter is for boards that decode the select lines into their
+ * chip selects (such as with a 74LVC1G139.) Between frames, the select lines are driven to
+ * kIdleDevice, so that address must not select any device.
+ */
+class SpiBus {
+    public:
+        /// Device address on the select lines when no device is selected
+        constexpr static const uint8_t kIdleDevice{0};
+
+        /**
+         * @brief A SPI transaction
+         *
+         * This is a small encapsulation of a transaction length, and the associated read/write
+         * buffers.
+         *
+         * @note If both transmit and receive buffers are specified, they must both be sufficiently
+         *       large to fit the desired number of bytes.
+         */
+        struct Transaction {
+            /// Pointer to buffer to hold receive data
+            void *rxBuf{nullptr};
+            /// Pointer to buffer holding data to be transmitted
+            const void *txBuf{nullptr};
+            /// Number of bytes to transfer
+            size_t length;
+        };
+
+        /**
+         * @brief A chip select framed group of transactions
+         *
+         * The chip select is asserted before the first transaction in the frame, and deasserted
+         * once the last transaction completed.
+         */
+        struct Frame {
+            /// Chip select pin to assert for the frame (if any)
+            etl::optional<Gpio::Pin> chipSelect;
+            /// Whether the chip select is active low
+            bool chipSelectActiveLow{true};
+            /// Device address to drive on the bus' select lines for the frame (if any)
+            etl::optional<uint8_t> device;
+            /// Transactions to perform
+            etl::span<const Transaction> transactions;
+        };
+
+    public:
+        virtual ~SpiBus() = default;
+
+        /**
+         * @brief Perform transactions without any chip select
+         *
+         * The caller is responsible for selecting the device.
+         *
+         * @param transactions Transactions to perform back-to-back
+         *
+         * @return 0 on success, or a negative error code
+         */
+        virtual int perform(etl::span<const Transaction> transactions) = 0;
+
+        /**
+         * @brief Perform a batch of frames
+         *
+         * Each frame selects its device for the duration of its transactions. The call returns
+         * once all frames completed, or one of them failed.
+         *
+         * @param frames Frames to execute, in order
+         *
+         * @return 0 on success, or a negative error code
+         *
+         * @remark All frames, transactions and their buffers must remain valid until this call
+         *         returns, and be in memory accessible to peripherals.
+         */
+        virtual int performBatch(etl::span<const Frame> frames) = 0;
+};
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "Hw/StatusLed.h"
 #include "Log/Logger.h"
 #include "Rtos/Rtos.h"
+#include "Rtos/Trace.h"
 
 #include "Common.h"
 #include "Watchdog.h"
@@ -90,6 +91,7 @@ void Watchdog::Enable() {
  */
 extern "C" void WWDG1_IRQHandler() {
     BaseType_t woken{pdFALSE};
+    Rtos::Trace::IsrEnter();
 
     // notify the task
     if(Watchdog::gEarlyWarningTask) {
@@ -100,4 +102,5 @@ extern "C" void WWDG1_IRQHandler() {
 
     // acknowledge interrupt
     WWDG1->SR = 0;
+    Rtos::Trace::IsrExit();
 }
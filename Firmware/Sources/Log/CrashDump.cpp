@@ -0,0 +1,188 @@
+#include "CrashDump.h"
+#include "Logger.h"
+
+#include "Rtos/Rtos.h"
+#include "Util/Hash.h"
+#include "stm32mp1xx.h"
+
+#include <printf/printf.h>
+#include <string.h>
+
+#include <etl/array.h>
+
+using namespace Log;
+
+/**
+ * @brief Retained snapshot region
+ *
+ * This lives in its own section, which the linker script places outside of any loadable segment,
+ * so neither the startup code nor the remoteproc loader clear it.
+ */
+__attribute__((section(".crashdump"))) CrashDump::Snapshot CrashDump::gSnapshot;
+bool CrashDump::gHasSnapshot{false};
+bool CrashDump::gHasFaultFrame{false};
+
+static_assert(sizeof(CrashDump::Snapshot) <= 0x400, "crash snapshot too large for region");
+
+/**
+ * @brief Check for a snapshot from a previous crash
+ *
+ * Validate the retained region: if it contains a valid snapshot, it's kept around for the host to
+ * read. Otherwise, it's invalidated.
+ *
+ * This should be called early during startup, before anything could possibly panic.
+ */
+void CrashDump::Init() {
+    auto &snap = gSnapshot;
+
+    if(snap.magic == kMagic && snap.version == kVersion && snap.length == sizeof(snap) &&
+            snap.checksum == CalculateChecksum()) {
+        gHasSnapshot = true;
+
+        snap.message[kMessageLength - 1] = '\0';
+        snap.taskName[kTaskNameLength - 1] = '\0';
+
+        Logger::Warning("Previous crash (reason %u, task '%s', pc %08x): %s",
+                static_cast<unsigned int>(snap.reason), snap.taskName, snap.regs.pc,
+                snap.message);
+    } else {
+        snap.magic = 0;
+    }
+}
+
+/**
+ * @brief Invalidate the crash snapshot
+ *
+ * Invoked once the host has retrieved the snapshot.
+ */
+void CrashDump::Clear() {
+    gHasSnapshot = false;
+    gSnapshot.magic = 0;
+}
+
+/**
+ * @brief Record the exception stack frame of a fault
+ *
+ * Copy the registers stacked by the processor on exception entry, as well as the fault status
+ * registers, into the snapshot.
+ *
+ * @param frame Exception stack frame (r0-r3, r12, lr, pc, psr)
+ */
+void CrashDump::SetFaultFrame(const uint32_t *frame) {
+    auto &regs = gSnapshot.regs;
+
+    regs.r0 = frame[0];
+    regs.r1 = frame[1];
+    regs.r2 = frame[2];
+    regs.r3 = frame[3];
+    regs.r12 = frame[4];
+    regs.lr = frame[5];
+    regs.pc = frame[6];
+    regs.psr = frame[7];
+    // the frame is 8 words, plus an alignment word if bit 9 of the stacked xPSR is set
+    regs.sp = reinterpret_cast<uint32_t>(frame + 8 + ((frame[7] & (1 << 9)) ? 1 : 0));
+
+    regs.cfsr = SCB->CFSR;
+    regs.hfsr = SCB->HFSR;
+    regs.mmfar = SCB->MMFAR;
+    regs.bfar = SCB->BFAR;
+    regs.afsr = SCB->AFSR;
+
+    gHasFaultFrame = true;
+}
+
+/**
+ * @brief Record the panic message
+ *
+ * @param fmt Format string
+ * @param args Arguments to format
+ */
+void CrashDump::SetMessage(const etl::string_view &fmt, va_list args) {
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+    vsnprintf(gSnapshot.message, kMessageLength, fmt.data(), args);
+#pragma clang diagnostic pop
+}
+
+/**
+ * @brief Capture the system state
+ *
+ * Fill in the remainder of the snapshot (task state, stack, trace records) and then checksum it.
+ * Once this returns, the snapshot is valid and will survive a reset of the processor.
+ *
+ * @remark This is called from the panic handler; it must not be called more than once per crash.
+ */
+void CrashDump::Capture() {
+    auto &snap = gSnapshot;
+    const bool isSchedulerRunning = (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED);
+
+    snap.version = kVersion;
+    snap.length = sizeof(snap);
+    snap.clock = SystemCoreClock;
+    snap.reason = gHasFaultFrame ? Reason::HardFault : Reason::Panic;
+    snap.uptime = isSchedulerRunning ? xTaskGetTickCount() : 0;
+
+    // for panics, we only know the current stack pointer
+    if(!gHasFaultFrame) {
+        memset(&snap.regs, 0, sizeof(snap.regs));
+        snap.regs.sp = (__get_IPSR() || !isSchedulerRunning) ? __get_MSP() : __get_PSP();
+    }
+
+    // running task
+    memset(snap.taskName, 0, kTaskNameLength);
+    if(isSchedulerRunning) {
+        strncpy(snap.taskName, pcTaskGetName(nullptr), kTaskNameLength - 1);
+    }
+
+    // stack excerpt
+    const auto stack = reinterpret_cast<const uint32_t *>(snap.regs.sp & ~0x3);
+    for(size_t i = 0; i < kStackWords; i++) {
+        snap.stack[i] = stack[i];
+    }
+
+    // most recent trace records
+    const auto totalRecords = Rtos::Trace::GetNumRecords();
+    const auto firstRecord = (totalRecords > kTraceRecords) ? (totalRecords - kTraceRecords) : 0;
+    snap.numTraceRecords = Rtos::Trace::Read(firstRecord, {snap.trace, kTraceRecords});
+
+    /*
+     * Task table: kernel APIs may not be called from handler mode, so this is only available for
+     * panics in task context; for faults, the trace records show what was running.
+     */
+    snap.numTasks = 0;
+
+    if(isSchedulerRunning && !__get_IPSR()) {
+        static etl::array<TaskStatus_t, Rtos::Stats::kMaxTasks> gTaskInfo;
+        const auto numTasks = uxTaskGetSystemState(gTaskInfo.data(), gTaskInfo.size(), nullptr);
+
+        for(size_t i = 0; i < numTasks; i++) {
+            const auto &info = gTaskInfo[i];
+            auto &task = snap.tasks[i];
+
+            memset(task.name, 0, kTaskNameLength);
+            strncpy(task.name, info.pcTaskName, kTaskNameLength - 1);
+            task.runtime = info.ulRunTimeCounter;
+            task.stackFree = info.usStackHighWaterMark;
+            task.priority = info.uxCurrentPriority;
+            task.state = info.eCurrentState;
+        }
+
+        snap.numTasks = numTasks;
+    }
+
+    // finalize
+    snap.checksum = CalculateChecksum();
+    snap.magic = kMagic;
+}
+
+/**
+ * @brief Calculate the snapshot checksum
+ *
+ * @return Checksum over all fields following the checksum field
+ */
+uint32_t CrashDump::CalculateChecksum() {
+    constexpr static const size_t kOffset{offsetof(Snapshot, uptime)};
+
+    return Util::Hash::MurmurHash3(reinterpret_cast<const uint8_t *>(&gSnapshot) + kOffset,
+            sizeof(Snapshot) - kOffset, kMagic);
+}
@@ -0,0 +1,155 @@
+#ifndef LOG_CRASHDUMP_H
+#define LOG_CRASHDUMP_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/span.h>
+#include <etl/string_view.h>
+
+#include "Rtos/Stats.h"
+#include "Rtos/Trace.h"
+
+namespace Log {
+/**
+ * @brief Crash snapshot
+ *
+ * When the system panics (or takes a fault) a snapshot of the system state is written into a
+ * region of retained RAM, which is not touched by the startup code, nor by the remoteproc loader.
+ * After the firmware is restarted, the snapshot is validated, and can then be read out by the host
+ * for diagnostics.
+ */
+class CrashDump {
+    public:
+        /**
+         * @brief Snapshot magic value
+         *
+         * Marks the retained region as containing a snapshot ('CRSH')
+         */
+        constexpr static const uint32_t kMagic{0x48535243};
+        /// Current snapshot format version
+        constexpr static const uint16_t kVersion{1};
+
+        /// Number of stack words to capture
+        constexpr static const size_t kStackWords{32};
+        /// Number of trace records to capture
+        constexpr static const size_t kTraceRecords{32};
+        /// Maximum length of the panic message
+        constexpr static const size_t kMessageLength{96};
+        /// Maximum length of a task name
+        constexpr static const size_t kTaskNameLength{16};
+
+        /**
+         * @brief Cause of the crash
+         */
+        enum class Reason: uint8_t {
+            /// Software panic (such as a failed assertion)
+            Panic                       = 1,
+            /// Hard fault (or escalated configurable fault)
+            HardFault                   = 2,
+        };
+
+        /**
+         * @brief Snapshot layout
+         *
+         * This is the layout of the retained RAM region. It's read out byte for byte by the host,
+         * so any changes here need to be reflected in the host side decoder, and the version
+         * incremented.
+         */
+        struct Snapshot {
+            /// Magic value (kMagic)
+            uint32_t magic;
+            /// Format version (kVersion)
+            uint16_t version;
+            /// Total size of the snapshot, in bytes
+            uint16_t length;
+            /// MurmurHash3 over all data following this field
+            uint32_t checksum;
+
+            /// Tick count at the time of the crash
+            uint32_t uptime;
+            /// Core clock frequency (to convert trace timestamps)
+            uint32_t clock;
+            /// Crash reason
+            Reason reason;
+            uint8_t reserved[3];
+
+            /// Panic message (NUL terminated)
+            char message[kMessageLength];
+            /// Name of the running task (NUL terminated; empty if none)
+            char taskName[kTaskNameLength];
+
+            /**
+             * @brief Processor state
+             *
+             * For faults, the registers are read from the exception stack frame; for panics, only
+             * the stack pointer is valid.
+             */
+            struct {
+                uint32_t r0, r1, r2, r3, r12, lr, pc, psr;
+                /// Stack pointer at the time of the fault
+                uint32_t sp;
+                /// Fault status registers
+                uint32_t cfsr, hfsr, mmfar, bfar, afsr;
+            } regs;
+
+            /// Stack contents, starting at the stack pointer
+            uint32_t stack[kStackWords];
+
+            /// Number of valid trace records
+            uint32_t numTraceRecords;
+            /// Most recent trace records (oldest first)
+            Rtos::Trace::Record trace[kTraceRecords];
+
+            /// Number of valid task entries
+            uint32_t numTasks;
+            /// Task table
+            struct Task {
+                char name[kTaskNameLength];
+                /// Runtime counter value
+                uint32_t runtime;
+                /// Minimum free stack, in words
+                uint16_t stackFree;
+                /// Current priority
+                uint8_t priority;
+                /// Task state (eTaskState)
+                uint8_t state;
+            } tasks[Rtos::Stats::kMaxTasks];
+        } __attribute__((packed, aligned(4)));
+
+    public:
+        static void Init();
+
+        static void SetFaultFrame(const uint32_t *frame);
+        static void SetMessage(const etl::string_view &fmt, va_list args);
+        static void Capture();
+
+        static void Clear();
+
+        /**
+         * @brief Get the snapshot from a previous crash
+         *
+         * @return Raw snapshot data, or an empty span if there is no valid snapshot
+         */
+        static inline etl::span<const uint8_t> GetSnapshot() {
+            if(!gHasSnapshot) {
+                return {};
+            }
+            return {reinterpret_cast<const uint8_t *>(&gSnapshot), sizeof(gSnapshot)};
+        }
+
+    private:
+        static uint32_t CalculateChecksum();
+
+    private:
+        /// Retained snapshot region
+        static Snapshot gSnapshot;
+        /// Set if a valid snapshot from a previous crash was found at startup
+        static bool gHasSnapshot;
+        /// Set once a fault frame has been recorded for the current crash
+        static bool gHasFaultFrame;
+};
+}
+
+#endif
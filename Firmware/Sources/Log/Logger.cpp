@@ -1,4 +1,5 @@
 #include "Logger.h"
+#include "CrashDump.h"
 
 #include "Rtos/Rtos.h"
 #include "Hw/StatusLed.h"
@@ -122,18 +123,29 @@ void Logger::Log(const Level level, const etl::string_view &format, va_list args
  * This disables interrupts and lands ourselves into an infinite loop and/or breakpoint.
  */
 void Logger::Panic() {
+    // a panic while panicking (e.g. while dumping state) just halts
+    static bool gIsPanicking{false};
+    if(gIsPanicking) {
+        __disable_irq();
+        __BKPT(0xf3);
+        while(1) {}
+    }
+    gIsPanicking = true;
+
     // print a message
     Error("Panic! at the system, halting");
     Hw::StatusLed::Set(Hw::StatusLed::Color::Red);
 
+    // record the system state so it survives a reset
+    CrashDump::Capture();
+
     // get task info (if scheduler is running)
-    unsigned long totalRuntime{0};
+    uint32_t totalRuntime{0};
     constexpr static const size_t kTaskInfoSize{8};
     static etl::array<TaskStatus_t, kTaskInfoSize> gTaskInfo;
 
     if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
-        //const auto ok = uxTaskGetSystemState(gTaskInfo.data(), kTaskInfoSize, &totalRuntime);
-        const auto ok = uxTaskGetSystemState(gTaskInfo.data(), kTaskInfoSize, nullptr);
+        const auto ok = uxTaskGetSystemState(gTaskInfo.data(), kTaskInfoSize, &totalRuntime);
 
         if(!ok) {
             Error("Failed to get RTOS state");
@@ -179,6 +191,16 @@ void Logger::Panic() {
     while(1) {}
 }
 
+/**
+ * @brief Record the panic message in the crash snapshot
+ *
+ * @param fmt Format string
+ * @param args Arguments to format
+ */
+void Logger::RecordPanicMessage(const etl::string_view &fmt, va_list args) {
+    CrashDump::SetMessage(fmt, args);
+}
+
 /**
  * @brief C panic function
  *
@@ -190,9 +212,12 @@ void Logger::Panic() {
 extern "C" void log_panic(const char *fmt, ...) {
     using Level = Log::Logger::Level;
 
-    va_list va;
+    va_list va, vaCopy;
     va_start(va, fmt);
+    va_copy(vaCopy, va);
     Log::Logger::Log(Level::Error, fmt, va);
+    Log::Logger::RecordPanicMessage(fmt, vaCopy);
+    va_end(vaCopy);
     va_end(va);
 
     Logger::Panic();
@@ -133,9 +133,12 @@ class Logger {
          * @param ... Arguments to message
          */
         [[noreturn]] static void Panic(const etl::string_view fmt, ...) {
-            va_list va;
+            va_list va, vaCopy;
             va_start(va, fmt);
+            va_copy(vaCopy, va);
             Log(Level::Error, fmt, va);
+            RecordPanicMessage(fmt, vaCopy);
+            va_end(vaCopy);
             va_end(va);
 
             Panic();
@@ -218,6 +221,7 @@ class Logger {
 
     private:
         [[noreturn]] static void Panic();
+        static void RecordPanicMessage(const etl::string_view &fmt, va_list args);
 
     private:
         static bool gInitialized;
@@ -1,3 +1,4 @@
+#include "Log/CrashDump.h"
 #include "Log/Logger.h"
 #include "Rtos/Start.h"
 
@@ -54,6 +55,12 @@ extern "C" int main() {
             gBuildInfo.buildUser, gBuildInfo.buildHost);
     Logger::Notice("MPU clock: %u Hz", SystemCoreClock);
 
+    /*
+     * Check whether we're coming back from a crash; if so, the snapshot is retained until the
+     * host has read it out.
+     */
+    Log::CrashDump::Init();
+
     /*
      * Initialize host RPC interface
      *
@@ -1,5 +1,6 @@
 #include "Log/Logger.h"
 #include "Rtos/Rtos.h"
+#include "Rtos/Trace.h"
 
 #include "stm32mp1xx.h"
 #include "stm32mp1xx_hal_ipcc.h"
@@ -209,12 +210,16 @@ void Mailbox::AckShutdownRequest() {
  * @brief IPCC receive interrupt handler
  */
 extern "C" void IPCC_RX1_IRQHandler() {
+    Rtos::Trace::IsrEnter();
     HAL_IPCC_RX_IRQHandler(&Mailbox::gHandle);
+    Rtos::Trace::IsrExit();
 }
 
 /**
  * @brief IPCC transmit interrupt handler
  */
 extern "C" void IPCC_TX1_IRQHandler() {
+    Rtos::Trace::IsrEnter();
     HAL_IPCC_TX_IRQHandler(&Mailbox::gHandle);
+    Rtos::Trace::IsrExit();
 }
@@ -0,0 +1,180 @@
+/**
+ * @file
+ *
+ * @brief Fixed size block allocator
+ *
+ * Implements the slab pools, as well as the wrappers for the FreeRTOS heap functions.
+ */
+#include "SlabAllocator.h"
+#include "Rtos/Rtos.h"
+
+using namespace Rtos;
+
+namespace {
+/// Number of 16 byte blocks
+constexpr static const size_t kNumBlocks16{48};
+/// Number of 32 byte blocks
+constexpr static const size_t kNumBlocks32{32};
+/// Number of 64 byte blocks
+constexpr static const size_t kNumBlocks64{24};
+/// Number of 128 byte blocks
+constexpr static const size_t kNumBlocks128{16};
+/// Number of 256 byte blocks
+constexpr static const size_t kNumBlocks256{8};
+
+/// Storage for the 16 byte class
+alignas(8) static uint8_t gPool16[16 * kNumBlocks16];
+/// Storage for the 32 byte class
+alignas(8) static uint8_t gPool32[32 * kNumBlocks32];
+/// Storage for the 64 byte class
+alignas(8) static uint8_t gPool64[64 * kNumBlocks64];
+/// Storage for the 128 byte class
+alignas(8) static uint8_t gPool128[128 * kNumBlocks128];
+/// Storage for the 256 byte class
+alignas(8) static uint8_t gPool256[256 * kNumBlocks256];
+}
+
+etl::array<SlabAllocator::Class, SlabAllocator::kNumClasses> SlabAllocator::gClasses{{
+    {gPool16, 16, kNumBlocks16},
+    {gPool32, 32, kNumBlocks32},
+    {gPool64, 64, kNumBlocks64},
+    {gPool128, 128, kNumBlocks128},
+    {gPool256, 256, kNumBlocks256},
+}};
+static_assert(SlabAllocator::kMaxBlockSize == 256);
+
+
+
+/**
+ * @brief Allocate a block
+ *
+ * Take a block from the free list of the appropriate size class; if it's empty, hand out the next
+ * block that was never allocated.
+ *
+ * @param size Number of bytes to allocate
+ *
+ * @return Pointer to the block, or `nullptr` if the size is not handled by any class or the class
+ *         is exhausted.
+ *
+ * @remark This may be called from any context.
+ */
+void *SlabAllocator::Alloc(const size_t size) {
+    if(!size || size > kMaxBlockSize) {
+        return nullptr;
+    }
+
+    auto &cls = gClasses[ClassForSize(size)];
+    void *block{nullptr};
+
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    if(cls.freeList) {
+        block = cls.freeList;
+        cls.freeList = cls.freeList->next;
+    } else if(cls.nextUnused < cls.numBlocks) {
+        block = cls.start + (cls.nextUnused++ * cls.blockSize);
+    }
+
+    if(block) {
+        cls.numAllocs++;
+        if(++cls.inUse > cls.peakInUse) {
+            cls.peakInUse = cls.inUse;
+        }
+    } else {
+        cls.numOverflows++;
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return block;
+}
+
+/**
+ * @brief Release a block
+ *
+ * If the pointer belongs to one of the pools, put it back on its class' free list.
+ *
+ * @param ptr Pointer previously returned by Alloc()
+ *
+ * @return Whether the pointer was allocated from a pool; if not, it must be freed elsewhere.
+ */
+bool SlabAllocator::Free(void *ptr) {
+    auto addr = static_cast<uint8_t *>(ptr);
+
+    for(auto &cls : gClasses) {
+        if(addr < cls.start || addr >= (cls.start + (cls.blockSize * cls.numBlocks))) {
+            continue;
+        }
+
+        auto block = static_cast<FreeBlock *>(ptr);
+        const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+        block->next = cls.freeList;
+        cls.freeList = block;
+        cls.inUse--;
+
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Get usage statistics of all size classes
+ *
+ * @param outStats Buffer to receive statistics, ordered by increasing block size
+ */
+void SlabAllocator::GetStats(etl::span<ClassStats, kNumClasses> outStats) {
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    for(size_t i = 0; i < kNumClasses; i++) {
+        const auto &cls = gClasses[i];
+
+        outStats[i] = {
+            .blockSize = cls.blockSize,
+            .numBlocks = cls.numBlocks,
+            .inUse = cls.inUse,
+            .peakInUse = cls.peakInUse,
+            .numAllocs = cls.numAllocs,
+            .numOverflows = cls.numOverflows,
+        };
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+
+
+extern "C" void *__real_pvPortMalloc(size_t);
+extern "C" void __real_vPortFree(void *);
+extern "C" void *__wrap_pvPortMalloc(size_t);
+extern "C" void __wrap_vPortFree(void *);
+
+/**
+ * @brief FreeRTOS heap allocation wrapper
+ *
+ * Try to satisfy the allocation from the slab pools first, before falling back to the heap.
+ */
+extern "C" void *__wrap_pvPortMalloc(size_t size) {
+    auto block = SlabAllocator::Alloc(size);
+    if(block) {
+        return block;
+    }
+
+    return __real_pvPortMalloc(size);
+}
+
+/**
+ * @brief FreeRTOS heap free wrapper
+ *
+ * Return blocks to their slab pool, or the heap if they didn't come from one.
+ */
+extern "C" void __wrap_vPortFree(void *ptr) {
+    if(!ptr) {
+        return;
+    }
+
+    if(!SlabAllocator::Free(ptr)) {
+        __real_vPortFree(ptr);
+    }
+}
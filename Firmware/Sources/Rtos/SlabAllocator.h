@@ -0,0 +1,109 @@
+/**
+ * @file
+ *
+ * @brief Fixed size block allocator
+ *
+ * Provides pools of fixed size blocks for small allocations, which are the bulk of the runtime
+ * allocations (kernel objects, RPC bookkeeping structures, log buffers) in the system.
+ */
+#ifndef RTOS_SLABALLOCATOR_H
+#define RTOS_SLABALLOCATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/array.h>
+#include <etl/span.h>
+
+namespace Rtos {
+/**
+ * @brief Size class slab allocator
+ *
+ * Allocations are rounded up to the next power of two size class, and served from a statically
+ * allocated pool of blocks for that class. Both allocation and freeing are O(1): each class keeps
+ * a free list threaded through its free blocks, plus a bump index for blocks never handed out.
+ *
+ * All calls to `pvPortMalloc` and `vPortFree` are redirected here at link time (with the linker's
+ * `--wrap` option) which means this also backs C++ `new` and `delete`, as well as kernel objects
+ * allocated dynamically. Requests that don't fit into any size class, or whose class is exhausted,
+ * fall through to the general purpose heap.
+ */
+class SlabAllocator {
+    public:
+        /// Number of size classes
+        constexpr static const size_t kNumClasses{5};
+        /// Size of the smallest class, in bytes
+        constexpr static const size_t kMinBlockSize{16};
+        /// Size of the largest class, in bytes
+        constexpr static const size_t kMaxBlockSize{kMinBlockSize << (kNumClasses - 1)};
+
+        /**
+         * @brief Usage statistics of a size class
+         */
+        struct ClassStats {
+            /// Size of each block, in bytes
+            uint16_t blockSize;
+            /// Total number of blocks in the class
+            uint16_t numBlocks;
+            /// Number of blocks currently allocated
+            uint16_t inUse;
+            /// Maximum number of blocks ever allocated at once
+            uint16_t peakInUse;
+            /// Number of successful allocations
+            uint32_t numAllocs;
+            /// Number of allocations that fell through to the heap because the class was full
+            uint32_t numOverflows;
+        };
+
+    public:
+        static void *Alloc(const size_t size);
+        static bool Free(void *ptr);
+
+        static void GetStats(etl::span<ClassStats, kNumClasses> outStats);
+
+    private:
+        /// Free block, as linked into a class' free list
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        /**
+         * @brief Size class state
+         */
+        struct Class {
+            /// Start of the pool's storage
+            uint8_t *const start;
+            /// Size of each block
+            const uint16_t blockSize;
+            /// Total number of blocks
+            const uint16_t numBlocks;
+
+            /// Head of the free list
+            FreeBlock *freeList{nullptr};
+            /// Index of the next never-allocated block
+            uint16_t nextUnused{0};
+
+            /// Usage statistics
+            uint16_t inUse{0}, peakInUse{0};
+            uint32_t numAllocs{0}, numOverflows{0};
+        };
+
+        /**
+         * @brief Get the size class index for an allocation size
+         *
+         * @remark Size must be between 1 and kMaxBlockSize bytes.
+         */
+        static inline size_t ClassForSize(const size_t size) {
+            if(size <= kMinBlockSize) {
+                return 0;
+            }
+            // index of the next power of two, relative to the smallest class
+            return (32 - __builtin_clz(size - 1)) - (32 - __builtin_clz(kMinBlockSize - 1));
+        }
+
+    private:
+        static etl::array<Class, kNumClasses> gClasses;
+};
+}
+
+#endif
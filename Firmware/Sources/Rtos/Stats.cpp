@@ -0,0 +1,268 @@
+/**
+ * @file
+ *
+ * @brief RTOS runtime statistics
+ *
+ * Implements the runtime counter used by FreeRTOS for task accounting, as well as the kernel trace
+ * hooks used to measure the latency between a task getting notified and it actually running.
+ */
+#include "Stats.h"
+#include "Rtos.h"
+
+#include "stm32mp1xx.h"
+
+#include <etl/array.h>
+
+using namespace Rtos;
+
+namespace {
+/**
+ * @brief Runtime counter prescaler (as a shift)
+ *
+ * The cycle counter is divided by 2^n before being handed to FreeRTOS. At 209MHz, this yields a
+ * resolution of about 0.3µs, and the counter wraps about every 21 minutes.
+ */
+constexpr static const size_t kRuntimeCounterShift{6};
+
+/**
+ * @brief Per task statistics state
+ *
+ * This holds the bits of state that FreeRTOS doesn't track for us.
+ */
+struct TaskSlot {
+    /// Task this slot belongs to, or `nullptr` if free
+    void *task;
+
+    /// Cycle counter value when the task was notified, or 0 if not pending
+    uint32_t notifyTimestamp;
+    /// Number of latency samples taken in this window
+    uint32_t latencyCount;
+    /// Total latency in this window, in cycles
+    uint32_t latencyTotal;
+    /// Maximum latency in this window, in cycles
+    uint32_t latencyMax;
+
+    /// Runtime counter value at the time of the last collection
+    uint32_t prevRuntime;
+};
+
+/// Per task state
+static etl::array<TaskSlot, Stats::kMaxTasks> gSlots;
+/// High part of the extended cycle counter
+static uint32_t gCycleHigh{0};
+/// Cycle counter value the last time the runtime counter was read
+static uint32_t gCycleLast{0};
+/// Total runtime at the time of the last collection
+static uint32_t gPrevTotalRuntime{0};
+
+/**
+ * @brief Get the slot for a task
+ *
+ * Find the slot that belongs to the given task, allocating a new one if needed.
+ *
+ * @return Slot for the task, or `nullptr` if all slots are in use
+ *
+ * @remark This must be called with interrupts masked.
+ */
+static TaskSlot *GetSlot(void *task) {
+    TaskSlot *free{nullptr};
+
+    for(auto &slot : gSlots) {
+        if(slot.task == task) {
+            return &slot;
+        } else if(!slot.task && !free) {
+            free = &slot;
+        }
+    }
+
+    if(free) {
+        *free = {};
+        free->task = task;
+    }
+    return free;
+}
+
+/**
+ * @brief Convert cycles to µs
+ */
+static inline uint32_t CyclesToUsec(const uint32_t cycles) {
+    return cycles / (SystemCoreClock / 1'000'000UL);
+}
+}
+
+
+
+/**
+ * @brief Collect task statistics
+ *
+ * Query the scheduler for the state of all tasks, and compute each task's CPU usage over the time
+ * since the previous invocation. Notification latency values are reset after being read.
+ *
+ * @param outTasks Buffer to receive task information
+ * @param outTotalLoad Variable to receive total CPU load (excluding the idle task) in 0.01%
+ *
+ * @return Number of tasks written to the output buffer
+ *
+ * @remark This is not reentrant; only a single task should ever invoke it.
+ */
+size_t Stats::Collect(etl::span<TaskInfo> outTasks, uint16_t &outTotalLoad) {
+    static etl::array<TaskStatus_t, kMaxTasks> gTaskInfo;
+    uint32_t totalRuntime{0};
+
+    const auto numTasks = uxTaskGetSystemState(gTaskInfo.data(), gTaskInfo.size(), &totalRuntime);
+    const auto window = totalRuntime - gPrevTotalRuntime;
+    gPrevTotalRuntime = totalRuntime;
+
+    const auto idle = xTaskGetIdleTaskHandle();
+    outTotalLoad = 10000;
+
+    // process each task
+    size_t numOut{0};
+    for(size_t i = 0; i < numTasks && numOut < outTasks.size(); i++) {
+        const auto &status = gTaskInfo[i];
+        auto &info = outTasks[numOut++];
+
+        info = {
+            .handle = status.xHandle,
+            .name = status.pcTaskName,
+            .priority = static_cast<uint8_t>(status.uxCurrentPriority),
+            .stackFree = static_cast<uint16_t>(status.usStackHighWaterMark),
+        };
+
+        // capture and reset the per task state
+        uint32_t prevRuntime, latencyCount, latencyTotal, latencyMax;
+
+        taskENTER_CRITICAL();
+        auto slot = GetSlot(status.xHandle);
+        if(!slot) {
+            taskEXIT_CRITICAL();
+            continue;
+        }
+
+        prevRuntime = slot->prevRuntime;
+        latencyCount = slot->latencyCount;
+        latencyTotal = slot->latencyTotal;
+        latencyMax = slot->latencyMax;
+
+        slot->prevRuntime = status.ulRunTimeCounter;
+        slot->latencyCount = slot->latencyTotal = slot->latencyMax = 0;
+        taskEXIT_CRITICAL();
+
+        // calculate CPU usage and latency
+        if(window) {
+            const uint64_t used = status.ulRunTimeCounter - prevRuntime;
+            info.cpuLoad = static_cast<uint16_t>((used * 10000ULL) / window);
+        }
+
+        if(latencyCount) {
+            info.notifyLatencyAvg = CyclesToUsec(latencyTotal / latencyCount);
+        }
+        info.notifyLatencyMax = CyclesToUsec(latencyMax);
+
+        if(status.xHandle == idle) {
+            outTotalLoad = (info.cpuLoad < 10000) ? (10000 - info.cpuLoad) : 0;
+        }
+    }
+
+    // release slots of tasks that no longer exist
+    taskENTER_CRITICAL();
+    for(auto &slot : gSlots) {
+        if(!slot.task) {
+            continue;
+        }
+
+        bool found{false};
+        for(size_t i = 0; i < numTasks; i++) {
+            if(gTaskInfo[i].xHandle == slot.task) {
+                found = true;
+                break;
+            }
+        }
+
+        if(!found && numTasks < gTaskInfo.size()) {
+            slot.task = nullptr;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return numOut;
+}
+
+
+
+/**
+ * @brief Initialize the runtime counter
+ *
+ * Enable the DWT cycle counter. This is invoked by FreeRTOS as the scheduler is started.
+ */
+extern "C" void rtos_stats_init() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Read the runtime counter
+ *
+ * Extend the 32-bit cycle counter to 64 bits, then scale it down to the runtime counter's
+ * resolution.
+ *
+ * @remark The cycle counter wraps roughly every 20 seconds; this needs to be called at least that
+ *         often to not lose time. Since it's called on every context switch, this isn't a problem.
+ */
+extern "C" uint32_t rtos_stats_get_counter() {
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    const uint32_t now = DWT->CYCCNT;
+    if(now < gCycleLast) {
+        gCycleHigh++;
+    }
+    gCycleLast = now;
+
+    const uint32_t value = (gCycleHigh << (32 - kRuntimeCounterShift)) |
+        (now >> kRuntimeCounterShift);
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+    return value;
+}
+
+/**
+ * @brief Task switched in hook
+ *
+ * If the task has a pending notification timestamp, account for its latency.
+ *
+ * @param task Task handle that is about to run
+ */
+extern "C" void rtos_stats_switched_in(void *task) {
+    auto slot = GetSlot(task);
+    if(!slot || !slot->notifyTimestamp) {
+        return;
+    }
+
+    const uint32_t latency = DWT->CYCCNT - slot->notifyTimestamp;
+    slot->notifyTimestamp = 0;
+
+    slot->latencyCount++;
+    slot->latencyTotal += latency;
+    if(latency > slot->latencyMax) {
+        slot->latencyMax = latency;
+    }
+}
+
+/**
+ * @brief Task notified hook
+ *
+ * Record the time at which the task was notified, unless there's already an earlier notification
+ * pending.
+ *
+ * @param task Task handle that was notified
+ */
+extern "C" void rtos_stats_notify(void *task) {
+    auto slot = GetSlot(task);
+    if(!slot || slot->notifyTimestamp) {
+        return;
+    }
+
+    // ensure the timestamp is never zero
+    slot->notifyTimestamp = DWT->CYCCNT | 1;
+}
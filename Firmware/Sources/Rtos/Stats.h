@@ -0,0 +1,55 @@
+/**
+ * @file
+ *
+ * @brief RTOS runtime statistics
+ *
+ * Collects per-task CPU usage, stack usage, and notification latency information, so that the
+ * remaining headroom of the system can be observed from the host.
+ */
+#ifndef RTOS_STATS_H
+#define RTOS_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Rtos.h"
+
+#include <etl/span.h>
+
+namespace Rtos::Stats {
+/**
+ * @brief Information about a single task
+ *
+ * All values (other than the stack high water mark) are computed over the window since the
+ * previous invocation of Collect().
+ */
+struct TaskInfo {
+    /// Task handle
+    TaskHandle_t handle;
+    /// Task name
+    const char *name;
+
+    /// Current task priority
+    uint8_t priority;
+    /// Minimum amount of free stack space ever observed, in words
+    uint16_t stackFree;
+    /// CPU time used by the task, in units of 0.01%
+    uint16_t cpuLoad;
+
+    /// Average latency between the task being notified and it running, in µs
+    uint32_t notifyLatencyAvg;
+    /// Maximum latency between the task being notified and it running, in µs
+    uint32_t notifyLatencyMax;
+};
+
+/**
+ * @brief Maximum number of tasks to track
+ *
+ * If more tasks than this exist in the system, the remaining ones are not reported.
+ */
+constexpr static const size_t kMaxTasks{12};
+
+size_t Collect(etl::span<TaskInfo> outTasks, uint16_t &outTotalLoad);
+}
+
+#endif
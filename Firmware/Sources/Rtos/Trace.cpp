@@ -0,0 +1,159 @@
+/**
+ * @file
+ *
+ * @brief Kernel event tracer
+ *
+ * Implements the trace ring buffer, and the thunks invoked by the FreeRTOS trace hooks.
+ */
+#include "Trace.h"
+#include "Rtos.h"
+
+#include "stm32mp1xx.h"
+
+#include <etl/algorithm.h>
+#include <etl/array.h>
+
+using namespace Rtos;
+
+namespace {
+/// Trace ring buffer
+static etl::array<Trace::Record, Trace::kNumRecords> gRecords;
+/// Index of the next record to write
+static size_t gWritePtr{0};
+/// Set once the ring buffer has wrapped around
+static bool gWrapped{false};
+/// Whether events are currently recorded
+static bool gEnabled{true};
+}
+
+
+
+/**
+ * @brief Record a trace event
+ *
+ * Write an event into the ring buffer, overwriting the oldest event if it's full.
+ *
+ * @param type Event type
+ * @param id Event specific identifier
+ *
+ * @remark This may be called from any context, including interrupt handlers.
+ */
+void Trace::Put(const Event type, const uint16_t id) {
+    const auto mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    if(gEnabled) {
+        gRecords[gWritePtr] = {
+            .timestamp = DWT->CYCCNT,
+            .type = type,
+            .reserved = 0,
+            .id = id,
+        };
+
+        if(++gWritePtr == gRecords.size()) {
+            gWritePtr = 0;
+            gWrapped = true;
+        }
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/**
+ * @brief Resume recording trace events
+ */
+void Trace::Start() {
+    taskENTER_CRITICAL();
+    gEnabled = true;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Stop recording trace events
+ *
+ * The contents of the ring buffer are left intact, so they can be read out consistently.
+ */
+void Trace::Stop() {
+    taskENTER_CRITICAL();
+    gEnabled = false;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Discard all recorded events and resume recording
+ */
+void Trace::Reset() {
+    taskENTER_CRITICAL();
+    gWritePtr = 0;
+    gWrapped = false;
+    gEnabled = true;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief Get the number of valid records in the ring buffer
+ */
+size_t Trace::GetNumRecords() {
+    return gWrapped ? gRecords.size() : gWritePtr;
+}
+
+/**
+ * @brief Read records from the ring buffer
+ *
+ * Copy records out of the ring, where offset 0 is the oldest record.
+ *
+ * @param offset Index of the first record to read
+ * @param outRecords Buffer to receive records
+ *
+ * @return Number of records copied
+ *
+ * @remark Recording should be stopped while reading, otherwise the records may be inconsistent.
+ */
+size_t Trace::Read(const size_t offset, etl::span<Record> outRecords) {
+    const auto total = GetNumRecords();
+    if(offset >= total) {
+        return 0;
+    }
+
+    const auto start = gWrapped ? gWritePtr : 0;
+    const auto count = etl::min(outRecords.size(), total - offset);
+
+    for(size_t i = 0; i < count; i++) {
+        outRecords[i] = gRecords[(start + offset + i) % gRecords.size()];
+    }
+
+    return count;
+}
+
+
+
+/**
+ * @brief Task switch hook
+ *
+ * @param in Whether the task is being switched in (1) or out (0)
+ * @param taskNumber Task number (as assigned by the kernel)
+ */
+extern "C" void rtos_trace_task_switch(const int in, const uint32_t taskNumber) {
+    Trace::Put(in ? Trace::Event::TaskSwitchIn : Trace::Event::TaskSwitchOut, taskNumber);
+}
+
+/**
+ * @brief Task notification hook
+ *
+ * @param taskNumber Task number (as assigned by the kernel) of the notified task
+ */
+extern "C" void rtos_trace_task_notify(const uint32_t taskNumber) {
+    Trace::Put(Trace::Event::TaskNotify, taskNumber);
+}
+
+/**
+ * @brief Queue operation hook
+ *
+ * Queues are identified by the low 16 bits of their address; this is unique within a single RAM
+ * bank.
+ *
+ * @param type Event type (one of the queue events)
+ * @param queue Queue on which the operation was performed
+ */
+extern "C" void rtos_trace_queue(const uint8_t type, const void *queue) {
+    Trace::Put(static_cast<Trace::Event>(type), reinterpret_cast<uintptr_t>(queue) & 0xFFFF);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file
+ *
+ * @brief Kernel event tracer
+ *
+ * Records task switches, interrupt entry/exit, queue operations and task notifications into a
+ * RAM ring buffer, which can then be read out by the host and converted into a timeline.
+ */
+#ifndef RTOS_TRACE_H
+#define RTOS_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// only the core intrinsics are needed, so drivers may include this alongside any device header
+#include <cmsis_gcc.h>
+
+#include <etl/span.h>
+
+namespace Rtos::Trace {
+/**
+ * @brief Trace event types
+ *
+ * @remark These must be kept in sync with the host side trace decoder.
+ */
+enum class Event: uint8_t {
+    /// Task was switched in (id = task number)
+    TaskSwitchIn                        = 0x01,
+    /// Task was switched out (id = task number)
+    TaskSwitchOut                       = 0x02,
+    /// Interrupt handler entered (id = exception number)
+    IsrEnter                            = 0x03,
+    /// Interrupt handler exited (id = exception number)
+    IsrExit                             = 0x04,
+    /// Item sent to a queue (id = queue)
+    QueueSend                           = 0x05,
+    /// Item received from a queue (id = queue)
+    QueueReceive                        = 0x06,
+    /// Task blocked sending to a queue (id = queue)
+    QueueBlockSend                      = 0x07,
+    /// Task blocked receiving from a queue (id = queue)
+    QueueBlockReceive                   = 0x08,
+    /// Task was notified (id = task number)
+    TaskNotify                          = 0x09,
+};
+
+/**
+ * @brief A single trace record
+ *
+ * Records are kept as small as possible, to fit as many events as possible into the ring buffer.
+ */
+struct Record {
+    /// Cycle counter value when the event took place
+    uint32_t timestamp;
+    /// Event type
+    Event type;
+    /// Reserved, set to 0
+    uint8_t reserved;
+    /// Event specific identifier (task number, exception number, queue)
+    uint16_t id;
+} __attribute__((packed));
+static_assert(sizeof(Record) == 8);
+
+/// Number of records in the trace ring buffer
+constexpr static const size_t kNumRecords{512};
+
+void Put(const Event type, const uint16_t id);
+
+void Start();
+void Stop();
+void Reset();
+
+size_t GetNumRecords();
+size_t Read(const size_t offset, etl::span<Record> outRecords);
+
+/**
+ * @brief Record interrupt handler entry
+ *
+ * Invoke at the top of an interrupt handler to record its execution.
+ */
+inline void IsrEnter() {
+    Put(Event::IsrEnter, static_cast<uint16_t>(__get_IPSR()));
+}
+
+/**
+ * @brief Record interrupt handler exit
+ *
+ * Invoke at the end of an interrupt handler.
+ */
+inline void IsrExit() {
+    Put(Event::IsrExit, static_cast<uint16_t>(__get_IPSR()));
+}
+}
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file
+ *
+ * @brief Software watchdog check-ins
+ */
+#include "Checkin.h"
+
+#include "Log/Logger.h"
+#include "Rtos/Rtos.h"
+
+using namespace Supervisor;
+
+uint32_t Checkin::gRegistered{0};
+uint32_t Checkin::gPending{0};
+etl::array<uint32_t, Checkin::kMaxClients> Checkin::gDeadline;
+etl::array<uint32_t, Checkin::kMaxClients> Checkin::gLastSeen;
+uint32_t Checkin::gLastRegistered{0};
+
+/**
+ * @brief Register a check-in client
+ *
+ * From this point on, the client must check in at least once every deadline period, or the system
+ * will be reset.
+ *
+ * @param client Client to register
+ * @param deadline Maximum time between check-ins, in milliseconds
+ */
+void Checkin::Register(const Client client, const uint32_t deadline) {
+    const auto bit = static_cast<uint8_t>(client);
+    REQUIRE(bit < kMaxClients, "invalid checkin client %u", bit);
+
+    gDeadline[bit] = pdMS_TO_TICKS(deadline);
+
+    /*
+     * The supervisor starts the client's first deadline period when it first observes it as
+     * registered. The check-in covers a client that is unregistered and registered again between
+     * two evaluations, which the supervisor can't tell apart from one that stayed registered.
+     */
+    CheckIn(client);
+    __atomic_fetch_or(&gRegistered, (1U << bit), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Unregister a check-in client
+ *
+ * The client is no longer taken into account when deciding whether to pet the watchdog.
+ */
+void Checkin::Unregister(const Client client) {
+    const auto bit = static_cast<uint8_t>(client);
+    __atomic_fetch_and(&gRegistered, ~(1U << bit), __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Evaluate client check-ins
+ *
+ * Consume all check-ins since the last evaluation, and check that every registered client has
+ * checked in within its deadline.
+ *
+ * @param now Current time, in ticks
+ * @param outMissed Set to the first client that missed its deadline
+ * @param outOverdue Set to the time by which the client exceeded its deadline, in ticks
+ *
+ * @return Whether all registered clients have checked in within their deadlines
+ *
+ * @remark This should only be called from the supervisor task.
+ */
+bool Checkin::Evaluate(const uint32_t now, Client &outMissed, uint32_t &outOverdue) {
+    const auto registered = __atomic_load_n(&gRegistered, __ATOMIC_ACQUIRE);
+    const auto pending = __atomic_exchange_n(&gPending, 0, __ATOMIC_RELAXED);
+
+    return Evaluate(now, registered, pending, outMissed, outOverdue);
+}
+
+/**
+ * @brief Evaluate client check-ins against a snapshot of the bitmaps
+ *
+ * Clients that weren't registered at the previous evaluation are treated as having checked in
+ * now. The bitmaps aren't read atomically: a client may register between the two reads, in which
+ * case the check-in made by registering is consumed before the client is part of the registered
+ * snapshot, and the next evaluation sees it registered with no check-in.
+ *
+ * @param now Current time, in ticks
+ * @param registered Bitmap of registered clients
+ * @param pending Bitmap of clients that checked in since the last evaluation
+ * @param outMissed Set to the first client that missed its deadline
+ * @param outOverdue Set to the time by which the client exceeded its deadline, in ticks
+ *
+ * @return Whether all registered clients have checked in within their deadlines
+ *
+ * @remark This should only be called from the supervisor task.
+ */
+bool Checkin::Evaluate(const uint32_t now, const uint32_t registered, const uint32_t pending,
+        Client &outMissed, uint32_t &outOverdue) {
+    const auto seen = pending | (registered & ~gLastRegistered);
+    gLastRegistered = registered;
+
+    bool ok{true};
+
+    for(uint32_t remaining = registered; remaining; remaining &= (remaining - 1)) {
+        const auto bit = __builtin_ctz(remaining);
+
+        if(seen & (1U << bit)) {
+            gLastSeen[bit] = now;
+            continue;
+        }
+
+        const auto elapsed = now - gLastSeen[bit];
+        if(ok && elapsed > gDeadline[bit]) {
+            outMissed = static_cast<Client>(bit);
+            outOverdue = elapsed - gDeadline[bit];
+            ok = false;
+        }
+    }
+
+    return ok;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file
+ *
+ * @brief Software watchdog check-ins
+ *
+ * Tasks that should be monitored by the supervisor register themselves here, along with a deadline
+ * by which they must check in again. The hardware watchdog is only pet while every registered task
+ * has checked in within its deadline.
+ */
+#ifndef SUPERVISOR_CHECKIN_H
+#define SUPERVISOR_CHECKIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/array.h>
+#include <etl/string_view.h>
+
+namespace Supervisor {
+/**
+ * @brief Deadline based task check-in tracking
+ *
+ * Each client is a bit in a pair of bitmaps: one indicating which clients are registered, and
+ * another in which clients mark that they've checked in since the last evaluation. Both are only
+ * ever modified with atomic operations, so checking in is lock-free and may be done from any
+ * context, including interrupt handlers.
+ *
+ * The supervisor periodically evaluates the bitmaps: it records the time of each client's most
+ * recent check-in, and determines whether any of them has exceeded its deadline. A client counts
+ * as having checked in at the first evaluation that observes it as registered.
+ */
+class Checkin {
+    public:
+        /**
+         * @brief Check-in clients
+         *
+         * Each value is the bit position of the client in the check-in bitmaps.
+         */
+        enum class Client: uint8_t {
+            /// Load control task
+            Control                     = 0,
+            /// Host message handler task
+            Rpmsg                       = 1,
+        };
+
+        /// Maximum number of clients
+        constexpr static const size_t kMaxClients{32};
+
+    public:
+        static void Register(const Client client, const uint32_t deadline);
+        static void Unregister(const Client client);
+
+        /**
+         * @brief Check in a client
+         *
+         * Marks the client as alive; this should be called at least once per the client's
+         * deadline.
+         *
+         * @remark This may be called from any context.
+         */
+        static inline void CheckIn(const Client client) {
+            __atomic_fetch_or(&gPending, (1U << static_cast<uint8_t>(client)), __ATOMIC_RELAXED);
+        }
+
+        static bool Evaluate(const uint32_t now, Client &outMissed, uint32_t &outOverdue);
+        static bool Evaluate(const uint32_t now, const uint32_t registered, const uint32_t pending,
+                Client &outMissed, uint32_t &outOverdue);
+
+        /**
+         * @brief Get the display name of a client
+         */
+        static constexpr etl::string_view GetName(const Client client) {
+            switch(client) {
+                case Client::Control:
+                    return "Control";
+                case Client::Rpmsg:
+                    return "Rpmsg";
+            }
+            return "?";
+        }
+
+    private:
+        /// Bitmap of registered clients
+        static uint32_t gRegistered;
+        /// Bitmap of clients that have checked in since the last evaluation
+        static uint32_t gPending;
+
+        /// Check-in deadline for each client, in ticks
+        static etl::array<uint32_t, kMaxClients> gDeadline;
+        /// Time of each client's most recent check-in, in ticks (owned by the supervisor)
+        static etl::array<uint32_t, kMaxClients> gLastSeen;
+        /// Registered clients as of the previous evaluation (owned by the supervisor)
+        static uint32_t gLastRegistered;
+};
+}
+
+#endif
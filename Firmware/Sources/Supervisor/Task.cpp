@@ -5,6 +5,7 @@
 #include "Rpc/Rpc.h"
 #include "Rtos/Rtos.h"
 
+#include "Checkin.h"
 #include "Task.h"
 
 using namespace Supervisor;
@@ -83,9 +84,20 @@ void Task::main() {
  * @brief Process a watchdog early warning event
  *
  * Evaluate the system's state, and kick the watchdog if it's valid.
+ *
+ * If any registered task failed to check in within its deadline, we panic: this records the task
+ * that missed its deadline in the crash snapshot, and since the watchdog is no longer pet, the
+ * system will be reset shortly after.
  */
 void Task::wdgEarlyWarning() {
-    // TODO: implement system status checking
+    Checkin::Client missed;
+    uint32_t overdue;
+
+    if(!Checkin::Evaluate(xTaskGetTickCount(), missed, overdue)) {
+        Logger::Panic("supervisor: %s missed checkin (%u ms overdue)",
+                Checkin::GetName(missed).data(), overdue * portTICK_PERIOD_MS);
+    }
+
     Drivers::Watchdog::Pet();
 
     // alternate the status LED
@@ -0,0 +1,90 @@
+#include "Crc32.h"
+
+#include <string.h>
+
+#include <etl/array.h>
+
+using namespace Util;
+
+/// Reflected CRC-32 polynomial
+constexpr static const uint32_t kPolynomial{0xEDB88320};
+
+/// Lookup tables for the slice-by-8 algorithm
+using Tables = etl::array<etl::array<uint32_t, 256>, 8>;
+
+/**
+ * @brief Generate the lookup tables
+ *
+ * The first table is the classic byte-wise CRC table; each subsequent table holds the CRC of a
+ * byte followed by one more zero byte than the previous table.
+ */
+static constexpr Tables GenerateTables() {
+    Tables tables{};
+
+    for(uint32_t i = 0; i < 256; i++) {
+        uint32_t crc{i};
+        for(size_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
+        }
+        tables[0][i] = crc;
+    }
+
+    for(uint32_t i = 0; i < 256; i++) {
+        for(size_t slice = 1; slice < 8; slice++) {
+            const auto prev = tables[slice - 1][i];
+            tables[slice][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+
+    return tables;
+}
+
+/// CRC lookup tables (generated at compile time, so they live in flash)
+constexpr static const Tables gTables{GenerateTables()};
+
+/**
+ * @brief Calculate CRC-32
+ *
+ * Bytes are processed individually until the input is aligned, then 8 bytes at a time, and any
+ * trailing bytes individually again.
+ *
+ * @param data Data to checksum
+ * @param dataLen Number of bytes of data
+ * @param previous CRC of any data preceding this buffer, or 0
+ *
+ * @return CRC-32 of the data
+ */
+uint32_t Crc32::Calculate(const void *data, const size_t dataLen, const uint32_t previous) {
+    auto ptr = reinterpret_cast<const uint8_t *>(data);
+    size_t remaining{dataLen};
+    uint32_t crc{~previous};
+
+    // process bytes until aligned
+    while(remaining && (reinterpret_cast<uintptr_t>(ptr) & 0x3)) {
+        crc = (crc >> 8) ^ gTables[0][(crc ^ *ptr++) & 0xFF];
+        remaining--;
+    }
+
+    // then 8 bytes at a time
+    while(remaining >= 8) {
+        uint32_t one, two;
+        memcpy(&one, ptr, sizeof(one));
+        memcpy(&two, ptr + 4, sizeof(two));
+        one ^= crc;
+
+        crc = gTables[7][one & 0xFF] ^ gTables[6][(one >> 8) & 0xFF] ^
+            gTables[5][(one >> 16) & 0xFF] ^ gTables[4][one >> 24] ^
+            gTables[3][two & 0xFF] ^ gTables[2][(two >> 8) & 0xFF] ^
+            gTables[1][(two >> 16) & 0xFF] ^ gTables[0][two >> 24];
+
+        ptr += 8;
+        remaining -= 8;
+    }
+
+    // and finally, the tail
+    while(remaining--) {
+        crc = (crc >> 8) ^ gTables[0][(crc ^ *ptr++) & 0xFF];
+    }
+
+    return ~crc;
+}
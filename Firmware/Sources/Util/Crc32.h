@@ -0,0 +1,37 @@
+#ifndef UTIL_CRC32_H
+#define UTIL_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/span.h>
+
+namespace Util {
+/**
+ * @brief CRC-32 calculation
+ *
+ * Calculates the standard (IEEE 802.3, as used by zlib) CRC-32 of data, using the slice-by-8
+ * algorithm: it processes 8 bytes per iteration using eight 256 entry lookup tables, which trades
+ * 8K of flash for being several times faster than the classic byte-wise table algorithm.
+ */
+class Crc32 {
+    public:
+        /**
+         * @brief Calculate the CRC of a buffer
+         *
+         * @param data Data to checksum
+         * @param previous CRC of the data preceding this buffer, to calculate the CRC over
+         *        multiple discontiguous buffers
+         *
+         * @return CRC over the previous data and this buffer
+         */
+        inline static uint32_t Calculate(etl::span<const uint8_t> data,
+                const uint32_t previous = 0) {
+            return Calculate(data.data(), data.size(), previous);
+        }
+        static uint32_t Calculate(const void *data, const size_t dataLen,
+                const uint32_t previous = 0);
+};
+}
+
+#endif
@@ -1,7 +1,11 @@
 #include "InventoryRom.h"
+#include "Crc32.h"
 
 #include "Log/Logger.h"
 
+#include <string.h>
+
+#include <etl/algorithm.h>
 #include <etl/array.h>
 
 using namespace Util;
@@ -100,3 +104,342 @@ beach:;
     // clean up
     return err;
 }
+
+
+
+etl::array<InventoryRom::CacheEntry, InventoryRom::kCacheSize> InventoryRom::gCache;
+size_t InventoryRom::gCacheNext{0};
+
+/**
+ * @brief Read and decode an inventory ROM
+ *
+ * The ROM is read sequentially in fixed size chunks (aligned to the chunk size) which are fed
+ * through the streaming parser, until the end atom is found.
+ *
+ * @param reader Callback to read from ROM
+ * @param readerCtx Context to reader
+ * @param romSize Total size of the ROM, in bytes
+ * @param out Structure to receive the decoded contents
+ *
+ * @return Positive number of atoms read, or a negative error code.
+ */
+int InventoryRom::Read(ReaderCallback reader, void *readerCtx, const size_t romSize,
+        Contents &out) {
+    int err;
+    etl::array<uint8_t, kReadChunkSize> chunk;
+    Parser parser(out);
+
+    for(uintptr_t addr = 0; !parser.isDone(); addr += kReadChunkSize) {
+        if(addr >= romSize) {
+            return Errors::Truncated;
+        }
+
+        const auto length = etl::min(kReadChunkSize, romSize - addr);
+        etl::span<uint8_t> buf(chunk.data(), length);
+
+        err = reader(addr, length, buf, readerCtx);
+        if(err) {
+            return err;
+        }
+
+        err = parser.feed(buf);
+        if(err) {
+            return err;
+        }
+    }
+
+    return parser.getNumAtoms();
+}
+
+/**
+ * @brief Get the decoded contents of an inventory ROM, using the cache
+ *
+ * If the ROM belonging to the board with the given serial number was read before, its cached
+ * contents are returned. Otherwise, the ROM is read and decoded, and the result is cached.
+ *
+ * @param serial Serial number of the board the ROM belongs to
+ * @param reader Callback to read from ROM
+ * @param readerCtx Context to reader
+ * @param romSize Total size of the ROM, in bytes
+ * @param out Variable to receive a pointer to the ROM contents
+ *
+ * @return 0 on success, or a negative error code.
+ *
+ * @remark This is not thread safe; only a single task should read inventory ROMs.
+ */
+int InventoryRom::ReadCached(etl::span<const uint8_t, 16> serial, ReaderCallback reader,
+        void *readerCtx, const size_t romSize, const Contents *&out) {
+    for(const auto &entry : gCache) {
+        if(entry.valid && !memcmp(entry.serial.data(), serial.data(), serial.size())) {
+            out = &entry.contents;
+            return 0;
+        }
+    }
+
+    // read the ROM into the next entry to replace
+    auto &entry = gCache[gCacheNext];
+    entry.valid = false;
+
+    const auto err = Read(reader, readerCtx, romSize, entry.contents);
+    if(err < 0) {
+        return err;
+    }
+
+    memcpy(entry.serial.data(), serial.data(), serial.size());
+    entry.valid = true;
+    gCacheNext = (gCacheNext + 1) % kCacheSize;
+
+    out = &entry.contents;
+    return 0;
+}
+
+
+
+/**
+ * @brief Consume the next chunk of the ROM
+ *
+ * @param chunk ROM data immediately following the data passed to the previous call
+ *
+ * @return 0 on success, or a negative error code. Once an error is returned, or the end atom is
+ *         reached, further data is ignored.
+ */
+int InventoryRom::Parser::feed(etl::span<const uint8_t> chunk) {
+    int err;
+    size_t i{0};
+
+    while(i < chunk.size() && this->state != State::Done) {
+        switch(this->state) {
+            // buffer the header, then validate it
+            case State::Header: {
+                const auto needed = sizeof(IdpromHeader) - this->bufferUsed;
+                const auto bytes = etl::min(needed, chunk.size() - i);
+
+                memcpy(this->buffer.data() + this->bufferUsed, chunk.data() + i, bytes);
+                this->crc = Crc32::Calculate(chunk.subspan(i, bytes), this->crc);
+                this->bufferUsed += bytes;
+                i += bytes;
+
+                if(this->bufferUsed == sizeof(IdpromHeader)) {
+                    err = this->validateHeader();
+                    if(err) {
+                        this->state = State::Done;
+                        return err;
+                    }
+
+                    this->bufferUsed = 0;
+                    this->state = State::SkipToAtoms;
+                }
+                break;
+            }
+
+            // discard any header data we don't understand
+            case State::SkipToAtoms: {
+                const auto offset = this->offset + i;
+                const auto bytes = etl::min(this->firstAtom - offset, chunk.size() - i);
+                this->crc = Crc32::Calculate(chunk.subspan(i, bytes), this->crc);
+                i += bytes;
+
+                if(offset + bytes == this->firstAtom) {
+                    this->state = State::AtomHeader;
+                }
+                break;
+            }
+
+            // read an atom header
+            case State::AtomHeader:
+                this->buffer[this->bufferUsed++] = chunk[i++];
+
+                if(this->bufferUsed == sizeof(AtomHeader)) {
+                    memcpy(&this->atom, this->buffer.data(), sizeof(AtomHeader));
+                    this->bufferUsed = 0;
+
+                    if(this->atom.type == AtomType::Invalid) {
+                        this->state = State::Done;
+                        return Errors::InvalidType;
+                    }
+
+                    // zero length atoms are finished right away
+                    if(!this->atom.length) {
+                        err = this->finishAtom();
+                        if(err) {
+                            this->state = State::Done;
+                            return err;
+                        }
+                    } else {
+                        this->state = State::Payload;
+                    }
+                }
+                break;
+
+            // buffer an atom's payload
+            case State::Payload: {
+                const auto needed = this->atom.length - this->bufferUsed;
+                const auto bytes = etl::min(needed, chunk.size() - i);
+
+                memcpy(this->buffer.data() + this->bufferUsed, chunk.data() + i, bytes);
+                this->bufferUsed += bytes;
+                i += bytes;
+
+                if(this->bufferUsed == this->atom.length) {
+                    err = this->finishAtom();
+                    if(err) {
+                        this->state = State::Done;
+                        return err;
+                    }
+                }
+                break;
+            }
+
+            case State::Done:
+                break;
+        }
+    }
+
+    this->offset += chunk.size();
+    return 0;
+}
+
+/**
+ * @brief Validate the ROM header
+ *
+ * The header has been read into the buffer in its entirety.
+ *
+ * @return 0 if the header is valid, or an error code.
+ */
+int InventoryRom::Parser::validateHeader() {
+    IdpromHeader hdr;
+    memcpy(&hdr, this->buffer.data(), sizeof(hdr));
+
+    hdr.magic = __builtin_bswap32(hdr.magic);
+    hdr.firstAtom = __builtin_bswap16(hdr.firstAtom);
+
+    if(hdr.magic != IdpromHeader::kMagicValue || hdr.size < sizeof(hdr) ||
+            hdr.version > 0x1F || hdr.firstAtom < hdr.size) {
+        return Errors::InvalidHeader;
+    }
+
+    this->firstAtom = hdr.firstAtom;
+    return 0;
+}
+
+/**
+ * @brief Handle a completely read atom
+ *
+ * Decode the payload of well known atoms into the output structure; the payload of all others is
+ * ignored. The next state is set up as well.
+ *
+ * @return 0 on success, or an error code if the atom's payload is invalid.
+ */
+int InventoryRom::Parser::finishAtom() {
+    const etl::span<const uint8_t> payload(this->buffer.data(), this->atom.length);
+    auto &out = this->out;
+
+    /*
+     * The checksum atom covers everything before its header; every other atom's header and
+     * payload are added to the checksum for the atoms following it.
+     */
+    if(this->atom.type == AtomType::Crc32) {
+        uint32_t expected;
+        if(payload.size() != sizeof(expected)) {
+            return Errors::InvalidPayload;
+        }
+
+        memcpy(&expected, payload.data(), sizeof(expected));
+        if(__builtin_bswap32(expected) != this->crc) {
+            return Errors::ChecksumMismatch;
+        }
+    }
+
+    this->crc = Crc32::Calculate(&this->atom, sizeof(this->atom), this->crc);
+    this->crc = Crc32::Calculate(payload, this->crc);
+
+    this->numAtoms++;
+    this->bufferUsed = 0;
+    this->state = State::AtomHeader;
+
+    switch(this->atom.type) {
+        case AtomType::End:
+            this->state = State::Done;
+            break;
+
+        // big endian 16-bit integer
+        case AtomType::HwRevision:
+            if(payload.size() != sizeof(uint16_t)) {
+                return Errors::InvalidPayload;
+            }
+            out.hwRevision = (payload[0] << 8) | payload[1];
+            break;
+
+        // strings (not NUL terminated in the ROM)
+        case AtomType::Name:
+        case AtomType::Manufacturer: {
+            auto &str = (this->atom.type == AtomType::Name) ? out.name : out.manufacturer;
+            const auto length = etl::min(payload.size(), Contents::kMaxStringLength);
+
+            memcpy(str.data(), payload.data(), length);
+            str[length] = '\0';
+            break;
+        }
+
+        // binary UUID
+        case AtomType::DriverId:
+            if(payload.size() != out.driverId.size()) {
+                return Errors::InvalidPayload;
+            }
+            memcpy(out.driverId.data(), payload.data(), out.driverId.size());
+            break;
+
+        // two big endian 32-bit integers
+        case AtomType::DriverRating:
+            if(payload.size() != 2 * sizeof(uint32_t)) {
+                return Errors::InvalidPayload;
+            }
+            memcpy(&out.maxVoltage, payload.data(), sizeof(uint32_t));
+            memcpy(&out.maxCurrent, payload.data() + sizeof(uint32_t), sizeof(uint32_t));
+            out.maxVoltage = __builtin_bswap32(out.maxVoltage);
+            out.maxCurrent = __builtin_bswap32(out.maxCurrent);
+            break;
+
+        // target, channel, then pairs of big endian 32-bit integers
+        case AtomType::Calibration: {
+            constexpr static const size_t kPointSize{2 * sizeof(int32_t)};
+
+            if(payload.size() < 2 || (payload.size() - 2) % kPointSize) {
+                return Errors::InvalidPayload;
+            }
+
+            const auto numPoints = (payload.size() - 2) / kPointSize;
+            if(numPoints < 2 || numPoints > kMaxCalibrationPoints) {
+                return Errors::InvalidPayload;
+            } else if(out.numCalibrationTables == kMaxCalibrationTables) {
+                // ignore any excess tables
+                break;
+            }
+
+            auto &table = out.calibration[out.numCalibrationTables++];
+            table.target = payload[0];
+            table.channel = payload[1];
+            table.numPoints = numPoints;
+
+            for(size_t i = 0; i < numPoints; i++) {
+                const auto point = payload.subspan(2 + (i * kPointSize), kPointSize);
+                uint32_t rawIn, rawOut;
+
+                memcpy(&rawIn, point.data(), sizeof(rawIn));
+                memcpy(&rawOut, point.data() + sizeof(rawIn), sizeof(rawOut));
+
+                table.points[i] = {
+                    .in = static_cast<int32_t>(__builtin_bswap32(rawIn)),
+                    .out = static_cast<int32_t>(__builtin_bswap32(rawOut)),
+                };
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    out.present.set(static_cast<uint8_t>(this->atom.type));
+    return 0;
+}
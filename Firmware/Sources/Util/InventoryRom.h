@@ -4,8 +4,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <etl/array.h>
+#include <etl/bitset.h>
 #include <etl/span.h>
 
+#include "PiecewiseLinear.h"
+
 namespace Util {
 /**
  * @brief Helpers for working with inventory ROMs
@@ -39,6 +43,27 @@ class InventoryRom {
              * match, the version is incorrect, or the size/atom start values are nonsensical.
              */
             InvalidHeader               = -50002,
+
+            /**
+             * @brief Invalid atom payload
+             *
+             * The payload of a well known atom type has the wrong length.
+             */
+            InvalidPayload              = -50003,
+
+            /**
+             * @brief ROM ended prematurely
+             *
+             * The end of the ROM was reached before the end atom.
+             */
+            Truncated                   = -50004,
+
+            /**
+             * @brief Checksum mismatch
+             *
+             * The ROM contains a checksum atom, but its value does not match the ROM contents.
+             */
+            ChecksumMismatch            = -50005,
         };
 
         /**
@@ -127,6 +152,16 @@ class InventoryRom {
              */
             DriverId                    = 0x04,
 
+            /**
+             * @brief Checksum
+             *
+             * A 32-bit integer containing the CRC-32 (IEEE 802.3) over all bytes of the ROM
+             * preceding this atom's header, starting with the IDPROM header. This atom is
+             * optional; if present, it should be the last atom before the end atom, so that it
+             * covers all others.
+             */
+            Crc32                       = 0x05,
+
             /**
              * @brief First application defined
              *
@@ -142,6 +177,17 @@ class InventoryRom {
              */
             DriverRating                = AppSpecific + 0,
 
+            /**
+             * @brief Calibration table
+             *
+             * Calibration of a single converter channel: an 8-bit target type (interpreted by the
+             * driver), an 8-bit channel index, followed by 2 to kMaxCalibrationPoints pairs of
+             * signed 32-bit integers. Each pair is an uncalibrated value (as produced by the ideal
+             * transfer function) and the corresponding true value; values in between are
+             * linearly interpolated. This atom may occur multiple times.
+             */
+            Calibration                 = AppSpecific + 1,
+
             /**
              * @brief Invalid header type
              *
@@ -221,9 +267,181 @@ class InventoryRom {
         using AtomDataCallback = void(*)(const AtomHeader &header,
                 etl::span<const uint8_t> buffer, void *ctx);
 
+        /// Maximum number of points in a calibration table
+        constexpr static const size_t kMaxCalibrationPoints{8};
+        /// Maximum number of calibration tables in a ROM
+        constexpr static const size_t kMaxCalibrationTables{10};
+
+        /**
+         * @brief Calibration table (Calibration atom)
+         */
+        struct CalibrationTable {
+            /// Type of converter this table applies to (driver specific)
+            uint8_t target{0};
+            /// Channel index
+            uint8_t channel{0};
+            /// Number of valid points
+            uint8_t numPoints{0};
+            /// Points, in order of increasing uncalibrated value
+            etl::array<PiecewiseLinearPoint, kMaxCalibrationPoints> points{};
+
+            /**
+             * @brief Get the valid points of the table
+             */
+            inline etl::span<const PiecewiseLinearPoint> getPoints() const {
+                return {this->points.data(), this->numPoints};
+            }
+        };
+
+        /**
+         * @brief Decoded contents of an inventory ROM
+         *
+         * Holds the values of all well known atoms in the ROM, decoded into their native types.
+         * Use has() to check whether a particular atom was present.
+         */
+        struct Contents {
+            /// Maximum length of string atoms; longer strings are truncated
+            constexpr static const size_t kMaxStringLength{31};
+
+            /// Atom types encountered in the ROM
+            etl::bitset<256> present;
+
+            /// Hardware revision (HwRevision)
+            uint16_t hwRevision{0};
+            /// Driver identifier (DriverId)
+            etl::array<uint8_t, 16> driverId{};
+            /// Maximum input voltage, in mV (DriverRating)
+            uint32_t maxVoltage{0};
+            /// Maximum load current, in mA (DriverRating)
+            uint32_t maxCurrent{0};
+            /// Descriptive name, NUL terminated (Name)
+            etl::array<char, kMaxStringLength + 1> name{};
+            /// Manufacturer name, NUL terminated (Manufacturer)
+            etl::array<char, kMaxStringLength + 1> manufacturer{};
+            /// Calibration tables (Calibration)
+            etl::array<CalibrationTable, kMaxCalibrationTables> calibration{};
+            /// Number of valid calibration tables
+            size_t numCalibrationTables{0};
+
+            /**
+             * @brief Check whether an atom was present in the ROM
+             */
+            inline bool has(const AtomType type) const {
+                return this->present.test(static_cast<uint8_t>(type));
+            }
+        };
+
+        /**
+         * @brief Streaming inventory ROM parser
+         *
+         * Consumes the raw contents of a ROM in arbitrarily sized chunks, in order, validating the
+         * header and each atom as it goes, and decoding well known atoms into a Contents struct.
+         * This allows reading the ROM in a few large reads, rather than one read per header and
+         * payload.
+         *
+         * A running checksum is kept over all data consumed, so that the checksum atom (if any)
+         * can be verified. Its presence in the contents indicates a successfully verified ROM.
+         */
+        class Parser {
+            public:
+                /**
+                 * @brief Set up the parser
+                 *
+                 * @param out Structure to receive the decoded atoms; it's reset
+                 */
+                Parser(Contents &out) : out(out) {
+                    out = {};
+                }
+
+                int feed(etl::span<const uint8_t> chunk);
+
+                /**
+                 * @brief Check whether the end atom has been parsed
+                 */
+                inline bool isDone() const {
+                    return this->state == State::Done;
+                }
+
+                /**
+                 * @brief Get the number of atoms parsed so far (including the end atom)
+                 */
+                inline size_t getNumAtoms() const {
+                    return this->numAtoms;
+                }
+
+            private:
+                /// Parser states
+                enum class State: uint8_t {
+                    /// Reading the ROM header
+                    Header,
+                    /// Skipping the rest of the header, up to the first atom
+                    SkipToAtoms,
+                    /// Reading an atom header
+                    AtomHeader,
+                    /// Reading an atom's payload
+                    Payload,
+                    /// The end atom was read
+                    Done,
+                };
+
+                int validateHeader();
+                int finishAtom();
+
+            private:
+                /// Output structure
+                Contents &out;
+
+                /// Current state
+                State state{State::Header};
+                /// Number of bytes consumed so far
+                size_t offset{0};
+                /// Offset of the first atom
+                size_t firstAtom{0};
+                /// Number of atoms parsed
+                size_t numAtoms{0};
+                /// CRC over all data preceding the current atom's header
+                uint32_t crc{0};
+
+                /// Header of the atom being parsed
+                AtomHeader atom;
+                /// Number of bytes buffered (of the ROM header, atom header or atom payload)
+                size_t bufferUsed{0};
+                /// Buffer for the ROM header, atom headers and atom payloads
+                etl::array<uint8_t, 255> buffer;
+        };
+
+    public:
         static int GetAtoms(ReaderCallback reader, void *readerCtx,
                 AtomCallback atomCallback, void *atomCallbackCtx,
                 AtomDataCallback atomDataCallback, void *atomDataCallbackCtx);
+
+        static int Read(ReaderCallback reader, void *readerCtx, const size_t romSize,
+                Contents &out);
+        static int ReadCached(etl::span<const uint8_t, 16> serial, ReaderCallback reader,
+                void *readerCtx, const size_t romSize, const Contents *&out);
+
+    private:
+        /// Size of the chunks the ROM is read in, in bytes
+        constexpr static const size_t kReadChunkSize{64};
+        /// Number of ROMs whose contents are cached
+        constexpr static const size_t kCacheSize{2};
+
+        /**
+         * @brief Cached ROM contents
+         */
+        struct CacheEntry {
+            /// Serial number of the board the ROM belongs to
+            etl::array<uint8_t, 16> serial;
+            /// Set if this entry is in use
+            bool valid{false};
+            /// Decoded contents of the ROM
+            Contents contents;
+        };
+
+        /// Cache of decoded ROM contents, indexed by board serial
+        static etl::array<CacheEntry, kCacheSize> gCache;
+        /// Index of the cache entry to replace next
+        static size_t gCacheNext;
 };
 }
 
@@ -0,0 +1,140 @@
+#ifndef UTIL_PIECEWISELINEAR_H
+#define UTIL_PIECEWISELINEAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <etl/array.h>
+#include <etl/span.h>
+
+namespace Util {
+/**
+ * @brief Point on a piecewise linear function
+ */
+struct PiecewiseLinearPoint {
+    /// Input value
+    int32_t in;
+    /// Output value at this input
+    int32_t out;
+};
+
+/**
+ * @brief Fixed point piecewise linear function
+ *
+ * Maps an input value to an output by linear interpolation between a small number of points;
+ * beyond the first and last point, the outermost segments are extrapolated. This is used to apply
+ * calibration (combined gain, offset and linearity correction) to measurements and setpoints.
+ *
+ * The slope of each segment is precomputed when the points are loaded, so evaluating the function
+ * is a short search, a multiply and a shift. Everything is constexpr, so that tables can also be
+ * built at compile time.
+ *
+ * A function with no points loaded is the identity.
+ *
+ * @tparam kMaxPoints Maximum number of points
+ */
+template<size_t kMaxPoints>
+class PiecewiseLinear {
+    static_assert(kMaxPoints >= 2, "need at least two points for a segment");
+
+    public:
+        using Point = PiecewiseLinearPoint;
+
+        constexpr PiecewiseLinear() = default;
+
+        /**
+         * @brief Load the function's points
+         *
+         * @param points Points to interpolate between, in order of strictly increasing input
+         *
+         * @return Whether the points were valid; if not, the function is reset to the identity.
+         */
+        constexpr bool load(etl::span<const Point> points) {
+            this->numPoints = 0;
+
+            if(points.size() < 2 || points.size() > kMaxPoints) {
+                return false;
+            }
+
+            for(size_t i = 0; i < points.size(); i++) {
+                if(i && points[i].in <= points[i - 1].in) {
+                    return false;
+                }
+
+                this->in[i] = points[i].in;
+                this->out[i] = points[i].out;
+            }
+
+            for(size_t i = 0; i < points.size() - 1; i++) {
+                const int64_t dx = static_cast<int64_t>(this->in[i + 1]) - this->in[i];
+                const int64_t dy = static_cast<int64_t>(this->out[i + 1]) - this->out[i];
+                const int64_t scaled = dy * (1LL << kSlopeBits);
+
+                // round to nearest
+                this->slope[i] = (scaled + ((scaled < 0) ? -(dx / 2) : (dx / 2))) / dx;
+            }
+
+            this->numPoints = points.size();
+            return true;
+        }
+
+        /**
+         * @brief Evaluate the function
+         *
+         * @param x Input value
+         *
+         * @return Interpolated output value
+         */
+        constexpr int32_t operator()(const int32_t x) const {
+            if(!this->numPoints) {
+                return x;
+            }
+
+            // find the segment; the last one is also used beyond the last point
+            size_t i{0};
+            while(i < this->numPoints - 2 && x >= this->in[i + 1]) {
+                i++;
+            }
+
+            const int64_t dx = static_cast<int64_t>(x) - this->in[i];
+            const int64_t y = this->out[i] +
+                ((dx * this->slope[i] + (1LL << (kSlopeBits - 1))) >> kSlopeBits);
+
+            if(y > INT32_MAX) {
+                return INT32_MAX;
+            } else if(y < INT32_MIN) {
+                return INT32_MIN;
+            }
+            return static_cast<int32_t>(y);
+        }
+
+        /**
+         * @brief Whether the function is the identity (no points loaded)
+         */
+        constexpr bool isIdentity() const {
+            return !this->numPoints;
+        }
+
+        /**
+         * @brief Get the number of points loaded
+         */
+        constexpr size_t getNumPoints() const {
+            return this->numPoints;
+        }
+
+    private:
+        /// Number of fractional bits in the slopes
+        constexpr static const uint8_t kSlopeBits{16};
+
+        /// Number of points loaded (0 = identity)
+        size_t numPoints{0};
+        /// Input value of each point
+        etl::array<int32_t, kMaxPoints> in{};
+        /// Output value of each point
+        etl::array<int32_t, kMaxPoints> out{};
+        /// Slope of each segment, with kSlopeBits fractional bits
+        etl::array<int64_t, kMaxPoints - 1> slope{};
+};
+}
+
+#endif
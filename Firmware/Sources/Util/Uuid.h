@@ -26,6 +26,15 @@ class Uuid {
          */
         Uuid() = default;
 
+        /**
+         * @brief Initialize an UUID from its bytes
+         *
+         * This allows UUIDs (such as driver identifiers) to be declared as constants.
+         *
+         * @param bytes UUID bytes, in network byte order
+         */
+        constexpr Uuid(const etl::array<uint8_t, kByteSize> &bytes) : data(bytes) {}
+
         /**
          * @brief Initialize an UUID from a given blob
          *
@@ -0,0 +1,620 @@
+/**
+ * @file
+ *
+ * @brief Analog load driver tests
+ *
+ * The board's SPI devices (two MCP356x ADCs and a DAC8562) are simulated behind the select line
+ * decoder, at the device addresses it decodes to their chip selects. The ADCs convert
+ * continuously in simulated time, taking their results from codes set by the test; the I²C
+ * devices are plain register banks.
+ */
+#include "Test.h"
+#include "SimulatedI2CBus.h"
+#include "SimulatedSpiBus.h"
+
+#include "App/Control/AnalogLoadDriver.h"
+#include "Drivers/I2CDevice/AT24CS32.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include <etl/array.h>
+
+using App::Control::AnalogLoadDriver;
+
+/// Device addresses decoded to each chip select (decoder outputs Y1 - Y3)
+constexpr static const uint8_t kVoltageAdcAddress{1}, kCurrentAdcAddress{2}, kDacAddress{3};
+
+/// Conversion time of the ADCs, as configured by the driver (OSR 8192, internal clock) in ns
+constexpr static const uint64_t kConversionTime{6'600'000};
+
+/// Reference voltage of the board's converters (µV)
+constexpr static const int64_t kReferenceVoltage{2'500'000};
+/// Values the driver assumes for the (placeholder) component values
+constexpr static const int64_t kShuntResistance{10}, kCurrentAdcGain{16}, kVSenseDivider{40},
+    kChannelMaxCurrent{10'000'000};
+
+/**
+ * @brief Simulated MCP3561/MCP3562 ADC
+ *
+ * Implements fast commands, incremental register writes and static reads of the data register.
+ * Status bytes and data are in the format the driver configures (32-bit with channel ID.)
+ *
+ * In continuous conversion mode, a conversion completes every kConversionTime after the
+ * configuration was written; in scan mode, each conversion is of the next enabled scan channel.
+ * The result of a conversion is the code set for its channel ID (0 outside of scan mode.)
+ */
+class SimulatedMcp356x: public SimulatedSpiBus::Device {
+    public:
+        /// Device address (as set at the factory)
+        constexpr static const uint8_t kAddress{0b01};
+
+        SimulatedMcp356x() {
+            this->reset();
+        }
+
+        void select() override {
+            this->convert();
+            this->numBytes = 0;
+            this->command = 0;
+            this->wasWritten = false;
+        }
+
+        uint8_t exchange(const uint8_t mosi) override {
+            if(!this->responding) {
+                return 0xFF;
+            }
+
+            // command byte: status is clocked out
+            if(!this->numBytes++) {
+                this->command = mosi;
+
+                if((mosi >> 6) != kAddress) {
+                    this->command = 0xFF;
+                } else if((mosi & 0b11) == 0b00) {
+                    this->fastCommand((mosi >> 2) & 0xF);
+                } else {
+                    this->pointer = (mosi >> 2) & 0xF;
+                    this->byteIndex = 0;
+                }
+
+                return (kAddress << 4) | ((~kAddress & 1) << 3) |
+                    (this->dataReady ? 0 : (1 << 2)) | 0b011;
+            }
+
+            if(this->command == 0xFF || (this->command & 0b11) == 0b00) {
+                return 0xFF;
+            }
+
+            // data phase
+            const auto type = this->command & 0b11;
+            if(type == 0b10) {
+                this->write(mosi);
+                return 0xFF;
+            } else if(this->pointer == 0x0) {
+                return this->readData();
+            }
+            return 0xFF;
+        }
+
+        void deselect() override {
+            if(this->wasWritten && this->isConverting()) {
+                this->scanIndex = 0;
+                this->nextConversion = Rtos::Simulation::Now() + kConversionTime;
+                this->dataReady = false;
+            }
+        }
+
+        /// Read back a register
+        uint32_t getRegister(const uint8_t reg) const {
+            return this->registers[reg];
+        }
+
+    public:
+        /// Conversion results, by channel ID
+        etl::array<int32_t, 16> codes{};
+        /// Whether the device responds on the bus
+        bool responding{true};
+
+        /// Number of full reset fast commands received
+        size_t numResets{0};
+        /// Number of data register reads
+        size_t numDataReads{0};
+
+    private:
+        /// Size of each register, in bytes (0 for the variable length data register)
+        constexpr static const etl::array<uint8_t, 16> kRegisterSizes{{
+            0, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3, 1, 1, 2,
+        }};
+
+        /// Restore the power-on register values
+        void reset() {
+            this->registers = {{
+                0, 0xC0, 0x0C, 0x8B, 0x00, 0x73, 0x01, 0, 0, 0, 0x800000, 0x900000, 0, 0x50, 0xA5, 0,
+            }};
+            this->dataReady = false;
+        }
+
+        void fastCommand(const uint8_t cmd) {
+            if(cmd == 0b1110) {
+                this->reset();
+                this->numResets++;
+            }
+        }
+
+        /// Write a byte into the register at the pointer, MSB first
+        void write(const uint8_t byte) {
+            const auto size = kRegisterSizes[this->pointer];
+            auto &reg = this->registers[this->pointer];
+            const auto shift = 8 * (size - 1 - this->byteIndex);
+
+            reg = (reg & ~(0xFFUL << shift)) | (static_cast<uint32_t>(byte) << shift);
+            this->wasWritten = true;
+
+            if(++this->byteIndex == size) {
+                this->byteIndex = 0;
+                this->pointer = (this->pointer + 1) & 0xF;
+            }
+        }
+
+        /// Read the next byte of the (32-bit, with channel ID) data register
+        uint8_t readData() {
+            const auto raw = static_cast<uint32_t>(this->data) & 0xFFFFFF;
+            const uint8_t sign = (this->data < 0) ? 0xF : 0x0;
+            const uint32_t word = (static_cast<uint32_t>(this->dataChannel) << 28) |
+                (static_cast<uint32_t>(sign) << 24) | raw;
+
+            const auto index = this->byteIndex++;
+            if(index == 3) {
+                this->dataReady = false;
+                this->numDataReads++;
+            }
+            return (index < 4) ? ((word >> (24 - (8 * index))) & 0xFF) : 0xFF;
+        }
+
+        /// Whether continuous conversions are running
+        bool isConverting() const {
+            return ((this->registers[0x1] & 0b11) == 0b11) &&
+                ((this->registers[0x4] >> 6) == 0b11);
+        }
+
+        /// Complete all conversions due by now
+        void convert() {
+            if(!this->isConverting()) {
+                return;
+            }
+
+            while(this->nextConversion <= Rtos::Simulation::Now()) {
+                const uint16_t scan = this->registers[0x7] & 0xFFFF;
+
+                if(scan) {
+                    uint8_t channel;
+                    do {
+                        channel = this->scanIndex;
+                        this->scanIndex = (this->scanIndex + 1) & 0xF;
+                    } while(!(scan & (1U << channel)));
+
+                    this->dataChannel = channel;
+                } else {
+                    this->dataChannel = 0;
+                }
+
+                this->data = this->codes[this->dataChannel];
+                this->dataReady = true;
+                this->nextConversion += kConversionTime;
+            }
+        }
+
+    private:
+        etl::array<uint32_t, 16> registers;
+
+        /// Command byte of the current frame
+        uint8_t command{0};
+        /// Number of bytes exchanged in the current frame
+        size_t numBytes{0};
+        /// Register pointer and byte within it
+        uint8_t pointer{0}, byteIndex{0};
+        /// Whether registers were written in the current frame
+        bool wasWritten{false};
+
+        /// Time at which the next conversion completes
+        uint64_t nextConversion{0};
+        /// Scan channel to convert next
+        uint8_t scanIndex{0};
+
+        /// Most recent conversion result, and its channel ID
+        int32_t data{0};
+        uint8_t dataChannel{0};
+        /// Whether a conversion completed since the data register was last read
+        bool dataReady{false};
+};
+
+/**
+ * @brief Simulated DAC8562
+ *
+ * Executes 24-bit write frames when the chip select is deasserted. The outputs start out with
+ * stale values, as if a previous driver left them on.
+ */
+class SimulatedDac8562: public SimulatedSpiBus::Device {
+    public:
+        void select() override {
+            this->frame = 0;
+            this->numBits = 0;
+        }
+
+        uint8_t exchange(const uint8_t mosi) override {
+            this->frame = (this->frame << 8) | mosi;
+            this->numBits += 8;
+            return 0xFF;
+        }
+
+        void deselect() override {
+            if(this->numBits != 24) {
+                this->numBadFrames++;
+                return;
+            }
+
+            const uint8_t cmd = (this->frame >> 19) & 0b111;
+            const uint8_t address = (this->frame >> 16) & 0b111;
+            const uint16_t data = this->frame & 0xFFFF;
+
+            switch(cmd) {
+                // write input register (or the gain register)
+                case 0b000:
+                case 0b010:
+                    if(cmd == 0b000 && address == 0b010) {
+                        this->gain = data & 0b11;
+                        break;
+                    }
+
+                    if(address == 0b000 || address == 0b111) {
+                        this->inputs[0] = data;
+                    }
+                    if(address == 0b001 || address == 0b111) {
+                        this->inputs[1] = data;
+                    }
+
+                    if(cmd == 0b010) {
+                        this->outputs = this->inputs;
+                        this->numUpdates++;
+                    }
+                    break;
+                // software reset
+                case 0b101:
+                    this->inputs = {};
+                    this->outputs = {};
+                    if(data & 1) {
+                        this->gain = 0;
+                        this->internalReference = false;
+                        this->ldac = 0;
+                    }
+                    this->numResets++;
+                    break;
+                case 0b110:
+                    this->ldac = data & 0b11;
+                    break;
+                case 0b111:
+                    this->internalReference = data & 1;
+                    break;
+            }
+        }
+
+    public:
+        /// Input and output registers of both outputs (A, B)
+        etl::array<uint16_t, 2> inputs{{0x1234, 0x5678}}, outputs{{0x1234, 0x5678}};
+        /// Gain register (bit set = gain of 1)
+        uint8_t gain{0};
+        /// LDAC pin disable register
+        uint8_t ldac{0};
+        /// Whether the internal reference is enabled
+        bool internalReference{true};
+
+        /// Number of times the outputs were updated
+        size_t numUpdates{0};
+        /// Number of software resets
+        size_t numResets{0};
+        /// Number of frames that weren't 24 bits
+        size_t numBadFrames{0};
+
+    private:
+        uint32_t frame{0};
+        size_t numBits{0};
+};
+
+/**
+ * @brief Simulated analog load board
+ */
+struct Board {
+    Board() {
+        this->i2c.attach(0b1010000, &this->idpromDevice);
+        this->i2c.attach(0b100'1100, &this->fan);
+        this->i2c.attach(0b100'0001, &this->io);
+
+        this->spi.attach(kVoltageAdcAddress, &this->voltageAdc);
+        this->spi.attach(kCurrentAdcAddress, &this->currentAdc);
+        this->spi.attach(kDacAddress, &this->dac);
+    }
+
+    SimulatedI2CBus i2c;
+    SimulatedRegisterDevice idpromDevice, fan, io;
+    Drivers::I2CDevice::AT24CS32 idprom{&i2c};
+
+    SimulatedSpiBus spi;
+    SimulatedMcp356x voltageAdc, currentAdc;
+    SimulatedDac8562 dac;
+};
+
+/// ADC code for a channel current (µA)
+static int32_t CurrentToAdcCode(const int64_t current) {
+    return (current * (1LL << 23) * kCurrentAdcGain * kShuntResistance) /
+        (kReferenceVoltage * 1000);
+}
+
+/// ADC code for an input voltage (mV)
+static int32_t VoltageToAdcCode(const int64_t voltage) {
+    return (voltage * 1000 * (1LL << 23)) / (kReferenceVoltage * kVSenseDivider);
+}
+
+/// DAC code for a channel current (µA)
+static uint16_t CurrentToDacCode(const int64_t current) {
+    return (std::min(current, kChannelMaxCurrent) * 0xFFFF) / kChannelMaxCurrent;
+}
+
+/**
+ * @brief Check that a reading is close to the expected value
+ *
+ * Conversions truncate in both directions, so readings may be off by a few LSB (about 2µA for
+ * current readings) per channel.
+ */
+static bool IsClose(const uint32_t actual, const uint32_t expected) {
+    return abs(static_cast<int64_t>(actual) - static_cast<int64_t>(expected)) <= 10;
+}
+
+/// Let one conversion complete, then run the driver interrupt
+static void RunConversion(AnalogLoadDriver &driver) {
+    Rtos::Simulation::Advance(kConversionTime);
+    driver.handleIrq();
+}
+
+/**
+ * @brief Initialization
+ *
+ * The DAC is reset before the ADCs are touched, and both ADCs get their full configuration,
+ * including the open drain IRQ output. The driver waits for the first input voltage reading.
+ */
+static void TestInit() {
+    Board board;
+    board.voltageAdc.codes[0] = VoltageToAdcCode(12'000);
+
+    AnalogLoadDriver driver{&board.i2c, board.idprom, &board.spi};
+
+    // only decoded device addresses are used, and the DAC goes first
+    CHECK(!board.spi.selected.empty());
+    CHECK_EQ(board.spi.selected.front(), kDacAddress);
+    for(const auto address : board.spi.selected) {
+        CHECK(address == kVoltageAdcAddress || address == kCurrentAdcAddress ||
+                address == kDacAddress);
+    }
+
+    // DAC: outputs zeroed, external reference, gain of 1, software updates only
+    CHECK_EQ(board.dac.numResets, 1);
+    CHECK_EQ(board.dac.numBadFrames, 0);
+    CHECK_EQ(board.dac.outputs[0], 0);
+    CHECK_EQ(board.dac.outputs[1], 0);
+    CHECK(!board.dac.internalReference);
+    CHECK_EQ(board.dac.gain, 0b11);
+    CHECK_EQ(board.dac.ldac, 0b11);
+
+    // ADCs: reset, then configured
+    for(const auto adc : {&board.voltageAdc, &board.currentAdc}) {
+        CHECK_EQ(adc->numResets, 1);
+        CHECK_EQ(adc->getRegister(0x1), 0b11'10'00'11);
+        CHECK_EQ(adc->getRegister(0x2), 0b00'1000'00);
+        CHECK_EQ(adc->getRegister(0x4), 0b11'11'0'0'0'0);
+        // IRQ: open drain (IRQ_MODE0 set), fast commands enabled
+        CHECK_EQ(adc->getRegister(0x5), 0b0'000'01'1'0);
+    }
+
+    CHECK_EQ(board.currentAdc.getRegister(0x3), 0b10'101'0'11);
+    CHECK_EQ(board.currentAdc.getRegister(0x7), 0x000300);
+
+    CHECK_EQ(board.voltageAdc.getRegister(0x3), 0b10'001'0'11);
+    CHECK_EQ(board.voltageAdc.getRegister(0x6), 0b0000'1000);
+    CHECK_EQ(board.voltageAdc.getRegister(0x7), 0);
+
+    uint32_t voltage{0};
+    CHECK_EQ(driver.readInputVoltage(voltage), 0);
+    CHECK(IsClose(voltage, 12'000));
+}
+
+/**
+ * @brief Current readings
+ *
+ * The current ADC alternates between the two channels' shunts; each reading updates only the
+ * channel whose scan channel ID it carries.
+ */
+static void TestReadCurrents() {
+    Board board;
+    board.voltageAdc.codes[0] = VoltageToAdcCode(24'000);
+    board.currentAdc.codes[0x8] = CurrentToAdcCode(1'000'000);
+    board.currentAdc.codes[0x9] = CurrentToAdcCode(2'500'000);
+
+    AnalogLoadDriver driver{&board.i2c, board.idprom, &board.spi};
+
+    uint32_t current{0};
+
+    // one full scan updates both channels
+    RunConversion(driver);
+    RunConversion(driver);
+    CHECK_EQ(driver.getChannelCode(0), CurrentToAdcCode(1'000'000));
+    CHECK_EQ(driver.getChannelCode(1), CurrentToAdcCode(2'500'000));
+    CHECK_EQ(driver.readChannelCurrent(0, current), 0);
+    CHECK(IsClose(current, 1'000'000));
+    CHECK_EQ(driver.readChannelCurrent(1, current), 0);
+    CHECK(IsClose(current, 2'500'000));
+
+    CHECK_EQ(driver.readInputCurrent(current), 0);
+    CHECK(IsClose(current, 3'500'000));
+
+    // a single conversion only updates the channel it's for
+    board.currentAdc.codes[0x8] = CurrentToAdcCode(3'000'000);
+    board.currentAdc.codes[0x9] = CurrentToAdcCode(4'000'000);
+    RunConversion(driver);
+
+    const bool updated0 = (driver.getChannelCode(0) == CurrentToAdcCode(3'000'000));
+    const bool updated1 = (driver.getChannelCode(1) == CurrentToAdcCode(4'000'000));
+    CHECK(updated0 != updated1);
+
+    RunConversion(driver);
+    CHECK_EQ(driver.readInputCurrent(current), 0);
+    CHECK(IsClose(current, 7'000'000));
+
+    // input voltage follows along
+    board.voltageAdc.codes[0] = VoltageToAdcCode(5'000);
+    RunConversion(driver);
+
+    uint32_t voltage{0};
+    CHECK_EQ(driver.readInputVoltage(voltage), 0);
+    CHECK(IsClose(voltage, 5'000));
+
+    // negative offsets read as zero current
+    board.currentAdc.codes[0x8] = -100;
+    RunConversion(driver);
+    CHECK_EQ(driver.readChannelCurrent(0, current), 0);
+    CHECK_EQ(current, 0);
+    CHECK_EQ(driver.getChannelCode(0), -100);
+}
+
+/**
+ * @brief Reads without new data
+ *
+ * If an ADC hasn't completed a conversion since it was last read, its reading isn't updated.
+ */
+static void TestNoNewData() {
+    Board board;
+    board.voltageAdc.codes[0] = VoltageToAdcCode(12'000);
+    board.currentAdc.codes[0x8] = CurrentToAdcCode(1'000'000);
+
+    AnalogLoadDriver driver{&board.i2c, board.idprom, &board.spi};
+    RunConversion(driver);
+
+    board.voltageAdc.codes[0] = VoltageToAdcCode(30'000);
+    board.currentAdc.codes[0x8] = CurrentToAdcCode(4'000'000);
+    const auto reads = board.currentAdc.numDataReads;
+
+    driver.handleIrq();
+
+    uint32_t current{0}, voltage{0};
+    CHECK_EQ(driver.readChannelCurrent(0, current), 0);
+    CHECK(IsClose(current, 1'000'000));
+    CHECK_EQ(driver.readInputVoltage(voltage), 0);
+    CHECK(IsClose(voltage, 12'000));
+    CHECK_EQ(board.currentAdc.numDataReads, reads + 1);
+}
+
+/**
+ * @brief ADC not responding
+ *
+ * If the current ADC doesn't return a status byte with its address, nothing is updated.
+ */
+static void TestAdcNotResponding() {
+    Board board;
+    board.voltageAdc.codes[0] = VoltageToAdcCode(12'000);
+
+    AnalogLoadDriver driver{&board.i2c, board.idprom, &board.spi};
+
+    board.currentAdc.responding = false;
+    board.currentAdc.codes[0x8] = CurrentToAdcCode(1'000'000);
+    board.voltageAdc.codes[0] = VoltageToAdcCode(20'000);
+    RunConversion(driver);
+
+    uint32_t current{0}, voltage{0};
+    CHECK_EQ(driver.readChannelCurrent(0, current), 0);
+    CHECK_EQ(current, 0);
+    CHECK_EQ(driver.readInputVoltage(voltage), 0);
+    CHECK(IsClose(voltage, 12'000));
+
+    // and it recovers once the ADC responds again
+    board.currentAdc.responding = true;
+    RunConversion(driver);
+    CHECK_EQ(driver.readInputVoltage(voltage), 0);
+    CHECK(IsClose(voltage, 20'000));
+}
+
+/**
+ * @brief Current setpoints
+ *
+ * Setpoints only reach the DAC while the load is enabled; both outputs always update together,
+ * in a single batch.
+ */
+static void TestSetpoints() {
+    Board board;
+    AnalogLoadDriver driver{&board.i2c, board.idprom, &board.spi};
+
+    // disabled: outputs stay at zero
+    const etl::array<uint32_t, 2> currents{{1'000'000, 5'000'000}};
+    CHECK_EQ(driver.setChannelCurrents(currents), 0);
+    CHECK_EQ(board.dac.outputs[0], 0);
+    CHECK_EQ(board.dac.outputs[1], 0);
+
+    // enabled: both outputs updated at once
+    const auto updates = board.dac.numUpdates;
+    const auto batches = board.spi.numBatches;
+
+    CHECK_EQ(driver.setEnabled(true), 0);
+    CHECK_EQ(board.dac.outputs[0], CurrentToDacCode(1'000'000));
+    CHECK_EQ(board.dac.outputs[1], CurrentToDacCode(5'000'000));
+    CHECK_EQ(board.dac.numUpdates, updates + 1);
+    CHECK_EQ(board.spi.numBatches, batches + 1);
+
+    // total current is split across channels
+    CHECK_EQ(driver.setOutputCurrent(3'000'001), 0);
+    CHECK_EQ(board.dac.outputs[0], CurrentToDacCode(1'500'001));
+    CHECK_EQ(board.dac.outputs[1], CurrentToDacCode(1'500'000));
+
+    // clamped to full scale
+    const etl::array<uint32_t, 2> tooLarge{{20'000'000, 10'000'000}};
+    CHECK_EQ(driver.setChannelCurrents(tooLarge), 0);
+    CHECK_EQ(board.dac.outputs[0], 0xFFFF);
+    CHECK_EQ(board.dac.outputs[1], 0xFFFF);
+
+    // disabling zeroes the outputs, and re-enabling restores the setpoints
+    CHECK_EQ(driver.setEnabled(false), 0);
+    CHECK_EQ(board.dac.outputs[0], 0);
+    CHECK_EQ(board.dac.outputs[1], 0);
+
+    CHECK_EQ(driver.setEnabled(true), 0);
+    CHECK_EQ(board.dac.outputs[0], 0xFFFF);
+    CHECK_EQ(board.dac.outputs[1], 0xFFFF);
+
+    CHECK_EQ(board.dac.numBadFrames, 0);
+    for(const auto address : board.spi.selected) {
+        CHECK(address != SimulatedSpiBus::kIdleDevice);
+    }
+}
+
+/**
+ * @brief Invalid channels
+ */
+static void TestInvalidChannel() {
+    Board board;
+    AnalogLoadDriver driver{&board.i2c, board.idprom, &board.spi};
+
+    uint32_t current;
+    CHECK_EQ(driver.readChannelCurrent(2, current), App::Control::LoadDriver::Errors::InvalidChannel);
+
+    const etl::array<uint32_t, 3> currents{};
+    CHECK_EQ(driver.setChannelCurrents(currents), App::Control::LoadDriver::Errors::InvalidChannel);
+}
+
+int main() {
+    TestInit();
+    TestReadCurrents();
+    TestNoNewData();
+    TestAdcNotResponding();
+    TestSetpoints();
+    TestInvalidChannel();
+
+    return Test::Finish();
+}
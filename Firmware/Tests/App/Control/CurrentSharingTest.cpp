@@ -0,0 +1,290 @@
+/**
+ * @file
+ *
+ * @brief Current sharing tests
+ *
+ * Runs the current sharing layer against a simulated four channel driver, whose channels settle
+ * instantly, with gain errors, open channels and temperature differences set by the test.
+ */
+#include "Test.h"
+#include "SimulatedLoadDriver.h"
+
+#include "App/Control/CurrentSharing.h"
+
+#include <stdlib.h>
+
+using App::Control::CurrentSharing;
+
+/// Maximum input current of the simulated driver (mA); 2.5A per channel
+constexpr static const uint32_t kMaxCurrent{10'000};
+/// Number of ticks before a channel out of tolerance is shed
+constexpr static const size_t kFaultTicks{25};
+
+/// Unity in the Q16 format used for trims
+constexpr static const int32_t kOne{1 << 16};
+
+/// Sum up the targets of all channels
+static uint32_t TotalTarget(const CurrentSharing &sharing, const size_t numChannels) {
+    uint32_t total{0};
+    for(size_t i = 0; i < numChannels; i++) {
+        total += sharing.getChannel(i).target;
+    }
+    return total;
+}
+
+/// Run a number of control ticks
+static void Run(CurrentSharing &sharing, const size_t ticks, const bool isEnabled = true) {
+    for(size_t i = 0; i < ticks; i++) {
+        CHECK_EQ(sharing.update(isEnabled), 0);
+    }
+}
+
+/**
+ * @brief Single channel drivers
+ *
+ * The setpoint goes straight to the driver's total current.
+ */
+static void TestSingleChannel() {
+    SimulatedLoadDriver driver{1, 5'000};
+    CurrentSharing sharing;
+    sharing.attach(&driver);
+
+    CHECK_EQ(sharing.setSetpoint(1'234'567), 0);
+    CHECK_EQ(driver.numOutputCurrentWrites, 1);
+    CHECK_EQ(driver.numChannelWrites, 0);
+    CHECK_EQ(driver.channels[0].command, 1'234'567);
+
+    CHECK_EQ(sharing.update(true), 0);
+    CHECK_EQ(driver.numOutputCurrentWrites, 1);
+}
+
+/**
+ * @brief Even split
+ *
+ * Without temperatures or gain errors, all channels get the same share, and nothing is trimmed.
+ */
+static void TestEvenSplit() {
+    SimulatedLoadDriver driver{4, kMaxCurrent};
+    driver.setEnabled(true);
+
+    CurrentSharing sharing;
+    sharing.attach(&driver);
+
+    CHECK_EQ(sharing.setSetpoint(6'000'000), 0);
+    for(size_t i = 0; i < 4; i++) {
+        CHECK_EQ(driver.channels[i].command, 1'500'000);
+    }
+
+    Run(sharing, 50);
+    for(size_t i = 0; i < 4; i++) {
+        CHECK_EQ(sharing.getChannel(i).trim, 0);
+        CHECK_EQ(driver.channels[i].command, 1'500'000);
+    }
+
+    // at most one µA per channel is lost to rounding
+    CHECK_EQ(sharing.setSetpoint(1'000'003), 0);
+    const auto total = TotalTarget(sharing, 4);
+    CHECK(total <= 1'000'003 && total >= 1'000'003 - 4);
+}
+
+/**
+ * @brief Gain error trimming
+ *
+ * A channel that conducts less than commanded gets trimmed up until it conducts its target; the
+ * trim is limited, and frozen while the load is disabled.
+ */
+static void TestTrim() {
+    SimulatedLoadDriver driver{4, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.channels[1].gain = 0.9;
+    driver.channels[3].gain = 0.6;
+
+    CurrentSharing sharing;
+    sharing.attach(&driver);
+    CHECK_EQ(sharing.setSetpoint(4'000'000), 0);
+
+    Run(sharing, 200);
+
+    // channel 1 converges onto its target
+    const auto &ch1 = sharing.getChannel(1);
+    CHECK(abs(static_cast<int32_t>(driver.getCurrent(1)) - 1'000'000) < 5'000);
+    CHECK(abs(ch1.trim - (kOne / 9)) < (kOne / 100));
+
+    // channel 3 would need more than the maximum trim
+    CHECK_EQ(sharing.getChannel(3).trim, kOne / 4);
+    CHECK_EQ(driver.channels[3].command, 1'250'000);
+
+    // untrimmed channels stay put
+    CHECK_EQ(sharing.getChannel(0).trim, 0);
+    CHECK_EQ(sharing.getChannel(2).trim, 0);
+
+    // disabled: trims frozen
+    const auto trim = ch1.trim;
+    driver.channels[1].gain = 0.5;
+    Run(sharing, 50, false);
+    CHECK_EQ(ch1.trim, trim);
+
+    // reset clears trims
+    sharing.reset();
+    CHECK_EQ(sharing.getChannel(1).trim, 0);
+    CHECK_EQ(sharing.getChannel(3).trim, 0);
+}
+
+/**
+ * @brief Thermal weighting
+ *
+ * Hotter channels take a smaller share, cooler ones a larger share; the total is unchanged.
+ */
+static void TestThermalWeighting() {
+    SimulatedLoadDriver driver{4, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.hasChannelTemperatures = true;
+    driver.channels[0].temperature = 40'000;
+    driver.channels[1].temperature = 50'000;
+    driver.channels[2].temperature = 60'000;
+    driver.channels[3].temperature = 50'000;
+
+    CurrentSharing sharing;
+    sharing.attach(&driver);
+    CHECK_EQ(sharing.setSetpoint(4'000'000), 0);
+    CHECK_EQ(sharing.update(false), 0);
+
+    // 2% per °C from the 50°C average (the Q16 derating rounds slightly toward zero)
+    CHECK(abs(static_cast<int32_t>(sharing.getChannel(0).target) - 1'200'000) < 1'000);
+    CHECK(abs(static_cast<int32_t>(sharing.getChannel(1).target) - 1'000'000) < 1'000);
+    CHECK(abs(static_cast<int32_t>(sharing.getChannel(2).target) - 800'000) < 1'000);
+    CHECK(abs(static_cast<int32_t>(TotalTarget(sharing, 4)) - 4'000'000) < 4);
+
+    // weights are limited to [0.5, 1.5]
+    driver.channels[0].temperature = 0;
+    driver.channels[1].temperature = 100'000;
+    driver.channels[2].temperature = 50'000;
+    driver.channels[3].temperature = 50'000;
+    CHECK_EQ(sharing.update(false), 0);
+
+    CHECK_EQ(sharing.getChannel(0).target, 1'500'000);
+    CHECK_EQ(sharing.getChannel(1).target, 500'000);
+}
+
+/**
+ * @brief Channel current limit
+ *
+ * A share above the channel's maximum current is clamped, and the excess goes to channels with
+ * headroom left.
+ */
+static void TestChannelLimit() {
+    SimulatedLoadDriver driver{4, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.hasChannelTemperatures = true;
+    driver.channels[0].temperature = 40'000;
+    driver.channels[1].temperature = 60'000;
+    driver.channels[2].temperature = 50'000;
+    driver.channels[3].temperature = 50'000;
+
+    CurrentSharing sharing;
+    sharing.attach(&driver);
+    CHECK_EQ(sharing.setSetpoint(9'000'000), 0);
+    CHECK_EQ(sharing.update(false), 0);
+
+    for(size_t i = 0; i < 4; i++) {
+        CHECK(sharing.getChannel(i).target <= 2'500'000);
+        CHECK(driver.channels[i].command <= 2'500'000);
+    }
+    CHECK_EQ(sharing.getChannel(0).target, 2'500'000);
+    CHECK(abs(static_cast<int32_t>(TotalTarget(sharing, 4)) - 9'000'000) < 4);
+
+    // more than the driver can do: all channels at their limit
+    CHECK_EQ(sharing.setSetpoint(12'000'000), 0);
+    for(size_t i = 0; i < 4; i++) {
+        CHECK_EQ(driver.channels[i].command, 2'500'000);
+    }
+}
+
+/**
+ * @brief Shedding failed channels
+ *
+ * An open channel is shed once it's been out of tolerance for the debounce time, and its share
+ * goes to the remaining channels; reset brings it back.
+ */
+static void TestShedding() {
+    SimulatedLoadDriver driver{4, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.channels[2].open = true;
+
+    CurrentSharing sharing;
+    sharing.attach(&driver);
+    CHECK_EQ(sharing.setSetpoint(3'000'000), 0);
+
+    Run(sharing, kFaultTicks - 1);
+    CHECK(!sharing.getChannel(2).failed);
+    CHECK_EQ(sharing.getNumActive(), 4);
+
+    Run(sharing, 1);
+    CHECK(sharing.getChannel(2).failed);
+    CHECK_EQ(sharing.getNumActive(), 3);
+    CHECK_EQ(driver.channels[2].command, 0);
+    for(const size_t i : {0, 1, 3}) {
+        CHECK_EQ(driver.channels[i].command, 1'000'000);
+    }
+
+    // a shed channel stays shed
+    driver.channels[2].open = false;
+    Run(sharing, 10);
+    CHECK(sharing.getChannel(2).failed);
+
+    sharing.reset();
+    CHECK_EQ(sharing.getNumActive(), 4);
+    CHECK_EQ(sharing.setSetpoint(3'000'000), 0);
+    CHECK_EQ(driver.channels[2].command, 750'000);
+}
+
+/**
+ * @brief Fault checks are skipped when they can't be judged
+ *
+ * No channel is shed while the load is disabled, or while its command is too small to measure
+ * reliably; a channel that recovers within the debounce time isn't shed either.
+ */
+static void TestNoFalseShedding() {
+    SimulatedLoadDriver driver{4, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.channels[0].open = true;
+
+    CurrentSharing sharing;
+    sharing.attach(&driver);
+
+    CHECK_EQ(sharing.setSetpoint(3'000'000), 0);
+    Run(sharing, 2 * kFaultTicks, false);
+    CHECK_EQ(sharing.getNumActive(), 4);
+
+    CHECK_EQ(sharing.setSetpoint(200'000), 0);
+    Run(sharing, 2 * kFaultTicks);
+    CHECK_EQ(sharing.getNumActive(), 4);
+
+    CHECK_EQ(sharing.setSetpoint(3'000'000), 0);
+    Run(sharing, kFaultTicks - 1);
+    driver.channels[0].open = false;
+    Run(sharing, 2 * kFaultTicks);
+    CHECK_EQ(sharing.getNumActive(), 4);
+
+    // all channels failed: nothing is commanded
+    for(size_t i = 0; i < 4; i++) {
+        driver.channels[i].open = true;
+    }
+    Run(sharing, kFaultTicks);
+    CHECK_EQ(sharing.getNumActive(), 0);
+    for(size_t i = 0; i < 4; i++) {
+        CHECK_EQ(driver.channels[i].command, 0);
+    }
+}
+
+int main() {
+    TestSingleChannel();
+    TestEvenSplit();
+    TestTrim();
+    TestThermalWeighting();
+    TestChannelLimit();
+    TestShedding();
+    TestNoFalseShedding();
+
+    return Test::Finish();
+}
@@ -0,0 +1,161 @@
+/**
+ * @file
+ *
+ * @brief I-V curve sweep tests
+ *
+ * The sweep is run the same way as the control task does: each tick, it's passed the
+ * measurements taken before the tick, and the current it returns is applied after it. The
+ * simulated source is a resistor from an open circuit voltage, and the measured current follows
+ * the applied current through a first order lag.
+ */
+#include "Test.h"
+
+#include "App/Control/IvSweep.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <vector>
+
+using App::Control::IvSweep;
+
+/**
+ * @brief Run a sweep to completion
+ *
+ * @param alpha Low pass coefficient of the measured current, per tick (1 for no lag)
+ * @param outCommands Variable to receive the current returned on each tick
+ */
+static void Run(IvSweep &sweep, const double alpha, std::vector<uint32_t> &outCommands) {
+    constexpr static const double kVoc{20'000}, kResistance{2};
+
+    // load is idle before the sweep, at 0.5A
+    double current{500'000};
+
+    while(sweep.isRunning()) {
+        const auto voltage = lround(kVoc - (kResistance * current) / 1000.);
+        const auto command = sweep.update(voltage, lround(current));
+
+        outCommands.push_back(command);
+        current += alpha * (command - current);
+    }
+}
+
+/**
+ * @brief Sweep parameters
+ *
+ * Sweeps need an end current, a settling time, and between 2 and kMaxPoints steps.
+ */
+static void TestStart() {
+    IvSweep sweep;
+    const IvSweep::Config valid{.endCurrent = 1'000'000, .numSteps = 8, .settleTicks = 1};
+
+    auto config = valid;
+    config.endCurrent = 0;
+    CHECK(!sweep.start(config));
+    CHECK(sweep.getState() == IvSweep::State::Aborted);
+
+    config = valid;
+    config.numSteps = 1;
+    CHECK(!sweep.start(config));
+    config.numSteps = IvSweep::kMaxPoints + 1;
+    CHECK(!sweep.start(config));
+
+    config = valid;
+    config.settleTicks = 0;
+    CHECK(!sweep.start(config));
+
+    CHECK(sweep.start(valid));
+    CHECK(sweep.isRunning());
+    sweep.abort();
+    CHECK_EQ(sweep.update(1, 1), 0);
+}
+
+/**
+ * @brief Step currents and timing
+ *
+ * Steps are evenly spaced from zero to the end current; each is applied for exactly the settling
+ * time before its point is captured, including the first one. With a single settling tick, every
+ * point thus measures its own step, rather than the current from before the sweep.
+ */
+static void TestSteps() {
+    for(const uint16_t settle : {1, 2, 5}) {
+        IvSweep sweep;
+        CHECK(sweep.start({.endCurrent = 7'000'000, .numSteps = 8, .settleTicks = settle}));
+
+        std::vector<uint32_t> commands;
+        Run(sweep, 1, commands);
+
+        CHECK(sweep.getState() == IvSweep::State::Done);
+        CHECK_EQ(commands.size(), static_cast<size_t>(1 + (8 * settle)));
+        CHECK_EQ(commands.back(), 0);
+
+        const auto points = sweep.getPoints();
+        CHECK_EQ(points.size(), 8U);
+        for(size_t i = 0; i < points.size(); i++) {
+            CHECK_EQ(points[i].current, 1'000'000 * i);
+            CHECK_EQ(points[i].voltage, 20'000 - (2'000 * i));
+
+            // the step is held for the whole settling time
+            for(size_t j = 0; j < settle; j++) {
+                CHECK_EQ(commands[(i * settle) + j], 1'000'000 * i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Equal settling for every point
+ *
+ * With a lag in the measurement, each point has settled by the same fraction of its step; the
+ * first point is no exception.
+ */
+static void TestEqualSettling() {
+    constexpr static const double kAlpha{0.5};
+
+    IvSweep sweep;
+    CHECK(sweep.start({.endCurrent = 3'000'000, .numSteps = 4, .settleTicks = 3}));
+
+    std::vector<uint32_t> commands;
+    Run(sweep, kAlpha, commands);
+
+    // after three ticks, 1/8 of each step (from the previous point) is left
+    const auto points = sweep.getPoints();
+    CHECK_EQ(points.size(), 4U);
+
+    double previous{500'000};
+    for(size_t i = 0; i < points.size(); i++) {
+        const double target = 1'000'000. * i;
+        const double expected = target - ((target - previous) / 8);
+        CHECK(fabs(points[i].current - expected) <= 1);
+        previous = expected;
+    }
+}
+
+/**
+ * @brief Voltage collapse
+ *
+ * With a minimum voltage, the sweep ends at the first point below it.
+ */
+static void TestMinVoltage() {
+    IvSweep sweep;
+    CHECK(sweep.start({.endCurrent = 10'000'000, .numSteps = 11, .settleTicks = 2,
+                .minVoltage = 9'000}));
+
+    std::vector<uint32_t> commands;
+    Run(sweep, 1, commands);
+
+    CHECK(sweep.getState() == IvSweep::State::Done);
+    const auto points = sweep.getPoints();
+    CHECK_EQ(points.size(), 7U);
+    CHECK_EQ(points.back().voltage, 8'000);
+    CHECK_EQ(commands.back(), 0);
+}
+
+int main() {
+    TestStart();
+    TestSteps();
+    TestEqualSettling();
+    TestMinVoltage();
+
+    return Test::Finish();
+}
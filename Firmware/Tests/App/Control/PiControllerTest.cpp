@@ -0,0 +1,121 @@
+/**
+ * @file
+ *
+ * @brief PI controller tests
+ *
+ * Checks the proportional and integral paths, output clamping, anti-windup, and that resets and
+ * gain changes don't bump the output.
+ */
+#include "Test.h"
+
+#include "App/Control/PiController.h"
+
+using App::Control::PiController;
+
+/// Create a controller with the given gains (as multiples of unity) and maximum output
+static PiController MakeController(const double kp, const double ki, const uint32_t max) {
+    PiController pi;
+    pi.setMaxOutput(max);
+    pi.setGains({
+        .kp = static_cast<int64_t>(kp * PiController::kOne),
+        .ki = static_cast<int64_t>(ki * PiController::kOne),
+    });
+    return pi;
+}
+
+/**
+ * @brief Proportional path
+ *
+ * Without integral gain, the output is the reset value plus the scaled error.
+ */
+static void TestProportional() {
+    auto pi = MakeController(2.5, 0, 1'000'000);
+    pi.reset(500'000);
+
+    CHECK_EQ(pi.update(0), 500'000);
+    CHECK_EQ(pi.update(1'000), 502'500);
+    CHECK_EQ(pi.update(-1'000), 497'500);
+    // no state is accumulated
+    CHECK_EQ(pi.update(0), 500'000);
+}
+
+/**
+ * @brief Integral path
+ *
+ * A constant error ramps the output by the integral gain each tick; it holds once the error is
+ * gone.
+ */
+static void TestIntegral() {
+    auto pi = MakeController(0, 0.5, 1'000'000);
+    pi.reset(0);
+
+    for(uint32_t i = 1; i <= 10; i++) {
+        CHECK_EQ(pi.update(100), 50 * i);
+    }
+    CHECK_EQ(pi.update(0), 500);
+
+    // fractional gains accumulate rather than being lost to rounding
+    auto slow = MakeController(0, 1. / 64, 1'000'000);
+    slow.reset(0);
+    uint32_t output{0};
+    for(size_t i = 0; i < 640; i++) {
+        output = slow.update(1);
+    }
+    CHECK_EQ(output, 10);
+}
+
+/**
+ * @brief Output clamping and anti-windup
+ *
+ * The output never leaves [0, max]; after a long time in saturation, it comes out of it as soon
+ * as the error reverses, rather than first unwinding the integrator.
+ */
+static void TestAntiWindup() {
+    auto pi = MakeController(1, 1, 10'000);
+    pi.reset(5'000);
+
+    for(size_t i = 0; i < 1'000; i++) {
+        CHECK_EQ(pi.update(1'000), i < 4 ? 5'000 + (1'000 * (i + 2)) : 10'000);
+    }
+
+    CHECK_EQ(pi.update(-1'000), 8'000);
+
+    for(size_t i = 0; i < 1'000; i++) {
+        pi.update(-1'000);
+    }
+    CHECK_EQ(pi.update(-1'000), 0);
+    CHECK_EQ(pi.update(1'000), 2'000);
+
+    // resetting to more than the maximum is clamped too
+    pi.reset(50'000);
+    CHECK_EQ(pi.update(0), 10'000);
+}
+
+/**
+ * @brief Bumpless gain changes
+ *
+ * The integrator is kept when gains change, so at zero error the output doesn't move.
+ */
+static void TestGainChange() {
+    auto pi = MakeController(1, 0.25, 1'000'000);
+    pi.reset(0);
+
+    for(size_t i = 0; i < 100; i++) {
+        pi.update(400);
+    }
+    const auto output = pi.update(0);
+    CHECK_EQ(output, 10'000);
+
+    pi.setGains({.kp = 8 * PiController::kOne, .ki = 2 * PiController::kOne});
+    CHECK_EQ(pi.update(0), output);
+    CHECK_EQ(pi.getGains().kp, 8 * PiController::kOne);
+}
+
+int main() {
+    TestProportional();
+    TestIntegral();
+    TestAntiWindup();
+    TestGainChange();
+
+    return Test::Finish();
+}
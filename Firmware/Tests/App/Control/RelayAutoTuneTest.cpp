@@ -0,0 +1,302 @@
+/**
+ * @file
+ *
+ * @brief Relay auto-tuner tests
+ *
+ * Tunes the constant voltage loop against a simulated driver, which sinks current from a source
+ * with a series resistance; the voltage the driver measures lags behind through a first order
+ * low pass and a transport delay. Each tick runs the same way as the control task: the control
+ * error is computed from the measured voltage, and the output is written to the driver.
+ *
+ * The oscillation the tuner measures is compared with the exact ultimate gain and period of the
+ * (discrete time) model, and the resulting gains must then regulate the voltage.
+ */
+#include "Test.h"
+#include "SimulatedLoadDriver.h"
+
+#include "App/Control/PiController.h"
+#include "App/Control/RelayAutoTune.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <deque>
+
+using App::Control::PiController;
+using App::Control::RelayAutoTune;
+
+/// Maximum input current of the simulated driver (mA)
+constexpr static const uint32_t kMaxCurrent{10'000};
+
+/**
+ * @brief Simulated voltage source and measurement path
+ *
+ * The source has an open circuit voltage and series resistance; the driver's measured voltage
+ * follows it through a first order low pass (updated once per tick) and a delay of whole ticks.
+ */
+class Source {
+    public:
+        /**
+         * @param voc Open circuit voltage (mV)
+         * @param resistance Series resistance (Ω)
+         * @param alpha Low pass coefficient, per tick
+         * @param delay Transport delay (ticks)
+         */
+        Source(const double voc, const double resistance, const double alpha, const size_t delay) :
+            voc(voc), resistance(resistance), alpha(alpha), filtered(voc),
+            delayLine(delay, voc) {}
+
+        /**
+         * @brief Advance by one tick, and update the driver's measured voltage
+         */
+        void step(SimulatedLoadDriver &driver) {
+            uint32_t current;
+            driver.readInputCurrent(current);
+
+            const double voltage = this->voc - (this->resistance * current) / 1000.;
+            this->filtered += this->alpha * (voltage - this->filtered);
+
+            this->delayLine.push_back(this->filtered);
+            driver.inputVoltage = lround(this->delayLine.front());
+            this->delayLine.pop_front();
+        }
+
+        /**
+         * @brief Magnitude of the response from load current to measured voltage
+         *
+         * @param omega Frequency (radians per tick)
+         *
+         * @return Gain, in mV per µA
+         */
+        double gain(const double omega) const {
+            const double re = 1 - (1 - this->alpha) * cos(omega);
+            const double im = (1 - this->alpha) * sin(omega);
+            return (this->resistance / 1000.) * (this->alpha / sqrt((re * re) + (im * im)));
+        }
+
+        /**
+         * @brief Phase lag of the response from load current to measured voltage
+         *
+         * This excludes the sign inversion (more current lowers the voltage), and includes the
+         * tick between computing an output and it being applied.
+         *
+         * @param omega Frequency (radians per tick)
+         *
+         * @return Phase (radians, unwrapped)
+         */
+        double phase(const double omega) const {
+            const double delay = static_cast<double>(this->delayLine.size() + 1);
+            return -(delay * omega) - atan2((1 - this->alpha) * sin(omega),
+                    1 - (1 - this->alpha) * cos(omega));
+        }
+
+    private:
+        double voc, resistance, alpha;
+        double filtered;
+        std::deque<double> delayLine;
+};
+
+/**
+ * @brief Ultimate gain and period of a source
+ *
+ * Find the frequency at which the source's phase lag reaches 180°, by bisection.
+ *
+ * @param outGain Ultimate gain (µA per mV)
+ * @param outPeriod Ultimate period (ticks)
+ */
+static void UltimatePoint(const Source &source, double &outGain, double &outPeriod) {
+    double lo{1e-6}, hi{M_PI};
+    for(size_t i = 0; i < 100; i++) {
+        const double mid = (lo + hi) / 2;
+        if(source.phase(mid) > -M_PI) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    outGain = 1. / source.gain(lo);
+    outPeriod = (2 * M_PI) / lo;
+}
+
+/**
+ * @brief Run the tuner in constant voltage mode until it completes
+ *
+ * @return Number of ticks taken
+ */
+static size_t Tune(RelayAutoTune &tuner, SimulatedLoadDriver &driver, Source &source,
+        const uint32_t setpoint) {
+    size_t ticks{0};
+
+    while(tuner.isRunning()) {
+        const int32_t error = static_cast<int32_t>(driver.inputVoltage) -
+            static_cast<int32_t>(setpoint);
+        driver.setOutputCurrent(tuner.update(error));
+        source.step(driver);
+        ticks++;
+    }
+
+    return ticks;
+}
+
+/**
+ * @brief Tuning parameters
+ *
+ * The tuner is rejected (and fails) with a zero amplitude, cycle count or timeout, a bias smaller
+ * than the amplitude, or too many cycles; while it's not running, it outputs the bias.
+ */
+static void TestStart() {
+    RelayAutoTune tuner;
+    CHECK(tuner.getState() == RelayAutoTune::State::Idle);
+
+    const RelayAutoTune::Config valid{.bias = 1'000, .amplitude = 500, .hysteresis = 10,
+        .numCycles = 4, .timeout = 1'000};
+
+    auto config = valid;
+    config.amplitude = 0;
+    CHECK(!tuner.start(config));
+    CHECK(tuner.getState() == RelayAutoTune::State::Failed);
+
+    config = valid;
+    config.bias = 400;
+    CHECK(!tuner.start(config));
+
+    config = valid;
+    config.timeout = 0;
+    CHECK(!tuner.start(config));
+
+    config = valid;
+    config.numCycles = 0;
+    CHECK(!tuner.start(config));
+    config.numCycles = RelayAutoTune::kMaxCycles + 1;
+    CHECK(!tuner.start(config));
+
+    CHECK(tuner.start(valid));
+    CHECK(tuner.isRunning());
+    // the relay starts out high
+    CHECK_EQ(tuner.update(0), 1'500);
+
+    tuner.abort();
+    CHECK(tuner.getState() == RelayAutoTune::State::Aborted);
+    CHECK_EQ(tuner.update(100'000), 1'000);
+}
+
+/**
+ * @brief Timeout
+ *
+ * A process that doesn't respond never completes a cycle; the tuner gives up after the timeout
+ * and goes back to outputting the bias.
+ */
+static void TestTimeout() {
+    RelayAutoTune tuner;
+    CHECK(tuner.start({.bias = 1'000, .amplitude = 500, .hysteresis = 10, .numCycles = 4,
+                .timeout = 100}));
+
+    for(size_t i = 0; i < 99; i++) {
+        CHECK_EQ(tuner.update(50), 1'500);
+    }
+    CHECK_EQ(tuner.update(50), 1'000);
+    CHECK(tuner.getState() == RelayAutoTune::State::Failed);
+}
+
+/**
+ * @brief Ultimate gain and period
+ *
+ * For a range of sources, the measured period and ultimate gain match the model's actual
+ * ultimate point, within the accuracy of the describing function approximation.
+ */
+static void TestUltimatePoint() {
+    struct Case {
+        double resistance, alpha;
+        size_t delay;
+    };
+
+    const Case cases[]{
+        {.resistance = 2., .alpha = 0.2, .delay = 3},
+        {.resistance = 0.5, .alpha = 0.1, .delay = 4},
+        {.resistance = 5., .alpha = 0.5, .delay = 5},
+        {.resistance = 1., .alpha = 0.05, .delay = 8},
+    };
+
+    for(const auto &c : cases) {
+        SimulatedLoadDriver driver{1, kMaxCurrent};
+        driver.setEnabled(true);
+        Source source{20'000, c.resistance, c.alpha, c.delay};
+
+        // operating point at 2A
+        const auto setpoint = static_cast<uint32_t>(lround(20'000 - c.resistance * 2'000));
+
+        RelayAutoTune tuner;
+        CHECK(tuner.start({.bias = 2'000'000, .amplitude = 250'000, .hysteresis = 5,
+                    .numCycles = 4, .timeout = 10'000}));
+        Tune(tuner, driver, source, setpoint);
+        CHECK(tuner.getState() == RelayAutoTune::State::Done);
+
+        double ku, tu;
+        UltimatePoint(source, ku, tu);
+
+        const auto &result = tuner.getResult();
+        CHECK(fabs(result.period - tu) < 0.15 * tu);
+        CHECK(fabs(result.ultimateGain - ku) < 0.25 * ku);
+
+        // Ziegler-Nichols PI gains
+        CHECK(fabs((result.gains.kp / static_cast<double>(PiController::kOne)) -
+                    0.45 * result.ultimateGain) < 0.01 * result.ultimateGain);
+        CHECK(result.gains.ki > 0);
+
+        // once done, the output returns to the bias
+        CHECK_EQ(tuner.update(0), 2'000'000);
+    }
+}
+
+/**
+ * @brief Closed loop with the tuned gains
+ *
+ * A constant voltage loop using the tuned gains settles onto a setpoint step without a sustained
+ * oscillation, and with the usual (moderate) Ziegler-Nichols overshoot.
+ */
+static void TestTunedLoop() {
+    SimulatedLoadDriver driver{2, kMaxCurrent};
+    driver.setEnabled(true);
+    Source source{20'000, 2., 0.2, 3};
+
+    RelayAutoTune tuner;
+    CHECK(tuner.start({.bias = 2'000'000, .amplitude = 250'000, .hysteresis = 5, .numCycles = 4,
+                .timeout = 10'000}));
+    Tune(tuner, driver, source, 16'000);
+    CHECK(tuner.getState() == RelayAutoTune::State::Done);
+
+    PiController pi;
+    pi.setMaxOutput(kMaxCurrent * 1'000);
+    pi.setGains(tuner.getResult().gains);
+    pi.reset(2'000'000);
+
+    // step from 16V down to 14V (3A)
+    constexpr static const uint32_t kSetpoint{14'000};
+    int32_t minVoltage{INT32_MAX}, lastMin{INT32_MAX}, lastMax{INT32_MIN};
+
+    for(size_t i = 0; i < 1'000; i++) {
+        const int32_t voltage = driver.inputVoltage;
+        minVoltage = std::min(minVoltage, voltage);
+        if(i >= 900) {
+            lastMin = std::min(lastMin, voltage);
+            lastMax = std::max(lastMax, voltage);
+        }
+
+        driver.setOutputCurrent(pi.update(voltage - static_cast<int32_t>(kSetpoint)));
+        source.step(driver);
+    }
+
+    CHECK(abs(lastMin - static_cast<int32_t>(kSetpoint)) <= 2);
+    CHECK(abs(lastMax - static_cast<int32_t>(kSetpoint)) <= 2);
+    CHECK(static_cast<int32_t>(kSetpoint) - minVoltage < 1'200);
+}
+
+int main() {
+    TestStart();
+    TestTimeout();
+    TestUltimatePoint();
+    TestTunedLoop();
+
+    return Test::Finish();
+}
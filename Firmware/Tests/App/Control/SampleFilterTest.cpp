@@ -0,0 +1,273 @@
+/**
+ * @file
+ *
+ * @brief Measurement filter tests
+ *
+ * Checks the decimator and IIR filter against their ideal responses: block averages, the
+ * exponential step response, the single pole magnitude response, and the boxcar's nulls.
+ */
+#include "Test.h"
+
+#include "App/Control/SampleFilter.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <vector>
+
+using App::Control::SampleFilter;
+
+/// Filter output value of one input unit
+constexpr static const double kOneFraction{1 << SampleFilter::kFractionBits};
+
+/// Create a filter with the given configuration
+static SampleFilter MakeFilter(const uint16_t decimation, const uint8_t iirShift) {
+    SampleFilter filter;
+    filter.configure({.decimation = decimation, .iirShift = iirShift});
+    return filter;
+}
+
+/**
+ * @brief Push samples, and collect the outputs produced
+ *
+ * @return Filter outputs, in input units (with their full resolution)
+ */
+static std::vector<double> Run(SampleFilter &filter, const std::vector<uint32_t> &samples) {
+    std::vector<double> outputs;
+
+    for(const auto sample : samples) {
+        if(filter.push(sample)) {
+            outputs.push_back(filter.getFilteredFraction() / kOneFraction);
+        }
+    }
+
+    return outputs;
+}
+
+/**
+ * @brief Sample a sine wave
+ *
+ * @param period Period, in samples
+ */
+static std::vector<uint32_t> Sine(const size_t count, const double period, const double offset,
+        const double amplitude) {
+    std::vector<uint32_t> samples;
+
+    for(size_t i = 0; i < count; i++) {
+        samples.push_back(lround(offset + amplitude * sin((2 * M_PI * i) / period)));
+    }
+
+    return samples;
+}
+
+/// Peak to peak amplitude of the outputs from the given index on
+static double PeakToPeak(const std::vector<double> &outputs, const size_t from) {
+    double lo{INFINITY}, hi{-INFINITY};
+
+    for(size_t i = from; i < outputs.size(); i++) {
+        lo = fmin(lo, outputs[i]);
+        hi = fmax(hi, outputs[i]);
+    }
+
+    return hi - lo;
+}
+
+/**
+ * @brief Configuration
+ *
+ * Out of range values are clamped; the defaults pass samples straight through.
+ */
+static void TestConfigure() {
+    SampleFilter filter;
+    CHECK(!filter.isValid());
+
+    for(const uint32_t sample : {0U, 12345U, UINT32_MAX}) {
+        CHECK(filter.push(sample));
+        CHECK(filter.isValid());
+        CHECK_EQ(filter.getRaw(), sample);
+        CHECK_EQ(filter.getFiltered(), sample);
+    }
+
+    filter.configure({.decimation = 0, .iirShift = 20});
+    CHECK_EQ(filter.getConfig().decimation, 1);
+    CHECK_EQ(filter.getConfig().iirShift, SampleFilter::kMaxIirShift);
+    CHECK(!filter.isValid());
+
+    filter.configure({.decimation = 1000, .iirShift = 0});
+    CHECK_EQ(filter.getConfig().decimation, SampleFilter::kMaxDecimation);
+}
+
+/**
+ * @brief Decimation
+ *
+ * Each output is the average of a block of samples, with fractional bits; the rounded output
+ * rounds halves up.
+ */
+static void TestDecimation() {
+    auto filter = MakeFilter(4, 0);
+
+    CHECK(!filter.push(1));
+    CHECK(!filter.push(2));
+    CHECK(!filter.push(3));
+    CHECK(!filter.isValid());
+    CHECK_EQ(filter.getRaw(), 3);
+
+    CHECK(filter.push(4));
+    CHECK(filter.isValid());
+    CHECK_EQ(filter.getFilteredFraction(), static_cast<uint64_t>(2.5 * kOneFraction));
+    CHECK_EQ(filter.getFiltered(), 3);
+
+    // averaging increases resolution
+    filter.configure({.decimation = 16, .iirShift = 0});
+    for(size_t i = 0; i < 16; i++) {
+        filter.push(100 + (i & 1));
+    }
+    CHECK_EQ(filter.getFilteredFraction(), static_cast<uint64_t>(100.5 * kOneFraction));
+
+    // large samples don't overflow the accumulator
+    filter.configure({.decimation = SampleFilter::kMaxDecimation, .iirShift = 0});
+    for(size_t i = 0; i < SampleFilter::kMaxDecimation; i++) {
+        filter.push(UINT32_MAX);
+    }
+    CHECK_EQ(filter.getFiltered(), UINT32_MAX);
+}
+
+/**
+ * @brief Reset
+ *
+ * Partially accumulated blocks are discarded, and the first output after a reset initializes the
+ * IIR filter directly.
+ */
+static void TestReset() {
+    auto filter = MakeFilter(2, 4);
+
+    Run(filter, {1000, 1000, 1000});
+    filter.reset();
+    CHECK(!filter.isValid());
+
+    CHECK(!filter.push(0));
+    CHECK(filter.push(0));
+    CHECK_EQ(filter.getFilteredFraction(), 0);
+}
+
+/**
+ * @brief IIR step response
+ *
+ * After n outputs, a step has settled to 1 - (1 - 2^-shift)^n of its final value; the filter
+ * settles all the way to the input (in both directions) rather than stalling an LSB short.
+ */
+static void TestStepResponse() {
+    constexpr static const uint8_t kShift{3};
+    const double alpha = 1. / (1 << kShift);
+
+    auto filter = MakeFilter(1, kShift);
+    filter.push(0);
+
+    for(size_t n = 1; n <= 100; n++) {
+        filter.push(1000);
+
+        const double expected = 1000. * (1. - pow(1. - alpha, n));
+        CHECK(fabs((filter.getFilteredFraction() / kOneFraction) - expected) < 0.01);
+    }
+    CHECK_EQ(filter.getFiltered(), 1000);
+
+    for(size_t n = 0; n < 200; n++) {
+        filter.push(0);
+    }
+    CHECK_EQ(filter.getFiltered(), 0);
+}
+
+/**
+ * @brief IIR magnitude response
+ *
+ * Sine waves are attenuated by |α / (1 - (1 - α)e^-jω)|, measured once the filter settled.
+ */
+static void TestMagnitudeResponse() {
+    constexpr static const uint8_t kShift{4};
+    const double alpha = 1. / (1 << kShift);
+
+    for(const double period : {2000., 200., 50., 10.}) {
+        auto filter = MakeFilter(1, kShift);
+        const auto outputs = Run(filter, Sine(20'000, period, 100'000, 10'000));
+
+        const double omega = (2 * M_PI) / period;
+        const double re = 1 - (1 - alpha) * cos(omega), im = (1 - alpha) * sin(omega);
+        const double gain = alpha / sqrt((re * re) + (im * im));
+
+        const double measured = PeakToPeak(outputs, 10'000) / 20'000;
+        CHECK(fabs(measured - gain) < (0.02 * gain) + 0.001);
+    }
+}
+
+/**
+ * @brief Boxcar nulls
+ *
+ * Averaging blocks of N samples completely rejects anything periodic in N samples (such as mains
+ * ripple, when the block spans a line cycle.)
+ */
+static void TestBoxcarNull() {
+    for(const uint16_t decimation : {8, 20, 64}) {
+        for(const size_t harmonic : {1, 2, 3}) {
+            auto filter = MakeFilter(decimation, 0);
+            const auto outputs = Run(filter, Sine(decimation * 50,
+                        static_cast<double>(decimation) / harmonic, 50'000, 5'000));
+
+            CHECK_EQ(outputs.size(), 50);
+            for(const auto output : outputs) {
+                CHECK(fabs(output - 50'000) < 1);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Noise reduction
+ *
+ * White noise variance is reduced by α / (2 - α) by the IIR filter, and by N by decimation.
+ */
+static void TestNoise() {
+    constexpr static const uint8_t kShift{4};
+    constexpr static const uint16_t kDecimation{16};
+    const double alpha = 1. / (1 << kShift);
+
+    // uniform noise in [-500, 500]: variance of 1000^2 / 12
+    std::vector<uint32_t> samples;
+    uint32_t lcg{1};
+    for(size_t i = 0; i < 200'000; i++) {
+        lcg = (lcg * 1'664'525) + 1'013'904'223;
+        samples.push_back(100'000 - 500 + ((lcg >> 8) % 1001));
+    }
+    const double inputVariance = (1001. * 1001. - 1) / 12;
+
+    const auto variance = [](const std::vector<double> &outputs, const size_t from) {
+        double sum{0}, sumSquares{0};
+        for(size_t i = from; i < outputs.size(); i++) {
+            sum += outputs[i];
+            sumSquares += outputs[i] * outputs[i];
+        }
+        const auto n = outputs.size() - from;
+        return (sumSquares - (sum * sum) / n) / n;
+    };
+
+    auto iir = MakeFilter(1, kShift);
+    const auto iirVariance = variance(Run(iir, samples), 1'000);
+    const auto expectedIir = inputVariance * (alpha / (2 - alpha));
+    CHECK(fabs(iirVariance - expectedIir) < 0.1 * expectedIir);
+
+    auto boxcar = MakeFilter(kDecimation, 0);
+    const auto boxcarVariance = variance(Run(boxcar, samples), 0);
+    const auto expectedBoxcar = inputVariance / kDecimation;
+    CHECK(fabs(boxcarVariance - expectedBoxcar) < 0.1 * expectedBoxcar);
+}
+
+int main() {
+    TestConfigure();
+    TestDecimation();
+    TestReset();
+    TestStepResponse();
+    TestMagnitudeResponse();
+    TestBoxcarNull();
+    TestNoise();
+
+    return Test::Finish();
+}
@@ -0,0 +1,228 @@
+/**
+ * @file
+ *
+ * @brief Slew rate limiter and soft-start ramp tests
+ *
+ * The limiter drives a simulated single channel driver the same way the control task does: each
+ * tick, the limiter's output is applied as the load current. The ramp shape is checked against
+ * the current the driver actually conducts.
+ */
+#include "Test.h"
+#include "SimulatedLoadDriver.h"
+
+#include "App/Control/SlewLimiter.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+using App::Control::SlewLimiter;
+
+/// Control tick interval (ms), same as the control task
+constexpr static const uint32_t kTickInterval{10};
+
+/**
+ * @brief Run control ticks
+ *
+ * @return Load current conducted after each tick (µA)
+ */
+static std::vector<uint32_t> Run(SlewLimiter &slew, SimulatedLoadDriver &driver,
+        const uint32_t target, const size_t ticks) {
+    std::vector<uint32_t> currents;
+
+    for(size_t i = 0; i < ticks; i++) {
+        CHECK_EQ(driver.setOutputCurrent(slew.update(target)), 0);
+
+        uint32_t current;
+        CHECK_EQ(driver.readInputCurrent(current), 0);
+        currents.push_back(current);
+    }
+
+    return currents;
+}
+
+/**
+ * @brief Unlimited
+ *
+ * Without a slew rate or soft-start, the target is applied right away.
+ */
+static void TestUnlimited() {
+    SimulatedLoadDriver driver{1, 10'000};
+    driver.setEnabled(true);
+
+    SlewLimiter slew;
+    slew.configure({}, kTickInterval);
+    CHECK(!slew.isActive());
+
+    slew.startSoftStart();
+    CHECK(!slew.isActive());
+
+    CHECK_EQ(Run(slew, driver, 5'000'000, 1).back(), 5'000'000);
+    CHECK_EQ(Run(slew, driver, 1'000, 1).back(), 1'000);
+}
+
+/**
+ * @brief Slew rate limiting
+ *
+ * The current moves towards the target in equal steps of the rate times the tick interval, in
+ * both directions, and lands exactly on the target.
+ */
+static void TestSlewRate() {
+    SimulatedLoadDriver driver{1, 10'000};
+    driver.setEnabled(true);
+
+    // 100 A/s: 1A per tick
+    SlewLimiter slew;
+    slew.configure({.slewRate = 100'000}, kTickInterval);
+    CHECK(slew.isActive());
+
+    auto currents = Run(slew, driver, 4'500'000, 8);
+    const std::vector<uint32_t> rising{1'000'000, 2'000'000, 3'000'000, 4'000'000, 4'500'000,
+        4'500'000, 4'500'000, 4'500'000};
+    CHECK(currents == rising);
+
+    currents = Run(slew, driver, 1'200'000, 5);
+    const std::vector<uint32_t> falling{3'500'000, 2'500'000, 1'500'000, 1'200'000, 1'200'000};
+    CHECK(currents == falling);
+
+    // a target change mid-ramp reverses it right away
+    Run(slew, driver, 5'000'000, 2);
+    CHECK_EQ(driver.getCurrent(0), 3'200'000);
+    CHECK_EQ(Run(slew, driver, 0, 1).back(), 2'200'000);
+}
+
+/**
+ * @brief Rates that aren't a multiple of the tick interval
+ *
+ * The rate is quantized to a whole step per tick; very large rates don't overflow it.
+ */
+static void TestSlewQuantization() {
+    SimulatedLoadDriver driver{1, 10'000};
+    driver.setEnabled(true);
+
+    SlewLimiter slew;
+    slew.configure({.slewRate = 3}, 7);
+    CHECK_EQ(Run(slew, driver, 1'000, 3).back(), 63);
+
+    slew.configure({.slewRate = UINT32_MAX}, kTickInterval);
+    CHECK_EQ(Run(slew, driver, UINT32_MAX, 1).back(), UINT32_MAX);
+    CHECK_EQ(Run(slew, driver, 0, 1).back(), 0);
+}
+
+/**
+ * @brief Soft-start ramp
+ *
+ * On enable, the current ramps up linearly from zero to the target over the soft-start time
+ * (rounded up to whole ticks), then follows the target without limiting.
+ */
+static void TestSoftStart() {
+    SimulatedLoadDriver driver{1, 10'000};
+    driver.setEnabled(true);
+
+    // 95 ms: 10 ticks
+    SlewLimiter slew;
+    slew.configure({.softStartTime = 95}, kTickInterval);
+    CHECK(!slew.isActive());
+
+    slew.reset(0);
+    slew.startSoftStart();
+    CHECK(slew.isActive());
+
+    const auto currents = Run(slew, driver, 2'000'000, 12);
+    for(size_t i = 0; i < 10; i++) {
+        CHECK_EQ(currents[i], (i + 1) * 200'000);
+    }
+    CHECK_EQ(currents[11], 2'000'000);
+    CHECK(!slew.isActive());
+
+    CHECK_EQ(Run(slew, driver, 6'000'000, 1).back(), 6'000'000);
+}
+
+/**
+ * @brief Soft-start with a changing target
+ *
+ * The ramp is a fraction of the target that grows each tick, so it follows target changes: the
+ * current is always the same fraction of the present target, and only reaches it at the end.
+ */
+static void TestSoftStartTargetChange() {
+    SimulatedLoadDriver driver{1, 10'000};
+    driver.setEnabled(true);
+
+    SlewLimiter slew;
+    slew.configure({.softStartTime = 100}, kTickInterval);
+    slew.startSoftStart();
+
+    CHECK_EQ(Run(slew, driver, 1'000'000, 4).back(), 400'000);
+    CHECK_EQ(Run(slew, driver, 3'000'000, 1).back(), 1'500'000);
+    CHECK_EQ(Run(slew, driver, 100'000, 1).back(), 60'000);
+
+    const auto currents = Run(slew, driver, 3'000'000, 4);
+    CHECK_EQ(currents[0], 2'100'000);
+    CHECK_EQ(currents[3], 3'000'000);
+}
+
+/**
+ * @brief Soft-start and slew rate combined
+ *
+ * The current follows whichever of the two is slower; once the soft-start ramp ends, only the
+ * slew rate applies.
+ */
+static void TestSoftStartWithSlew() {
+    SimulatedLoadDriver driver{1, 10'000};
+    driver.setEnabled(true);
+
+    // 10 tick ramp to 10A (1A per tick), with a faster slew rate of 1.5A per tick
+    SlewLimiter slew;
+    slew.configure({.slewRate = 150'000, .softStartTime = 100}, kTickInterval);
+    slew.startSoftStart();
+
+    auto currents = Run(slew, driver, 10'000'000, 10);
+    for(size_t i = 0; i < currents.size(); i++) {
+        CHECK_EQ(currents[i], (i + 1) * 1'000'000);
+    }
+    CHECK_EQ(Run(slew, driver, 20'000'000, 1).back(), 11'500'000);
+
+    // with a slower slew rate of 0.8A per tick, it limits past the end of the ramp
+    slew.configure({.slewRate = 80'000, .softStartTime = 100}, kTickInterval);
+    slew.reset(0);
+    slew.startSoftStart();
+
+    currents = Run(slew, driver, 10'000'000, 14);
+    for(size_t i = 0; i < currents.size(); i++) {
+        CHECK_EQ(currents[i], std::min<uint32_t>((i + 1) * 800'000, 10'000'000));
+    }
+}
+
+/**
+ * @brief Reconfiguration
+ *
+ * Changing the parameters cuts a soft-start ramp in progress short; the new slew rate applies
+ * from the current output on.
+ */
+static void TestReconfigure() {
+    SimulatedLoadDriver driver{1, 10'000};
+    driver.setEnabled(true);
+
+    SlewLimiter slew;
+    slew.configure({.softStartTime = 1'000}, kTickInterval);
+    slew.startSoftStart();
+    CHECK_EQ(Run(slew, driver, 10'000'000, 10).back(), 1'000'000);
+
+    slew.configure({.slewRate = 50'000, .softStartTime = 1'000}, kTickInterval);
+    const auto currents = Run(slew, driver, 10'000'000, 3);
+    CHECK_EQ(currents[0], 1'500'000);
+    CHECK_EQ(currents[2], 2'500'000);
+}
+
+int main() {
+    TestUnlimited();
+    TestSlewRate();
+    TestSlewQuantization();
+    TestSoftStart();
+    TestSoftStartTargetChange();
+    TestSoftStartWithSlew();
+    TestReconfigure();
+
+    return Test::Finish();
+}
@@ -0,0 +1,321 @@
+/**
+ * @file
+ *
+ * @brief SOA limiter tests and per-tick cost benchmark
+ *
+ * The limiter runs against a simulated driver, whose channels conduct exactly what they're
+ * commanded. Tests close the loop the same way the control task does: each tick, channels are
+ * commanded the smaller of the requested current and the limiter's last limit.
+ *
+ * The benchmark reports the host time taken by a single update() for increasing numbers of
+ * channels and thermal stages; it's only meaningful relative to itself, but shows that the cost
+ * scales with the model size and nothing else.
+ */
+#include "Test.h"
+#include "SimulatedLoadDriver.h"
+
+#include "App/Control/SoaLimiter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+
+using App::Control::LoadDriver;
+using App::Control::SoaLimiter;
+
+/// Control tick interval (ms), same as the control task
+constexpr static const uint32_t kTickInterval{10};
+/// Maximum input current of the simulated driver (mA); 10A per channel
+constexpr static const uint32_t kMaxCurrent{20'000};
+
+/// Thermal network (same as the analog board)
+static const etl::array<LoadDriver::SafeOperatingArea::Stage, 3> gStages{{
+    {.resistance = 300, .timeConstant = 5},
+    {.resistance = 150, .timeConstant = 50},
+    {.resistance = 500, .timeConstant = 1000},
+}};
+
+/// DC SOA curve (same as the analog board)
+static const etl::array<LoadDriver::SafeOperatingArea::Point, 4> gCurve{{
+    {.voltage = 0, .power = 100'000},
+    {.voltage = 10'000, .power = 100'000},
+    {.voltage = 30'000, .power = 75'000},
+    {.voltage = 60'000, .power = 40'000},
+}};
+
+static const LoadDriver::SafeOperatingArea gSoa{
+    .stages = gStages,
+    .curve = gCurve,
+    .maxJunctionTemp = 125'000,
+    .defaultHeatsinkTemp = 85'000,
+};
+
+/**
+ * @brief Run control ticks
+ *
+ * Each tick, all channels are commanded the requested current, limited to the limiter's current
+ * limit; then the limiter is updated.
+ *
+ * @return Highest modelled junction temperature of any channel (m°C)
+ */
+static int32_t Run(SimulatedLoadDriver &driver, SoaLimiter &limiter, const size_t numChannels,
+        const uint32_t voltage, const uint32_t requested, const size_t ticks) {
+    int32_t maxTemp{INT32_MIN};
+
+    driver.inputVoltage = voltage;
+
+    for(size_t i = 0; i < ticks; i++) {
+        for(size_t j = 0; j < numChannels; j++) {
+            driver.channels[j].command = std::min(requested, limiter.getChannelCurrentLimit());
+        }
+
+        CHECK_EQ(limiter.update(voltage), 0);
+
+        for(size_t j = 0; j < numChannels; j++) {
+            maxTemp = std::max(maxTemp, limiter.getJunctionTemp(j));
+        }
+    }
+
+    return maxTemp;
+}
+
+/**
+ * @brief Drivers without a thermal model
+ *
+ * Only the channel current limit applies.
+ */
+static void TestNoThermalModel() {
+    SimulatedLoadDriver driver{2, kMaxCurrent};
+    driver.setEnabled(true);
+
+    SoaLimiter limiter;
+    limiter.attach(&driver, kTickInterval);
+    CHECK_EQ(limiter.getChannelCurrentLimit(), 10'000'000);
+
+    Run(driver, limiter, 2, 60'000, 10'000'000, 100);
+    CHECK_EQ(limiter.getChannelCurrentLimit(), 10'000'000);
+}
+
+/**
+ * @brief DC SOA curve
+ *
+ * With cold channels, the limit is set by the SOA curve (interpolated, and clamped at its ends)
+ * or the channel current limit.
+ */
+static void TestSoaCurve() {
+    SimulatedLoadDriver driver{2, kMaxCurrent};
+    driver.soa = &gSoa;
+
+    SoaLimiter limiter;
+    limiter.attach(&driver, kTickInterval);
+
+    // 87.5W at 20V
+    CHECK_EQ(limiter.update(20'000), 0);
+    CHECK_EQ(limiter.getChannelCurrentLimit(), 4'375'000);
+
+    // 40W beyond the end of the curve
+    CHECK_EQ(limiter.update(80'000), 0);
+    CHECK_EQ(limiter.getChannelCurrentLimit(), 500'000);
+
+    // 100W at 5V would be 20A
+    CHECK_EQ(limiter.update(5'000), 0);
+    CHECK_EQ(limiter.getChannelCurrentLimit(), 10'000'000);
+
+    // no voltage: no power to limit
+    CHECK_EQ(limiter.update(0), 0);
+    CHECK_EQ(limiter.getChannelCurrentLimit(), 10'000'000);
+}
+
+/**
+ * @brief Heatsink temperature
+ *
+ * The measured heatsink temperature is used if available, the driver's default otherwise.
+ */
+static void TestHeatsinkTemp() {
+    SimulatedLoadDriver driver{2, kMaxCurrent};
+    driver.soa = &gSoa;
+
+    SoaLimiter limiter;
+    limiter.attach(&driver, kTickInterval);
+    CHECK_EQ(limiter.update(10'000), 0);
+    CHECK_EQ(limiter.getHeatsinkTemp(), 85'000);
+    CHECK_EQ(limiter.getJunctionTemp(0), 85'000);
+
+    driver.hasHeatsinkTemperature = true;
+    driver.heatsinkTemperature = 42'000;
+    CHECK_EQ(limiter.update(10'000), 0);
+    CHECK_EQ(limiter.getHeatsinkTemp(), 42'000);
+    CHECK_EQ(limiter.getJunctionTemp(1), 42'000);
+}
+
+/**
+ * @brief Thermal model steady state
+ *
+ * At constant power, the junction settles at the heatsink temperature plus the power times the
+ * total thermal resistance.
+ */
+static void TestSteadyState() {
+    SimulatedLoadDriver driver{2, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.soa = &gSoa;
+    driver.hasHeatsinkTemperature = true;
+    driver.heatsinkTemperature = 25'000;
+
+    SoaLimiter limiter;
+    limiter.attach(&driver, kTickInterval);
+
+    // 40W for 20 of the longest time constants: 25°C + 40W * 0.95°C/W = 63°C
+    Run(driver, limiter, 2, 20'000, 2'000'000, 2'000);
+    CHECK(abs(limiter.getJunctionTemp(0) - 63'000) < 500);
+    CHECK(abs(limiter.getJunctionTemp(1) - 63'000) < 500);
+
+    // and cools back down to the heatsink
+    Run(driver, limiter, 2, 20'000, 0, 2'000);
+    CHECK(abs(limiter.getJunctionTemp(0) - 25'000) < 500);
+}
+
+/**
+ * @brief Junction temperature limit
+ *
+ * Requesting more than the channels can dissipate on a hot heatsink: the limit keeps the junction
+ * below its maximum at all times, without being overly conservative once it's settled.
+ */
+static void TestJunctionLimit() {
+    SimulatedLoadDriver driver{2, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.soa = &gSoa;
+    driver.hasHeatsinkTemperature = true;
+    driver.heatsinkTemperature = 80'000;
+
+    SoaLimiter limiter;
+    limiter.attach(&driver, kTickInterval);
+    CHECK_EQ(limiter.update(30'000), 0);
+
+    // the SOA curve alone (75W) would allow 2.5A; that's 71°C above the heatsink though
+    CHECK_EQ(limiter.getChannelCurrentLimit(), 2'500'000);
+
+    const auto maxTemp = Run(driver, limiter, 2, 30'000, 10'000'000, 5'000);
+    CHECK(maxTemp <= gSoa.maxJunctionTemp);
+    CHECK(limiter.getJunctionTemp(0) > gSoa.maxJunctionTemp - 2'000);
+    CHECK(limiter.getChannelCurrentLimit() < 2'500'000);
+
+    // a cooler heatsink allows more current again
+    const auto limit = limiter.getChannelCurrentLimit();
+    driver.heatsinkTemperature = 40'000;
+    Run(driver, limiter, 2, 30'000, 10'000'000, 10);
+    CHECK(limiter.getChannelCurrentLimit() > limit);
+}
+
+/**
+ * @brief Hottest channel sets the limit
+ *
+ * The limit applies to all channels, so it's that of the channel with the least headroom.
+ */
+static void TestHottestChannel() {
+    SimulatedLoadDriver driver{2, kMaxCurrent};
+    driver.setEnabled(true);
+    driver.soa = &gSoa;
+    driver.hasHeatsinkTemperature = true;
+    driver.heatsinkTemperature = 80'000;
+
+    SoaLimiter limiter;
+    limiter.attach(&driver, kTickInterval);
+
+    // heat up only channel 0
+    driver.inputVoltage = 30'000;
+    for(size_t i = 0; i < 200; i++) {
+        driver.channels[0].command = std::min(2'000'000U, limiter.getChannelCurrentLimit());
+        driver.channels[1].command = 0;
+        CHECK_EQ(limiter.update(30'000), 0);
+    }
+
+    CHECK(limiter.getJunctionTemp(0) > limiter.getJunctionTemp(1));
+    CHECK_EQ(limiter.getJunctionTemp(1), 80'000);
+
+    // compare with a fresh limiter, where both channels are cold
+    SoaLimiter cold;
+    cold.attach(&driver, kTickInterval);
+    driver.channels[0].command = 0;
+    CHECK_EQ(cold.update(30'000), 0);
+
+    CHECK(limiter.getChannelCurrentLimit() < cold.getChannelCurrentLimit());
+}
+
+/**
+ * @brief Measure the cost of a single update
+ *
+ * @return Time per update, in ns
+ */
+static double MeasureUpdate(const size_t numChannels, const LoadDriver::SafeOperatingArea &soa,
+        const size_t iterations) {
+    using Clock = std::chrono::steady_clock;
+
+    SimulatedLoadDriver driver{numChannels, 10'000 * static_cast<uint32_t>(numChannels)};
+    driver.setEnabled(true);
+    driver.soa = &soa;
+    driver.hasHeatsinkTemperature = true;
+    driver.heatsinkTemperature = 60'000;
+    for(size_t i = 0; i < numChannels; i++) {
+        driver.channels[i].command = 1'000'000 + (i * 100'000);
+    }
+
+    SoaLimiter limiter;
+    limiter.attach(&driver, kTickInterval);
+
+    volatile uint32_t sink{0};
+    const auto start = Clock::now();
+    for(size_t i = 0; i < iterations; i++) {
+        limiter.update(25'000 + (i & 0xFFF));
+        sink = sink + limiter.getChannelCurrentLimit();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+
+    return elapsed.count() / iterations;
+}
+
+/**
+ * @brief Per-tick cost for increasing model sizes
+ *
+ * Up to the maximum of four channels and four thermal stages; the SOA curve has four points.
+ */
+static void Benchmark() {
+    static const etl::array<LoadDriver::SafeOperatingArea::Stage, 4> kStages{{
+        {.resistance = 300, .timeConstant = 5},
+        {.resistance = 150, .timeConstant = 50},
+        {.resistance = 250, .timeConstant = 500},
+        {.resistance = 250, .timeConstant = 5000},
+    }};
+
+    constexpr static const size_t kIterations{1'000'000};
+
+    printf("%8s %8s %12s\n", "channels", "stages", "ns/tick");
+
+    for(const size_t channels : {1, 2, 4}) {
+        for(const size_t stages : {1, 2, 4}) {
+            const LoadDriver::SafeOperatingArea soa{
+                .stages = {kStages.data(), stages},
+                .curve = gCurve,
+                .maxJunctionTemp = 125'000,
+                .defaultHeatsinkTemp = 85'000,
+            };
+
+            printf("%8zu %8zu %12.1f\n", channels, stages,
+                    MeasureUpdate(channels, soa, kIterations));
+        }
+    }
+}
+
+int main() {
+    TestNoThermalModel();
+    TestSoaCurve();
+    TestHeatsinkTemp();
+    TestSteadyState();
+    TestJunctionLimit();
+    TestHottestChannel();
+
+    Benchmark();
+
+    return Test::Finish();
+}
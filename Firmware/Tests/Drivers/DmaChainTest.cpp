@@ -0,0 +1,232 @@
+/**
+ * @file
+ *
+ * @brief DMA descriptor chain tests
+ *
+ * Covers allocation from the shared descriptor pool, segment configuration, and linking chains
+ * (including circular chains) when they're started. The controller itself isn't simulated.
+ */
+#include "Test.h"
+
+#include "Drivers/Dma.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+using Drivers::Dma;
+using BeatSize = Dma::BeatSize;
+
+/// Buffers for segments to transfer from/to
+static uint8_t gSource[1024], gDestination[1024];
+/// A fixed peripheral data register
+static volatile uint32_t gDataReg;
+
+/**
+ * @brief Descriptor address of an object
+ */
+template<typename T>
+static uintptr_t Address(T *ptr) {
+    return reinterpret_cast<uintptr_t>(ptr);
+}
+
+/**
+ * @brief Configure every segment of a chain as a 16 byte copy
+ */
+static void ConfigureAll(Dma::Chain &chain, const bool interrupt = false) {
+    for(size_t i = 0; i < chain.length; i++) {
+        CHECK_EQ(Dma::ConfigureChainSegment(chain, i, BeatSize::Byte, gSource + (16 * i), true,
+                    gDestination + (16 * i), true, 16, interrupt), 0);
+    }
+}
+
+/**
+ * @brief Chains are contiguous, first-fit allocations from the pool
+ */
+static void TestAllocation() {
+    Dma::Chain a, b, c;
+
+    CHECK_EQ(Dma::AllocChain(a, 4), 0);
+    CHECK_EQ(Dma::AllocChain(b, 8), 0);
+    CHECK_EQ(a.length, 4U);
+    CHECK(b.descriptors == a.descriptors + 4);
+
+    // remaining 20 descriptors can't satisfy a larger chain
+    CHECK_EQ(Dma::AllocChain(c, Dma::kChainPoolSize - 11), Dma::Errors::NoDescriptors);
+    CHECK(!c.descriptors);
+
+    // freeing the first leaves a hole that a smaller chain reuses
+    Dma::FreeChain(a);
+    CHECK(!a.descriptors);
+    CHECK_EQ(a.length, 0U);
+
+    CHECK_EQ(Dma::AllocChain(c, 3), 0);
+    CHECK(c.descriptors == b.descriptors - 4);
+
+    // but a chain that doesn't fit in the hole goes after the last one
+    CHECK_EQ(Dma::AllocChain(a, 5), 0);
+    CHECK(a.descriptors == b.descriptors + 8);
+
+    // freshly allocated descriptors are invalid
+    for(size_t i = 0; i < a.length; i++) {
+        CHECK_EQ(a.descriptors[i].BTCTRL.reg, 0);
+    }
+
+    // freeing twice, or a chain that was never allocated, is harmless
+    Dma::FreeChain(a);
+    Dma::FreeChain(a);
+    Dma::FreeChain(b);
+    Dma::FreeChain(c);
+
+    // all descriptors are free again, so the whole pool can be allocated as one chain
+    CHECK_EQ(Dma::AllocChain(a, Dma::kChainPoolSize), 0);
+    CHECK_EQ(Dma::AllocChain(b, 1), Dma::Errors::NoDescriptors);
+    Dma::FreeChain(a);
+
+    CHECK_EQ(Dma::AllocChain(a, 0), Dma::Errors::InvalidChain);
+    CHECK_EQ(Dma::AllocChain(a, Dma::kChainPoolSize + 1), Dma::Errors::InvalidChain);
+}
+
+/**
+ * @brief Pool exhaustion by many single descriptor chains
+ */
+static void TestExhaustion() {
+    std::vector<Dma::Chain> chains(Dma::kChainPoolSize);
+
+    for(auto &chain : chains) {
+        CHECK_EQ(Dma::AllocChain(chain, 1), 0);
+    }
+
+    Dma::Chain extra;
+    CHECK_EQ(Dma::AllocChain(extra, 1), Dma::Errors::NoDescriptors);
+
+    // free every other one: no room for two contiguous descriptors
+    for(size_t i = 0; i < chains.size(); i += 2) {
+        Dma::FreeChain(chains[i]);
+    }
+    CHECK_EQ(Dma::AllocChain(extra, 2), Dma::Errors::NoDescriptors);
+    CHECK_EQ(Dma::AllocChain(extra, 1), 0);
+
+    Dma::FreeChain(extra);
+    for(auto &chain : chains) {
+        Dma::FreeChain(chain);
+    }
+}
+
+/**
+ * @brief Segment beat size, count and address configuration
+ */
+static void TestSegment() {
+    Dma::Chain chain;
+    CHECK_EQ(Dma::AllocChain(chain, 3), 0);
+
+    // memory to memory: end addresses are programmed for incrementing addresses
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 0, BeatSize::Word, gSource, true, gDestination,
+                true, 64, false), 0);
+    const auto &copy = chain.descriptors[0];
+    CHECK_EQ(copy.BTCTRL.bit.VALID, 1);
+    CHECK_EQ(copy.BTCTRL.bit.BEATSIZE, static_cast<uint8_t>(BeatSize::Word));
+    CHECK_EQ(copy.BTCTRL.bit.SRCINC, 1);
+    CHECK_EQ(copy.BTCTRL.bit.DSTINC, 1);
+    CHECK_EQ(copy.BTCTRL.bit.BLOCKACT, 0);
+    CHECK_EQ(copy.BTCNT.reg, 16);
+    CHECK_EQ(copy.SRCADDR.reg, Address(gSource) + 64);
+    CHECK_EQ(copy.DSTADDR.reg, Address(gDestination) + 64);
+
+    // memory to peripheral: the register address is fixed
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 1, BeatSize::HalfWord, gSource, true,
+                const_cast<uint32_t *>(&gDataReg), false, 10, true), 0);
+    const auto &tx = chain.descriptors[1];
+    CHECK_EQ(tx.BTCTRL.bit.DSTINC, 0);
+    CHECK_EQ(tx.BTCTRL.bit.BLOCKACT, 1);
+    CHECK_EQ(tx.BTCNT.reg, 5);
+    CHECK_EQ(tx.SRCADDR.reg, Address(gSource) + 10);
+    CHECK_EQ(tx.DSTADDR.reg, Address(&gDataReg));
+
+    // lengths must be a multiple of the beat size
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 2, BeatSize::HalfWord, gSource, true,
+                gDestination, true, 3, false), Dma::Errors::LengthBeatMismatch);
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 2, BeatSize::Word, gSource, true,
+                gDestination, true, 6, false), Dma::Errors::LengthBeatMismatch);
+    // and fit in the 16-bit beat count
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 2, BeatSize::Byte, gSource, false,
+                gDestination, false, 0x10000, false), Dma::Errors::TooLong);
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 2, BeatSize::Word, gSource, false,
+                gDestination, false, 0x3FFFC, false), 0);
+    CHECK_EQ(chain.descriptors[2].BTCNT.reg, 0xFFFF);
+
+    // a failed configuration leaves the segment invalid
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 2, BeatSize::Word, gSource, false,
+                gDestination, false, 2, false), Dma::Errors::LengthBeatMismatch);
+    CHECK_EQ(chain.descriptors[2].BTCTRL.bit.VALID, 0);
+
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 3, BeatSize::Byte, gSource, true, gDestination,
+                true, 1, false), Dma::Errors::InvalidChain);
+
+    Dma::FreeChain(chain);
+}
+
+/**
+ * @brief Starting a chain links its descriptors
+ */
+static void TestLinking() {
+    Dma::Chain chain;
+    CHECK_EQ(Dma::AllocChain(chain, 4), 0);
+
+    // incomplete chains can't be started
+    CHECK_EQ(Dma::ConfigureChainSegment(chain, 0, BeatSize::Byte, gSource, true, gDestination,
+                true, 16, false), 0);
+    CHECK_EQ(Dma::StartChain(0, chain), Dma::Errors::InvalidDescriptor);
+
+    ConfigureAll(chain);
+    CHECK_EQ(Dma::StartChain(0, chain), 0);
+
+    for(size_t i = 0; i + 1 < chain.length; i++) {
+        CHECK_EQ(chain.descriptors[i].DESCADDR.reg, Address(&chain.descriptors[i + 1]));
+        CHECK_EQ(chain.descriptors[i].BTCTRL.bit.BLOCKACT, 0);
+    }
+
+    // the last segment ends the chain, and always raises an interrupt
+    CHECK_EQ(chain.descriptors[3].DESCADDR.reg, 0U);
+    CHECK_EQ(chain.descriptors[3].BTCTRL.bit.BLOCKACT, 1);
+
+    // restarted as circular, the last links back to the first
+    CHECK_EQ(Dma::StartChain(1, chain, true), 0);
+    CHECK_EQ(chain.descriptors[3].DESCADDR.reg, Address(&chain.descriptors[0]));
+    CHECK_EQ(chain.descriptors[2].DESCADDR.reg, Address(&chain.descriptors[3]));
+
+    // a single segment circular chain links to itself
+    Dma::Chain single;
+    CHECK_EQ(Dma::AllocChain(single, 1), 0);
+    ConfigureAll(single, true);
+    CHECK_EQ(Dma::StartChain(2, single, true), 0);
+    CHECK_EQ(single.descriptors[0].DESCADDR.reg, Address(&single.descriptors[0]));
+
+    Dma::FreeChain(single);
+    Dma::FreeChain(chain);
+
+    Dma::Chain empty;
+    CHECK_EQ(Dma::StartChain(0, empty), Dma::Errors::InvalidChain);
+}
+
+/**
+ * @brief Single transfers are validated the same way as chain segments
+ */
+static void TestTransfer() {
+    CHECK_EQ(Dma::ConfigureTransfer(0, BeatSize::Byte, gSource, true, gDestination, true,
+                sizeof(gSource)), 0);
+    CHECK_EQ(Dma::ConfigureTransfer(0, BeatSize::Word, gSource, true, gDestination, true, 2),
+            Dma::Errors::LengthBeatMismatch);
+    CHECK_EQ(Dma::ConfigureTransfer(0, BeatSize::HalfWord, gSource, false, gDestination, false,
+                0x20000), Dma::Errors::TooLong);
+}
+
+int main() {
+    TestAllocation();
+    TestExhaustion();
+    TestSegment();
+    TestLinking();
+    TestTransfer();
+
+    return Test::Finish();
+}
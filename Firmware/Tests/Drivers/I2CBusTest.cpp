@@ -0,0 +1,271 @@
+/**
+ * @file
+ *
+ * @brief Asynchronous I²C request tests
+ *
+ * Exercises request queueing and completion on the simulated bus.
+ */
+#include "Test.h"
+#include "SimulatedI2CBus.h"
+
+#include "Drivers/I2CDevice/Common.h"
+
+#include <vector>
+
+using Drivers::I2CBus;
+using Priority = I2CBus::Priority;
+
+/// Address of the simulated register device
+constexpr static const uint8_t kDeviceAddress{0x20};
+/// Address at which there is no device
+constexpr static const uint8_t kMissingAddress{0x21};
+
+/**
+ * @brief A register write request
+ *
+ * Writes a single value to a register; completions are recorded in a shared list.
+ */
+struct WriteRequest {
+    etl::array<uint8_t, 2> buffer;
+    I2CBus::Transaction txn;
+    I2CBus::Request request;
+
+    WriteRequest(std::vector<int> &log, const int id, const uint8_t reg, const uint8_t value,
+            const Priority priority = Priority::Normal, const uint8_t address = kDeviceAddress) :
+            buffer{reg, value}, log(&log), id(id) {
+        this->txn = {
+            .address = address,
+            .read = 0,
+            .length = 2,
+            .data = this->buffer,
+        };
+        this->request = {
+            .transactions = {&this->txn, 1},
+            .priority = priority,
+            .callback = [](const int, void *ctx) {
+                auto req = reinterpret_cast<WriteRequest *>(ctx);
+                req->log->push_back(req->id);
+            },
+            .callbackContext = this,
+        };
+    }
+
+    std::vector<int> *log;
+    int id;
+};
+
+/**
+ * @brief Requests submitted while the bus is busy are executed back to back, in order
+ */
+static void TestQueuedInOrder() {
+    SimulatedI2CBus bus;
+    SimulatedRegisterDevice dev;
+    bus.attach(kDeviceAddress, &dev);
+
+    std::vector<int> log;
+    WriteRequest a(log, 1, 0x00, 0xAA), b(log, 2, 0x01, 0xBB), c(log, 3, 0x02, 0xCC);
+
+    CHECK_EQ(bus.submit(a.request), 0);
+    CHECK(bus.isBusy());
+    CHECK_EQ(bus.submit(b.request), 0);
+    CHECK_EQ(bus.submit(c.request), 0);
+
+    // nothing completes until the bus runs
+    CHECK(log.empty());
+
+    // each interrupt completes one request and starts the next
+    bus.runInterrupt();
+    CHECK_EQ(log.size(), 1U);
+    CHECK(bus.isBusy());
+
+    bus.runUntilIdle();
+    CHECK((log == std::vector<int>{1, 2, 3}));
+    CHECK_EQ(dev.registers[0x00], 0xAA);
+    CHECK_EQ(dev.registers[0x01], 0xBB);
+    CHECK_EQ(dev.registers[0x02], 0xCC);
+    CHECK_EQ(a.request.status, 0);
+}
+
+/**
+ * @brief A completion callback may submit a follow-up request
+ */
+static void TestChainedFromCallback() {
+    SimulatedI2CBus bus;
+    SimulatedRegisterDevice dev;
+    bus.attach(kDeviceAddress, &dev);
+
+    std::vector<int> log;
+    WriteRequest first(log, 1, 0x10, 0x01), second(log, 2, 0x11, 0x02), third(log, 3, 0x12, 0x03);
+
+    struct Chain {
+        SimulatedI2CBus *bus;
+        I2CBus::Request *next;
+        WriteRequest *self;
+    } chain{&bus, &second.request, &first};
+
+    first.request.callback = [](const int, void *ctx) {
+        auto chain = reinterpret_cast<Chain *>(ctx);
+        chain->self->log->push_back(chain->self->id);
+        chain->bus->submit(*chain->next);
+    };
+    first.request.callbackContext = &chain;
+
+    CHECK_EQ(bus.submit(first.request), 0);
+    CHECK_EQ(bus.submit(third.request), 0);
+    bus.runUntilIdle();
+
+    // the chained request was submitted after the third one was already queued
+    CHECK((log == std::vector<int>{1, 3, 2}));
+    CHECK_EQ(dev.registers[0x11], 0x02);
+}
+
+/**
+ * @brief Completion notifies the requesting task
+ */
+static void TestTaskNotification() {
+    SimulatedI2CBus bus;
+    SimulatedRegisterDevice dev;
+    bus.attach(kDeviceAddress, &dev);
+
+    tskTaskControlBlock task;
+    std::vector<int> log;
+    WriteRequest a(log, 1, 0x00, 0x55);
+
+    a.request.notifyTask = &task;
+    a.request.notifyIndex = Rtos::TaskNotifyIndex::TaskSpecific;
+    a.request.notifyBits = (1U << 4);
+
+    CHECK_EQ(bus.submit(a.request), 0);
+    CHECK_EQ(task.notifyValue[Rtos::TaskNotifyIndex::TaskSpecific], 0U);
+
+    bus.runUntilIdle();
+    CHECK_EQ(task.notifyValue[Rtos::TaskNotifyIndex::TaskSpecific], (1U << 4));
+}
+
+/**
+ * @brief A failed request reports its error, and doesn't affect the requests behind it
+ */
+static void TestErrorDoesNotStall() {
+    SimulatedI2CBus bus;
+    SimulatedRegisterDevice dev;
+    bus.attach(kDeviceAddress, &dev);
+
+    std::vector<int> log;
+    WriteRequest bad(log, 1, 0x00, 0x01, Priority::Normal, kMissingAddress),
+                 good(log, 2, 0x00, 0x02);
+
+    CHECK_EQ(bus.submit(bad.request), 0);
+    CHECK_EQ(bus.submit(good.request), 0);
+    bus.runUntilIdle();
+
+    CHECK((log == std::vector<int>{1, 2}));
+    CHECK_EQ(bad.request.status, I2CBus::kErrorNoAck);
+    CHECK_EQ(good.request.status, 0);
+    CHECK_EQ(dev.registers[0x00], 0x02);
+}
+
+/**
+ * @brief Invalid requests are rejected when submitted
+ */
+static void TestInvalidRejected() {
+    SimulatedI2CBus bus;
+
+    std::vector<int> log;
+    WriteRequest empty(log, 1, 0x00, 0x00);
+    empty.txn.length = 0;
+
+    CHECK(bus.submit(empty.request) != 0);
+    CHECK(!bus.isBusy());
+}
+
+/**
+ * @brief Higher priority requests are started first, at request boundaries
+ */
+static void TestPriorityOrder() {
+    SimulatedI2CBus bus;
+    SimulatedRegisterDevice dev;
+    bus.attach(kDeviceAddress, &dev);
+
+    std::vector<int> log;
+    WriteRequest running(log, 1, 0x00, 0x00, Priority::Low),
+                 low(log, 2, 0x01, 0x00, Priority::Low),
+                 normal(log, 3, 0x02, 0x00, Priority::Normal),
+                 high1(log, 4, 0x03, 0x00, Priority::High),
+                 high2(log, 5, 0x04, 0x00, Priority::High);
+
+    CHECK_EQ(bus.submit(running.request), 0);
+    CHECK_EQ(bus.submit(low.request), 0);
+    CHECK_EQ(bus.submit(normal.request), 0);
+    CHECK_EQ(bus.submit(high1.request), 0);
+    CHECK_EQ(bus.submit(high2.request), 0);
+    bus.runUntilIdle();
+
+    // the running request isn't interrupted
+    CHECK((log == std::vector<int>{1, 4, 5, 3, 2}));
+}
+
+/**
+ * @brief Busses without asynchronous support complete requests synchronously
+ */
+static void TestDefaultSubmit() {
+    class SyncBus: public I2CBus {
+        public:
+            int perform(etl::span<const Transaction> transactions,
+                    const Priority priority) override {
+                this->numPerformed++;
+                return transactions.front().address == kDeviceAddress ? 0 : -1;
+            }
+
+            size_t numPerformed{0};
+    } bus;
+
+    std::vector<int> log;
+    WriteRequest a(log, 1, 0x00, 0x00), b(log, 2, 0x00, 0x00, Priority::High, kMissingAddress);
+
+    CHECK_EQ(bus.submit(a.request), 0);
+    CHECK((log == std::vector<int>{1}));
+    CHECK_EQ(a.request.status, 0);
+
+    CHECK_EQ(bus.submit(b.request), 0);
+    CHECK((log == std::vector<int>{1, 2}));
+    CHECK_EQ(b.request.status, -1);
+    CHECK_EQ(bus.numPerformed, 2U);
+}
+
+/**
+ * @brief Register helpers submit their requests at the requested priority
+ */
+static void TestRegisterHelperPriority() {
+    using Drivers::I2CDevice::Common;
+
+    SimulatedI2CBus bus;
+    SimulatedRegisterDevice dev;
+    bus.attach(kDeviceAddress, &dev);
+
+    const etl::array<uint8_t, 2> values{{0x12, 0x34}};
+    uint8_t value{0};
+
+    CHECK_EQ(Common::WriteRegister(&bus, kDeviceAddress, 0x00, 0xAB), 0);
+    CHECK_EQ(Common::WriteRegisters(&bus, kDeviceAddress, 0x01, values, Priority::High), 0);
+    CHECK_EQ(Common::ReadRegister(&bus, kDeviceAddress, 0x02, value, Priority::Low), 0);
+
+    CHECK_EQ(value, 0x34);
+    CHECK_EQ(dev.registers[0x00], 0xAB);
+    CHECK_EQ(bus.completed.size(), 3U);
+    CHECK(bus.completed[0].priority == Priority::Normal);
+    CHECK(bus.completed[1].priority == Priority::High);
+    CHECK(bus.completed[2].priority == Priority::Low);
+}
+
+int main() {
+    TestQueuedInOrder();
+    TestChainedFromCallback();
+    TestTaskNotification();
+    TestErrorDoesNotStall();
+    TestInvalidRejected();
+    TestPriorityOrder();
+    TestDefaultSubmit();
+    TestRegisterHelperPriority();
+
+    return Test::Finish();
+}
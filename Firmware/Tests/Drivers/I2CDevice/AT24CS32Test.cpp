@@ -0,0 +1,256 @@
+/**
+ * @file
+ *
+ * @brief AT24CS32 EEPROM driver tests and write benchmark
+ *
+ * The EEPROM is simulated on a 400kHz bus, with a configurable write cycle time (tWR) during which
+ * it doesn't acknowledge its address. The benchmark writes the entire user area, and reports the
+ * simulated time taken, compared to waiting the maximum write cycle time after each page.
+ */
+#include "Test.h"
+#include "SimulatedI2CBus.h"
+
+#include "Drivers/I2CDevice/AT24CS32.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+using Drivers::I2CDevice::AT24CS32;
+
+/// Time to transfer a byte (and acknowledge bit) at 400kHz, in ns
+constexpr static const uint64_t kBytePeriod{9 * 2'500};
+/// Maximum write cycle time from the datasheet, in ns
+constexpr static const uint64_t kMaxWriteCycle{5'000'000};
+
+/**
+ * @brief Simulated AT24CS32 memory array
+ *
+ * The first two bytes of a write set the address pointer; following bytes are written into the
+ * current page (wrapping around within it.) A STOP after writing data starts the write cycle.
+ */
+class SimulatedEeprom: public SimulatedI2CBus::Device {
+    public:
+        /// Size of the memory array (4K x 8)
+        constexpr static const size_t kArraySize{0x1000};
+
+        SimulatedEeprom(const uint64_t writeCycle) : writeCycle(writeCycle) {}
+
+        bool start(const bool read) override {
+            if(Rtos::Simulation::Now() < this->busyUntil) {
+                this->numNacks++;
+                return false;
+            }
+
+            if(!read) {
+                this->numAddressBytes = 0;
+            }
+            return true;
+        }
+
+        bool write(const uint8_t byte) override {
+            if(this->numAddressBytes < 2) {
+                this->pointer = ((this->pointer << 8) | byte) & (kArraySize - 1);
+                this->numAddressBytes++;
+            } else {
+                const auto page = this->pointer & ~(AT24CS32::kPageSize - 1);
+                this->memory[page | ((this->pointer + this->numLatched) &
+                        (AT24CS32::kPageSize - 1))] = byte;
+                this->numLatched++;
+            }
+            return true;
+        }
+
+        uint8_t read() override {
+            const auto value = this->memory[this->pointer];
+            this->pointer = (this->pointer + 1) & (kArraySize - 1);
+            return value;
+        }
+
+        void stop() override {
+            if(this->numLatched) {
+                this->busyUntil = Rtos::Simulation::Now() + this->writeCycle;
+                this->numPageWrites++;
+                this->numLatched = 0;
+            }
+        }
+
+    public:
+        /// Memory array contents
+        etl::array<uint8_t, kArraySize> memory{};
+
+        /// Number of page write cycles started
+        size_t numPageWrites{0};
+        /// Number of times the device didn't acknowledge because it was busy
+        size_t numNacks{0};
+
+    private:
+        /// Duration of a write cycle, in ns
+        uint64_t writeCycle;
+        /// Time at which the current write cycle completes
+        uint64_t busyUntil{0};
+
+        /// Current memory address
+        uint16_t pointer{0};
+        /// Number of address bytes received in the current write
+        uint8_t numAddressBytes{0};
+        /// Number of data bytes latched for the current page write
+        size_t numLatched{0};
+};
+
+/**
+ * @brief Test fixture: an EEPROM on a simulated 400kHz bus
+ */
+struct Fixture {
+    SimulatedI2CBus bus;
+    SimulatedEeprom eeprom;
+    AT24CS32 driver{&bus};
+
+    Fixture(const uint64_t writeCycle) : eeprom(writeCycle) {
+        this->bus.bytePeriod = kBytePeriod;
+        this->bus.attach(AT24CS32::kDefaultAddress, &this->eeprom);
+    }
+};
+
+/**
+ * @brief Generate test data
+ */
+static std::vector<uint8_t> MakeData(const size_t length, const uint8_t seed) {
+    std::vector<uint8_t> data(length);
+    for(size_t i = 0; i < length; i++) {
+        data[i] = static_cast<uint8_t>((i * 7) + seed);
+    }
+    return data;
+}
+
+/**
+ * @brief Unaligned writes are split at page boundaries, and can be read back
+ */
+static void TestUnalignedWrite() {
+    Fixture f(kMaxWriteCycle);
+    const auto data = MakeData(100, 0x31);
+
+    CHECK_EQ(f.driver.writeData(0x1F0, data), 0);
+    // 16 bytes to the end of the first page, then 32 + 32 + 20
+    CHECK_EQ(f.eeprom.numPageWrites, 4U);
+
+    std::vector<uint8_t> readback(data.size());
+    CHECK_EQ(f.driver.readData(0x1F0, readback), 0);
+    CHECK((readback == data));
+}
+
+/**
+ * @brief A device that stays busy times out
+ */
+static void TestWriteTimeout() {
+    Fixture f(100'000'000);
+    const auto data = MakeData(AT24CS32::kPageSize * 2, 0);
+
+    CHECK_EQ(f.driver.writeData(0, data), AT24CS32::Errors::WriteTimeout);
+    CHECK_EQ(f.eeprom.numPageWrites, 1U);
+}
+
+/**
+ * @brief Invalid writes are rejected
+ */
+static void TestInvalidWrite() {
+    Fixture f(kMaxWriteCycle);
+    const auto data = MakeData(0x20, 0);
+
+    CHECK_EQ(f.driver.writeData(AT24CS32::kDeviceSize - 0x10, data),
+            AT24CS32::Errors::InvalidBuffer);
+    CHECK_EQ(f.driver.writeData(0, {}), AT24CS32::Errors::InvalidBuffer);
+    CHECK_EQ(f.eeprom.numPageWrites, 0U);
+}
+
+/**
+ * @brief Asynchronous writes are paced by the retry timer, and complete once
+ */
+static void TestAsyncWrite() {
+    Fixture f(kMaxWriteCycle);
+    const auto data = MakeData(80, 0x5A);
+
+    AT24CS32::AsyncWrite op;
+    int status{1}, numCallbacks{0};
+
+    struct Result {
+        int *status;
+        int *numCallbacks;
+    } result{&status, &numCallbacks};
+
+    CHECK_EQ(f.driver.writeDataAsync(op, 0x10, data, [](const int status, void *ctx) {
+        auto result = reinterpret_cast<Result *>(ctx);
+        *result->status = status;
+        (*result->numCallbacks)++;
+    }, &result), 0);
+    CHECK(op.isBusy());
+
+    // a second write on the same object is rejected
+    CHECK_EQ(f.driver.writeDataAsync(op, 0x10, data, nullptr, nullptr), AT24CS32::Errors::InUse);
+
+    while(op.isBusy()) {
+        if(f.bus.isBusy()) {
+            f.bus.runInterrupt();
+        } else if(!Rtos::Simulation::RunNextTimer()) {
+            break;
+        }
+    }
+
+    CHECK(!op.isBusy());
+    CHECK_EQ(status, 0);
+    CHECK_EQ(numCallbacks, 1);
+    CHECK_EQ(f.eeprom.numPageWrites, 3U);
+
+    std::vector<uint8_t> readback(data.size());
+    CHECK_EQ(f.driver.readData(0x10, readback), 0);
+    CHECK((readback == data));
+}
+
+/**
+ * @brief Benchmark writing the entire user area
+ *
+ * Compares the time taken with the baseline of waiting the worst case write cycle time after
+ * each page, for several write cycle times.
+ */
+static void BenchmarkFullWrite() {
+    constexpr static const size_t kNumPages{AT24CS32::kDeviceSize / AT24CS32::kPageSize};
+    // device address + 2 address bytes + page data
+    constexpr static const uint64_t kPageTransfer{(3 + AT24CS32::kPageSize) * kBytePeriod};
+    // a poll is the device address + 2 address bytes
+    constexpr static const uint64_t kPollTransfer{3 * kBytePeriod};
+    constexpr static const uint64_t kPollInterval{AT24CS32::kPollInterval * 1'000'000ULL};
+
+    const auto baseline = kNumPages * (kPageTransfer + kMaxWriteCycle);
+
+    printf("AT24CS32 full write (%zu pages), baseline %.1f ms\n", kNumPages, baseline / 1e6);
+
+    for(const uint64_t writeCycle : {uint64_t{1'500'000}, uint64_t{3'000'000}, kMaxWriteCycle}) {
+        Fixture f(writeCycle);
+        const auto data = MakeData(AT24CS32::kDeviceSize, static_cast<uint8_t>(writeCycle));
+
+        const auto start = Rtos::Simulation::Now();
+        CHECK_EQ(f.driver.writeData(0, data), 0);
+        const auto elapsed = Rtos::Simulation::Now() - start;
+
+        CHECK_EQ(f.eeprom.numPageWrites, kNumPages);
+        CHECK(std::equal(data.begin(), data.end(), f.eeprom.memory.begin()));
+
+        // each page costs at most its transfer, the write cycle, and one poll interval of slack
+        CHECK(elapsed <= kNumPages * (kPageTransfer + writeCycle + kPollInterval + kPollTransfer));
+
+        printf("  tWR %.1f ms: %8.1f ms (%.2f ms/page, %5.1f%% of baseline), %zu busy NACKs\n",
+                writeCycle / 1e6, elapsed / 1e6, (elapsed / 1e6) / kNumPages,
+                (100. * elapsed) / baseline, f.eeprom.numNacks);
+    }
+}
+
+int main() {
+    TestUnalignedWrite();
+    TestWriteTimeout();
+    TestInvalidWrite();
+    TestAsyncWrite();
+    BenchmarkFullWrite();
+
+    return Test::Finish();
+}
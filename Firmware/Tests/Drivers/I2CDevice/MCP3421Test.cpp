@@ -0,0 +1,344 @@
+/**
+ * @file
+ *
+ * @brief MCP3421 autoranging read tests
+ *
+ * The ADC is simulated at the register level: reads return the output code followed by the
+ * configuration byte, whose ready bit is cleared when a conversion completes, and set again once
+ * the result was read. Conversions only complete when the test says so, and each one uses the
+ * gain that was set when it started; a gain change thus only applies from the conversion after
+ * the one in progress.
+ */
+#include "Test.h"
+#include "SimulatedI2CBus.h"
+
+#include "Drivers/I2CDevice/MCP3421.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+using Drivers::I2CDevice::MCP3421;
+
+/// Address of the ADC
+constexpr static const uint8_t kAddress{0x68};
+
+/**
+ * @brief Simulated MCP3421
+ */
+class SimulatedAdc: public SimulatedI2CBus::Device {
+    public:
+        /// Conversion not ready bit in the configuration register
+        constexpr static const uint8_t kNotReady{(1 << 7)};
+        /// Continuous conversion mode bit in the configuration register
+        constexpr static const uint8_t kContinuous{(1 << 4)};
+
+        bool start(const bool) override {
+            this->numRead = 0;
+            return true;
+        }
+
+        bool write(const uint8_t byte) override {
+            this->config = (this->config & kNotReady) | (byte & ~kNotReady);
+            this->numConfigWrites++;
+            return true;
+        }
+
+        uint8_t read() override {
+            const size_t numData = this->getNumDataBytes();
+            const size_t index = this->numRead++;
+
+            if(index < numData) {
+                return static_cast<uint8_t>(this->code >> (8 * (numData - 1 - index)));
+            }
+            return this->config;
+        }
+
+        void stop() override {
+            if(this->numRead) {
+                this->config |= kNotReady;
+            }
+        }
+
+        /**
+         * @brief Complete the conversion in progress
+         *
+         * Only conversions in continuous mode complete; the next conversion starts with the gain
+         * currently configured.
+         */
+        void convert() {
+            if(!(this->config & kContinuous)) {
+                return;
+            }
+
+            static const double kLsb[]{1000., 250., 62.5, 15.625};
+            const auto depth = (this->config >> 2) & 0b11;
+            const int32_t fullScale = (1 << (11 + (2 * depth))) - 1;
+
+            const auto code = lround((this->input * (1 << this->conversionGain)) / kLsb[depth]);
+            this->code = std::clamp<int32_t>(code, -fullScale - 1, fullScale);
+            this->config &= ~kNotReady;
+            this->numConversions++;
+
+            this->conversionGain = this->config & 0b11;
+        }
+
+    public:
+        /// Input voltage (µV)
+        double input{0};
+
+        /// Configuration register (power on default)
+        uint8_t config{kNotReady | kContinuous};
+        /// Output code of the most recent conversion
+        int32_t code{0};
+
+        /// Number of configuration register writes
+        size_t numConfigWrites{0};
+        /// Number of conversions completed
+        size_t numConversions{0};
+
+    private:
+        /// Number of output code bytes (18 bit conversions need three)
+        size_t getNumDataBytes() const {
+            return (((this->config >> 2) & 0b11) == 0b11) ? 3 : 2;
+        }
+
+    private:
+        /// Gain setting of the conversion in progress
+        uint8_t conversionGain{0};
+        /// Number of bytes read in the current message
+        size_t numRead{0};
+};
+
+/**
+ * @brief Simulated bus with the ADC attached
+ */
+struct Board {
+    SimulatedI2CBus bus;
+    SimulatedAdc adc;
+
+    Board() {
+        this->bus.attach(kAddress, &this->adc);
+    }
+};
+
+/**
+ * @brief Test fixture: an ADC and its driver
+ */
+struct Fixture: public Board {
+    MCP3421 driver;
+
+    Fixture(const MCP3421::SampleDepth depth = MCP3421::SampleDepth::Low) :
+        driver(&this->bus, kAddress, depth) {}
+
+    /**
+     * @brief Complete a conversion at the given input voltage, then read it
+     */
+    MCP3421::Sample convert(const double input) {
+        this->adc.input = input;
+        this->adc.convert();
+        return this->read();
+    }
+
+    /// Perform an autoranging read
+    MCP3421::Sample read() {
+        MCP3421::Sample sample;
+        CHECK_EQ(this->driver.readAutoranging(sample), 0);
+        return sample;
+    }
+
+    /**
+     * @brief Settle at the given input voltage
+     *
+     * Convert until the gain no longer changes.
+     *
+     * @return The last sample
+     */
+    MCP3421::Sample settle(const double input) {
+        MCP3421::Sample sample;
+        for(size_t i = 0; i < 10; i++) {
+            sample = this->convert(input);
+            if(sample.isNew && sample.gain == this->driver.getGain()) {
+                break;
+            }
+        }
+        return sample;
+    }
+};
+
+/**
+ * @brief Ready bit
+ *
+ * Until a conversion completes, reads return the previous sample again, marked as not new,
+ * without touching the gain.
+ */
+static void TestNotReady() {
+    Fixture f;
+
+    // nothing converted yet
+    auto sample = f.read();
+    CHECK(!sample.isNew);
+    CHECK_EQ(sample.code, 0);
+
+    sample = f.convert(1'000'000);
+    CHECK(sample.isNew);
+    CHECK_EQ(sample.code, 1'000);
+    CHECK_EQ(sample.voltage, 1'000'000);
+    CHECK(sample.gain == MCP3421::Gain::Unity);
+
+    for(size_t i = 0; i < 3; i++) {
+        sample = f.read();
+        CHECK(!sample.isNew);
+        CHECK_EQ(sample.voltage, 1'000'000);
+    }
+    CHECK(f.driver.getGain() == MCP3421::Gain::Unity);
+}
+
+/**
+ * @brief Gain change discards the conversion in progress
+ *
+ * Increasing the gain discards the next conversion (made with the old gain) even though it's
+ * ready; the one after that is returned, with the new gain and the same voltage.
+ */
+static void TestDiscardAfterGainChange() {
+    Fixture f;
+
+    // 0.5V is below 3/8 of full scale
+    auto sample = f.convert(500'000);
+    CHECK(sample.isNew);
+    CHECK(sample.gain == MCP3421::Gain::Unity);
+    CHECK(f.driver.getGain() == MCP3421::Gain::x2);
+    CHECK_EQ(f.adc.config & 0b11, 0b01);
+
+    // not ready: the discard is still pending
+    CHECK(!f.read().isNew);
+
+    // conversion started with the old gain
+    sample = f.convert(500'000);
+    CHECK(!sample.isNew);
+    CHECK_EQ(sample.code, 500);
+    CHECK_EQ(f.adc.code, 500);
+
+    sample = f.convert(500'000);
+    CHECK(sample.isNew);
+    CHECK(sample.gain == MCP3421::Gain::x2);
+    CHECK_EQ(sample.code, 1'000);
+    CHECK_EQ(sample.voltage, 500'000);
+}
+
+/**
+ * @brief Hysteresis
+ *
+ * The gain is halved at or above 7/8 of full scale, and doubled below 3/8; anywhere in between,
+ * it stays put. Since a gain step doubles the code, settling at either threshold never toggles
+ * the gain back.
+ */
+static void TestHysteresis() {
+    // 12 bits: full scale is 2047, so the thresholds are 1785 and 765 (1mV per code at unity)
+    Fixture f;
+
+    // 383mV: 766 at 2x is just inside the band
+    auto sample = f.settle(383'000);
+    CHECK(sample.gain == MCP3421::Gain::x2);
+    CHECK_EQ(sample.code, 766);
+
+    // 382mV: 764 at 2x is just below it, so it settles at 4x
+    sample = f.settle(382'000);
+    CHECK(sample.gain == MCP3421::Gain::x4);
+    CHECK_EQ(sample.code, 1'528);
+
+    // just below the upper threshold at 4x stays there
+    sample = f.settle(446'000);
+    CHECK(sample.gain == MCP3421::Gain::x4);
+    CHECK_EQ(sample.code, 1'784);
+
+    // at it, the gain is halved once, and stays there
+    sample = f.convert(446'250);
+    CHECK_EQ(sample.code, 1'785);
+    CHECK(f.driver.getGain() == MCP3421::Gain::x2);
+
+    sample = f.settle(446'250);
+    CHECK(sample.gain == MCP3421::Gain::x2);
+    CHECK_EQ(sample.code, 893);
+    CHECK_EQ(sample.voltage, 446'500);
+
+    // the magnitude counts for negative inputs
+    sample = f.settle(-1'000'000);
+    CHECK(sample.gain == MCP3421::Gain::Unity);
+    CHECK_EQ(sample.code, -1'000);
+
+    // the gain saturates at both ends
+    sample = f.settle(5'000'000);
+    CHECK(sample.gain == MCP3421::Gain::Unity);
+    CHECK_EQ(sample.code, 2'047);
+
+    sample = f.settle(10'000);
+    CHECK(sample.gain == MCP3421::Gain::x8);
+    CHECK_EQ(sample.code, 80);
+    CHECK_EQ(sample.voltage, 10'000);
+
+    // each gain step (8x down to 1x) costs exactly one discarded conversion
+    const auto conversions = f.adc.numConversions;
+    f.settle(1'700'000);
+    CHECK_EQ(f.adc.numConversions - conversions, 7U);
+    CHECK(f.driver.getGain() == MCP3421::Gain::Unity);
+}
+
+/**
+ * @brief 18 bit conversions
+ *
+ * The output code is three bytes; negative codes are sign extended.
+ */
+static void TestHighestDepth() {
+    Fixture f(MCP3421::SampleDepth::Highest);
+
+    auto sample = f.settle(-1'000'000);
+    CHECK(sample.isNew);
+    CHECK(sample.gain == MCP3421::Gain::Unity);
+    CHECK_EQ(sample.code, -64'000);
+    CHECK_EQ(sample.voltage, -1'000'000);
+
+    sample = f.settle(-250'000);
+    CHECK(sample.gain == MCP3421::Gain::x4);
+    CHECK_EQ(sample.code, -64'000);
+    CHECK_EQ(sample.voltage, -250'000);
+}
+
+/**
+ * @brief Switch to continuous mode
+ *
+ * In one shot mode, no conversions happen on their own; the autoranging read switches the ADC to
+ * continuous mode (once) before reading.
+ */
+static void TestContinuousSwitch() {
+    Fixture f;
+    CHECK(f.adc.config & SimulatedAdc::kContinuous);
+
+    CHECK_EQ(f.driver.setOneShot(true), 0);
+    CHECK(!(f.adc.config & SimulatedAdc::kContinuous));
+
+    // no conversion completes in one shot mode
+    f.adc.input = 1'000'000;
+    f.adc.convert();
+    CHECK_EQ(f.adc.numConversions, 0U);
+
+    const auto writes = f.adc.numConfigWrites;
+    CHECK(!f.read().isNew);
+    CHECK(f.adc.config & SimulatedAdc::kContinuous);
+    CHECK_EQ(f.adc.numConfigWrites, writes + 1);
+
+    auto sample = f.convert(1'000'000);
+    CHECK(sample.isNew);
+    CHECK_EQ(sample.voltage, 1'000'000);
+    CHECK_EQ(f.adc.numConfigWrites, writes + 1);
+}
+
+int main() {
+    TestNotReady();
+    TestDiscardAfterGainChange();
+    TestHysteresis();
+    TestHighestDepth();
+    TestContinuousSwitch();
+
+    return Test::Finish();
+}
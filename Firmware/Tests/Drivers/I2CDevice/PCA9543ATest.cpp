@@ -0,0 +1,356 @@
+/**
+ * @file
+ *
+ * @brief PCA9543A bus switch tests
+ *
+ * The switch is simulated along with a register device behind each channel, at the same address;
+ * the device only answers when the switch has routed the bus to its channel. Each test counts the
+ * requests the upstream bus executed and the select writes the switch received, and compares them
+ * with the driver's channel selection statistics.
+ */
+#include "Test.h"
+#include "SimulatedI2CBus.h"
+
+#include "Drivers/I2CDevice/PCA9543A.h"
+
+#include <vector>
+
+using Drivers::I2CBus;
+using Drivers::I2CDevice::PCA9543A;
+
+/// Address of the bus switch
+constexpr static const uint8_t kMuxAddress{0x70};
+/// Address of the register device on each downstream channel
+constexpr static const uint8_t kDeviceAddress{0x50};
+
+/**
+ * @brief Simulated PCA9543A
+ *
+ * Reads return the control register (with the interrupt bits); a written control byte takes
+ * effect at the following STOP, as on the real device.
+ */
+class SimulatedMux: public SimulatedI2CBus::Device {
+    public:
+        bool write(const uint8_t byte) override {
+            this->pending = byte & 0b11;
+            this->hasPending = true;
+            this->numControlWrites++;
+            return true;
+        }
+
+        uint8_t read() override {
+            return this->control | (this->irq << 4);
+        }
+
+        void stop() override {
+            if(this->hasPending) {
+                this->control = this->pending;
+                this->hasPending = false;
+            }
+        }
+
+    public:
+        /// Enabled channels (bit mask)
+        uint8_t control{0};
+        /// Asserted channel interrupts (bit mask)
+        uint8_t irq{0};
+
+        /// Number of control register writes
+        size_t numControlWrites{0};
+
+    private:
+        /// Control register value to apply at the next STOP
+        uint8_t pending{0};
+        /// Whether a control register value was written
+        bool hasPending{false};
+};
+
+/**
+ * @brief Downstream side of the simulated switch
+ *
+ * Routes messages to the device on the single enabled channel. Nothing acknowledges if no channel
+ * (or both) are enabled, or if the channel's device is offline.
+ */
+class SimulatedChannels: public SimulatedI2CBus::Device {
+    public:
+        SimulatedChannels(const SimulatedMux &mux) : mux(mux) {}
+
+        bool start(const bool read) override {
+            this->active = nullptr;
+
+            for(size_t i = 0; i < 2; i++) {
+                if(this->mux.control == (1U << i) && !this->offline[i]) {
+                    this->active = &this->devices[i];
+                }
+            }
+
+            return this->active && this->active->start(read);
+        }
+
+        bool write(const uint8_t byte) override {
+            return this->active->write(byte);
+        }
+
+        uint8_t read() override {
+            return this->active->read();
+        }
+
+        void stop() override {
+            if(this->active) {
+                this->active->stop();
+            }
+        }
+
+    public:
+        /// Register device behind each channel
+        SimulatedRegisterDevice devices[2];
+        /// Whether the device behind a channel is offline
+        bool offline[2]{false, false};
+
+    private:
+        const SimulatedMux &mux;
+        /// Device addressed by the current message
+        SimulatedRegisterDevice *active{nullptr};
+};
+
+/**
+ * @brief Driver with access to its lock, to check that it's balanced
+ */
+class TestMux: public PCA9543A {
+    public:
+        using PCA9543A::PCA9543A;
+
+        UBaseType_t getLockHoldCount() const {
+            return this->busLock->holdCount;
+        }
+};
+
+/**
+ * @brief Simulated bus with the switch (and its channels) attached
+ */
+struct Board {
+    SimulatedI2CBus bus;
+    SimulatedMux mux;
+    SimulatedChannels channels{mux};
+
+    Board(const uint8_t initialControl) {
+        this->mux.control = initialControl;
+        this->bus.attach(kMuxAddress, &this->mux);
+        this->bus.attach(kDeviceAddress, &this->channels);
+    }
+};
+
+/**
+ * @brief Test fixture: a switch (initially with no channel enabled) and its driver
+ */
+struct Fixture: public Board {
+    TestMux driver;
+
+    Fixture(const uint8_t initialControl = 0) : Board(initialControl),
+        driver(kMuxAddress, &this->bus) {}
+
+    /// Number of upstream requests since the driver read the initial state
+    size_t numRequests() const {
+        return this->bus.completed.size() - 1;
+    }
+
+    /// Number of batches that didn't need a select write
+    uint32_t numSavedWrites() const {
+        const auto &stats = this->driver.getStats();
+        return stats.numBatches - stats.numSelects;
+    }
+};
+
+/**
+ * @brief Write a batch of registers on a downstream bus
+ *
+ * Each of the registers [0, count) is written in its own transaction.
+ */
+static int WriteBatch(I2CBus *bus, const size_t count, const uint8_t value) {
+    std::vector<etl::array<uint8_t, 2>> buffers(count);
+    std::vector<I2CBus::Transaction> txns(count);
+
+    for(size_t i = 0; i < count; i++) {
+        buffers[i] = {{static_cast<uint8_t>(i), value}};
+        txns[i] = {
+            .address = kDeviceAddress,
+            .read = 0,
+            .length = 2,
+            .data = buffers[i],
+        };
+    }
+
+    return bus->perform(txns);
+}
+
+/**
+ * @brief Initial state
+ *
+ * The driver picks up the channel the switch already has enabled, and disables both if both are
+ * enabled.
+ */
+static void TestInitialState() {
+    {
+        Fixture f(0b10);
+        CHECK(f.driver.getActiveBus() == 1);
+        CHECK_EQ(f.mux.numControlWrites, 0U);
+
+        // no select is needed for the already enabled channel
+        CHECK_EQ(WriteBatch(f.driver.getDownstream1(), 1, 0x11), 0);
+        CHECK_EQ(f.driver.getStats().numSelects, 0U);
+        CHECK_EQ(f.channels.devices[1].registers[0], 0x11);
+    }
+
+    Fixture f(0b11);
+    CHECK(!f.driver.getActiveBus());
+    CHECK_EQ(f.mux.numControlWrites, 1U);
+    CHECK_EQ(f.mux.control, 0);
+
+    f.mux.irq = 0b10;
+    bool irq0, irq1;
+    CHECK_EQ(f.driver.readIrqState(irq0, irq1), 0);
+    CHECK(!irq0);
+    CHECK(irq1);
+}
+
+/**
+ * @brief Repeated batches on the same channel
+ *
+ * Only the first batch selects the channel, together with its transactions; every batch is a
+ * single upstream request.
+ */
+static void TestSameChannel() {
+    Fixture f;
+
+    for(size_t i = 0; i < 10; i++) {
+        CHECK_EQ(WriteBatch(f.driver.getDownstream0(), 3, static_cast<uint8_t>(i)), 0);
+    }
+
+    CHECK_EQ(f.numRequests(), 10U);
+    CHECK_EQ(f.mux.numControlWrites, 1U);
+
+    const auto &stats = f.driver.getStats();
+    CHECK_EQ(stats.numBatches, 10U);
+    CHECK_EQ(stats.numSelects, 1U);
+    CHECK_EQ(f.numSavedWrites(), 9U);
+    CHECK_EQ(stats.numInvalidations, 0U);
+
+    CHECK_EQ(f.channels.devices[0].numWrites, 30U);
+    CHECK_EQ(f.channels.devices[0].registers[2], 9);
+    CHECK_EQ(f.channels.devices[1].numMessages, 0U);
+    CHECK_EQ(f.driver.getLockHoldCount(), 0U);
+}
+
+/**
+ * @brief Switching channels
+ *
+ * Every switch costs a select write, but it's combined with the batch into one upstream request;
+ * the select takes effect before the batch, so it always reaches the right device.
+ */
+static void TestChannelSwitch() {
+    Fixture f;
+
+    for(size_t i = 0; i < 8; i++) {
+        auto bus = (i & 1) ? f.driver.getDownstream1() : f.driver.getDownstream0();
+        CHECK_EQ(WriteBatch(bus, 2, static_cast<uint8_t>(i)), 0);
+        CHECK(f.driver.getActiveBus() == static_cast<uint8_t>(i & 1));
+    }
+
+    CHECK_EQ(f.numRequests(), 8U);
+    CHECK_EQ(f.mux.numControlWrites, 8U);
+    CHECK_EQ(f.driver.getStats().numSelects, 8U);
+    CHECK_EQ(f.numSavedWrites(), 0U);
+
+    CHECK_EQ(f.channels.devices[0].registers[1], 6);
+    CHECK_EQ(f.channels.devices[1].registers[1], 7);
+
+    // staying on the last channel is free again
+    CHECK_EQ(WriteBatch(f.driver.getDownstream1(), 2, 0x42), 0);
+    CHECK_EQ(f.numRequests(), 9U);
+    CHECK_EQ(f.mux.numControlWrites, 8U);
+    CHECK_EQ(f.numSavedWrites(), 1U);
+    CHECK_EQ(f.driver.getLockHoldCount(), 0U);
+}
+
+/**
+ * @brief Batches longer than the combined limit
+ *
+ * A batch of up to kMaxCombinedTransactions is combined with the select; a longer one needs a
+ * separate select request first. Either way, the next batch on that channel needs no select.
+ */
+static void TestLargeBatch() {
+    constexpr static const auto kMax = PCA9543A::kMaxCombinedTransactions;
+    Fixture f;
+
+    CHECK_EQ(WriteBatch(f.driver.getDownstream0(), kMax, 0x01), 0);
+    CHECK_EQ(f.numRequests(), 1U);
+
+    CHECK_EQ(WriteBatch(f.driver.getDownstream1(), kMax + 1, 0x02), 0);
+    CHECK_EQ(f.numRequests(), 3U);
+    CHECK_EQ(f.channels.devices[1].numWrites, kMax + 1);
+
+    CHECK_EQ(WriteBatch(f.driver.getDownstream1(), kMax + 1, 0x03), 0);
+    CHECK_EQ(f.numRequests(), 4U);
+
+    CHECK_EQ(f.mux.numControlWrites, 2U);
+    CHECK_EQ(f.driver.getStats().numSelects, 2U);
+    CHECK_EQ(f.numSavedWrites(), 1U);
+    CHECK_EQ(f.driver.getLockHoldCount(), 0U);
+}
+
+/**
+ * @brief Errors invalidate the active channel
+ *
+ * After a failed batch, the switch state is unknown: the next batch selects the channel again,
+ * even if it's the same one. The same goes for an explicit invalidation.
+ */
+static void TestErrorReselect() {
+    Fixture f;
+
+    CHECK_EQ(WriteBatch(f.driver.getDownstream0(), 1, 0x01), 0);
+
+    // failure on an already selected channel
+    f.channels.offline[0] = true;
+    CHECK_EQ(WriteBatch(f.driver.getDownstream0(), 1, 0x02), I2CBus::kErrorNoAck);
+    CHECK(!f.driver.getActiveBus());
+    CHECK_EQ(f.driver.getStats().numInvalidations, 1U);
+    f.channels.offline[0] = false;
+
+    CHECK_EQ(WriteBatch(f.driver.getDownstream0(), 1, 0x03), 0);
+    CHECK_EQ(f.mux.numControlWrites, 2U);
+    CHECK_EQ(f.numRequests(), 3U);
+
+    // failure in a combined select and batch
+    f.channels.offline[1] = true;
+    CHECK_EQ(WriteBatch(f.driver.getDownstream1(), 1, 0x04), I2CBus::kErrorNoAck);
+    CHECK(!f.driver.getActiveBus());
+    CHECK_EQ(f.driver.getStats().numInvalidations, 2U);
+    f.channels.offline[1] = false;
+
+    CHECK_EQ(WriteBatch(f.driver.getDownstream1(), 1, 0x05), 0);
+    CHECK_EQ(f.mux.numControlWrites, 4U);
+    CHECK_EQ(f.channels.devices[1].registers[0], 0x05);
+
+    // explicit invalidation
+    f.driver.invalidateActiveBus();
+    CHECK_EQ(WriteBatch(f.driver.getDownstream1(), 1, 0x06), 0);
+    CHECK_EQ(f.mux.numControlWrites, 5U);
+
+    const auto &stats = f.driver.getStats();
+    CHECK_EQ(stats.numBatches, 6U);
+    CHECK_EQ(stats.numSelects, 5U);
+    CHECK_EQ(f.numSavedWrites(), 1U);
+    CHECK_EQ(stats.numInvalidations, 2U);
+    CHECK_EQ(f.numRequests(), 6U);
+    CHECK_EQ(f.driver.getLockHoldCount(), 0U);
+}
+
+int main() {
+    TestInitialState();
+    TestSameChannel();
+    TestChannelSwitch();
+    TestLargeBatch();
+    TestErrorReselect();
+
+    return Test::Finish();
+}
@@ -0,0 +1,200 @@
+/**
+ * @file
+ *
+ * @brief Shadow register cache tests
+ *
+ * Checks the cache on its own (with a recording writer) and in the EMC2101 driver, on the
+ * simulated bus.
+ */
+#include "Test.h"
+#include "SimulatedI2CBus.h"
+
+#include "Drivers/I2CDevice/EMC2101.h"
+#include "Drivers/I2CDevice/RegisterCache.h"
+
+#include <utility>
+#include <vector>
+
+using Drivers::I2CDevice::EMC2101;
+using Drivers::I2CDevice::RegisterCache;
+
+/// Cache used by the tests: 16 registers, with register 3 volatile
+using Cache = RegisterCache<uint8_t, 16>;
+constexpr static const etl::array<uint8_t, 1> kVolatile{{3}};
+
+/**
+ * @brief Writer that records the bursts it was asked to write
+ */
+struct Recorder {
+    /// First register and values of each burst
+    std::vector<std::pair<uint8_t, std::vector<uint8_t>>> bursts;
+    /// Error code to return
+    int error{0};
+
+    auto writer() {
+        return [this](const uint8_t first, etl::span<const uint8_t> values) {
+            this->bursts.push_back({first, {values.begin(), values.end()}});
+            return this->error;
+        };
+    }
+};
+
+/**
+ * @brief Registers are served from the cache once filled; volatile ones never are
+ */
+static void TestReadFill() {
+    Cache cache{kVolatile};
+    uint8_t value{0};
+
+    CHECK(!cache.read(0, value));
+    cache.fill(0, 0x42);
+    CHECK(cache.read(0, value));
+    CHECK_EQ(value, 0x42);
+
+    cache.fill(3, 0x55);
+    CHECK(!cache.read(3, value));
+
+    // out of range registers are not cached
+    cache.fill(16, 0x01);
+    CHECK(!cache.read(16, value));
+
+    cache.invalidate(0);
+    CHECK(!cache.read(0, value));
+}
+
+/**
+ * @brief Writes that don't change a known value are skipped; volatile writes always go out
+ */
+static void TestWriteSkipsUnchanged() {
+    Cache cache{kVolatile};
+    Recorder rec;
+
+    CHECK(cache.write(0, 0x10));
+    CHECK_EQ(cache.flush(rec.writer()), 0);
+    CHECK_EQ(rec.bursts.size(), 1U);
+
+    CHECK(!cache.write(0, 0x10));
+    CHECK(!cache.isDirty());
+
+    CHECK(cache.write(3, 0x20));
+    CHECK_EQ(cache.flush(rec.writer()), 0);
+    CHECK(cache.write(3, 0x20));
+    CHECK_EQ(cache.flush(rec.writer()), 0);
+    CHECK_EQ(rec.bursts.size(), 3U);
+
+    // the written value is cached
+    uint8_t value{0};
+    CHECK(cache.read(0, value));
+    CHECK_EQ(value, 0x10);
+}
+
+/**
+ * @brief Consecutive dirty registers are combined, up to the maximum burst length
+ */
+static void TestFlushBursts() {
+    Cache cache;
+    Recorder rec;
+
+    for(const uint8_t reg : {1, 2, 3, 4, 8, 15}) {
+        cache.write(reg, reg);
+    }
+
+    CHECK_EQ(cache.flush(rec.writer(), 3), 0);
+    CHECK_EQ(rec.bursts.size(), 4U);
+    CHECK((rec.bursts[0] == std::pair<uint8_t, std::vector<uint8_t>>{1, {1, 2, 3}}));
+    CHECK((rec.bursts[1] == std::pair<uint8_t, std::vector<uint8_t>>{4, {4}}));
+    CHECK((rec.bursts[2] == std::pair<uint8_t, std::vector<uint8_t>>{8, {8}}));
+    CHECK((rec.bursts[3] == std::pair<uint8_t, std::vector<uint8_t>>{15, {15}}));
+    CHECK(!cache.isDirty());
+}
+
+/**
+ * @brief A failed burst invalidates its registers and stops the flush
+ */
+static void TestFlushError() {
+    Cache cache;
+    Recorder rec;
+    uint8_t value;
+
+    cache.write(0, 0xAA);
+    cache.write(5, 0xBB);
+    rec.error = -1;
+
+    CHECK_EQ(cache.flush(rec.writer()), -1);
+    CHECK_EQ(rec.bursts.size(), 1U);
+    CHECK(!cache.read(0, value));
+
+    // the next write of the same value goes to the device again
+    rec.error = 0;
+    CHECK(cache.write(0, 0xAA));
+    CHECK_EQ(cache.flush(rec.writer()), 0);
+    CHECK_EQ(rec.bursts.size(), 3U);
+}
+
+/**
+ * @brief Read-modify-write only applies to known registers
+ */
+static void TestUpdate() {
+    Cache cache;
+    uint8_t value;
+
+    CHECK(!cache.update(0, 0x0F, 0x05));
+
+    cache.fill(0, 0xF0);
+    CHECK(cache.update(0, 0x0F, 0x05));
+    CHECK(cache.read(0, value));
+    CHECK_EQ(value, 0xF5);
+
+    cache.invalidateAll();
+    CHECK(!cache.isDirty());
+    CHECK(!cache.read(0, value));
+}
+
+/**
+ * @brief EMC2101 fan speed writes reach the device after the controller changed the setting
+ *
+ * The controller rewrites the fan setting register on its own while in automatic mode; the
+ * driver must not assume the register still holds the value it last wrote.
+ */
+static void TestEmc2101FanSetting() {
+    constexpr static const uint8_t kAddress{0b100'1100};
+    constexpr static const uint8_t kFanSetting{0x4C};
+
+    SimulatedI2CBus bus;
+    SimulatedRegisterDevice dev;
+    bus.attach(kAddress, &dev);
+
+    EMC2101 fan(&bus, {});
+
+    CHECK_EQ(fan.setFanSpeed(0x80), 0);
+    CHECK_EQ(dev.registers[kFanSetting], 0x20);
+
+    CHECK_EQ(fan.setFanMode(EMC2101::FanMode::Automatic), 0);
+    CHECK_EQ(fan.setFanSpeed(0x40), EMC2101::Errors::InvalidMode);
+    dev.registers[kFanSetting] = 0x3F;
+
+    CHECK_EQ(fan.setFanMode(EMC2101::FanMode::Manual), 0);
+    CHECK_EQ(fan.setFanSpeed(0x80), 0);
+    CHECK_EQ(dev.registers[kFanSetting], 0x20);
+
+    // writing the same speed again still goes to the device
+    dev.registers[kFanSetting] = 0x3F;
+    CHECK_EQ(fan.setFanSpeed(0x80), 0);
+    CHECK_EQ(dev.registers[kFanSetting], 0x20);
+
+    // other configuration registers are still cached
+    const auto writes = dev.numWrites;
+    CHECK_EQ(fan.setFanMode(EMC2101::FanMode::Manual), 0);
+    CHECK_EQ(dev.numWrites, writes);
+}
+
+int main() {
+    TestReadFill();
+    TestWriteSkipsUnchanged();
+    TestFlushBursts();
+    TestFlushError();
+    TestUpdate();
+    TestEmc2101FanSetting();
+
+    return Test::Finish();
+}
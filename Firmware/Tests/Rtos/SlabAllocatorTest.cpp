@@ -0,0 +1,399 @@
+/**
+ * @file
+ *
+ * @brief Slab allocator tests and benchmark
+ *
+ * The allocator is linked the same way as in the firmware: the tests call the `pvPortMalloc` and
+ * `vPortFree` wrappers, and the "real" heap behind them is a first-fit heap with an address
+ * ordered free list that coalesces adjacent blocks, like FreeRTOS' heap_4.
+ *
+ * The benchmark runs the same random mix of allocations and frees for each size class against
+ * both the slab pools and the reference heap, and reports the host time per operation.
+ */
+#include "Test.h"
+
+#include "Rtos/SlabAllocator.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+
+using Rtos::SlabAllocator;
+
+extern "C" void *__wrap_pvPortMalloc(size_t size);
+extern "C" void __wrap_vPortFree(void *ptr);
+extern "C" void *__real_pvPortMalloc(size_t size);
+extern "C" void __real_vPortFree(void *ptr);
+
+/**
+ * @brief First-fit reference heap
+ *
+ * Free blocks are kept in a list sorted by address; allocation takes the first block that's large
+ * enough, splitting off the remainder, and freeing merges a block with its free neighbors.
+ */
+class FirstFitHeap {
+    public:
+        /// Size of the heap, in bytes
+        constexpr static const size_t kSize{0x8000};
+
+        FirstFitHeap() {
+            auto block = reinterpret_cast<Block *>(this->storage);
+            block->next = nullptr;
+            block->size = kSize;
+            this->start.next = block;
+        }
+
+        void *alloc(const size_t size) {
+            const size_t total = kHeaderSize + ((size + (kAlignment - 1)) & ~(kAlignment - 1));
+
+            Block *prev = &this->start, *block = this->start.next;
+            while(block && block->size < total) {
+                prev = block;
+                block = block->next;
+            }
+            if(!block) {
+                return nullptr;
+            }
+
+            prev->next = block->next;
+            if(block->size - total >= kMinBlockSize) {
+                auto rest = reinterpret_cast<Block *>(reinterpret_cast<uint8_t *>(block) + total);
+                rest->size = block->size - total;
+                block->size = total;
+                this->insert(rest);
+            }
+
+            this->numAllocs++;
+            return reinterpret_cast<uint8_t *>(block) + kHeaderSize;
+        }
+
+        void free(void *ptr) {
+            this->numFrees++;
+            this->insert(reinterpret_cast<Block *>(static_cast<uint8_t *>(ptr) - kHeaderSize));
+        }
+
+        /// Size of the largest free block, in bytes
+        size_t getLargestFree() const {
+            size_t largest{0};
+            for(auto block = this->start.next; block; block = block->next) {
+                largest = std::max(largest, block->size);
+            }
+            return largest;
+        }
+
+    public:
+        /// Number of allocations and frees
+        size_t numAllocs{0}, numFrees{0};
+
+    private:
+        /// Header of each (allocated or free) block
+        struct Block {
+            /// Next free block (by address)
+            Block *next;
+            /// Size of the block, including this header
+            size_t size;
+        };
+
+        constexpr static const size_t kAlignment{8};
+        constexpr static const size_t kHeaderSize{(sizeof(Block) + (kAlignment - 1)) &
+            ~(kAlignment - 1)};
+        /// Smallest remainder that's split off into a separate block
+        constexpr static const size_t kMinBlockSize{kHeaderSize * 2};
+
+        /**
+         * @brief Insert a block into the free list, merging it with adjacent free blocks
+         */
+        void insert(Block *block) {
+            auto prev = &this->start;
+            while(prev->next && prev->next < block) {
+                prev = prev->next;
+            }
+
+            auto next = prev->next;
+            if(next && (reinterpret_cast<uint8_t *>(block) + block->size) ==
+                    reinterpret_cast<uint8_t *>(next)) {
+                block->size += next->size;
+                next = next->next;
+            }
+            block->next = next;
+
+            if(prev != &this->start && (reinterpret_cast<uint8_t *>(prev) + prev->size) ==
+                    reinterpret_cast<uint8_t *>(block)) {
+                prev->size += block->size;
+                prev->next = block->next;
+            } else {
+                prev->next = block;
+            }
+        }
+
+    private:
+        /// Free list head
+        Block start{nullptr, 0};
+        alignas(kAlignment) uint8_t storage[kSize];
+};
+
+/// Heap behind the allocator wrappers
+static FirstFitHeap gHeap;
+
+extern "C" void *__real_pvPortMalloc(size_t size) {
+    return gHeap.alloc(size);
+}
+
+extern "C" void __real_vPortFree(void *ptr) {
+    gHeap.free(ptr);
+}
+
+/**
+ * @brief Get the statistics of all size classes
+ */
+static etl::array<SlabAllocator::ClassStats, SlabAllocator::kNumClasses> GetStats() {
+    etl::array<SlabAllocator::ClassStats, SlabAllocator::kNumClasses> stats;
+    SlabAllocator::GetStats(stats);
+    return stats;
+}
+
+/**
+ * @brief Free list and bump index
+ *
+ * Fresh blocks are handed out in address order; freed blocks are reused most recently freed
+ * first, before any further fresh blocks.
+ *
+ * @remark This must run first, while the 32 byte class has never been used.
+ */
+static void TestFreeList() {
+    constexpr static const size_t kBlockSize{32};
+
+    auto b0 = static_cast<uint8_t *>(SlabAllocator::Alloc(kBlockSize));
+    auto b1 = static_cast<uint8_t *>(SlabAllocator::Alloc(kBlockSize));
+    auto b2 = static_cast<uint8_t *>(SlabAllocator::Alloc(kBlockSize - 1));
+    CHECK(b0);
+    CHECK_EQ(b1, b0 + kBlockSize);
+    CHECK_EQ(b2, b0 + (2 * kBlockSize));
+
+    CHECK(SlabAllocator::Free(b1));
+    CHECK(SlabAllocator::Free(b0));
+    CHECK_EQ(SlabAllocator::Alloc(kBlockSize), b0);
+    CHECK_EQ(SlabAllocator::Alloc(kBlockSize), b1);
+    CHECK_EQ(SlabAllocator::Alloc(kBlockSize), b0 + (3 * kBlockSize));
+
+    for(size_t i = 0; i < 4; i++) {
+        CHECK(SlabAllocator::Free(b0 + (i * kBlockSize)));
+    }
+
+    const auto stats = GetStats()[1];
+    CHECK_EQ(stats.blockSize, kBlockSize);
+    CHECK_EQ(stats.inUse, 0);
+    CHECK_EQ(stats.peakInUse, 4);
+    CHECK_EQ(stats.numAllocs, 6U);
+}
+
+/**
+ * @brief Size classes
+ *
+ * Sizes are rounded up to the next class; zero and sizes beyond the largest class aren't handled
+ * (and don't count as overflows) so the wrapper passes them to the heap.
+ */
+static void TestSizeClasses() {
+    static const struct {
+        size_t size, cls;
+    } kCases[]{
+        {1, 0}, {16, 0}, {17, 1}, {32, 1}, {33, 2}, {64, 2}, {65, 3}, {128, 3}, {129, 4},
+        {256, 4},
+    };
+
+    for(const auto &c : kCases) {
+        const auto before = GetStats()[c.cls];
+
+        auto ptr = SlabAllocator::Alloc(c.size);
+        CHECK(ptr);
+        CHECK_EQ(GetStats()[c.cls].inUse, before.inUse + 1);
+        CHECK_EQ(GetStats()[c.cls].numAllocs, before.numAllocs + 1);
+
+        CHECK(SlabAllocator::Free(ptr));
+        CHECK_EQ(GetStats()[c.cls].inUse, before.inUse);
+    }
+
+    CHECK(!SlabAllocator::Alloc(0));
+    CHECK(!SlabAllocator::Alloc(SlabAllocator::kMaxBlockSize + 1));
+
+    const auto heapAllocs = gHeap.numAllocs;
+    auto large = __wrap_pvPortMalloc(SlabAllocator::kMaxBlockSize + 1);
+    CHECK(large);
+    CHECK_EQ(gHeap.numAllocs, heapAllocs + 1);
+    CHECK(!SlabAllocator::Free(large));
+    __wrap_vPortFree(large);
+    CHECK_EQ(gHeap.numFrees, gHeap.numAllocs);
+
+    for(const auto &stats : GetStats()) {
+        CHECK_EQ(stats.numOverflows, 0U);
+    }
+}
+
+/**
+ * @brief Exhausted size class
+ *
+ * Once all blocks of a class are in use, further allocations fall through to the heap and are
+ * counted as overflows; freeing everything returns the usage counts (and the heap) to where they
+ * started.
+ */
+static void TestExhaustion() {
+    const auto before = GetStats()[0];
+    const auto heapAllocs = gHeap.numAllocs;
+    const auto heapFree = gHeap.getLargestFree();
+
+    std::vector<void *> blocks;
+    std::set<void *> unique;
+    for(size_t i = 0; i < before.numBlocks; i++) {
+        blocks.push_back(__wrap_pvPortMalloc(12));
+        unique.insert(blocks.back());
+    }
+    CHECK_EQ(unique.size(), before.numBlocks);
+    CHECK_EQ(gHeap.numAllocs, heapAllocs);
+
+    auto overflow = __wrap_pvPortMalloc(12);
+    CHECK(overflow);
+    CHECK(!unique.count(overflow));
+    CHECK_EQ(gHeap.numAllocs, heapAllocs + 1);
+
+    auto stats = GetStats()[0];
+    CHECK_EQ(stats.inUse, stats.numBlocks);
+    CHECK_EQ(stats.peakInUse, stats.numBlocks);
+    CHECK_EQ(stats.numAllocs, before.numAllocs + before.numBlocks);
+    CHECK_EQ(stats.numOverflows, before.numOverflows + 1);
+
+    // other classes are unaffected
+    CHECK_EQ(GetStats()[1].inUse, 0);
+    CHECK(SlabAllocator::Free(SlabAllocator::Alloc(20)));
+
+    __wrap_vPortFree(overflow);
+    for(auto block : blocks) {
+        __wrap_vPortFree(block);
+    }
+    __wrap_vPortFree(nullptr);
+
+    stats = GetStats()[0];
+    CHECK_EQ(stats.inUse, 0);
+    CHECK_EQ(stats.peakInUse, stats.numBlocks);
+    CHECK_EQ(gHeap.numFrees, gHeap.numAllocs);
+    CHECK_EQ(gHeap.getLargestFree(), heapFree);
+
+    // the class is usable again
+    CHECK(SlabAllocator::Free(SlabAllocator::Alloc(1)));
+}
+
+/**
+ * @brief Allocation or free in a benchmark sequence
+ */
+struct Operation {
+    /// Size to allocate, or 0 to free
+    uint16_t size;
+    /// Slot that holds the allocated block
+    uint16_t slot;
+};
+
+/**
+ * @brief Generate a random mix of allocations and frees
+ *
+ * Each operation picks a random slot: an empty slot is filled with a block between half the size
+ * of the class and its full size; an occupied one is freed. The sequence ends with every slot
+ * empty.
+ */
+static std::vector<Operation> MakeOperations(const size_t blockSize, const size_t numSlots,
+        const size_t count) {
+    std::mt19937 rng{static_cast<uint32_t>(blockSize)};
+    std::uniform_int_distribution<size_t> slots{0, numSlots - 1};
+    std::uniform_int_distribution<size_t> sizes{(blockSize / 2) + 1, blockSize};
+
+    std::vector<Operation> ops;
+    std::vector<bool> used(numSlots, false);
+
+    for(size_t i = 0; i < count; i++) {
+        const auto slot = slots(rng);
+        ops.push_back({static_cast<uint16_t>(used[slot] ? 0 : sizes(rng)),
+                static_cast<uint16_t>(slot)});
+        used[slot] = !used[slot];
+    }
+    for(size_t slot = 0; slot < numSlots; slot++) {
+        if(used[slot]) {
+            ops.push_back({0, static_cast<uint16_t>(slot)});
+        }
+    }
+
+    return ops;
+}
+
+/**
+ * @brief Run a sequence of operations
+ *
+ * @return Time per operation, in ns
+ */
+template<typename Alloc, typename Free>
+static double Measure(const std::vector<Operation> &ops, const size_t numSlots,
+        const size_t repeats, Alloc alloc, Free free) {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<void *> slots(numSlots, nullptr);
+
+    const auto start = Clock::now();
+    for(size_t i = 0; i < repeats; i++) {
+        for(const auto &op : ops) {
+            if(op.size) {
+                auto ptr = static_cast<uint8_t *>(alloc(op.size));
+                *ptr = static_cast<uint8_t>(op.slot);
+                slots[op.slot] = ptr;
+            } else {
+                free(slots[op.slot]);
+            }
+        }
+    }
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+
+    return elapsed.count() / (repeats * ops.size());
+}
+
+/**
+ * @brief Time per operation for each size class, against the reference heap
+ *
+ * Half of each class' blocks are used as slots, so the class never overflows; the heap serves the
+ * same sequence, so it holds the same live blocks, and its free list fragments as they're freed
+ * out of order.
+ */
+static void Benchmark() {
+    constexpr static const size_t kNumOperations{10'000};
+    constexpr static const size_t kRepeats{100};
+
+    printf("%6s %8s %12s %12s\n", "size", "slots", "slab ns/op", "heap ns/op");
+
+    for(const auto &stats : GetStats()) {
+        const size_t numSlots = stats.numBlocks / 2;
+        const auto ops = MakeOperations(stats.blockSize, numSlots, kNumOperations);
+
+        const auto slab = Measure(ops, numSlots, kRepeats, __wrap_pvPortMalloc, __wrap_vPortFree);
+        const auto heap = Measure(ops, numSlots, kRepeats, [](size_t size) {
+            return gHeap.alloc(size);
+        }, [](void *ptr) {
+            gHeap.free(ptr);
+        });
+
+        printf("%6u %8zu %12.1f %12.1f\n", stats.blockSize, numSlots, slab, heap);
+    }
+
+    for(const auto &stats : GetStats()) {
+        CHECK_EQ(stats.inUse, 0);
+        CHECK_EQ(stats.numOverflows, 1U * (stats.blockSize == SlabAllocator::kMinBlockSize));
+    }
+}
+
+int main() {
+    TestFreeList();
+    TestSizeClasses();
+    TestExhaustion();
+
+    Benchmark();
+
+    return Test::Finish();
+}
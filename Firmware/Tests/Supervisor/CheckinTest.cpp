@@ -0,0 +1,162 @@
+/**
+ * @file
+ *
+ * @brief Software watchdog check-in tests
+ *
+ * Drives the check-in evaluation with a simulated clock (in ticks, which are milliseconds.)
+ */
+#include "Test.h"
+
+#include "Supervisor/Checkin.h"
+
+using Checkin = Supervisor::Checkin;
+using Client = Checkin::Client;
+
+/// Simulated time, in ticks
+static uint32_t gNow{100'000};
+
+/**
+ * @brief Advance the clock and evaluate check-ins
+ */
+static bool Step(const uint32_t ticks, Client &outMissed, uint32_t &outOverdue) {
+    gNow += ticks;
+    return Checkin::Evaluate(gNow, outMissed, outOverdue);
+}
+
+/**
+ * @brief Unregister all clients, and let the supervisor observe it
+ */
+static void Reset() {
+    Client missed;
+    uint32_t overdue;
+
+    Checkin::Unregister(Client::Control);
+    Checkin::Unregister(Client::Rpmsg);
+    Checkin::Evaluate(gNow, missed, overdue);
+}
+
+/**
+ * @brief A client registering long after boot gets a full deadline period
+ */
+static void TestRegisterLate() {
+    Client missed;
+    uint32_t overdue;
+
+    Checkin::Register(Client::Control, 500);
+
+    CHECK(Step(0, missed, overdue));
+    CHECK(Step(500, missed, overdue));
+
+    CHECK(!Step(1, missed, overdue));
+    CHECK(missed == Client::Control);
+    CHECK_EQ(overdue, 1U);
+
+    Reset();
+}
+
+/**
+ * @brief Clients that keep checking in never miss their deadline
+ */
+static void TestPeriodicCheckin() {
+    Client missed;
+    uint32_t overdue;
+
+    Checkin::Register(Client::Control, 500);
+    Checkin::Register(Client::Rpmsg, 1000);
+
+    for(size_t i = 0; i < 1000; i++) {
+        Checkin::CheckIn(Client::Control);
+        if(i % 4 == 0) {
+            Checkin::CheckIn(Client::Rpmsg);
+        }
+
+        CHECK(Step(200, missed, overdue));
+    }
+
+    Reset();
+}
+
+/**
+ * @brief The client that stopped checking in is reported
+ */
+static void TestMissedClient() {
+    Client missed;
+    uint32_t overdue;
+
+    Checkin::Register(Client::Control, 500);
+    Checkin::Register(Client::Rpmsg, 1000);
+    CHECK(Step(0, missed, overdue));
+
+    // Rpmsg stops checking in; it's reported once its deadline has passed
+    bool ok{true};
+    uint32_t elapsed{0};
+
+    while(ok && elapsed < 2000) {
+        Checkin::CheckIn(Client::Control);
+        ok = Step(200, missed, overdue);
+        elapsed += 200;
+    }
+
+    CHECK(!ok);
+    CHECK(missed == Client::Rpmsg);
+    CHECK_EQ(elapsed, 1200U);
+    CHECK_EQ(overdue, 200U);
+
+    Reset();
+}
+
+/**
+ * @brief Unregistered clients are not taken into account
+ */
+static void TestUnregister() {
+    Client missed;
+    uint32_t overdue;
+
+    Checkin::Register(Client::Control, 500);
+    CHECK(Step(0, missed, overdue));
+
+    Checkin::Unregister(Client::Control);
+    CHECK(Step(10'000, missed, overdue));
+
+    // registering again starts a new deadline period
+    Checkin::Register(Client::Control, 500);
+    CHECK(Step(0, missed, overdue));
+    CHECK(Step(500, missed, overdue));
+    CHECK(!Step(1, missed, overdue));
+
+    Reset();
+}
+
+/**
+ * @brief Registering concurrently with an evaluation does not cause a spurious miss
+ *
+ * The supervisor reads the registered bitmap before the client registers, then consumes the
+ * check-in made by registering. The next evaluation sees the client registered, but with no
+ * check-in.
+ */
+static void TestRegisterDuringEvaluation() {
+    Client missed;
+    uint32_t overdue;
+    constexpr auto bit = (1U << static_cast<uint8_t>(Client::Control));
+
+    Checkin::Register(Client::Control, 500);
+
+    CHECK(Checkin::Evaluate(gNow, 0, bit, missed, overdue));
+    CHECK(Checkin::Evaluate(gNow + 200, bit, 0, missed, overdue));
+    CHECK(Checkin::Evaluate(gNow + 700, bit, 0, missed, overdue));
+    CHECK(!Checkin::Evaluate(gNow + 701, bit, 0, missed, overdue));
+    CHECK(missed == Client::Control);
+
+    gNow += 701;
+    Reset();
+}
+
+int main() {
+    TestRegisterLate();
+    TestPeriodicCheckin();
+    TestMissedClient();
+    TestUnregister();
+    TestRegisterDuringEvaluation();
+
+    return Test::Finish();
+}
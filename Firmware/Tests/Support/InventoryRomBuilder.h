@@ -0,0 +1,134 @@
+/**
+ * @file
+ *
+ * @brief Builds inventory ROM images for tests
+ */
+#ifndef TESTS_SUPPORT_INVENTORYROMBUILDER_H
+#define TESTS_SUPPORT_INVENTORYROMBUILDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "Util/Crc32.h"
+#include "Util/InventoryRom.h"
+
+/**
+ * @brief Inventory ROM image builder
+ *
+ * Writes the ROM header, then atoms in the order they're added. Integers are stored big endian,
+ * as the parser expects.
+ */
+class InventoryRomBuilder {
+    public:
+        using AtomType = Util::InventoryRom::AtomType;
+
+        /**
+         * @brief Start a ROM image
+         *
+         * @param headerSize Size of the header; anything past the standard header is padding
+         * @param version Header version
+         */
+        InventoryRomBuilder(const uint8_t headerSize = 8, const uint8_t version = 0x10) {
+            this->u32(Util::InventoryRom::IdpromHeader::kMagicValue);
+            this->data.push_back(headerSize);
+            this->data.push_back(version);
+            this->u16(headerSize);
+            this->data.resize(headerSize, 0);
+        }
+
+        /// Append an atom with the given payload
+        InventoryRomBuilder &atom(const AtomType type, const std::vector<uint8_t> &payload) {
+            this->data.push_back(static_cast<uint8_t>(type));
+            this->data.push_back(static_cast<uint8_t>(payload.size()));
+            this->data.insert(this->data.end(), payload.begin(), payload.end());
+            return *this;
+        }
+
+        /// Append a string atom
+        InventoryRomBuilder &string(const AtomType type, const char *str) {
+            return this->atom(type, {str, str + strlen(str)});
+        }
+
+        /// Append a hardware revision atom
+        InventoryRomBuilder &hwRevision(const uint16_t rev) {
+            return this->atom(AtomType::HwRevision, {static_cast<uint8_t>(rev >> 8),
+                    static_cast<uint8_t>(rev)});
+        }
+
+        /// Append a driver rating atom
+        InventoryRomBuilder &rating(const uint32_t maxVoltage, const uint32_t maxCurrent) {
+            std::vector<uint8_t> payload;
+            Append32(payload, maxVoltage);
+            Append32(payload, maxCurrent);
+            return this->atom(AtomType::DriverRating, payload);
+        }
+
+        /// Append a calibration table atom
+        InventoryRomBuilder &calibration(const uint8_t target, const uint8_t channel,
+                const std::vector<Util::PiecewiseLinearPoint> &points) {
+            std::vector<uint8_t> payload{target, channel};
+            for(const auto &point : points) {
+                Append32(payload, static_cast<uint32_t>(point.in));
+                Append32(payload, static_cast<uint32_t>(point.out));
+            }
+            return this->atom(AtomType::Calibration, payload);
+        }
+
+        /// Append a checksum atom covering everything written so far
+        InventoryRomBuilder &checksum() {
+            std::vector<uint8_t> payload;
+            Append32(payload, Util::Crc32::Calculate(this->data.data(), this->data.size()));
+            return this->atom(AtomType::Crc32, payload);
+        }
+
+        /// Append the end atom
+        InventoryRomBuilder &end() {
+            return this->atom(AtomType::End, {});
+        }
+
+        /**
+         * @brief Build a representative ROM
+         *
+         * Contains all well known atoms, the maximum number of calibration tables, and a checksum.
+         */
+        static std::vector<uint8_t> Typical() {
+            InventoryRomBuilder rom;
+            rom.hwRevision(3)
+                .string(AtomType::Name, "Analog load driver")
+                .string(AtomType::Manufacturer, "Test Manufacturer")
+                .atom(AtomType::DriverId, std::vector<uint8_t>(16, 0xA5))
+                .rating(72'000, 10'000);
+
+            for(uint8_t i = 0; i < Util::InventoryRom::kMaxCalibrationTables; i++) {
+                rom.calibration(i / 4, i % 4, {{0, 3}, {1000, 1004}, {100'000, 99'970},
+                        {1'000'000, 1'000'120}});
+            }
+
+            return rom.checksum().end().data;
+        }
+
+    public:
+        /// ROM contents
+        std::vector<uint8_t> data;
+
+    private:
+        void u16(const uint16_t value) {
+            this->data.push_back(value >> 8);
+            this->data.push_back(value);
+        }
+        void u32(const uint32_t value) {
+            Append32(this->data, value);
+        }
+
+        static void Append32(std::vector<uint8_t> &out, const uint32_t value) {
+            out.push_back(value >> 24);
+            out.push_back(value >> 16);
+            out.push_back(value >> 8);
+            out.push_back(value);
+        }
+};
+
+#endif
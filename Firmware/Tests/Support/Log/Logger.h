@@ -0,0 +1,78 @@
+/**
+ * @file
+ *
+ * @brief Host version of the firmware logger
+ *
+ * Messages are written to stderr; panics abort the test.
+ */
+#ifndef LOG_LOGGER_H
+#define LOG_LOGGER_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <etl/string_view.h>
+
+namespace Log {
+class Logger {
+    public:
+        enum class Level: uint8_t {
+            Error                       = 5,
+            Warning                     = 4,
+            Notice                      = 3,
+            Debug                       = 2,
+            Trace                       = 1,
+        };
+
+    public:
+        Logger() = delete;
+
+        [[noreturn]] static void Panic(const etl::string_view fmt, ...) {
+            va_list va;
+            va_start(va, fmt);
+            Log(Level::Error, fmt, va);
+            va_end(va);
+
+            abort();
+        }
+
+        static void Error(const etl::string_view fmt, ...) {
+            va_list va;
+            va_start(va, fmt);
+            Log(Level::Error, fmt, va);
+            va_end(va);
+        }
+
+        static void Warning(const etl::string_view fmt, ...) {
+            va_list va;
+            va_start(va, fmt);
+            Log(Level::Warning, fmt, va);
+            va_end(va);
+        }
+
+        static void Notice(const etl::string_view fmt, ...) {
+            va_list va;
+            va_start(va, fmt);
+            Log(Level::Notice, fmt, va);
+            va_end(va);
+        }
+
+        static void Debug(const etl::string_view, ...) {}
+        static void Trace(const etl::string_view, ...) {}
+
+        static void Log(const Level lvl, const etl::string_view &fmt, va_list args) {
+            // format strings are always literals, so they're terminated
+            fprintf(stderr, "[%u] ", static_cast<unsigned int>(lvl));
+            vfprintf(stderr, fmt.data(), args);
+            fputc('\n', stderr);
+        }
+};
+}
+
+using Logger = Log::Logger;
+
+#define REQUIRE(cond, ...) {if(!(cond)) { Logger::Panic(__VA_ARGS__); }}
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file
+ *
+ * @brief Host version of the RTOS helpers
+ *
+ * Implements the simulated clock and software timers.
+ */
+#include "Rtos/Rtos.h"
+
+#include <algorithm>
+#include <vector>
+
+/// Current simulated time, in ns
+static uint64_t gNow{0};
+/// All timers that were created (and not yet deleted)
+static std::vector<TimerHandle_t> gTimers;
+
+/// Length of a tick, in ns
+constexpr static const uint64_t kTickLength{1'000'000'000ULL / configTICK_RATE_HZ};
+
+/**
+ * @brief Create a timer
+ *
+ * The timer is created dormant.
+ */
+TimerHandle_t xTimerCreateStatic(const char *name, const TickType_t period,
+        const UBaseType_t autoReload, void *id, TimerCallbackFunction_t callback,
+        StaticTimer_t *buffer) {
+    *buffer = {
+        .name = name,
+        .period = period,
+        .autoReload = !!autoReload,
+        .id = id,
+        .callback = callback,
+    };
+
+    gTimers.push_back(buffer);
+    return buffer;
+}
+
+/**
+ * @brief Delete a timer
+ */
+BaseType_t xTimerDelete(TimerHandle_t timer, const TickType_t) {
+    std::erase(gTimers, timer);
+    return pdPASS;
+}
+
+/**
+ * @brief Start (or restart) a timer
+ *
+ * It fires one period from the current time.
+ */
+BaseType_t xTimerStart(TimerHandle_t timer, const TickType_t) {
+    timer->active = true;
+    timer->expiry = gNow + (timer->period * kTickLength);
+    return pdPASS;
+}
+
+/**
+ * @brief Stop a timer
+ */
+BaseType_t xTimerStop(TimerHandle_t timer, const TickType_t) {
+    timer->active = false;
+    return pdPASS;
+}
+
+/**
+ * @brief Get the current tick count
+ */
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(gNow / kTickLength);
+}
+
+/**
+ * @brief Delay the calling task
+ *
+ * Simulated time advances by the given number of ticks; timers expiring in the meantime fire.
+ */
+void vTaskDelay(const TickType_t ticks) {
+    Rtos::Simulation::Advance(ticks * kTickLength);
+}
+
+/**
+ * @brief Get the current simulated time
+ *
+ * @return Time since the start of the test, in ns
+ */
+uint64_t Rtos::Simulation::Now() {
+    return gNow;
+}
+
+/**
+ * @brief Get the active timer that expires first
+ *
+ * @return Timer, or `nullptr` if no timers are running
+ */
+static TimerHandle_t GetNextTimer() {
+    TimerHandle_t next{nullptr};
+
+    for(auto timer : gTimers) {
+        if(timer->active && (!next || timer->expiry < next->expiry)) {
+            next = timer;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * @brief Fire a timer
+ *
+ * Advances the clock to its expiry, then invokes its callback.
+ */
+static void FireTimer(TimerHandle_t timer) {
+    gNow = std::max(gNow, timer->expiry);
+
+    if(timer->autoReload) {
+        timer->expiry += timer->period * kTickLength;
+    } else {
+        timer->active = false;
+    }
+
+    timer->callback(timer);
+}
+
+/**
+ * @brief Advance the simulated time
+ *
+ * Any timers expiring in the given interval fire, in order of their expiry.
+ *
+ * @param ns Time to advance by, in ns
+ */
+void Rtos::Simulation::Advance(const uint64_t ns) {
+    const auto end = gNow + ns;
+
+    for(auto timer = GetNextTimer(); timer && timer->expiry <= end; timer = GetNextTimer()) {
+        FireTimer(timer);
+    }
+
+    gNow = end;
+}
+
+/**
+ * @brief Advance the simulated time to the next timer expiry, and fire it
+ *
+ * @return Whether a timer fired; if no timers are running, time doesn't advance.
+ */
+bool Rtos::Simulation::RunNextTimer() {
+    const auto timer = GetNextTimer();
+    if(!timer) {
+        return false;
+    }
+
+    FireTimer(timer);
+    return true;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file
+ *
+ * @brief Host version of the RTOS helpers
+ *
+ * Provides just enough of the FreeRTOS API for the hardware independent firmware code. Ticks are
+ * milliseconds, as on the device.
+ *
+ * Time is simulated: it only advances when a task delays, or when the test advances it (see the
+ * Rtos::Simulation namespace.) Software timers fire as the simulated time passes their expiry.
+ */
+#ifndef RTOS_RTOS_H
+#define RTOS_RTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+using TickType_t = uint32_t;
+using BaseType_t = long;
+using UBaseType_t = unsigned long;
+
+#define pdFALSE                         ((BaseType_t) 0)
+#define pdTRUE                          ((BaseType_t) 1)
+#define pdPASS                          pdTRUE
+#define pdFAIL                          pdFALSE
+
+#define portMAX_DELAY                   ((TickType_t) 0xFFFFFFFF)
+
+#define configTICK_RATE_HZ              1000
+#define portTICK_PERIOD_MS              (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)               ((TickType_t) (((TickType_t) (ms) * configTICK_RATE_HZ) / 1000))
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define portSET_INTERRUPT_MASK_FROM_ISR()       0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)    ((void) (x))
+#define portYIELD_FROM_ISR(x)                   ((void) (x))
+
+/**
+ * @brief Simulated task
+ *
+ * Tasks don't run on the host; this just records the notifications sent to a task, so tests can
+ * check them.
+ */
+struct tskTaskControlBlock {
+    /// Notification values, by index
+    uint32_t notifyValue[4]{};
+};
+using TaskHandle_t = tskTaskControlBlock *;
+
+enum eNotifyAction {
+    eSetBits,
+};
+
+inline BaseType_t xTaskNotifyIndexed(TaskHandle_t task, const UBaseType_t index,
+        const uint32_t value, const eNotifyAction) {
+    task->notifyValue[index] |= value;
+    return pdPASS;
+}
+
+inline BaseType_t xTaskNotifyIndexedFromISR(TaskHandle_t task, const UBaseType_t index,
+        const uint32_t value, const eNotifyAction action, BaseType_t *woken) {
+    *woken = pdTRUE;
+    return xTaskNotifyIndexed(task, index, value, action);
+}
+
+/**
+ * @brief Simulated software timer
+ */
+struct tmrTimerControl {
+    /// Timer name
+    const char *name;
+    /// Timer period, in ticks
+    TickType_t period;
+    /// Whether the timer restarts itself when it fires
+    bool autoReload;
+    /// Timer ID (context pointer)
+    void *id;
+    /// Callback invoked when the timer fires
+    void (*callback)(tmrTimerControl *);
+
+    /// Whether the timer is running
+    bool active{false};
+    /// Simulated time at which the timer fires, in ns
+    uint64_t expiry{0};
+};
+using TimerHandle_t = tmrTimerControl *;
+using StaticTimer_t = tmrTimerControl;
+using TimerCallbackFunction_t = void(*)(TimerHandle_t);
+
+TimerHandle_t xTimerCreateStatic(const char *name, const TickType_t period,
+        const UBaseType_t autoReload, void *id, TimerCallbackFunction_t callback,
+        StaticTimer_t *buffer);
+BaseType_t xTimerDelete(TimerHandle_t timer, const TickType_t wait);
+BaseType_t xTimerStart(TimerHandle_t timer, const TickType_t wait);
+BaseType_t xTimerStop(TimerHandle_t timer, const TickType_t wait);
+
+inline BaseType_t xTimerStartFromISR(TimerHandle_t timer, BaseType_t *) {
+    return xTimerStart(timer, 0);
+}
+inline void *pvTimerGetTimerID(TimerHandle_t timer) {
+    return timer->id;
+}
+
+/**
+ * @brief Simulated recursive mutex
+ *
+ * Tasks don't run concurrently on the host, so taking it never blocks; this just tracks how many
+ * times it's held, so tests can check that locks are balanced.
+ */
+struct QueueDefinition {
+    /// Number of times the mutex is currently held
+    UBaseType_t holdCount{0};
+};
+using SemaphoreHandle_t = QueueDefinition *;
+using StaticSemaphore_t = QueueDefinition;
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t *buffer) {
+    *buffer = {};
+    return buffer;
+}
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, const TickType_t) {
+    mutex->holdCount++;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+    if(!mutex->holdCount) {
+        return pdFAIL;
+    }
+    mutex->holdCount--;
+    return pdTRUE;
+}
+inline void vSemaphoreDelete(SemaphoreHandle_t) {}
+
+TickType_t xTaskGetTickCount();
+void vTaskDelay(const TickType_t ticks);
+
+namespace Rtos {
+/**
+ * @brief Simulated time
+ *
+ * The clock has nanosecond resolution, so that tests can account for bus transfer times.
+ */
+namespace Simulation {
+uint64_t Now();
+void Advance(const uint64_t ns);
+bool RunNextTimer();
+}
+
+/// Task notification indices (same as the firmware)
+enum TaskNotifyIndex: size_t {
+    Stream                              = 0,
+    DriverPrivate                       = 1,
+    TaskSpecific                        = 2,
+};
+}
+
+#endif
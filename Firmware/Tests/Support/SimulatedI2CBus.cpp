@@ -0,0 +1,163 @@
+/**
+ * @file
+ *
+ * @brief Simulated I²C bus
+ */
+#include "SimulatedI2CBus.h"
+
+#include "stm32mp1xx.h"
+
+/**
+ * @brief Perform transactions synchronously
+ *
+ * The transactions are submitted as a request like any other, then the bus interrupt is run
+ * until it has completed; requests queued ahead of it execute first.
+ */
+int SimulatedI2CBus::perform(etl::span<const Transaction> transactions, const Priority priority) {
+    bool done{false};
+
+    Request request{
+        .transactions = transactions,
+        .priority = priority,
+        .callback = [](const int, void *ctx) {
+            *reinterpret_cast<bool *>(ctx) = true;
+        },
+        .callbackContext = &done,
+    };
+
+    const auto err = this->submit(request);
+    if(err) {
+        return err;
+    }
+
+    while(!done) {
+        this->runInterrupt();
+    }
+
+    return request.status;
+}
+
+/**
+ * @brief Submit a request
+ *
+ * Start it if the bus is idle, otherwise add it to the queue.
+ */
+int SimulatedI2CBus::submit(Request &request) {
+    if(request.transactions.empty()) {
+        return kInvalidTransaction;
+    }
+
+    const auto err = ValidateTransactions(request.transactions);
+    if(err) {
+        return err;
+    }
+    if(static_cast<size_t>(request.priority) >= kNumPriorities) {
+        return kInvalidTransaction;
+    }
+
+    request.next = nullptr;
+    request.status = 0;
+
+    if(!this->current) {
+        this->current = &request;
+    } else {
+        this->queue.push(request);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Run the bus interrupt
+ *
+ * Execute the current request, then start the next one (if any) and complete the finished
+ * request, the same way the SERCOM bus' interrupt handler does.
+ */
+void SimulatedI2CBus::runInterrupt() {
+    if(!this->current) {
+        return;
+    }
+
+    auto done = this->current;
+    const auto bytes = this->numBytes;
+    const auto status = this->execute(done->transactions);
+
+    Rtos::Simulation::Advance((this->numBytes - bytes) * this->bytePeriod);
+
+    this->completed.push_back({
+        .address = done->transactions.front().address,
+        .priority = done->priority,
+        .status = status,
+    });
+
+    this->current = this->queue.pop();
+
+    BaseType_t woken{pdFALSE};
+    Test::gIpsr = 1;
+    CompleteRequest(*done, status, &woken);
+    Test::gIpsr = 0;
+}
+
+/**
+ * @brief Run the bus interrupt until all requests have completed
+ */
+void SimulatedI2CBus::runUntilIdle() {
+    while(this->current) {
+        this->runInterrupt();
+    }
+}
+
+/**
+ * @brief Execute transactions against the simulated devices
+ *
+ * @return 0 on success, or an error code
+ */
+int SimulatedI2CBus::execute(etl::span<const Transaction> transactions) {
+    Device *device{nullptr};
+
+    for(const auto &txn : transactions) {
+        // (repeated) START and address phase
+        if(!txn.continuation || !txn.skipRestart) {
+            auto next = this->findDevice(txn.address);
+            if(device && (!txn.continuation || device != next)) {
+                device->stop();
+            }
+            device = next;
+
+            this->numBytes++;
+            if(!device || !device->start(txn.read)) {
+                if(device) {
+                    device->stop();
+                }
+                return kErrorNoAck;
+            }
+        }
+
+        // data phase
+        for(size_t i = 0; i < txn.length; i++) {
+            this->numBytes++;
+
+            if(txn.read) {
+                txn.data[i] = device->read();
+            } else if(!device->write(txn.data[i])) {
+                device->stop();
+                return kUnexpectedNAck;
+            }
+        }
+    }
+
+    if(device) {
+        device->stop();
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the device at the given address
+ *
+ * @return Device, or `nullptr` if there is none
+ */
+SimulatedI2CBus::Device *SimulatedI2CBus::findDevice(const uint8_t address) {
+    const auto it = this->devices.find(address);
+    return (it != this->devices.end()) ? it->second : nullptr;
+}
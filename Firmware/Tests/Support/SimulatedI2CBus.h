@@ -0,0 +1,188 @@
+/**
+ * @file
+ *
+ * @brief Simulated I²C bus and devices
+ */
+#ifndef TESTS_SUPPORT_SIMULATEDI2CBUS_H
+#define TESTS_SUPPORT_SIMULATEDI2CBUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "Drivers/I2CBus.h"
+#include "Drivers/I2CRequestQueue.h"
+
+#include <etl/array.h>
+#include <etl/span.h>
+
+/**
+ * @brief Simulated I²C bus
+ *
+ * Executes requests against simulated devices, at the byte level. It behaves like the interrupt
+ * driven SERCOM bus: submitting a request to an idle bus starts it, otherwise it's queued. The
+ * request executes (and completes) when the test invokes the bus "interrupt", which then starts
+ * the next queued request before completing the finished one.
+ *
+ * Synchronous transactions run the interrupt until they've completed.
+ *
+ * If a byte period is set, executing a request advances the simulated time by the time taken to
+ * transfer its bytes.
+ */
+class SimulatedI2CBus: public Drivers::I2CBus {
+    public:
+        /// Invalid request (same value as the SERCOM bus)
+        constexpr static const int kInvalidTransaction{-104};
+        /// Device did not acknowledge a written byte (same value as the SERCOM bus)
+        constexpr static const int kUnexpectedNAck{-105};
+
+        /**
+         * @brief A device on the bus
+         */
+        class Device {
+            public:
+                virtual ~Device() = default;
+
+                /**
+                 * @brief The device was addressed by a START or repeated START
+                 *
+                 * @return Whether the device acknowledges its address
+                 */
+                virtual bool start(const bool read) {
+                    return true;
+                }
+                /**
+                 * @brief Byte written to the device
+                 *
+                 * @return Whether the device acknowledges the byte
+                 */
+                virtual bool write(const uint8_t byte) = 0;
+                /**
+                 * @brief Byte read from the device
+                 */
+                virtual uint8_t read() = 0;
+                /**
+                 * @brief STOP condition, or the device is no longer addressed
+                 */
+                virtual void stop() {}
+        };
+
+        /**
+         * @brief A request that completed on the bus
+         */
+        struct Completion {
+            /// Address of the first transaction
+            uint8_t address;
+            /// Request priority
+            Priority priority;
+            /// Completion status
+            int status;
+        };
+
+    public:
+        /// Attach a device at the given address
+        void attach(const uint8_t address, Device *device) {
+            this->devices[address] = device;
+        }
+
+        int perform(etl::span<const Transaction> transactions,
+                const Priority priority = Priority::Normal) override;
+        int submit(Request &request) override;
+
+        /// Whether a request is executing on the bus
+        bool isBusy() const {
+            return !!this->current;
+        }
+
+        void runInterrupt();
+        void runUntilIdle();
+
+    public:
+        /// Requests completed so far, in order
+        std::vector<Completion> completed;
+        /// Total number of bytes (including addresses) transferred
+        size_t numBytes{0};
+
+        /// Time to transfer a byte (including the acknowledge bit) in ns
+        uint64_t bytePeriod{0};
+
+    private:
+        int execute(etl::span<const Transaction> transactions);
+        Device *findDevice(const uint8_t address);
+
+    private:
+        /// Request currently executing, if any
+        Request *current{nullptr};
+        /// Pending requests
+        Drivers::I2CRequestQueue queue;
+
+        /// Devices, by address
+        std::map<uint8_t, Device *> devices;
+};
+
+/**
+ * @brief Simulated device with a bank of 8-bit registers
+ *
+ * The first byte written in each message sets the register pointer; following bytes are written
+ * to registers starting at the pointer. Reads return registers starting at the pointer. The
+ * pointer increments after each access, if enabled.
+ */
+class SimulatedRegisterDevice: public SimulatedI2CBus::Device {
+    public:
+        SimulatedRegisterDevice(const bool autoIncrement = true) : autoIncrement(autoIncrement) {}
+
+        bool start(const bool read) override {
+            this->isFirstByte = !read;
+            this->numMessages++;
+            return true;
+        }
+
+        bool write(const uint8_t byte) override {
+            if(this->isFirstByte) {
+                this->pointer = byte;
+                this->isFirstByte = false;
+            } else {
+                this->registers[this->pointer] = byte;
+                this->numWrites++;
+                this->advance();
+            }
+            return true;
+        }
+
+        uint8_t read() override {
+            const auto value = this->registers[this->pointer];
+            this->numReads++;
+            this->advance();
+            return value;
+        }
+
+    public:
+        /// Register values
+        etl::array<uint8_t, 256> registers{};
+
+        /// Number of messages (START conditions) addressed to the device
+        size_t numMessages{0};
+        /// Number of register bytes written
+        size_t numWrites{0};
+        /// Number of register bytes read
+        size_t numReads{0};
+
+    private:
+        void advance() {
+            if(this->autoIncrement) {
+                this->pointer++;
+            }
+        }
+
+    private:
+        /// Whether the register pointer increments after each access
+        bool autoIncrement;
+        /// Whether the next written byte is the register pointer
+        bool isFirstByte{false};
+        /// Register pointer
+        uint8_t pointer{0};
+};
+
+#endif
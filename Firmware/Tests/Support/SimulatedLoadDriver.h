@@ -0,0 +1,188 @@
+/**
+ * @file
+ *
+ * @brief Simulated load driver
+ */
+#ifndef TESTS_SUPPORT_SIMULATEDLOADDRIVER_H
+#define TESTS_SUPPORT_SIMULATEDLOADDRIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SimulatedI2CBus.h"
+
+#include "App/Control/LoadDriver.h"
+#include "Drivers/I2CDevice/AT24CS32.h"
+
+#include <etl/array.h>
+#include <etl/span.h>
+
+/**
+ * @brief Board I²C bus for a simulated driver
+ *
+ * This is a separate base class so that it's constructed before the load driver, which resets
+ * the bus when it's constructed.
+ */
+struct SimulatedLoadDriverBus {
+    SimulatedI2CBus boardBus;
+    Drivers::I2CDevice::AT24CS32 boardIdprom{&boardBus};
+};
+
+/**
+ * @brief Simulated load driver
+ *
+ * Models a board with up to four channels that settle instantly: each channel's measured current
+ * is its commanded current times its gain (zero if it's open) while the load is enabled. The
+ * input voltage, and channel and heatsink temperatures, are set directly by the test; the
+ * temperatures are reported only if enabled.
+ */
+class SimulatedLoadDriver: private SimulatedLoadDriverBus, public App::Control::LoadDriver {
+    public:
+        /// Maximum number of channels
+        constexpr static const size_t kMaxChannels{4};
+
+        /// State of a simulated channel
+        struct Channel {
+            /// Last commanded current (µA)
+            uint32_t command{0};
+            /// Ratio of conducted to commanded current
+            double gain{1.};
+            /// Whether the channel is open, and conducts no current at all
+            bool open{false};
+            /// Temperature (m°C)
+            int32_t temperature{25'000};
+        };
+
+    public:
+        /**
+         * @param numChannels Number of channels
+         * @param maxCurrent Maximum total input current (mA)
+         */
+        SimulatedLoadDriver(const size_t numChannels, const uint32_t maxCurrent) :
+            LoadDriver(&this->boardBus, this->boardIdprom), numChannels(numChannels),
+            maxCurrent(maxCurrent) {}
+
+        int setEnabled(const bool isEnabled) override {
+            this->isEnabled = isEnabled;
+            return 0;
+        }
+
+        int readInputCurrent(uint32_t &outCurrent) override {
+            uint32_t total{0};
+            for(size_t i = 0; i < this->numChannels; i++) {
+                total += this->getCurrent(i);
+            }
+            outCurrent = total;
+            return 0;
+        }
+
+        /// Spread the current evenly across channels
+        int setOutputCurrent(const uint32_t current) override {
+            for(size_t i = 0; i < this->numChannels; i++) {
+                this->channels[i].command = current / this->numChannels;
+            }
+            this->numOutputCurrentWrites++;
+            return 0;
+        }
+
+        size_t getNumChannels() const override {
+            return this->numChannels;
+        }
+
+        int readChannelCurrent(const size_t channel, uint32_t &outCurrent) override {
+            if(channel >= this->numChannels) {
+                return Errors::InvalidChannel;
+            }
+            outCurrent = this->getCurrent(channel);
+            return 0;
+        }
+
+        int setChannelCurrents(etl::span<const uint32_t> currents) override {
+            if(currents.size() != this->numChannels) {
+                return Errors::InvalidChannel;
+            }
+            for(size_t i = 0; i < this->numChannels; i++) {
+                this->channels[i].command = currents[i];
+            }
+            this->numChannelWrites++;
+            return 0;
+        }
+
+        int readChannelTemperature(const size_t channel, int32_t &outTemp) override {
+            if(!this->hasChannelTemperatures) {
+                return Errors::Unsupported;
+            } else if(channel >= this->numChannels) {
+                return Errors::InvalidChannel;
+            }
+            outTemp = this->channels[channel].temperature;
+            return 0;
+        }
+
+        int readHeatsinkTemperature(int32_t &outTemp) override {
+            if(!this->hasHeatsinkTemperature) {
+                return Errors::Unsupported;
+            }
+            outTemp = this->heatsinkTemperature;
+            return 0;
+        }
+
+        const SafeOperatingArea *getSafeOperatingArea() const override {
+            return this->soa;
+        }
+
+        int getMaxInputVoltage(uint32_t &outVoltage) override {
+            outVoltage = 60'000;
+            return 0;
+        }
+
+        int getMaxInputCurrent(uint32_t &outCurrent) override {
+            outCurrent = this->maxCurrent;
+            return 0;
+        }
+
+        int readInputVoltage(uint32_t &outVoltage) override {
+            outVoltage = this->inputVoltage;
+            return 0;
+        }
+
+        int setExternalVSense(const bool isExternal) override {
+            return 0;
+        }
+
+        /// Get the current a channel conducts (µA)
+        uint32_t getCurrent(const size_t channel) const {
+            const auto &ch = this->channels[channel];
+            if(!this->isEnabled || ch.open) {
+                return 0;
+            }
+            return static_cast<uint32_t>(ch.command * ch.gain);
+        }
+
+    public:
+        /// Channel state
+        etl::array<Channel, kMaxChannels> channels{};
+        /// Whether the load is enabled
+        bool isEnabled{false};
+        /// Input voltage (mV)
+        uint32_t inputVoltage{0};
+
+        /// Whether per-channel temperatures are reported
+        bool hasChannelTemperatures{false};
+        /// Whether the heatsink temperature is reported, and its value (m°C)
+        bool hasHeatsinkTemperature{false};
+        int32_t heatsinkTemperature{25'000};
+
+        /// Thermal model reported to the control loop (if any)
+        const SafeOperatingArea *soa{nullptr};
+
+        /// Number of calls to setOutputCurrent()
+        size_t numOutputCurrentWrites{0};
+        /// Number of calls to setChannelCurrents()
+        size_t numChannelWrites{0};
+
+    private:
+        size_t numChannels;
+        uint32_t maxCurrent;
+};
+
+#endif
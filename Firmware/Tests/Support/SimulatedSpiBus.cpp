@@ -0,0 +1,87 @@
+/**
+ * @file
+ *
+ * @brief Simulated SPI bus
+ */
+#include "SimulatedSpiBus.h"
+
+#include "Rtos/Rtos.h"
+
+/**
+ * @brief Perform transactions without selecting a device
+ *
+ * No device sees the transfer, so all received bytes are ones.
+ */
+int SimulatedSpiBus::perform(etl::span<const Transaction> transactions) {
+    if(transactions.empty()) {
+        return kInvalidTransaction;
+    }
+
+    const auto bytes = this->numBytes;
+    this->execute(nullptr, transactions);
+    Rtos::Simulation::Advance((this->numBytes - bytes) * this->bytePeriod);
+
+    return 0;
+}
+
+/**
+ * @brief Perform a batch of frames
+ *
+ * All frames are validated before any of them execute, same as the SERCOM bus.
+ */
+int SimulatedSpiBus::performBatch(etl::span<const Frame> frames) {
+    if(frames.empty()) {
+        return kInvalidTransaction;
+    }
+
+    for(const auto &frame : frames) {
+        if(frame.transactions.empty() || frame.chipSelect || !frame.device ||
+                *frame.device == kIdleDevice) {
+            return kInvalidTransaction;
+        }
+    }
+
+    const auto bytes = this->numBytes;
+
+    for(const auto &frame : frames) {
+        const auto it = this->devices.find(*frame.device);
+        auto device = (it != this->devices.end()) ? it->second : nullptr;
+
+        this->selected.push_back(*frame.device);
+
+        if(device) {
+            device->select();
+        }
+        this->execute(device, frame.transactions);
+        if(device) {
+            device->deselect();
+        }
+    }
+
+    this->numBatches++;
+    Rtos::Simulation::Advance((this->numBytes - bytes) * this->bytePeriod);
+
+    return 0;
+}
+
+/**
+ * @brief Exchange the bytes of transactions with a device
+ *
+ * @param device Selected device, if any
+ */
+void SimulatedSpiBus::execute(Device *device, etl::span<const Transaction> transactions) {
+    for(const auto &txn : transactions) {
+        auto tx = reinterpret_cast<const uint8_t *>(txn.txBuf);
+        auto rx = reinterpret_cast<uint8_t *>(txn.rxBuf);
+
+        for(size_t i = 0; i < txn.length; i++) {
+            const uint8_t mosi = tx ? tx[i] : 0x00;
+            const uint8_t miso = device ? device->exchange(mosi) : 0xFF;
+
+            if(rx) {
+                rx[i] = miso;
+            }
+            this->numBytes++;
+        }
+    }
+}
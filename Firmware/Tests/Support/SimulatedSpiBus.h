@@ -0,0 +1,89 @@
+/**
+ * @file
+ *
+ * @brief Simulated SPI bus
+ */
+#ifndef TESTS_SUPPORT_SIMULATEDSPIBUS_H
+#define TESTS_SUPPORT_SIMULATEDSPIBUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "Drivers/SpiBus.h"
+
+#include <etl/span.h>
+
+/**
+ * @brief Simulated SPI bus
+ *
+ * Executes frames synchronously against simulated devices, at the byte level. Devices are
+ * selected by device address, like on a board that decodes the bus' select lines into chip
+ * selects; frames with a dedicated chip select pin aren't supported.
+ *
+ * Reading from an address without a device returns all ones (MISO is pulled up.)
+ *
+ * If a byte period is set, executing a batch advances the simulated time by the time taken to
+ * transfer its bytes.
+ */
+class SimulatedSpiBus: public Drivers::SpiBus {
+    public:
+        /// Invalid transaction or frame (same value as the SERCOM bus)
+        constexpr static const int kInvalidTransaction{-201};
+
+        /**
+         * @brief A device on the bus
+         */
+        class Device {
+            public:
+                virtual ~Device() = default;
+
+                /**
+                 * @brief The device's chip select was asserted
+                 */
+                virtual void select() {}
+                /**
+                 * @brief Exchange a byte with the device
+                 *
+                 * @param mosi Byte written to the device
+                 *
+                 * @return Byte the device returns
+                 */
+                virtual uint8_t exchange(const uint8_t mosi) = 0;
+                /**
+                 * @brief The device's chip select was deasserted
+                 */
+                virtual void deselect() {}
+        };
+
+    public:
+        /// Attach a device at the given device address
+        void attach(const uint8_t address, Device *device) {
+            this->devices[address] = device;
+        }
+
+        int perform(etl::span<const Transaction> transactions) override;
+        int performBatch(etl::span<const Frame> frames) override;
+
+    public:
+        /// Device address of every frame executed so far, in order
+        std::vector<uint8_t> selected;
+        /// Number of batches executed
+        size_t numBatches{0};
+        /// Total number of bytes transferred
+        size_t numBytes{0};
+
+        /// Time to transfer a byte in ns
+        uint64_t bytePeriod{0};
+
+    private:
+        void execute(Device *device, etl::span<const Transaction> transactions);
+
+    private:
+        /// Devices, by address
+        std::map<uint8_t, Device *> devices;
+};
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * @file
+ *
+ * @brief Minimal host test harness
+ *
+ * Each test is an executable that runs a series of checks, and exits with a nonzero status if any
+ * of them failed.
+ */
+#ifndef TESTS_SUPPORT_TEST_H
+#define TESTS_SUPPORT_TEST_H
+
+#include <stdio.h>
+
+namespace Test {
+/// Number of failed checks
+inline unsigned int gNumFailures{0};
+
+/**
+ * @brief Record a failed check
+ */
+inline void Fail(const char *file, const int line, const char *expr) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    gNumFailures++;
+}
+
+/**
+ * @brief Print the test summary
+ *
+ * @return Exit code for the test executable
+ */
+inline int Finish() {
+    if(gNumFailures) {
+        fprintf(stderr, "%u check(s) failed\n", gNumFailures);
+        return 1;
+    }
+    return 0;
+}
+}
+
+/// Check that a condition is true; the test continues either way
+#define CHECK(cond) { if(!(cond)) { Test::Fail(__FILE__, __LINE__, #cond); } }
+/// Check that two values are equal
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+#endif
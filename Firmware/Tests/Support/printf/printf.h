@@ -0,0 +1,13 @@
+/**
+ * @file
+ *
+ * @brief Host replacement for the embedded printf library
+ *
+ * The host C library provides the same functions.
+ */
+#ifndef TESTS_SUPPORT_PRINTF_PRINTF_H
+#define TESTS_SUPPORT_PRINTF_PRINTF_H
+
+#include <stdio.h>
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file
+ *
+ * @brief Host version of the device header
+ *
+ * Provides only the core register accessors used by hardware independent code. The simulated
+ * interrupt state is set by simulated peripherals while they run their "interrupt handlers."
+ */
+#ifndef STM32MP1XX_H
+#define STM32MP1XX_H
+
+#include <stdint.h>
+
+namespace Test {
+/// Simulated IPSR value; nonzero while in an interrupt handler
+inline uint32_t gIpsr{0};
+}
+
+inline uint32_t __get_IPSR() {
+    return Test::gIpsr;
+}
+
+#endif
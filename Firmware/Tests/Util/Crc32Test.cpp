@@ -0,0 +1,168 @@
+/**
+ * @file
+ *
+ * @brief CRC-32 tests and benchmark
+ *
+ * Checks the slice-by-8 implementation against the standard check values and a bitwise
+ * reference, then compares its throughput with the byte-wise table algorithm and MurmurHash3.
+ */
+#include "Test.h"
+
+#include "Util/Crc32.h"
+#include "Util/Hash.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using Util::Crc32;
+
+/**
+ * @brief Bitwise reference CRC-32
+ */
+static uint32_t ReferenceCrc(const uint8_t *data, const size_t length, const uint32_t previous) {
+    uint32_t crc{~previous};
+
+    for(size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for(size_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+/**
+ * @brief Byte-wise table CRC-32 (the classic algorithm, as a benchmark baseline)
+ */
+static uint32_t BytewiseCrc(const uint8_t *data, const size_t length) {
+    static uint32_t table[256];
+    if(!table[1]) {
+        for(uint32_t i = 0; i < 256; i++) {
+            uint32_t crc{i};
+            for(size_t bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+            }
+            table[i] = crc;
+        }
+    }
+
+    uint32_t crc{~0U};
+    for(size_t i = 0; i < length; i++) {
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Standard check values
+ */
+static void TestVectors() {
+    const auto crc = [](const char *str) {
+        return Crc32::Calculate(str, strlen(str));
+    };
+
+    CHECK_EQ(crc(""), 0x00000000U);
+    CHECK_EQ(crc("a"), 0xE8B7BE43U);
+    CHECK_EQ(crc("123456789"), 0xCBF43926U);
+    CHECK_EQ(crc("The quick brown fox jumps over the lazy dog"), 0x414FA339U);
+
+    const std::vector<uint8_t> zeros(32, 0x00), ones(32, 0xFF);
+    CHECK_EQ(Crc32::Calculate(zeros.data(), zeros.size()), 0x190A55ADU);
+    CHECK_EQ(Crc32::Calculate(ones.data(), ones.size()), 0xFF6CAB0BU);
+}
+
+/**
+ * @brief Random buffers of any length and alignment match the reference
+ */
+static void TestReference() {
+    std::mt19937 rng(0xC3C);
+    std::vector<uint8_t> buffer(300);
+    for(auto &byte : buffer) {
+        byte = rng();
+    }
+
+    for(size_t offset = 0; offset < 8; offset++) {
+        for(size_t length = 0; length <= 256; length++) {
+            const auto ptr = buffer.data() + offset;
+            CHECK_EQ(Crc32::Calculate(ptr, length), ReferenceCrc(ptr, length, 0));
+        }
+    }
+}
+
+/**
+ * @brief Checksums may be calculated over multiple buffers
+ */
+static void TestIncremental() {
+    const char *str = "The quick brown fox jumps over the lazy dog";
+    const auto length = strlen(str);
+
+    for(size_t split = 0; split <= length; split++) {
+        const auto first = Crc32::Calculate(str, split);
+        CHECK_EQ(Crc32::Calculate(str + split, length - split, first), 0x414FA339U);
+    }
+}
+
+/**
+ * @brief Measure the time taken by a hash function
+ *
+ * @return Time per call, in ns
+ */
+template<typename Fn>
+static double Measure(const size_t iterations, Fn &&fn) {
+    using Clock = std::chrono::steady_clock;
+    volatile uint32_t sink{0};
+
+    const auto start = Clock::now();
+    for(size_t i = 0; i < iterations; i++) {
+        sink = sink + fn();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+
+    return elapsed.count() / iterations;
+}
+
+/**
+ * @brief Compare throughput with the byte-wise algorithm and MurmurHash3
+ *
+ * Sizes are a small atom, a typical inventory ROM, and the entire EEPROM. Host timings are only
+ * meaningful relative to each other.
+ */
+static void Benchmark() {
+    constexpr static const size_t kBytesPerSize{64 * 1024 * 1024};
+
+    std::vector<uint8_t> buffer(4096);
+    std::mt19937 rng(0xBE7);
+    for(auto &byte : buffer) {
+        byte = rng();
+    }
+
+    printf("%8s %14s %14s %14s\n", "bytes", "crc32 MB/s", "bytewise MB/s", "murmur3 MB/s");
+
+    for(const size_t size : {32, 447, 4096}) {
+        const auto iterations = kBytesPerSize / size;
+        const auto data = buffer.data();
+
+        const auto crc = Measure(iterations, [&]{ return Crc32::Calculate(data, size); });
+        const auto bytewise = Measure(iterations, [&]{ return BytewiseCrc(data, size); });
+        const auto murmur = Measure(iterations, [&]{
+            return Util::Hash::MurmurHash3(data, size);
+        });
+
+        printf("%8zu %14.0f %14.0f %14.0f\n", size, size * 1e3 / crc, size * 1e3 / bytewise,
+                size * 1e3 / murmur);
+    }
+}
+
+int main() {
+    TestVectors();
+    TestReference();
+    TestIncremental();
+    Benchmark();
+
+    return Test::Finish();
+}
@@ -0,0 +1,264 @@
+/**
+ * @file
+ *
+ * @brief Inventory ROM parser fuzz target
+ *
+ * Parses each input three ways: in one piece, one byte at a time, and in chunks whose size is
+ * taken from the first input byte; then through InventoryRom::Read(). All of them must agree on
+ * the outcome and the decoded contents, and the contents must be consistent. Any mismatch aborts,
+ * which the fuzzer reports as a crash.
+ *
+ * With libFuzzer (Clang, `-DFUZZ=ON`) this builds a regular fuzzer. Otherwise, it's built as a
+ * standalone test (`FUZZ_STANDALONE` defined) that replays the files given on the command line,
+ * or runs a fixed number of random mutations of a few seed ROMs.
+ */
+#include "InventoryRomBuilder.h"
+
+#include "Util/InventoryRom.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+using Util::InventoryRom;
+
+/// Abort with a message if the condition is false
+#define FUZZ_ASSERT(cond) { if(!(cond)) { \
+    fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond); abort(); } }
+
+/**
+ * @brief Result of parsing a ROM
+ */
+struct Outcome {
+    /// First error returned by the parser, or 0
+    int err{0};
+    /// Whether the end atom was reached
+    bool done{false};
+    /// Number of atoms parsed
+    size_t numAtoms{0};
+    /// Decoded contents
+    InventoryRom::Contents contents;
+};
+
+/**
+ * @brief Feed the ROM to a parser in chunks of the given size
+ */
+static void Parse(etl::span<const uint8_t> rom, const size_t chunkSize, Outcome &out) {
+    InventoryRom::Parser parser(out.contents);
+
+    for(size_t offset = 0; offset < rom.size() && !parser.isDone(); offset += chunkSize) {
+        const auto err = parser.feed(rom.subspan(offset, std::min(chunkSize, rom.size() - offset)));
+        if(err) {
+            out.err = err;
+            break;
+        }
+    }
+
+    out.done = !out.err && parser.isDone();
+    out.numAtoms = parser.getNumAtoms();
+}
+
+/**
+ * @brief Check that the decoded contents are internally consistent
+ */
+static void CheckContents(const InventoryRom::Contents &c) {
+    FUZZ_ASSERT(memchr(c.name.data(), '\0', c.name.size()));
+    FUZZ_ASSERT(memchr(c.manufacturer.data(), '\0', c.manufacturer.size()));
+    FUZZ_ASSERT(c.numCalibrationTables <= InventoryRom::kMaxCalibrationTables);
+
+    for(size_t i = 0; i < c.numCalibrationTables; i++) {
+        const auto &table = c.calibration[i];
+        FUZZ_ASSERT(table.numPoints >= 2 && table.numPoints <= InventoryRom::kMaxCalibrationPoints);
+    }
+
+    FUZZ_ASSERT(!c.numCalibrationTables || c.has(InventoryRom::AtomType::Calibration));
+}
+
+/**
+ * @brief Compare two sets of decoded contents
+ */
+static bool operator==(const InventoryRom::Contents &a, const InventoryRom::Contents &b) {
+    if(a.present != b.present || a.hwRevision != b.hwRevision || a.driverId != b.driverId ||
+            a.maxVoltage != b.maxVoltage || a.maxCurrent != b.maxCurrent ||
+            strcmp(a.name.data(), b.name.data()) ||
+            strcmp(a.manufacturer.data(), b.manufacturer.data()) ||
+            a.numCalibrationTables != b.numCalibrationTables) {
+        return false;
+    }
+
+    for(size_t i = 0; i < a.numCalibrationTables; i++) {
+        const auto &ta = a.calibration[i], &tb = b.calibration[i];
+        if(ta.target != tb.target || ta.channel != tb.channel || ta.numPoints != tb.numPoints) {
+            return false;
+        }
+
+        for(size_t j = 0; j < ta.numPoints; j++) {
+            if(ta.points[j].in != tb.points[j].in || ta.points[j].out != tb.points[j].out) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Check that two parses of the same ROM agree
+ */
+static void CheckSame(const Outcome &a, const Outcome &b) {
+    FUZZ_ASSERT(a.err == b.err);
+    FUZZ_ASSERT(a.done == b.done);
+    FUZZ_ASSERT(a.numAtoms == b.numAtoms);
+    FUZZ_ASSERT(a.contents == b.contents);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/**
+ * @brief Fuzzer entry point
+ *
+ * The first byte of the input selects the chunk size; the rest is the ROM image.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if(!size) {
+        return 0;
+    }
+
+    const auto chunkSize = (data[0] % 64) + 1;
+    const etl::span<const uint8_t> rom(data + 1, size - 1);
+
+    static Outcome whole, bytewise, chunked;
+    whole = {};
+    bytewise = {};
+    chunked = {};
+
+    Parse(rom, std::max<size_t>(rom.size(), 1), whole);
+    Parse(rom, 1, bytewise);
+    Parse(rom, chunkSize, chunked);
+
+    CheckContents(whole.contents);
+    CheckSame(whole, bytewise);
+    CheckSame(whole, chunked);
+
+    // a successful parse always ends with the end atom
+    FUZZ_ASSERT(!whole.done || whole.contents.has(InventoryRom::AtomType::End));
+
+    // reading the ROM through the reader callback gives the same result
+    static InventoryRom::Contents contents;
+    const auto ret = InventoryRom::Read([](auto address, auto length, auto buffer, auto ctx) {
+        const auto &rom = *reinterpret_cast<const etl::span<const uint8_t> *>(ctx);
+        FUZZ_ASSERT(address + length <= rom.size() && length <= buffer.size());
+
+        memcpy(buffer.data(), rom.data() + address, length);
+        return 0;
+    }, const_cast<etl::span<const uint8_t> *>(&rom), rom.size(), contents);
+
+    if(whole.err) {
+        FUZZ_ASSERT(ret == whole.err);
+    } else if(whole.done) {
+        FUZZ_ASSERT(ret == static_cast<int>(whole.numAtoms));
+        FUZZ_ASSERT(contents == whole.contents);
+    } else {
+        FUZZ_ASSERT(ret == InventoryRom::Errors::Truncated);
+    }
+
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+/// Number of mutated inputs to run when no files are specified
+constexpr static const size_t kNumIterations{20'000};
+
+/**
+ * @brief Build the seed inputs
+ *
+ * Each starts with the chunk size byte, followed by a ROM.
+ */
+static std::vector<std::vector<uint8_t>> GetSeeds() {
+    using AtomType = InventoryRom::AtomType;
+
+    std::vector<std::vector<uint8_t>> roms{
+        InventoryRomBuilder::Typical(),
+        InventoryRomBuilder().end().data,
+        InventoryRomBuilder(13).hwRevision(1).atom(static_cast<AtomType>(0x80), {1, 2, 3})
+            .checksum().end().data,
+        InventoryRomBuilder().string(AtomType::Name, "A name that is longer than the limit")
+            .calibration(0, 0, {{0, 0}, {1, 1}}).end().data,
+    };
+
+    for(auto &rom : roms) {
+        rom.insert(rom.begin(), static_cast<uint8_t>(rom.size()));
+    }
+    return roms;
+}
+
+/**
+ * @brief Randomly mutate an input
+ *
+ * Applies a few byte flips, overwrites, insertions, deletions or a truncation.
+ */
+static void Mutate(std::vector<uint8_t> &input, std::mt19937 &rng) {
+    const auto numMutations = 1 + (rng() % 4);
+
+    for(size_t i = 0; i < numMutations && !input.empty(); i++) {
+        const auto pos = rng() % input.size();
+
+        switch(rng() % 5) {
+            case 0:
+                input[pos] ^= 1U << (rng() % 8);
+                break;
+            case 1:
+                input[pos] = rng();
+                break;
+            case 2:
+                input.insert(input.begin() + pos, static_cast<uint8_t>(rng()));
+                break;
+            case 3:
+                input.erase(input.begin() + pos);
+                break;
+            case 4:
+                input.resize(pos);
+                break;
+        }
+    }
+}
+
+int main(int argc, const char **argv) {
+    // replay the specified inputs (such as crash reproducers from the fuzzer)
+    if(argc > 1) {
+        for(int i = 1; i < argc; i++) {
+            std::ifstream file(argv[i], std::ios::binary);
+            if(!file) {
+                fprintf(stderr, "failed to open %s\n", argv[i]);
+                return 1;
+            }
+
+            const std::vector<uint8_t> input{std::istreambuf_iterator<char>(file), {}};
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        return 0;
+    }
+
+    const auto seeds = GetSeeds();
+    std::mt19937 rng(0x1D9A0);
+
+    for(const auto &seed : seeds) {
+        LLVMFuzzerTestOneInput(seed.data(), seed.size());
+    }
+
+    for(size_t i = 0; i < kNumIterations; i++) {
+        auto input = seeds[i % seeds.size()];
+        Mutate(input, rng);
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+
+    printf("InventoryRom: %zu inputs ok\n", kNumIterations + seeds.size());
+    return 0;
+}
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file
+ *
+ * @brief Inventory ROM parser tests and benchmark
+ *
+ * The benchmark compares reading a typical ROM with the streaming parser against the per-atom
+ * GetAtoms() interface: both by host CPU time, and by the number of reads (which are separate
+ * EEPROM transactions on the device) and the resulting bus time.
+ */
+#include "Test.h"
+#include "InventoryRomBuilder.h"
+
+#include "Util/InventoryRom.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+using Util::InventoryRom;
+using AtomType = InventoryRom::AtomType;
+
+/**
+ * @brief A ROM image, read through the reader callback
+ */
+struct Rom {
+    std::vector<uint8_t> data;
+
+    /// Number of reads performed
+    size_t numReads{0};
+    /// Total number of bytes read
+    size_t numBytes{0};
+
+    static int Reader(uintptr_t address, size_t length, etl::span<uint8_t> buffer, void *ctx) {
+        auto rom = reinterpret_cast<Rom *>(ctx);
+        rom->numReads++;
+        rom->numBytes += length;
+
+        if(address + length > rom->data.size() || length > buffer.size()) {
+            return -1;
+        }
+        memcpy(buffer.data(), rom->data.data() + address, length);
+        return 0;
+    }
+
+    int read(InventoryRom::Contents &out) {
+        return InventoryRom::Read(&Reader, this, this->data.size(), out);
+    }
+};
+
+/**
+ * @brief A typical ROM decodes completely
+ */
+static void TestTypical() {
+    Rom rom{InventoryRomBuilder::Typical()};
+    InventoryRom::Contents c;
+
+    // all well known atoms, ten calibration tables, checksum and end
+    CHECK_EQ(rom.read(c), 17);
+
+    CHECK(c.has(AtomType::Crc32));
+    CHECK(c.has(AtomType::End));
+    CHECK_EQ(c.hwRevision, 3);
+    CHECK(!strcmp(c.name.data(), "Analog load driver"));
+    CHECK(!strcmp(c.manufacturer.data(), "Test Manufacturer"));
+    CHECK_EQ(c.driverId[15], 0xA5);
+    CHECK_EQ(c.maxVoltage, 72'000U);
+    CHECK_EQ(c.maxCurrent, 10'000U);
+
+    CHECK_EQ(c.numCalibrationTables, InventoryRom::kMaxCalibrationTables);
+    const auto &table = c.calibration[9];
+    CHECK_EQ(table.target, 2);
+    CHECK_EQ(table.channel, 1);
+    CHECK_EQ(table.getPoints().size(), 4U);
+    CHECK_EQ(table.points[3].in, 1'000'000);
+    CHECK_EQ(table.points[3].out, 1'000'120);
+}
+
+/**
+ * @brief Feeding the ROM in any chunk size gives the same result
+ */
+static void TestChunking() {
+    const auto data = InventoryRomBuilder(11).hwRevision(7).string(AtomType::Name, "x")
+        .checksum().end().data;
+
+    for(size_t chunk = 1; chunk <= data.size(); chunk++) {
+        InventoryRom::Contents c;
+        InventoryRom::Parser parser(c);
+
+        for(size_t i = 0; i < data.size(); i += chunk) {
+            const auto n = std::min(chunk, data.size() - i);
+            CHECK_EQ(parser.feed({data.data() + i, n}), 0);
+        }
+
+        CHECK(parser.isDone());
+        CHECK_EQ(parser.getNumAtoms(), 4U);
+        CHECK_EQ(c.hwRevision, 7);
+        CHECK(c.has(AtomType::Crc32));
+    }
+}
+
+/**
+ * @brief Corrupted, truncated and malformed ROMs are rejected
+ */
+static void TestInvalid() {
+    InventoryRom::Contents c;
+
+    // data corrupted after the checksum was computed
+    Rom corrupt{InventoryRomBuilder::Typical()};
+    corrupt.data[20] ^= 0x01;
+    CHECK_EQ(corrupt.read(c), InventoryRom::Errors::ChecksumMismatch);
+
+    // no end atom
+    Rom truncated{InventoryRomBuilder().hwRevision(1).data};
+    CHECK_EQ(truncated.read(c), InventoryRom::Errors::Truncated);
+
+    // erased EEPROM
+    Rom erased{std::vector<uint8_t>(256, 0xFF)};
+    CHECK_EQ(erased.read(c), InventoryRom::Errors::InvalidHeader);
+
+    // unsupported version
+    Rom version{InventoryRomBuilder(8, 0x20).end().data};
+    CHECK_EQ(version.read(c), InventoryRom::Errors::InvalidHeader);
+
+    // wrong payload length for a well known atom
+    Rom payload{InventoryRomBuilder().atom(AtomType::HwRevision, {1, 2, 3}).end().data};
+    CHECK_EQ(payload.read(c), InventoryRom::Errors::InvalidPayload);
+
+    // calibration table with a single point
+    Rom table{InventoryRomBuilder().calibration(0, 0, {{0, 0}}).end().data};
+    CHECK_EQ(table.read(c), InventoryRom::Errors::InvalidPayload);
+
+    // unprogrammed atom
+    Rom atom{InventoryRomBuilder().atom(AtomType::Invalid, {}).data};
+    CHECK_EQ(atom.read(c), InventoryRom::Errors::InvalidType);
+}
+
+/**
+ * @brief Read all atoms (including their payload) with GetAtoms()
+ */
+static int ReadPerAtom(Rom &rom) {
+    static etl::array<uint8_t, 255> payload;
+
+    return InventoryRom::GetAtoms(&Rom::Reader, &rom,
+        [](const auto &header, void *, etl::span<uint8_t> &outBuf) {
+            outBuf = {payload.data(), header.length};
+            return true;
+        }, nullptr,
+        [](const auto &, etl::span<const uint8_t>, void *) {}, nullptr);
+}
+
+/**
+ * @brief Compare the streaming parser against per-atom reads
+ */
+static void BenchmarkRead() {
+    constexpr static const size_t kIterations{20'000};
+    // each read transaction: device address (twice), two address bytes; at 400kHz
+    constexpr static const double kReadOverhead{4}, kBytePeriodUs{22.5};
+
+    Rom streaming{InventoryRomBuilder::Typical()}, perAtom{streaming.data};
+    InventoryRom::Contents c;
+
+    CHECK_EQ(streaming.read(c), 17);
+    CHECK_EQ(ReadPerAtom(perAtom), 17);
+
+    const auto busTime = [](const Rom &rom) {
+        return ((rom.numReads * kReadOverhead) + rom.numBytes) * kBytePeriodUs;
+    };
+
+    printf("InventoryRom: %zu byte ROM\n", streaming.data.size());
+    printf("  streaming: %3zu reads, %4zu bytes, ~%.0f us bus time\n", streaming.numReads,
+            streaming.numBytes, busTime(streaming));
+    printf("  per atom:  %3zu reads, %4zu bytes, ~%.0f us bus time\n", perAtom.numReads,
+            perAtom.numBytes, busTime(perAtom));
+
+    CHECK(streaming.numReads < perAtom.numReads);
+
+    // host CPU time, for relative comparison only
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+    for(size_t i = 0; i < kIterations; i++) {
+        streaming.read(c);
+    }
+    const std::chrono::duration<double, std::nano> streamingTime = Clock::now() - start;
+
+    start = Clock::now();
+    for(size_t i = 0; i < kIterations; i++) {
+        ReadPerAtom(perAtom);
+    }
+    const std::chrono::duration<double, std::nano> perAtomTime = Clock::now() - start;
+
+    printf("  host: streaming %.0f ns/ROM (parse + decode + CRC), per atom %.0f ns/ROM\n",
+            streamingTime.count() / kIterations, perAtomTime.count() / kIterations);
+}
+
+int main() {
+    TestTypical();
+    TestChunking();
+    TestInvalid();
+    BenchmarkRead();
+
+    return Test::Finish();
+}
@@ -9,7 +9,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace LibLoad {
 /**
@@ -50,6 +52,98 @@ struct Device {
         MaxCurrent                      = 0x06,
     };
 
+    /**
+     * @brief Runtime statistics of a single firmware task
+     *
+     * Usage values are computed over the window since the previous statistics request.
+     */
+    struct TaskStats {
+        /// Task name
+        std::string name;
+        /// Current priority
+        unsigned int priority{0};
+        /// CPU usage, in percent
+        double cpuLoad{0};
+        /// Minimum amount of free stack space, in words
+        unsigned int stackFree{0};
+        /// Average latency from being notified until running, in µs
+        unsigned int notifyLatencyAvg{0};
+        /// Maximum latency from being notified until running, in µs
+        unsigned int notifyLatencyMax{0};
+    };
+
+    /**
+     * @brief Queueing latency of a single I²C request priority
+     *
+     * Describes how long requests of one priority on the driver bus waited before they were
+     * executed, over the time since the previous query.
+     */
+    struct BusQueueStats {
+        /// Number of requests executed
+        unsigned int numRequests{0};
+        /// Average queueing latency, in µs
+        unsigned int latencyAvg{0};
+        /// Maximum queueing latency, in µs
+        unsigned int latencyMax{0};
+    };
+
+    /**
+     * @brief Usage of a single firmware slab allocator size class
+     */
+    struct HeapClassStats {
+        /// Size of each block, in bytes
+        unsigned int blockSize{0};
+        /// Total number of blocks
+        unsigned int numBlocks{0};
+        /// Number of blocks currently in use
+        unsigned int inUse{0};
+        /// Maximum number of blocks ever in use at once
+        unsigned int peakInUse{0};
+        /// Number of allocations served from this class
+        unsigned int numAllocs{0};
+        /// Number of allocations that fell through to the heap because the class was full
+        unsigned int numOverflows{0};
+    };
+
+    /**
+     * @brief A single firmware trace event
+     */
+    struct TraceEvent {
+        /**
+         * @brief Event types
+         *
+         * @remark These must be kept in sync with `Rtos::Trace::Event` in the firmware.
+         */
+        enum class Type: uint8_t {
+            TaskSwitchIn                = 0x01,
+            TaskSwitchOut               = 0x02,
+            IsrEnter                    = 0x03,
+            IsrExit                     = 0x04,
+            QueueSend                   = 0x05,
+            QueueReceive                = 0x06,
+            QueueBlockSend              = 0x07,
+            QueueBlockReceive           = 0x08,
+            TaskNotify                  = 0x09,
+        };
+
+        /// Time since the first event in the trace, in µs
+        double timestamp{0};
+        /// Event type
+        Type type;
+        /// Task number, exception number, or queue id (depending on type)
+        uint16_t id{0};
+    };
+
+    /**
+     * @brief Firmware event trace
+     */
+    struct Trace {
+        /// All events, oldest first
+        std::vector<TraceEvent> events;
+        /// Names of tasks, by task number
+        std::map<unsigned int, std::string> taskNames;
+    };
+
     virtual ~Device() = default;
 
     /**
@@ -69,6 +163,18 @@ struct Device {
     virtual bool propertyRead(const Property id, unsigned int &outValue) = 0;
     /// Read a property (as a floating point)
     //virtual bool propertyRead(const Property id, double &outValue) = 0;
+
+    /// Read firmware task runtime statistics
+    virtual bool readTaskStats(double &outTotalLoad, std::vector<TaskStats> &outTasks,
+            std::vector<BusQueueStats> &outBusQueues) = 0;
+    /// Read firmware slab allocator statistics
+    virtual bool readHeapStats(std::vector<HeapClassStats> &outClasses) = 0;
+    /// Read the firmware event trace
+    virtual bool readTrace(Trace &outTrace) = 0;
+    /// Discard the firmware event trace and restart recording
+    virtual bool resetTrace() = 0;
+    /// Read the raw crash snapshot left behind by a previous firmware run
+    virtual bool readCrashDump(std::vector<uint8_t> &outData, const bool clear = false) = 0;
 };
 
 void Init();
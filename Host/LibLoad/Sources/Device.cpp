@@ -36,6 +36,316 @@ Cborg DeviceImpl::propertyGet(const Property key) {
     return response.find("get").find(static_cast<int32_t>(key));
 }
 
+/**
+ * @brief Read task runtime statistics
+ *
+ * Request the firmware's per task statistics. Usage values are accumulated by the device since the
+ * previous request, so the first request after connecting covers the time since boot.
+ *
+ * @param outTotalLoad Variable to receive the total CPU load, in percent
+ * @param outTasks Vector to receive information about each task
+ * @param outBusQueues Vector to receive driver bus queueing latency, indexed by request priority
+ *
+ * @return Whether statistics were read successfully
+ */
+bool DeviceImpl::readTaskStats(double &outTotalLoad, std::vector<TaskStats> &outTasks,
+        std::vector<BusQueueStats> &outBusQueues) {
+    std::lock_guard lg(this->lock);
+
+    // send the request
+    this->writeCborMessage(Endpoint::TaskStats, [](auto encoder) {
+        return encoder.map().end();
+    });
+
+    // read response
+    Cborg response;
+    this->readCborMessage(response);
+
+    uint32_t load{0};
+    if(!response.find("load").getUnsigned(&load)) {
+        return false;
+    }
+    outTotalLoad = static_cast<double>(load) / 100.;
+
+    // decode each task
+    auto tasks = response.find("tasks");
+    outTasks.clear();
+
+    for(uint32_t i = 0; i < tasks.getSize(); i++) {
+        auto task = tasks.at(i);
+        TaskStats info;
+        uint32_t temp{0};
+
+        task.find("n").getString(info.name);
+        if(task.find("p").getUnsigned(&temp)) {
+            info.priority = temp;
+        }
+        if(task.find("c").getUnsigned(&temp)) {
+            info.cpuLoad = static_cast<double>(temp) / 100.;
+        }
+        if(task.find("s").getUnsigned(&temp)) {
+            info.stackFree = temp;
+        }
+        if(task.find("l").getUnsigned(&temp)) {
+            info.notifyLatencyAvg = temp;
+        }
+        if(task.find("L").getUnsigned(&temp)) {
+            info.notifyLatencyMax = temp;
+        }
+
+        outTasks.emplace_back(std::move(info));
+    }
+
+    // decode bus queue statistics (highest priority first)
+    auto busQueues = response.find("i2c");
+    outBusQueues.clear();
+
+    for(uint32_t i = 0; i < busQueues.getSize(); i++) {
+        auto queue = busQueues.at(i);
+        BusQueueStats info;
+        uint32_t temp{0};
+
+        if(queue.find("n").getUnsigned(&temp)) {
+            info.numRequests = temp;
+        }
+        if(queue.find("l").getUnsigned(&temp)) {
+            info.latencyAvg = temp;
+        }
+        if(queue.find("L").getUnsigned(&temp)) {
+            info.latencyMax = temp;
+        }
+
+        outBusQueues.emplace_back(std::move(info));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read slab allocator statistics
+ *
+ * Request the usage statistics of each of the firmware's slab allocator size classes.
+ *
+ * @param outClasses Vector to receive information about each size class
+ *
+ * @return Whether statistics were read successfully
+ */
+bool DeviceImpl::readHeapStats(std::vector<HeapClassStats> &outClasses) {
+    std::lock_guard lg(this->lock);
+
+    // send the request
+    this->writeCborMessage(Endpoint::HeapStats, [](auto encoder) {
+        return encoder.map().end();
+    });
+
+    // read response
+    Cborg response;
+    this->readCborMessage(response);
+
+    auto classes = response.find("classes");
+    if(!classes.getSize()) {
+        return false;
+    }
+
+    outClasses.clear();
+
+    for(uint32_t i = 0; i < classes.getSize(); i++) {
+        auto cls = classes.at(i);
+        HeapClassStats info;
+        uint32_t temp{0};
+
+        if(cls.find("s").getUnsigned(&temp)) {
+            info.blockSize = temp;
+        }
+        if(cls.find("n").getUnsigned(&temp)) {
+            info.numBlocks = temp;
+        }
+        if(cls.find("u").getUnsigned(&temp)) {
+            info.inUse = temp;
+        }
+        if(cls.find("p").getUnsigned(&temp)) {
+            info.peakInUse = temp;
+        }
+        if(cls.find("a").getUnsigned(&temp)) {
+            info.numAllocs = temp;
+        }
+        if(cls.find("o").getUnsigned(&temp)) {
+            info.numOverflows = temp;
+        }
+
+        outClasses.emplace_back(std::move(info));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read the firmware event trace
+ *
+ * Read out the entire trace buffer in chunks. The device stops recording when the first chunk is
+ * requested, and resumes once all of them have been read (or if the read is abandoned, after a
+ * timeout.)
+ *
+ * Raw timestamps are the device's 32-bit cycle counter; they're extended (assuming no more than
+ * one wraparound between consecutive events) and converted to µs relative to the first event.
+ *
+ * @param outTrace Trace structure to receive the events and task names
+ *
+ * @return Whether the trace was read successfully
+ */
+bool DeviceImpl::readTrace(Trace &outTrace) {
+    // size of a single trace record, in bytes
+    constexpr static const size_t kRecordSize{8};
+
+    std::lock_guard lg(this->lock);
+
+    uint32_t offset{0}, total{0}, clock{0};
+    uint32_t lastTimestamp{0};
+    uint64_t timestamp{0};
+
+    outTrace.events.clear();
+    outTrace.taskNames.clear();
+
+    do {
+        // request the next chunk
+        this->writeCborMessage(Endpoint::TraceRead, [offset](auto encoder) {
+            return encoder.map()
+                .key("off").value(offset)
+            .end();
+        });
+
+        Cborg response;
+        this->readCborMessage(response);
+
+        const uint8_t *records{nullptr};
+        uint32_t recordsLen{0};
+
+        if(!response.find("total").getUnsigned(&total) ||
+                !response.find("clk").getUnsigned(&clock) || !clock ||
+                !response.find("rec").getBytes(&records, &recordsLen)) {
+            return false;
+        }
+
+        /*
+         * The first chunk carries the task names. Task numbers are assigned sequentially as tasks
+         * are created, so probing the low range of numbers is sufficient.
+         */
+        if(!offset) {
+            auto tasks = response.find("tasks");
+            for(uint32_t i = 0; i < 256; i++) {
+                std::string name;
+                if(tasks.find(static_cast<int32_t>(i)).getString(name)) {
+                    outTrace.taskNames.emplace(i, std::move(name));
+                }
+            }
+        }
+
+        // decode records
+        const auto numRecords = recordsLen / kRecordSize;
+        if(!numRecords) {
+            break;
+        }
+
+        for(size_t i = 0; i < numRecords; i++) {
+            const auto record = records + (i * kRecordSize);
+
+            const uint32_t raw = record[0] | (record[1] << 8) | (record[2] << 16) |
+                (static_cast<uint32_t>(record[3]) << 24);
+            if(!outTrace.events.empty()) {
+                timestamp += static_cast<uint32_t>(raw - lastTimestamp);
+            }
+            lastTimestamp = raw;
+
+            outTrace.events.push_back({
+                .timestamp = static_cast<double>(timestamp) / (static_cast<double>(clock) / 1e6),
+                .type = static_cast<TraceEvent::Type>(record[4]),
+                .id = static_cast<uint16_t>(record[6] | (record[7] << 8)),
+            });
+        }
+
+        offset += numRecords;
+    } while(offset < total);
+
+    return true;
+}
+
+/**
+ * @brief Reset the firmware event trace
+ *
+ * Discard all recorded events, and restart recording. This may be used to recover from a trace
+ * read that was abandoned part way through, without waiting for the device to time it out.
+ *
+ * @return Whether the request completed successfully
+ */
+bool DeviceImpl::resetTrace() {
+    std::lock_guard lg(this->lock);
+
+    this->writeCborMessage(Endpoint::TraceRead, [](auto encoder) {
+        return encoder.map()
+            .key("reset").value(true)
+        .end();
+    });
+
+    Cborg response;
+    this->readCborMessage(response);
+
+    uint32_t total{0};
+    return response.find("total").getUnsigned(&total);
+}
+
+/**
+ * @brief Read the crash snapshot
+ *
+ * Read out the raw crash snapshot (if any) that was left behind by a previous run of the firmware.
+ * It's up to the caller to decode it.
+ *
+ * @param outData Buffer to receive the snapshot; it's empty if the device has no snapshot
+ * @param clear Discard the snapshot on the device after it has been read
+ *
+ * @return Whether the request completed successfully
+ */
+bool DeviceImpl::readCrashDump(std::vector<uint8_t> &outData, const bool clear) {
+    std::lock_guard lg(this->lock);
+
+    uint32_t size{0};
+    outData.clear();
+
+    // read all chunks; the final request (at the end of the snapshot) may discard it
+    do {
+        const uint32_t offset = outData.size();
+        const bool isLast = size && (offset >= size);
+
+        this->writeCborMessage(Endpoint::CrashDump, [offset, isLast, clear](auto encoder) {
+            return encoder.map()
+                .key("off").value(offset)
+                .key("clear").value(isLast && clear)
+            .end();
+        });
+
+        Cborg response;
+        this->readCborMessage(response);
+
+        const uint8_t *data{nullptr};
+        uint32_t dataLen{0};
+
+        if(!response.find("size").getUnsigned(&size) ||
+                !response.find("data").getBytes(&data, &dataLen)) {
+            return false;
+        }
+
+        if(isLast || !size) {
+            break;
+        }
+        if(!dataLen) {
+            return false;
+        }
+
+        outData.insert(outData.end(), data, data + dataLen);
+    } while(true);
+
+    return true;
+}
+
 /**
  * @brief Send a CBOR-encoded message to the device
  *
@@ -34,6 +34,14 @@ class DeviceImpl: public LibLoad::Device {
          */
         enum class Endpoint: uint8_t {
             PropertyRequest             = 0x01,
+            /// Task runtime statistics (must match firmware message type)
+            TaskStats                   = 0x20,
+            /// Event trace readout (must match firmware message type)
+            TraceRead                   = 0x21,
+            /// Crash snapshot readout (must match firmware message type)
+            CrashDump                   = 0x22,
+            /// Slab allocator statistics (must match firmware message type)
+            HeapStats                   = 0x23,
         };
 
     public:
@@ -86,6 +94,13 @@ class DeviceImpl: public LibLoad::Device {
             return val.getString(outValue);
         }
 
+        bool readTaskStats(double &outTotalLoad, std::vector<TaskStats> &outTasks,
+                std::vector<BusQueueStats> &outBusQueues) override;
+        bool readHeapStats(std::vector<HeapClassStats> &outClasses) override;
+        bool readTrace(Trace &outTrace) override;
+        bool resetTrace() override;
+        bool readCrashDump(std::vector<uint8_t> &outData, const bool clear) override;
+
     private:
         Cborg propertyGet(const Property key);
 
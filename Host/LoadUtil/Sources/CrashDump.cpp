@@ -0,0 +1,365 @@
+/**
+ * @file
+ *
+ * @brief Commands to read and decode firmware crash snapshots
+ *
+ * The layout decoded here must match `Log::CrashDump::Snapshot` in the firmware.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <rang.hpp>
+#include <tabulate/table.hpp>
+
+#include <LibLoad.h>
+
+/// Snapshot magic value ('CRSH')
+constexpr static const uint32_t kMagic{0x48535243};
+/// Supported snapshot version
+constexpr static const uint16_t kVersion{1};
+
+/// Number of stack words in the snapshot
+constexpr static const size_t kStackWords{32};
+/// Number of trace records in the snapshot
+constexpr static const size_t kTraceRecords{32};
+/// Length of the message field
+constexpr static const size_t kMessageLength{96};
+/// Length of task name fields
+constexpr static const size_t kTaskNameLength{16};
+/// Maximum number of task table entries
+constexpr static const size_t kMaxTasks{12};
+
+/**
+ * @brief Sequential little endian reader for the snapshot
+ */
+class Reader {
+    public:
+        Reader(std::span<const uint8_t> data) : data(data) {}
+
+        bool ok() const {
+            return this->offset <= this->data.size();
+        }
+
+        uint32_t u32() {
+            return this->read(4);
+        }
+        uint16_t u16() {
+            return this->read(2);
+        }
+        uint8_t u8() {
+            return this->read(1);
+        }
+
+        std::string string(const size_t length) {
+            std::string out;
+            if(this->offset + length <= this->data.size()) {
+                const auto start = reinterpret_cast<const char *>(this->data.data() + this->offset);
+                out.assign(start, strnlen(start, length));
+            }
+            this->offset += length;
+            return out;
+        }
+
+        void skip(const size_t length) {
+            this->offset += length;
+        }
+
+    private:
+        uint32_t read(const size_t length) {
+            uint32_t value{0};
+            if(this->offset + length <= this->data.size()) {
+                for(size_t i = 0; i < length; i++) {
+                    value |= static_cast<uint32_t>(this->data[this->offset + i]) << (i * 8);
+                }
+            }
+            this->offset += length;
+            return value;
+        }
+
+    private:
+        std::span<const uint8_t> data;
+        size_t offset{0};
+};
+
+/**
+ * @brief MurmurHash3 (x86, 32-bit)
+ *
+ * Same as `Util::Hash::MurmurHash3` in the firmware; used to validate the snapshot checksum.
+ */
+static uint32_t MurmurHash3(std::span<const uint8_t> data, const uint32_t seed) {
+    constexpr uint32_t c1{0xcc9e2d51}, c2{0x1b873593};
+    auto rotl = [](const uint32_t x, const int r) {
+        return (x << r) | (x >> (32 - r));
+    };
+
+    uint32_t h1{seed};
+    const size_t numBlocks = data.size() / 4;
+
+    for(size_t i = 0; i < numBlocks; i++) {
+        uint32_t k1;
+        memcpy(&k1, data.data() + (i * 4), sizeof(k1));
+
+        k1 *= c1;
+        k1 = rotl(k1, 15);
+        k1 *= c2;
+
+        h1 ^= k1;
+        h1 = rotl(h1, 13);
+        h1 = h1 * 5 + 0xe6546b64;
+    }
+
+    const auto tail = data.data() + (numBlocks * 4);
+    uint32_t k1{0};
+
+    switch(data.size() & 3) {
+        case 3:
+            k1 ^= tail[2] << 16;
+            [[fallthrough]];
+        case 2:
+            k1 ^= tail[1] << 8;
+            [[fallthrough]];
+        case 1:
+            k1 ^= tail[0];
+            k1 *= c1;
+            k1 = rotl(k1, 15);
+            k1 *= c2;
+            h1 ^= k1;
+    }
+
+    h1 ^= data.size();
+    h1 ^= h1 >> 16;
+    h1 *= 0x85ebca6b;
+    h1 ^= h1 >> 13;
+    h1 *= 0xc2b2ae35;
+    h1 ^= h1 >> 16;
+
+    return h1;
+}
+
+/**
+ * @brief Get a description of the set bits in the CFSR
+ */
+static std::string DescribeCfsr(const uint32_t cfsr) {
+    constexpr static const std::pair<uint32_t, std::string_view> kBits[]{
+        {(1 << 0), "IACCVIOL"}, {(1 << 1), "DACCVIOL"}, {(1 << 3), "MUNSTKERR"},
+        {(1 << 4), "MSTKERR"}, {(1 << 5), "MLSPERR"}, {(1 << 7), "MMARVALID"},
+        {(1 << 8), "IBUSERR"}, {(1 << 9), "PRECISERR"}, {(1 << 10), "IMPRECISERR"},
+        {(1 << 11), "UNSTKERR"}, {(1 << 12), "STKERR"}, {(1 << 13), "LSPERR"},
+        {(1 << 15), "BFARVALID"}, {(1 << 16), "UNDEFINSTR"}, {(1 << 17), "INVSTATE"},
+        {(1 << 18), "INVPC"}, {(1 << 19), "NOCP"}, {(1 << 24), "UNALIGNED"},
+        {(1 << 25), "DIVBYZERO"},
+    };
+
+    std::string out;
+    for(const auto &[bit, name] : kBits) {
+        if(cfsr & bit) {
+            if(!out.empty()) {
+                out += " ";
+            }
+            out += name;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Get the name of a trace event type
+ */
+static std::string_view TraceEventName(const uint8_t type) {
+    using Type = LibLoad::Device::TraceEvent::Type;
+
+    switch(static_cast<Type>(type)) {
+        case Type::TaskSwitchIn:
+            return "task in";
+        case Type::TaskSwitchOut:
+            return "task out";
+        case Type::IsrEnter:
+            return "isr enter";
+        case Type::IsrExit:
+            return "isr exit";
+        case Type::QueueSend:
+            return "queue send";
+        case Type::QueueReceive:
+            return "queue receive";
+        case Type::QueueBlockSend:
+            return "queue block send";
+        case Type::QueueBlockReceive:
+            return "queue block receive";
+        case Type::TaskNotify:
+            return "notify";
+    }
+    return "?";
+}
+
+/**
+ * @brief Decode and print a crash snapshot
+ *
+ * @param data Raw snapshot data, as read from the device
+ */
+static void PrintCrashDump(std::span<const uint8_t> data) {
+    Reader r(data);
+
+    // validate header
+    const auto magic = r.u32();
+    const auto version = r.u16();
+    const auto length = r.u16();
+    const auto checksum = r.u32();
+
+    if(magic != kMagic || version != kVersion || length != data.size()) {
+        std::cerr << rang::fg::red
+            << fmt::format("Unsupported crash snapshot (magic {:08x}, version {}, length {})",
+                    magic, version, length) << rang::style::reset << std::endl;
+        return;
+    }
+
+    if(MurmurHash3(data.subspan(12), kMagic) != checksum) {
+        std::cerr << rang::fg::yellow << "Crash snapshot checksum mismatch" << rang::style::reset
+            << std::endl;
+    }
+
+    // general information
+    const auto uptime = r.u32();
+    const auto clock = r.u32();
+    const auto reason = r.u8();
+    r.skip(3);
+    const auto message = r.string(kMessageLength);
+    const auto taskName = r.string(kTaskNameLength);
+
+    tabulate::Table info;
+    info.add_row({"Reason", (reason == 2) ? "Hard fault" : ((reason == 1) ? "Panic" :
+                fmt::format("Unknown ({})", reason))});
+    info.add_row({"Uptime", fmt::format("{:.3f} s", static_cast<double>(uptime) / 1000.)});
+    info.add_row({"Task", taskName.empty() ? "(none)" : taskName});
+    info.add_row({"Message", message});
+
+    for(auto &cell : info.column(0)) {
+        cell.format().font_align(tabulate::FontAlign::right)
+            .font_style({tabulate::FontStyle::bold});
+    }
+    std::cout << info << std::endl;
+
+    // registers
+    constexpr static const std::string_view kRegNames[]{
+        "r0", "r1", "r2", "r3", "r12", "lr", "pc", "psr", "sp", "cfsr", "hfsr", "mmfar", "bfar",
+        "afsr"
+    };
+
+    tabulate::Table regs;
+    uint32_t cfsr{0};
+    for(const auto &name : kRegNames) {
+        const auto value = r.u32();
+        if(name == "cfsr") {
+            cfsr = value;
+        }
+        regs.add_row({std::string(name), fmt::format("{:08x}", value)});
+    }
+    if(cfsr) {
+        regs.add_row({"", DescribeCfsr(cfsr)});
+    }
+
+    for(auto &cell : regs.column(0)) {
+        cell.format().font_align(tabulate::FontAlign::right)
+            .font_style({tabulate::FontStyle::bold});
+    }
+    std::cout << std::endl << rang::style::bold << "Registers" << rang::style::reset
+        << std::endl << regs << std::endl;
+
+    // stack
+    std::cout << std::endl << rang::style::bold << "Stack" << rang::style::reset << std::endl;
+    for(size_t i = 0; i < kStackWords; i++) {
+        std::cout << fmt::format("{:08x}{}", r.u32(), ((i % 8) == 7) ? "\n" : " ");
+    }
+
+    // trace records
+    const auto numRecords = std::min<size_t>(r.u32(), kTraceRecords);
+    std::cout << std::endl << rang::style::bold << "Trace (most recent last)"
+        << rang::style::reset << std::endl;
+
+    tabulate::Table trace;
+    trace.add_row({"Time", "Event", "Id"});
+
+    std::vector<std::pair<uint32_t, uint8_t>> records;
+    uint32_t lastTimestamp{0};
+    for(size_t i = 0; i < kTraceRecords; i++) {
+        const auto timestamp = r.u32();
+        const auto type = r.u8();
+        r.skip(1);
+        const auto id = r.u16();
+
+        if(i >= numRecords) {
+            continue;
+        }
+
+        // print times relative to the last record
+        records.emplace_back(timestamp, type);
+        lastTimestamp = timestamp;
+        trace.add_row({std::to_string(timestamp), std::string(TraceEventName(type)),
+                fmt::format("{}", id)});
+    }
+
+    for(size_t i = 0; i < records.size(); i++) {
+        const auto delta = static_cast<uint32_t>(lastTimestamp - records[i].first);
+        trace[i + 1][0].set_text(clock ? fmt::format("-{:.3f} µs",
+                    static_cast<double>(delta) / (static_cast<double>(clock) / 1e6)) :
+                fmt::format("-{} cycles", delta));
+    }
+    std::cout << trace << std::endl;
+
+    // task table
+    const auto numTasks = std::min<size_t>(r.u32(), kMaxTasks);
+    if(numTasks) {
+        constexpr static const char kStates[]{'*', 'R', 'B', 'S', 'x'};
+
+        tabulate::Table tasks;
+        tasks.add_row({"Name", "State", "Priority", "Stack Free", "Runtime"});
+
+        for(size_t i = 0; i < kMaxTasks; i++) {
+            const auto name = r.string(kTaskNameLength);
+            const auto runtime = r.u32();
+            const auto stackFree = r.u16();
+            const auto priority = r.u8();
+            const auto state = r.u8();
+
+            if(i >= numTasks) {
+                continue;
+            }
+
+            tasks.add_row({name, std::string(1, (state < sizeof(kStates)) ? kStates[state] : '?'),
+                    std::to_string(priority), fmt::format("{} words", stackFree),
+                    std::to_string(runtime)});
+        }
+
+        std::cout << std::endl << rang::style::bold << "Tasks" << rang::style::reset
+            << std::endl << tasks << std::endl;
+    }
+}
+
+/**
+ * @brief Read the crash snapshot from a device and print it
+ *
+ * @param device Device to read the snapshot from
+ * @param clear Whether the snapshot should be discarded on the device after reading
+ */
+void GetCrashDump(LibLoad::Device *device, const bool clear) {
+    std::vector<uint8_t> data;
+
+    if(!device->readCrashDump(data, clear)) {
+        std::cerr << rang::fg::red << "Failed to read crash snapshot" << rang::style::reset
+            << std::endl;
+        return;
+    }
+
+    if(data.empty()) {
+        std::cout << "No crash snapshot available" << std::endl;
+        return;
+    }
+
+    PrintCrashDump(data);
+}
@@ -0,0 +1,395 @@
+/**
+ * @file
+ *
+ * @brief Commands to generate inventory ROM images
+ *
+ * Builds the contents of a driver board's identification EEPROM: the IDPROM header, followed by
+ * the atoms describing the board, a checksum atom and the end atom. The resulting binary image is
+ * written to a file, to be programmed into the EEPROM.
+ *
+ * Calibration tables can be generated from the measurements of a calibration run, given as a CSV
+ * file with one measurement per line: `target,channel,ideal,actual`. The target is one of `isense`
+ * (channel current measurement), `iset` (channel current setpoint) or `vsense` (input voltage
+ * measurement); `ideal` is the value the firmware read (or requested) before calibration, and
+ * `actual` the value measured with a reference instrument, both in µA or mV. Blank lines and lines
+ * starting with `#` are ignored.
+ */
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <span>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <rang.hpp>
+
+/// IDPROM magic value ('INVi')
+constexpr static const uint32_t kMagic{0x494E5669};
+/// IDPROM header version
+constexpr static const uint8_t kVersion{0x10};
+/// Size of the IDPROM header, in bytes
+constexpr static const uint8_t kHeaderSize{8};
+/// Offset of the first atom
+constexpr static const uint16_t kFirstAtom{16};
+/// Size of the EEPROM's user data area, in bytes
+constexpr static const size_t kRomSize{0x800};
+/// Maximum number of points in a calibration table
+constexpr static const size_t kMaxCalibrationPoints{8};
+
+/**
+ * @brief Atom types
+ *
+ * These must match the values in the firmware's `Util::InventoryRom::AtomType`.
+ */
+enum class AtomType: uint8_t {
+    End                                 = 0x00,
+    HwRevision                          = 0x01,
+    Name                                = 0x02,
+    Manufacturer                        = 0x03,
+    DriverId                            = 0x04,
+    Crc32                               = 0x05,
+    DriverRating                        = 0x40,
+    Calibration                         = 0x41,
+};
+
+/**
+ * @brief Calibration targets
+ *
+ * These must match the values in the firmware's `App::Control::LoadDriver::CalibrationTarget`.
+ */
+enum class CalibrationTarget: uint8_t {
+    ChannelCurrentSense                 = 0x00,
+    ChannelCurrentSetpoint              = 0x01,
+    InputVoltageSense                   = 0x02,
+};
+
+/// Calibration points (ideal, actual) of a single converter, keyed by target and channel
+using CalibrationData = std::map<std::pair<uint8_t, uint8_t>,
+      std::vector<std::pair<int32_t, int32_t>>>;
+
+/**
+ * @brief Calculate CRC-32
+ *
+ * This is the standard (IEEE 802.3) CRC, matching the firmware's `Util::Crc32`. Performance isn't
+ * a concern here, so it's calculated bit by bit.
+ */
+static uint32_t Crc32(std::span<const uint8_t> data) {
+    uint32_t crc{0xFFFFFFFF};
+
+    for(const auto byte : data) {
+        crc ^= byte;
+        for(size_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+/**
+ * @brief Helper to build a ROM image
+ */
+class RomWriter {
+    public:
+        /**
+         * @brief Append a big endian integer
+         */
+        void putInt(const uint32_t value, const size_t bytes) {
+            for(size_t i = 0; i < bytes; i++) {
+                this->data.push_back((value >> (8 * (bytes - i - 1))) & 0xFF);
+            }
+        }
+
+        /**
+         * @brief Append an atom
+         *
+         * @return Whether the atom was added; it fails if the payload is too long
+         */
+        bool putAtom(const AtomType type, std::span<const uint8_t> payload) {
+            if(payload.size() > 0xFF) {
+                return false;
+            }
+
+            this->data.push_back(static_cast<uint8_t>(type));
+            this->data.push_back(static_cast<uint8_t>(payload.size()));
+            this->data.insert(this->data.end(), payload.begin(), payload.end());
+            return true;
+        }
+
+        /**
+         * @brief Append an atom with a string payload
+         */
+        bool putAtom(const AtomType type, const std::string &str) {
+            return this->putAtom(type, {reinterpret_cast<const uint8_t *>(str.data()),
+                    str.size()});
+        }
+
+    public:
+        std::vector<uint8_t> data;
+};
+
+/**
+ * @brief Parse an UUID string
+ *
+ * @param str UUID in the canonical hex string format; dashes are ignored
+ * @param outBytes Buffer to receive the binary UUID
+ *
+ * @return Whether the string was a valid UUID
+ */
+static bool ParseUuid(const std::string &str, std::array<uint8_t, 16> &outBytes) {
+    size_t nybbles{0};
+
+    for(const auto ch : str) {
+        if(ch == '-') {
+            continue;
+        } else if(nybbles == 32 || !isxdigit(ch)) {
+            return false;
+        }
+
+        const uint8_t value = isdigit(ch) ? (ch - '0') : (tolower(ch) - 'a' + 10);
+        auto &byte = outBytes[nybbles / 2];
+        byte = (nybbles & 1) ? (byte | value) : (value << 4);
+        nybbles++;
+    }
+
+    return nybbles == 32;
+}
+
+/**
+ * @brief Read the measurements of a calibration run
+ *
+ * @param path Path of the CSV file to read
+ * @param outData Map to receive the measurements, grouped by converter
+ *
+ * @return Whether the file was read successfully
+ */
+static bool ReadCalibration(const std::string &path, CalibrationData &outData) {
+    std::ifstream in(path);
+    if(!in.good()) {
+        std::cerr << rang::fg::red << fmt::format("Failed to open '{}'", path)
+            << rang::style::reset << std::endl;
+        return false;
+    }
+
+    std::string line;
+    size_t lineNo{0};
+
+    while(std::getline(in, line)) {
+        lineNo++;
+        if(line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // split into fields
+        std::vector<std::string> fields;
+        std::stringstream str(line);
+        std::string field;
+
+        while(std::getline(str, field, ',')) {
+            field.erase(0, field.find_first_not_of(" \t"));
+            field.erase(field.find_last_not_of(" \t\r") + 1);
+            fields.push_back(field);
+        }
+
+        if(fields.size() != 4) {
+            std::cerr << rang::fg::red << fmt::format("{}:{}: expected 4 fields", path, lineNo)
+                << rang::style::reset << std::endl;
+            return false;
+        }
+
+        // decode them
+        CalibrationTarget target;
+        if(fields[0] == "isense") {
+            target = CalibrationTarget::ChannelCurrentSense;
+        } else if(fields[0] == "iset") {
+            target = CalibrationTarget::ChannelCurrentSetpoint;
+        } else if(fields[0] == "vsense") {
+            target = CalibrationTarget::InputVoltageSense;
+        } else {
+            std::cerr << rang::fg::red << fmt::format("{}:{}: invalid target '{}'", path, lineNo,
+                    fields[0]) << rang::style::reset << std::endl;
+            return false;
+        }
+
+        try {
+            const auto channel = std::stoul(fields[1]);
+            const auto ideal = std::stol(fields[2]), actual = std::stol(fields[3]);
+
+            if(channel > 0xFF) {
+                throw std::out_of_range("channel");
+            }
+
+            outData[{static_cast<uint8_t>(target), static_cast<uint8_t>(channel)}].emplace_back(
+                    ideal, actual);
+        } catch(const std::exception &) {
+            std::cerr << rang::fg::red << fmt::format("{}:{}: invalid value", path, lineNo)
+                << rang::style::reset << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reduce the measurements of a converter to a calibration table
+ *
+ * Measurements at the same ideal value are averaged. If there are more distinct values than fit
+ * in a table, points are picked evenly spaced across them, always including the first and last
+ * so that the full calibrated range is covered.
+ *
+ * @param points Measurements of the converter, as pairs of ideal and actual value
+ *
+ * @return Table points, in order of increasing ideal value
+ */
+static std::vector<std::pair<int32_t, int32_t>> MakeCalibrationTable(
+        std::vector<std::pair<int32_t, int32_t>> points) {
+    std::vector<std::pair<int32_t, int32_t>> averaged, table;
+
+    std::sort(points.begin(), points.end());
+
+    for(size_t i = 0; i < points.size();) {
+        int64_t sum{0};
+        size_t j{i};
+
+        for(; j < points.size() && points[j].first == points[i].first; j++) {
+            sum += points[j].second;
+        }
+
+        averaged.emplace_back(points[i].first, static_cast<int32_t>(sum /
+                    static_cast<int64_t>(j - i)));
+        i = j;
+    }
+
+    if(averaged.size() <= kMaxCalibrationPoints) {
+        return averaged;
+    }
+
+    for(size_t i = 0; i < kMaxCalibrationPoints; i++) {
+        table.push_back(averaged[(i * (averaged.size() - 1)) / (kMaxCalibrationPoints - 1)]);
+    }
+
+    return table;
+}
+
+/**
+ * @brief Generate an inventory ROM image
+ *
+ * The image contains all atoms that were specified, followed by a checksum atom covering the
+ * entire image preceding it, and the end atom.
+ *
+ * @param path Path of the image file to write
+ * @param name Descriptive name of the board (omitted if empty)
+ * @param manufacturer Manufacturer name (omitted if empty)
+ * @param revision Hardware revision
+ * @param driverId Driver UUID string
+ * @param maxVoltage Maximum input voltage rating, in mV
+ * @param maxCurrent Maximum load current rating, in mA; the rating is omitted if both are 0
+ * @param calibrationPath Path of a calibration run CSV file (no calibration if empty)
+ */
+void MakeIdprom(const std::string &path, const std::string &name,
+        const std::string &manufacturer, const uint16_t revision, const std::string &driverId,
+        const uint32_t maxVoltage, const uint32_t maxCurrent,
+        const std::string &calibrationPath) {
+    RomWriter rom;
+
+    // header, padded to the first atom
+    rom.putInt(kMagic, 4);
+    rom.putInt(kHeaderSize, 1);
+    rom.putInt(kVersion, 1);
+    rom.putInt(kFirstAtom, 2);
+    rom.data.resize(kFirstAtom, 0x00);
+
+    // atoms
+    std::array<uint8_t, 2> revBytes{static_cast<uint8_t>(revision >> 8),
+        static_cast<uint8_t>(revision & 0xFF)};
+    rom.putAtom(AtomType::HwRevision, revBytes);
+
+    std::array<uint8_t, 16> uuid;
+    if(!ParseUuid(driverId, uuid)) {
+        std::cerr << rang::fg::red << fmt::format("Invalid driver id '{}'", driverId)
+            << rang::style::reset << std::endl;
+        return;
+    }
+    rom.putAtom(AtomType::DriverId, uuid);
+
+    if(!name.empty() && !rom.putAtom(AtomType::Name, name)) {
+        std::cerr << rang::fg::red << "Name is too long" << rang::style::reset << std::endl;
+        return;
+    }
+    if(!manufacturer.empty() && !rom.putAtom(AtomType::Manufacturer, manufacturer)) {
+        std::cerr << rang::fg::red << "Manufacturer is too long" << rang::style::reset
+            << std::endl;
+        return;
+    }
+
+    if(maxVoltage || maxCurrent) {
+        RomWriter rating;
+        rating.putInt(maxVoltage, 4);
+        rating.putInt(maxCurrent, 4);
+        rom.putAtom(AtomType::DriverRating, rating.data);
+    }
+
+    if(!calibrationPath.empty()) {
+        CalibrationData data;
+        if(!ReadCalibration(calibrationPath, data)) {
+            return;
+        }
+
+        for(const auto &[key, points] : data) {
+            const auto table = MakeCalibrationTable(points);
+            if(table.size() < 2) {
+                std::cerr << rang::fg::red << fmt::format(
+                        "Calibration for target {} channel {} needs at least 2 distinct points",
+                        key.first, key.second) << rang::style::reset << std::endl;
+                return;
+            }
+
+            RomWriter cal;
+            cal.putInt(key.first, 1);
+            cal.putInt(key.second, 1);
+
+            for(const auto &[ideal, actual] : table) {
+                cal.putInt(static_cast<uint32_t>(ideal), 4);
+                cal.putInt(static_cast<uint32_t>(actual), 4);
+            }
+
+            rom.putAtom(AtomType::Calibration, cal.data);
+        }
+    }
+
+    // checksum over everything so far, then terminate
+    const auto crc = Crc32(rom.data);
+
+    RomWriter crcBytes;
+    crcBytes.putInt(crc, 4);
+    rom.putAtom(AtomType::Crc32, crcBytes.data);
+    rom.putAtom(AtomType::End, std::span<const uint8_t>{});
+
+    if(rom.data.size() > kRomSize) {
+        std::cerr << rang::fg::red
+            << fmt::format("Image too large ({} bytes, max {})", rom.data.size(), kRomSize)
+            << rang::style::reset << std::endl;
+        return;
+    }
+
+    // write it out
+    std::ofstream out(path, std::ios::binary);
+    if(!out.good()) {
+        std::cerr << rang::fg::red << fmt::format("Failed to open '{}' for writing", path)
+            << rang::style::reset << std::endl;
+        return;
+    }
+
+    out.write(reinterpret_cast<const char *>(rom.data.data()), rom.data.size());
+
+    std::cout << fmt::format("Wrote {} byte image (crc {:08x}) to '{}'", rom.data.size(), crc,
+            path) << std::endl;
+}
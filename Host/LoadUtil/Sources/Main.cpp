@@ -11,6 +11,15 @@
 #include <LibLoad.h>
 
 extern void GetInfo(LibLoad::Device *device);
+extern void PrintTaskStats(LibLoad::Device *device);
+extern void PrintHeapStats(LibLoad::Device *device);
+extern void DumpTrace(LibLoad::Device *device, const std::string &path);
+extern void ResetTrace(LibLoad::Device *device);
+extern void GetCrashDump(LibLoad::Device *device, const bool clear);
+extern void MakeIdprom(const std::string &path, const std::string &name,
+        const std::string &manufacturer, const uint16_t revision, const std::string &driverId,
+        const uint32_t maxVoltage, const uint32_t maxCurrent,
+        const std::string &calibrationPath);
 
 /**
  * @brief Initialize the load library
@@ -66,7 +75,11 @@ static void PrintDeviceList() {
  * device to connect to, and what actions to perform.
  */
 int main(int argc, const char **argv) {
-    std::string serial;
+    std::string serial, tracePath{"trace.json"};
+    bool clearCrashDump{false}, resetTrace{false};
+    std::string idpromPath, idpromName, idpromManufacturer, idpromDriverId, idpromCalibration;
+    uint16_t idpromRevision{0};
+    uint32_t idpromMaxVoltage{0}, idpromMaxCurrent{0};
 
     // initialize
     InitLib();
@@ -96,6 +109,81 @@ int main(int argc, const char **argv) {
         }
     })->needs(connectGroup);
 
+    // diagnostics
+    app.add_subcommand("task-stats", "Print firmware task CPU, stack and latency statistics")
+        ->callback([&](){
+        auto dev = LibLoad::Connect(serial);
+        if(dev) {
+            PrintTaskStats(dev);
+        } else {
+            std::cerr << rang::fg::red
+                << fmt::format("Failed to connect to device S/N '{}'", serial)
+                << rang::style::reset << std::endl;
+        }
+    })->needs(connectGroup);
+
+    app.add_subcommand("heap-stats", "Print firmware slab allocator usage statistics")
+        ->callback([&](){
+        auto dev = LibLoad::Connect(serial);
+        if(dev) {
+            PrintHeapStats(dev);
+        } else {
+            std::cerr << rang::fg::red
+                << fmt::format("Failed to connect to device S/N '{}'", serial)
+                << rang::style::reset << std::endl;
+        }
+    })->needs(connectGroup);
+
+    auto trace = app.add_subcommand("trace",
+            "Read the firmware event trace and convert it to Chrome/Perfetto JSON");
+    trace->add_option("--output,-o", tracePath, "Path of the JSON file to write");
+    trace->add_flag("--reset", resetTrace, "Discard the trace and restart recording instead");
+    trace->callback([&](){
+        auto dev = LibLoad::Connect(serial);
+        if(dev) {
+            if(resetTrace) {
+                ResetTrace(dev);
+            } else {
+                DumpTrace(dev, tracePath);
+            }
+        } else {
+            std::cerr << rang::fg::red
+                << fmt::format("Failed to connect to device S/N '{}'", serial)
+                << rang::style::reset << std::endl;
+        }
+    })->needs(connectGroup);
+
+    auto crash = app.add_subcommand("crash-dump",
+            "Decode the crash snapshot left behind by a previous firmware run");
+    crash->add_flag("--clear", clearCrashDump, "Discard the snapshot after reading it");
+    crash->callback([&](){
+        auto dev = LibLoad::Connect(serial);
+        if(dev) {
+            GetCrashDump(dev, clearCrashDump);
+        } else {
+            std::cerr << rang::fg::red
+                << fmt::format("Failed to connect to device S/N '{}'", serial)
+                << rang::style::reset << std::endl;
+        }
+    })->needs(connectGroup);
+
+    // offline tools
+    auto idprom = app.add_subcommand("make-idprom",
+            "Generate a checksummed inventory ROM image for a driver board");
+    idprom->add_option("--output,-o", idpromPath, "Path of the image file to write")->required();
+    idprom->add_option("--driver-id", idpromDriverId, "Driver UUID")->required();
+    idprom->add_option("--revision", idpromRevision, "Hardware revision")->required();
+    idprom->add_option("--name", idpromName, "Descriptive board name");
+    idprom->add_option("--manufacturer", idpromManufacturer, "Manufacturer name");
+    idprom->add_option("--max-voltage", idpromMaxVoltage, "Maximum input voltage (mV)");
+    idprom->add_option("--max-current", idpromMaxCurrent, "Maximum load current (mA)");
+    idprom->add_option("--calibration", idpromCalibration,
+            "Calibration run measurements (CSV) to generate calibration tables from");
+    idprom->callback([&](){
+        MakeIdprom(idpromPath, idpromName, idpromManufacturer, idpromRevision, idpromDriverId,
+                idpromMaxVoltage, idpromMaxCurrent, idpromCalibration);
+    })->excludes(connectGroup);
+
     // perform parsing
     app.require_subcommand(1);
     CLI11_PARSE(app, argc, argv);
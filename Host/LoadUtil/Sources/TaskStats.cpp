@@ -0,0 +1,127 @@
+/**
+ * @file
+ *
+ * @brief Commands to get firmware runtime and memory statistics
+ */
+#include <array>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <rang.hpp>
+#include <tabulate/table.hpp>
+
+#include <LibLoad.h>
+
+
+
+/**
+ * @brief Print task runtime statistics
+ *
+ * Query the device for per task CPU usage, stack usage and notification latency, and print it as
+ * a table; followed by the queueing latency of each driver bus request priority. Usage values
+ * cover the time since the previous query.
+ */
+void PrintTaskStats(LibLoad::Device *device) {
+    double totalLoad{0};
+    std::vector<LibLoad::Device::TaskStats> tasks;
+    std::vector<LibLoad::Device::BusQueueStats> busQueues;
+
+    if(!device->readTaskStats(totalLoad, tasks, busQueues)) {
+        std::cerr << rang::fg::red << "Failed to read task statistics" << rang::style::reset
+            << std::endl;
+        return;
+    }
+
+    // make a pretty table
+    tabulate::Table table;
+    table.add_row({"Task", "Priority", "CPU", "Stack Free", "Latency (avg)", "Latency (max)"});
+
+    for(const auto &task : tasks) {
+        table.add_row({task.name, fmt::format("{}", task.priority),
+                fmt::format("{:.2f} %", task.cpuLoad), fmt::format("{} words", task.stackFree),
+                fmt::format("{} µs", task.notifyLatencyAvg),
+                fmt::format("{} µs", task.notifyLatencyMax)});
+    }
+
+    for(auto &cell : table.row(0)) {
+        cell.format().font_align(tabulate::FontAlign::center)
+            .font_style({tabulate::FontStyle::bold});
+    }
+    for(size_t i = 1; i < 6; i++) {
+        for(auto &cell : table.column(i)) {
+            cell.format().font_align(tabulate::FontAlign::right);
+        }
+    }
+
+    std::cout << rang::style::bold << fmt::format("Total CPU load: {:.2f} %", totalLoad)
+        << rang::style::reset << std::endl << table << std::endl;
+
+    // bus queueing latency
+    constexpr static const std::array<std::string_view, 3> kPriorityNames{{
+        "High", "Normal", "Low"
+    }};
+
+    tabulate::Table busTable;
+    busTable.add_row({"I²C Priority", "Requests", "Wait (avg)", "Wait (max)"});
+
+    for(size_t i = 0; i < busQueues.size(); i++) {
+        const auto &queue = busQueues[i];
+        const auto name = (i < kPriorityNames.size()) ? std::string(kPriorityNames[i]) :
+            fmt::format("{}", i);
+
+        busTable.add_row({name, fmt::format("{}", queue.numRequests),
+                fmt::format("{} µs", queue.latencyAvg), fmt::format("{} µs", queue.latencyMax)});
+    }
+
+    for(auto &cell : busTable.row(0)) {
+        cell.format().font_align(tabulate::FontAlign::center)
+            .font_style({tabulate::FontStyle::bold});
+    }
+    for(size_t i = 1; i < 4; i++) {
+        for(auto &cell : busTable.column(i)) {
+            cell.format().font_align(tabulate::FontAlign::right);
+        }
+    }
+
+    std::cout << busTable << std::endl;
+}
+
+/**
+ * @brief Print slab allocator statistics
+ *
+ * Query the device for the usage of each slab allocator size class, and print it as a table.
+ */
+void PrintHeapStats(LibLoad::Device *device) {
+    std::vector<LibLoad::Device::HeapClassStats> classes;
+
+    if(!device->readHeapStats(classes)) {
+        std::cerr << rang::fg::red << "Failed to read heap statistics" << rang::style::reset
+            << std::endl;
+        return;
+    }
+
+    // make a pretty table
+    tabulate::Table table;
+    table.add_row({"Block Size", "Blocks", "In Use", "Peak", "Allocations", "Overflows"});
+
+    for(const auto &cls : classes) {
+        table.add_row({fmt::format("{} bytes", cls.blockSize), fmt::format("{}", cls.numBlocks),
+                fmt::format("{}", cls.inUse), fmt::format("{}", cls.peakInUse),
+                fmt::format("{}", cls.numAllocs), fmt::format("{}", cls.numOverflows)});
+    }
+
+    for(auto &cell : table.row(0)) {
+        cell.format().font_align(tabulate::FontAlign::center)
+            .font_style({tabulate::FontStyle::bold});
+    }
+    for(size_t i = 0; i < 6; i++) {
+        for(auto &cell : table.column(i)) {
+            cell.format().font_align(tabulate::FontAlign::right);
+        }
+    }
+
+    std::cout << table << std::endl;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file
+ *
+ * @brief Commands to read out the firmware event trace
+ *
+ * The trace is converted into the Chrome trace event (JSON) format, which can be loaded into
+ * Perfetto or `chrome://tracing` to inspect task scheduling on a timeline.
+ */
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <rang.hpp>
+
+#include <LibLoad.h>
+
+using Event = LibLoad::Device::TraceEvent;
+
+/// Process id used for all trace events
+constexpr static const unsigned int kPid{1};
+/// Base thread id for interrupt handlers (the exception number is added to this)
+constexpr static const unsigned int kIsrTidBase{0x10000};
+
+/**
+ * @brief Escape a string for inclusion in JSON output
+ */
+static std::string EscapeJson(const std::string_view &str) {
+    std::string out;
+    out.reserve(str.size());
+
+    for(const auto ch : str) {
+        if(ch == '"' || ch == '\\') {
+            out.push_back('\\');
+            out.push_back(ch);
+        } else if(static_cast<unsigned char>(ch) < 0x20) {
+            out += fmt::format("\\u{:04x}", static_cast<unsigned int>(ch));
+        } else {
+            out.push_back(ch);
+        }
+    }
+
+    return out;
+}
+
+/**
+ * @brief Convert a trace to Chrome trace event format
+ *
+ * Task execution and interrupt handlers are emitted as duration events, each on their own track;
+ * queue operations and notifications are emitted as instant events on the track of the context
+ * they happened in (or the notified task, respectively.)
+ *
+ * @param trace Trace to convert
+ * @param out Stream to write the JSON to
+ */
+static void WriteChromeTrace(const LibLoad::Device::Trace &trace, std::ostream &out) {
+    bool first{true};
+    auto emit = [&](const std::string &event) {
+        out << (first ? "\n" : ",\n") << "  " << event;
+        first = false;
+    };
+
+    auto taskName = [&](const unsigned int id) -> std::string {
+        if(trace.taskNames.contains(id)) {
+            return trace.taskNames.at(id);
+        }
+        return fmt::format("Task {}", id);
+    };
+
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+    // name all tracks
+    for(const auto &[id, name] : trace.taskNames) {
+        emit(fmt::format(R"({{"name": "thread_name", "ph": "M", "pid": {}, "tid": {}, )"
+                    R"("args": {{"name": "{}"}}}})", kPid, id, EscapeJson(name)));
+    }
+
+    // convert events
+    unsigned int currentTask{0};
+    std::vector<unsigned int> isrStack;
+
+    for(const auto &event : trace.events) {
+        const auto context = isrStack.empty() ? currentTask : isrStack.back();
+
+        switch(event.type) {
+            case Event::Type::TaskSwitchIn:
+                currentTask = event.id;
+                emit(fmt::format(R"({{"name": "{}", "ph": "B", "ts": {:.3f}, "pid": {}, )"
+                            R"("tid": {}}})", EscapeJson(taskName(event.id)), event.timestamp,
+                            kPid, event.id));
+                break;
+            case Event::Type::TaskSwitchOut:
+                emit(fmt::format(R"({{"ph": "E", "ts": {:.3f}, "pid": {}, "tid": {}}})",
+                            event.timestamp, kPid, event.id));
+                break;
+
+            case Event::Type::IsrEnter: {
+                const auto tid = kIsrTidBase + event.id;
+                if(!trace.taskNames.contains(tid)) {
+                    emit(fmt::format(R"({{"name": "thread_name", "ph": "M", "pid": {}, )"
+                                R"("tid": {}, "args": {{"name": "IRQ {}"}}}})", kPid, tid,
+                                static_cast<int>(event.id) - 16));
+                }
+                isrStack.push_back(tid);
+                emit(fmt::format(R"({{"name": "IRQ {}", "ph": "B", "ts": {:.3f}, "pid": {}, )"
+                            R"("tid": {}}})", static_cast<int>(event.id) - 16, event.timestamp,
+                            kPid, tid));
+                break;
+            }
+            case Event::Type::IsrExit:
+                if(!isrStack.empty()) {
+                    isrStack.pop_back();
+                }
+                emit(fmt::format(R"({{"ph": "E", "ts": {:.3f}, "pid": {}, "tid": {}}})",
+                            event.timestamp, kPid, kIsrTidBase + event.id));
+                break;
+
+            case Event::Type::QueueSend:
+            case Event::Type::QueueReceive:
+            case Event::Type::QueueBlockSend:
+            case Event::Type::QueueBlockReceive: {
+                std::string_view name;
+                switch(event.type) {
+                    case Event::Type::QueueSend:
+                        name = "queue send";
+                        break;
+                    case Event::Type::QueueReceive:
+                        name = "queue receive";
+                        break;
+                    case Event::Type::QueueBlockSend:
+                        name = "blocked on queue send";
+                        break;
+                    default:
+                        name = "blocked on queue receive";
+                        break;
+                }
+
+                emit(fmt::format(R"({{"name": "{}", "ph": "i", "s": "t", "ts": {:.3f}, )"
+                            R"("pid": {}, "tid": {}, "args": {{"queue": "{:04x}"}}}})", name,
+                            event.timestamp, kPid, context, event.id));
+                break;
+            }
+
+            case Event::Type::TaskNotify:
+                emit(fmt::format(R"({{"name": "notified", "ph": "i", "s": "t", "ts": {:.3f}, )"
+                            R"("pid": {}, "tid": {}}})", event.timestamp, kPid, event.id));
+                break;
+
+            default:
+                std::cerr << rang::fg::yellow
+                    << fmt::format("Unknown trace event type {:02x}",
+                            static_cast<unsigned int>(event.type))
+                    << rang::style::reset << std::endl;
+                break;
+        }
+    }
+
+    out << "\n]}" << std::endl;
+}
+
+/**
+ * @brief Read the event trace and write it to a file
+ *
+ * @param device Device to read the trace from
+ * @param path Path of the JSON file to write
+ */
+void DumpTrace(LibLoad::Device *device, const std::string &path) {
+    LibLoad::Device::Trace trace;
+
+    if(!device->readTrace(trace)) {
+        std::cerr << rang::fg::red << "Failed to read event trace" << rang::style::reset
+            << std::endl;
+        return;
+    }
+
+    std::ofstream out(path);
+    if(!out.good()) {
+        std::cerr << rang::fg::red << fmt::format("Failed to open '{}' for writing", path)
+            << rang::style::reset << std::endl;
+        return;
+    }
+
+    WriteChromeTrace(trace, out);
+
+    std::cout << fmt::format("Wrote {} events ({:.3f} ms) to '{}'", trace.events.size(),
+            trace.events.empty() ? 0. : (trace.events.back().timestamp / 1000.), path)
+        << std::endl;
+}
+
+/**
+ * @brief Discard the event trace and restart recording
+ *
+ * @param device Device whose trace to reset
+ */
+void ResetTrace(LibLoad::Device *device) {
+    if(!device->resetTrace()) {
+        std::cerr << rang::fg::red << "Failed to reset event trace" << rang::style::reset
+            << std::endl;
+        return;
+    }
+
+    std::cout << "Event trace reset" << std::endl;
+}